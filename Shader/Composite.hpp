@@ -197,6 +197,18 @@ void ClearBufferCS(COMPUTE_SHADER_INPUT)
 	buffer[inDispatchThreadID.x] = mRootConstants.mData1;
 }
 
+[numthreads(64, 1, 1)]
+void SpatialCacheUpdateCS(COMPUTE_SHADER_INPUT)
+{
+	if (inDispatchThreadID.x >= SpatialCache::HASHMAP_SIZE)
+		return;
+
+	if (SpatialCache::Evict(inDispatchThreadID.x))
+		RadianceCache::Clear(inDispatchThreadID.x);
+	else if (mConstants.mSpatialCache.mRadianceCacheActive)
+		RadianceCache::ResolveCell(inDispatchThreadID.x);
+}
+
 [numthreads(8, 8, 1)]
 void GeneratTextureCS(COMPUTE_SHADER_INPUT)
 {
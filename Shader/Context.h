@@ -66,12 +66,18 @@ struct SurfaceContext
 {	
 	void			LoadSurface()
 	{
-		USING_RESOURCE(StructuredBuffer<uint>,   RaytraceIndicesSRV);
+		USING_RESOURCE(ByteAddressBuffer,        RaytraceIndicesSRV);
+#if QUANTIZED_VERTEX_ATTRIBUTES
+		USING_RESOURCE(StructuredBuffer<uint2>,  RaytraceVerticesSRV);
+		USING_RESOURCE(StructuredBuffer<uint>,   RaytraceNormalsSRV);
+		USING_RESOURCE(StructuredBuffer<uint>,   RaytraceUVsSRV);
+#else
 		USING_RESOURCE(StructuredBuffer<float3>, RaytraceVerticesSRV);
 		USING_RESOURCE(StructuredBuffer<float3>, RaytraceNormalsSRV);
 		USING_RESOURCE(StructuredBuffer<float2>, RaytraceUVsSRV);
+#endif // QUANTIZED_VERTEX_ATTRIBUTES
 
-		// Only support 32bit index for simplicity
+		// 16bit or 32bit index per instance as InstanceData::mFlags.mIndex16Bit, packed by Scene::PackIndices
 		// see https://github.com/microsoft/DirectX-Graphics-Samples/blob/master/Samples/Desktop/D3D12Raytracing/src/D3D12RaytracingSimpleLighting/Raytracing.hlsl for reference
 #if NVAPI_CLUSTERS
 		StructuredBuffer<meshopt_Meshlet> MeshletBuffer = ResourceDescriptorHeap[mInstanceData.mClusterMeshletBufferIndex];
@@ -81,24 +87,45 @@ struct SurfaceContext
 		uint base_index					= mPrimitiveIndex * kIndexCountPerTriangle + meshlet.triangle_offset;
 		uint3 indices					= uint3(IndexBuffer[base_index], IndexBuffer[base_index + 1], IndexBuffer[base_index + 2]) + mInstanceData.mVertexOffset;
 #else
-		uint base_index					= mPrimitiveIndex * kIndexCountPerTriangle + mInstanceData.mIndexOffset;
-		uint3 indices					= uint3(RaytraceIndicesSRV[base_index], RaytraceIndicesSRV[base_index + 1], RaytraceIndicesSRV[base_index + 2]) + mInstanceData.mVertexOffset;
+		uint3 indices					= 0;
+		if (mInstanceData.mFlags.mIndex16Bit)
+		{
+			// 3 indices span 2 dwords, starting at either half of first one
+			uint address				= mInstanceData.mIndexByteOffset + mPrimitiveIndex * kIndexCountPerTriangle * 2;
+			uint2 words					= RaytraceIndicesSRV.Load2(address & ~3u);
+			indices						= (address & 2) != 0 ? uint3(words.x >> 16, words.y & 0xffff, words.y >> 16) : uint3(words.x & 0xffff, words.x >> 16, words.y & 0xffff);
+		}
+		else
+			indices						= RaytraceIndicesSRV.Load3(mInstanceData.mIndexByteOffset + mPrimitiveIndex * kIndexCountPerTriangle * 4);
+		indices							+= mInstanceData.mVertexOffset;
 #endif // NVAPI_CLUSTERS
 
 		mVertexPositionOS				= 0;
 		{
+#if QUANTIZED_VERTEX_ATTRIBUTES
+			mVertexPositions[0]			= DecodePositionUnorm16(RaytraceVerticesSRV[indices[0]], mInstanceData.mPositionQuantizationMin, mInstanceData.mPositionQuantizationScale);
+			mVertexPositions[1]			= DecodePositionUnorm16(RaytraceVerticesSRV[indices[1]], mInstanceData.mPositionQuantizationMin, mInstanceData.mPositionQuantizationScale);
+			mVertexPositions[2]			= DecodePositionUnorm16(RaytraceVerticesSRV[indices[2]], mInstanceData.mPositionQuantizationMin, mInstanceData.mPositionQuantizationScale);
+#else
 			mVertexPositions[0]			= RaytraceVerticesSRV[indices[0]].xyz;
 			mVertexPositions[1]			= RaytraceVerticesSRV[indices[1]].xyz;
 			mVertexPositions[2]			= RaytraceVerticesSRV[indices[2]].xyz;
+#endif // QUANTIZED_VERTEX_ATTRIBUTES
 		}
 		mVertexPositionOS				= mVertexPositions[0] * mBarycentrics.x + mVertexPositions[1] * mBarycentrics.y + mVertexPositions[2] * mBarycentrics.z;
 
 		mVertexNormalOS					= 0;
 		if (mInstanceData.mFlags.mNormal)
 		{
+#if QUANTIZED_VERTEX_ATTRIBUTES
+			mVertexNormals[0]			= DecodeNormalOct16(RaytraceNormalsSRV[indices[0]]);
+			mVertexNormals[1]			= DecodeNormalOct16(RaytraceNormalsSRV[indices[1]]);
+			mVertexNormals[2]			= DecodeNormalOct16(RaytraceNormalsSRV[indices[2]]);
+#else
 			mVertexNormals[0]			= RaytraceNormalsSRV[indices[0]];
 			mVertexNormals[1]			= RaytraceNormalsSRV[indices[1]];
 			mVertexNormals[2]			= RaytraceNormalsSRV[indices[2]];
+#endif // QUANTIZED_VERTEX_ATTRIBUTES
 			float3 normal				= normalize(mVertexNormals[0] * mBarycentrics.x + mVertexNormals[1] * mBarycentrics.y + mVertexNormals[2] * mBarycentrics.z);
 			mVertexNormalOS				= normal;	
 		}
@@ -111,9 +138,15 @@ struct SurfaceContext
 		mUV								= 0;
 		if (mInstanceData.mFlags.mUV)
 		{
+#if QUANTIZED_VERTEX_ATTRIBUTES
+			mVertexUVs[0]				= DecodeUVHalf(RaytraceUVsSRV[indices[0]]);
+			mVertexUVs[1]				= DecodeUVHalf(RaytraceUVsSRV[indices[1]]);
+			mVertexUVs[2]				= DecodeUVHalf(RaytraceUVsSRV[indices[2]]);
+#else
 			mVertexUVs[0]				= RaytraceUVsSRV[indices[0]];
 			mVertexUVs[1]				= RaytraceUVsSRV[indices[1]];
 			mVertexUVs[2]				= RaytraceUVsSRV[indices[2]];
+#endif // QUANTIZED_VERTEX_ATTRIBUTES
 			mUV							= mVertexUVs[0] * mBarycentrics.x + mVertexUVs[1] * mBarycentrics.y + mVertexUVs[2] * mBarycentrics.z;
 		}
 	}
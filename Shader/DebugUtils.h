@@ -6,6 +6,7 @@
 #include "Context.h"
 #include "Reservoir.h"
 #include "SpatialCache.h"
+#include "RadianceCache.h"
 #include "ShaderPrint.h"
 
 namespace Visualize
@@ -28,8 +29,9 @@ namespace Visualize
         case VisualizeMode::RoughnessAlpha:					inPathContext.mEmission = inHitContext.RoughnessAlpha(); ioContinueBounce = false; break;
         case VisualizeMode::RecursionDepth:					ioContinueBounce = true; break;
         case VisualizeMode::RandomState:					ioContinueBounce = inPathContext.mRecursionDepth <= GetDebugRecursion(); break;
-        case VisualizeMode::SpatialHash:					inPathContext.mEmission = SpatialCache::HashGridGetColorFromHash32(SpatialCache::FindOrInsert(inHitContext.PositionWS(), 0, SpatialCache::kCellSize)); ioContinueBounce = false; break;
-        case VisualizeMode::SpatialData:					inPathContext.mEmission = SpatialCache::LoadData(SpatialCache::FindOrInsert(inHitContext.PositionWS(), 0, SpatialCache::kCellSize)) / 1024.0; ioContinueBounce = false; break;
+        case VisualizeMode::SpatialHash:					inPathContext.mEmission = SpatialCache::HashGridGetColorFromHash32(SpatialCache::FindOrInsert(inHitContext.PositionWS(), 0, SpatialCache::CellSize(inHitContext.PositionWS()))); ioContinueBounce = false; break;
+        case VisualizeMode::SpatialData:					inPathContext.mEmission = SpatialCache::LoadData(SpatialCache::FindOrInsert(inHitContext.PositionWS(), 0, SpatialCache::CellSize(inHitContext.PositionWS()))) / 1024.0; ioContinueBounce = false; break;
+        case VisualizeMode::RadianceCache:					inPathContext.mEmission = RadianceCache::Load(SpatialCache::FindOrInsert(inHitContext.PositionWS(), inHitContext.mVertexNormalWS, SpatialCache::CellSize(inHitContext.PositionWS()))).xyz; ioContinueBounce = false; break;
         default:											inPathContext.mEmission = sVisualizeModeValue; ioContinueBounce = false; break;
         }
 #endif // SHADER_DEBUG
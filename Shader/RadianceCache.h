@@ -0,0 +1,143 @@
+#pragma once
+// Also included by C++ for CPU-side reference integrator, see Source/RadianceCacheIntegrator.cpp
+#ifndef __cplusplus
+#include "SpatialCache.h"
+#endif // __cplusplus
+
+// World space radiance cache in cells of SpatialCache, after SHARC https://github.com/NVIDIA-RTX/SHARC
+//   Update: radiance leaving each path vertex is accumulated into its cell in fixed point
+//   Resolve: once per frame accumulation is blended into resolved radiance then cleared, see SpatialCacheUpdateCS
+//   Query: after first bounce, paths terminate into resolved radiance of cells with enough samples
+// [NOTE] Cached radiance is averaged over outgoing directions, DiracDelta surfaces are skipped but glossy ones are not, which biases them
+namespace RadianceCache
+{
+	static const uint kVertexCountMax			= 4;
+	// Sums of a frame stay within 32 bits as kAccumulationCountMax * kSampleValueMax < 2^32
+	// Samples of a cell beyond kAccumulationCountMax in a frame are dropped, count itself is only bounded by vertices of a frame
+	static const uint kSampleValueMax			= (1u << 20) - 1;	// Per channel of a sample in fixed point
+	static const uint kAccumulationCountMax		= 1u << 12;			// Per cell per frame
+
+	struct Vertex
+	{
+		uint			mCellIndex;
+		float3			mThroughput;			// Of path reaching the vertex
+		float3			mEmission;				// Of path before the vertex
+	};
+
+	// Radiance leaving the vertex toward previous one, from emission of the whole path
+	float3 VertexRadiance(Vertex inVertex, float3 inPathEmission)
+	{
+		return (inPathEmission - inVertex.mEmission) / max(inVertex.mThroughput, 1E-6f);
+	}
+
+	// Summed per channel, w is sample count
+	uint4 ToAccumulation(float3 inRadiance, float inRadianceScale)
+	{
+		float3 value							= clamp(inRadiance * inRadianceScale, 0.0f, (float)kSampleValueMax);
+		return uint4(uint3(value), 1);
+	}
+
+	// Same as Accumulate
+	uint4 AddAccumulation(uint4 inAccumulation, uint4 inValue)
+	{
+		if (inAccumulation.w >= kAccumulationCountMax)
+			return inAccumulation;
+		return inAccumulation + inValue;
+	}
+
+	// Resolved radiance in xyz, sample count in w
+	float4 Resolve(float4 inResolved, uint4 inAccumulation, SpatialCacheConstants inConstants)
+	{
+		if (inAccumulation.w == 0)
+			return inResolved;
+
+		float accumulation_count				= (float)(inAccumulation.w < kAccumulationCountMax ? inAccumulation.w : kAccumulationCountMax);
+		float3 radiance							= float3((float)inAccumulation.x, (float)inAccumulation.y, (float)inAccumulation.z) / (accumulation_count * inConstants.mRadianceScale);
+		float sample_count						= inResolved.w + accumulation_count;
+		float weight							= accumulation_count / sample_count;
+		float sample_count_max					= (float)inConstants.mRadianceSampleCountMax;
+
+		float4 resolved;
+		resolved.x								= inResolved.x + (radiance.x - inResolved.x) * weight;
+		resolved.y								= inResolved.y + (radiance.y - inResolved.y) * weight;
+		resolved.z								= inResolved.z + (radiance.z - inResolved.z) * weight;
+		resolved.w								= sample_count < sample_count_max ? sample_count : sample_count_max;
+		return resolved;
+	}
+
+	bool IsConverged(float4 inResolved, SpatialCacheConstants inConstants)
+	{
+		return inResolved.w >= (float)inConstants.mRadianceSampleCountMin;
+	}
+
+#ifndef __cplusplus
+	void Accumulate(uint inCellIndex, float3 inRadiance)
+	{
+		USING_RESOURCE(RWStructuredBuffer<uint>, RadianceCacheAccumulationUAV);
+
+		if (inCellIndex == SpatialCache::kInvalidCellIndex)
+			return;
+
+		// Reserve a slot first, so sums only take first kAccumulationCountMax samples
+		uint4 value								= ToAccumulation(inRadiance, mConstants.mSpatialCache.mRadianceScale);
+		uint accumulation_index					= 0;
+		InterlockedAdd(RadianceCacheAccumulationUAV[inCellIndex * 4 + 3], value.w, accumulation_index);
+		if (accumulation_index >= kAccumulationCountMax)
+			return;
+
+		InterlockedAdd(RadianceCacheAccumulationUAV[inCellIndex * 4 + 0], value.x);
+		InterlockedAdd(RadianceCacheAccumulationUAV[inCellIndex * 4 + 1], value.y);
+		InterlockedAdd(RadianceCacheAccumulationUAV[inCellIndex * 4 + 2], value.z);
+	}
+
+	float4 Load(uint inCellIndex)
+	{
+		USING_RESOURCE(RWStructuredBuffer<float4>, RadianceCacheResolvedUAV);
+
+		if (inCellIndex == SpatialCache::kInvalidCellIndex)
+			return 0;
+
+		return RadianceCacheResolvedUAV[inCellIndex];
+	}
+
+	bool Query(uint inCellIndex, out float3 outRadiance)
+	{
+		float4 resolved							= Load(inCellIndex);
+		outRadiance								= resolved.xyz;
+		return IsConverged(resolved, mConstants.mSpatialCache);
+	}
+
+	void ResolveCell(uint inCellIndex)
+	{
+		USING_RESOURCE(RWStructuredBuffer<uint>, RadianceCacheAccumulationUAV);
+		USING_RESOURCE(RWStructuredBuffer<float4>, RadianceCacheResolvedUAV);
+
+		uint4 accumulation						= uint4(
+			RadianceCacheAccumulationUAV[inCellIndex * 4 + 0],
+			RadianceCacheAccumulationUAV[inCellIndex * 4 + 1],
+			RadianceCacheAccumulationUAV[inCellIndex * 4 + 2],
+			RadianceCacheAccumulationUAV[inCellIndex * 4 + 3]);
+		if (accumulation.w == 0)
+			return;
+
+		RadianceCacheResolvedUAV[inCellIndex]	= Resolve(RadianceCacheResolvedUAV[inCellIndex], accumulation, mConstants.mSpatialCache);
+
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 0] = 0;
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 1] = 0;
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 2] = 0;
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 3] = 0;
+	}
+
+	void Clear(uint inCellIndex)
+	{
+		USING_RESOURCE(RWStructuredBuffer<uint>, RadianceCacheAccumulationUAV);
+		USING_RESOURCE(RWStructuredBuffer<float4>, RadianceCacheResolvedUAV);
+
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 0] = 0;
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 1] = 0;
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 2] = 0;
+		RadianceCacheAccumulationUAV[inCellIndex * 4 + 3] = 0;
+		RadianceCacheResolvedUAV[inCellIndex]	= 0;
+	}
+#endif // __cplusplus
+}
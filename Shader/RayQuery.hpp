@@ -10,6 +10,7 @@
 #include "AtmosphereIntegration.h"
 #include "CloudIntegration.h"
 #include "SpatialCache.h"
+#include "RadianceCache.h"
 #include "ShaderPrint.h"
 
 #if NVAPI_LSS
@@ -85,6 +86,10 @@ void TraceRay(inout PixelContext ioPixelContext)
 	
 	Reservoir reservoir_to_write				= Reservoir::Generate();
 
+	bool radiance_cache							= mConstants.mSpatialCache.mRadianceCacheActive && !ioPixelContext.mReservoirInitialize && !ioPixelContext.mReservoirTemporal && !ioPixelContext.mReservoirSpatial;
+	RadianceCache::Vertex radiance_cache_vertices[RadianceCache::kVertexCountMax];
+	uint radiance_cache_vertex_count			= 0;
+
 	for (;;)
 	{
 		bool continue_bounce					= false;
@@ -227,6 +232,28 @@ void TraceRay(inout PixelContext ioPixelContext)
 				}
 				else // Ray hit a surface
 				{
+					// Radiance cache / [SHARC] Terminate into cache after first bounce, otherwise record vertex for update
+					if (radiance_cache && !hit_context.DiracDeltaDistribution())
+					{
+						uint cell_index							= SpatialCache::FindOrInsert(hit_context.PositionWS(), hit_context.mVertexNormalWS, SpatialCache::CellSize(hit_context.PositionWS()));
+
+						float3 cached_radiance					= 0;
+						if (path_context.mRecursionDepth > 0 && RadianceCache::Query(cell_index, cached_radiance))
+						{
+							path_context.mEmission				+= path_context.mThroughput * cached_radiance;
+							break;
+						}
+
+						if (radiance_cache_vertex_count < RadianceCache::kVertexCountMax && cell_index != SpatialCache::kInvalidCellIndex)
+						{
+							RadianceCache::Vertex vertex;
+							vertex.mCellIndex					= cell_index;
+							vertex.mThroughput					= path_context.mThroughput;
+							vertex.mEmission					= path_context.mEmission;
+							radiance_cache_vertices[radiance_cache_vertex_count++] = vertex;
+						}
+					}
+
 					// Sample light (NEE) / [Mitsuba] Emitter sampling, before mThroughput updated
 					bool sample_light = GetSampleMode() == SampleMode::Light || GetSampleMode() == SampleMode::MIS;
 					if (mConstants.mLightCount > 0 &&											// No light -> no light sample
@@ -262,8 +289,8 @@ void TraceRay(inout PixelContext ioPixelContext)
 						}
 						if (ioPixelContext.mReservoirTemporal)
 						{
-							USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirInitializeUAV);
-							USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirTemporalUAV);
+							USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirInitializeUAV);
+							USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirTemporalUAV);
 
 							Reservoir reservoir					= Reservoir::Generate();
 							Reservoir initial_reservoir			= Reservoir::Generate();
@@ -306,8 +333,8 @@ void TraceRay(inout PixelContext ioPixelContext)
 						}
 						if (ioPixelContext.mReservoirSpatial)
 						{
-							USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirInitializeUAV);
-							USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirTemporalUAV);
+							USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirInitializeUAV);
+							USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirTemporalUAV);
 
 							Reservoir reservoir				= Reservoir::Generate();
 							Reservoir temporal_reservoir	= Reservoir::Generate();
@@ -325,7 +352,7 @@ void TraceRay(inout PixelContext ioPixelContext)
 
 							for (uint sample_index = 0; sample_index < mConstants.mReSTIR.mSampleCountSpatial; sample_index++)
 							{
-								float r						= 5.0 * RandomFloat01(path_context.mRandomState);
+								float r						= mConstants.mReSTIR.mSpatialRadius * RandomFloat01(path_context.mRandomState);
 								float theta					= 2.0 * MATH_PI * RandomFloat01(path_context.mRandomState);
 								int x						= r * cos(theta);
 								int y						= r * sin(theta);
@@ -359,7 +386,7 @@ void TraceRay(inout PixelContext ioPixelContext)
 						LightContext light_context			= initial_light_context;
 						if (ioPixelContext.mReservoirUse && mConstants.mReSTIR.mEnabled)
 						{
-							USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirSpatialUAV);
+							USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirSpatialUAV);
 
 							Reservoir spatial_reservoir		= Reservoir::Generate();
 							spatial_reservoir.Unpack(ScreenReservoirSpatialUAV[ioPixelContext.mPixelIndex.xy]);
@@ -455,7 +482,7 @@ void TraceRay(inout PixelContext ioPixelContext)
 				}
 
 				if (mConstants.mSpatialCache.mFrameActive)
-					SpatialCache::AddData(SpatialCache::FindOrInsert(hit_context.PositionWS(), 0, SpatialCache::kCellSize), 1);
+					SpatialCache::AddData(SpatialCache::FindOrInsert(hit_context.PositionWS(), 0, SpatialCache::CellSize(hit_context.PositionWS())), 1);
 				
 				Visualize::Hit(path_context, hit_context, continue_bounce);
 				// PrintNameValueLine("Albedo: ", hit_context.Albedo());
@@ -518,23 +545,27 @@ void TraceRay(inout PixelContext ioPixelContext)
 		path_context.mRecursionDepth++;
 	}
 
+	// Radiance cache update, including radiance of cache the path terminated into
+	for (uint vertex_index = 0; vertex_index < radiance_cache_vertex_count; vertex_index++)
+		RadianceCache::Accumulate(radiance_cache_vertices[vertex_index].mCellIndex, RadianceCache::VertexRadiance(radiance_cache_vertices[vertex_index], path_context.mEmission));
+
 	if (ioPixelContext.mReservoirInitialize)
 	{
-		USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirInitializeUAV);
+		USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirInitializeUAV);
 		if (mConstants.mCurrentFrameWeight != 0.0f)
 			ScreenReservoirInitializeUAV[ioPixelContext.mPixelIndex.xy] = reservoir_to_write.Pack();
 		return;
 	}
 	if (ioPixelContext.mReservoirTemporal)
 	{
-		USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirTemporalUAV);
+		USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirTemporalUAV);
 		if (mConstants.mCurrentFrameWeight != 0.0f)
 			ScreenReservoirTemporalUAV[ioPixelContext.mPixelIndex.xy] = reservoir_to_write.Pack();
 		return;
 	}
 	if (ioPixelContext.mReservoirSpatial)
 	{
-		USING_RESOURCE(RWTexture2D<uint4>, ScreenReservoirSpatialUAV);
+		USING_RESOURCE(RWTexture2D<ReservoirPacked>, ScreenReservoirSpatialUAV);
 		if (mConstants.mCurrentFrameWeight != 0.0f)
 			ScreenReservoirSpatialUAV[ioPixelContext.mPixelIndex.xy] = reservoir_to_write.Pack();
 		return;
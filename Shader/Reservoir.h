@@ -1,12 +1,17 @@
 #pragma once
+// Also included by C++ for CPU-side resampling, see Source/ReSTIR.cpp
+#ifndef __cplusplus
 #include "Common.h"
 #include "Context.h"
+#endif // __cplusplus
 
 // Following formulation in [Wyman2023] https://intro-to-restir.cwyman.org/presentations/2023ReSTIR_Course_Notes.pdf
 struct Reservoir
 {
 	static const uint kLightValidBit			= 0x80000000;
 	static const uint kLightIndexMask			= 0x7FFFFFFF;
+	static const uint kLightIndexInvalid		= 0xFFFFFFFF;	// ContextConstant::sLightIndexInvalid
+	static const uint kCompactLightIndexMask	= 0x00FFFFFF;	// 24 bits of light index, 8 bits of M in compact packing
 	
 	uint			mLightIndex;                // Selected sample, X
 	float2			mUV;
@@ -18,13 +23,13 @@ struct Reservoir
 
 	float			mM;							// Sample count, M
 
-	bool			IsValid()					{ return mLightIndex != ContextConstant::sLightIndexInvalid; }
+	bool			IsValid()					{ return mLightIndex != kLightIndexInvalid; }
 
 	static Reservoir Generate()
 	{
 		Reservoir reservoir;
-		reservoir.mLightIndex					= ContextConstant::sLightIndexInvalid;
-		reservoir.mUV							= 0;
+		reservoir.mLightIndex					= kLightIndexInvalid;
+		reservoir.mUV							= float2(0, 0);
 		reservoir.mTargetFunction				= 0.0f;
 		reservoir.mContributionWeight			= 0.0f;
 		reservoir.mWeightSum					= 0.0f;
@@ -32,6 +37,7 @@ struct Reservoir
 		return reservoir;
 	}
 
+#ifndef __cplusplus
 	static Reservoir FromLight(LightContext inLightContex, float inTargetFunction, float inContributionWeight)
 	{
 		Reservoir reservoir;
@@ -43,6 +49,7 @@ struct Reservoir
 		reservoir.mM							= 0.0f;
 		return reservoir;
 	}
+#endif // __cplusplus
 
 	// Add sample to reservoir, see RTXDI_StreamSample, RTXDI_CombineDIReservoirs in RTXDI
 	bool			Stream(Reservoir inReservoir, float inMISWeight, float inRandom01)
@@ -74,24 +81,69 @@ struct Reservoir
 	void			ComputeContributionWeight(bool inNormalizeMISWeight)
 	{
 		// Unbiased contribution weight (UCW), W_X = \sum w_i / \hat{p}(X) in [Wyman2023]
-		mContributionWeight						= (mTargetFunction == 0.0) ? 0.0 : mWeightSum / mTargetFunction;
-		mContributionWeight						/= (mM > 1 && inNormalizeMISWeight) ? mM : 1.0;
+		mContributionWeight						= (mTargetFunction == 0.0f) ? 0.0f : mWeightSum / mTargetFunction;
+		mContributionWeight						/= (mM > 1 && inNormalizeMISWeight) ? mM : 1.0f;
 	}
 
-	uint4 Pack()
+	// Target function is not stored, it is re-evaluated at the reusing pixel
+	ReservoirPacked	Pack()
 	{
-		uint4 packed							= 0;
+#if RESERVOIR_PACKING_COMPACT
+		return PackCompact();
+#else
+		return PackFull();
+#endif // RESERVOIR_PACKING_COMPACT
+	}
+
+	void			Unpack(ReservoirPacked inPacked)
+	{
+#if RESERVOIR_PACKING_COMPACT
+		UnpackCompact(inPacked);
+#else
+		UnpackFull(inPacked);
+#endif // RESERVOIR_PACKING_COMPACT
+	}
+
+	// 128 bits
+	//   x: light index (32 bits)
+	//   y: contribution weight (float)
+	//   z: UV (16 bits each, unorm, x in low bits)
+	//   w: M (float)
+	uint4			PackFull()
+	{
+		uint4 packed							= uint4(0, 0, 0, 0);
 		packed.x								= mLightIndex;
 		packed.y								= asuint(mContributionWeight);
 		packed.z								= uint(saturate(mUV.x) * 0xffff) | (uint(saturate(mUV.y) * 0xffff) << 16);
-		packed.w								= 0;
+		packed.w								= asuint(mM);
 		return packed;
 	}
 
-	void Unpack(uint4 inPacked)
+	void			UnpackFull(uint4 inPacked)
 	{
 		mLightIndex								= inPacked.x;
 		mContributionWeight						= asfloat(inPacked.y);
-		mUV										= float2((inPacked.z & 0xffff) * (1.0 / 0xffff), (inPacked.z >> 16) * (1.0 / 0xffff));
+		mUV										= float2((inPacked.z & 0xffff) * (1.0f / 0xffff), (inPacked.z >> 16) * (1.0f / 0xffff));
+		mM										= asfloat(inPacked.w);
+	}
+
+	// 64 bits, opt-in with RESERVOIR_PACKING_COMPACT
+	//   x: light index (bits 0-23, all ones as invalid) | M (bits 24-31, clamped to 255)
+	//   y: contribution weight (bits 0-15, half, clamped to 65504) | UV.x (bits 16-23, unorm) | UV.y (bits 24-31, unorm)
+	uint2			PackCompact()
+	{
+		uint2 packed							= uint2(0, 0);
+		packed.x								= (mLightIndex & kCompactLightIndexMask) | (uint(saturate(mM / 255.0f) * 0xff) << 24);
+		packed.y								= f32tof16(mContributionWeight < 65504.0f ? mContributionWeight : 65504.0f) | (uint(saturate(mUV.x) * 0xff + 0.5f) << 16) | (uint(saturate(mUV.y) * 0xff + 0.5f) << 24);
+		return packed;
+	}
+
+	void			UnpackCompact(uint2 inPacked)
+	{
+		uint light_index						= inPacked.x & kCompactLightIndexMask;
+		mLightIndex								= light_index == kCompactLightIndexMask ? kLightIndexInvalid : light_index;
+		mM										= float(inPacked.x >> 24);
+		mContributionWeight						= f16tof32(inPacked.y);
+		mUV										= float2(((inPacked.y >> 16) & 0xff) * (1.0f / 0xff), (inPacked.y >> 24) * (1.0f / 0xff));
 	}
 };
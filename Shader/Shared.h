@@ -5,6 +5,7 @@
 
 #include <glm.h>	// glm
 #include <bit>		// std::bit_cast
+#include <cmath>	// std::floor, std::log, std::pow
 
 using float2 = glm::vec2;
 using float3 = glm::vec3;
@@ -37,6 +38,15 @@ using float4x4 = glm::mat4x4;
 
 inline float asfloat(uint x) { return std::bit_cast<float>(x); }
 inline uint asuint(float x) { return std::bit_cast<uint>(x); }
+inline float saturate(float x) { return glm::clamp(x, 0.0f, 1.0f); }
+inline float2 saturate(float2 x) { return glm::clamp(x, 0.0f, 1.0f); }
+inline uint f32tof16(float x) { return glm::packHalf2x16(float2(x, 0.0f)) & 0xffff; }
+inline float f16tof32(uint x) { return glm::unpackHalf2x16(x & 0xffff).x; }
+
+// Float overloads for scalar math of shared code, instead of double ones of global namespace
+using std::floor;
+using std::log;
+using std::pow;
 
 #else
 
@@ -50,6 +60,7 @@ inline uint asuint(float x) { return std::bit_cast<uint>(x); }
 
 inline float QNaN() { return asfloat(0x7fc00000); }
 inline float Inf() { return asfloat(0x7f800000); }
+inline float RGBToLuminance(float3 inColor) { return dot(inColor, float3(0.299f, 0.587f, 0.114f)); }
 
 #ifdef __SLANG__
 #define MUTATING [mutating]
@@ -78,8 +89,65 @@ static const float kSolarLM2KW					= 1.0f / kSolarKW2LM;
 
 static const int kFrameInFlightCount			= 2;
 
+// Quantized vertex attributes, encoded with meshoptimizer by Scene::QuantizeVertexAttributes
+// [NOTE] Only for shading, BLAS is still built from float positions
+// Position: 16bit unorm of each component within bounds of vertex range, xy in first uint, z in second
+inline float3 DecodePositionUnorm16(uint2 inPacked, float3 inMin, float3 inScale)
+{
+	uint3 quantized								= uint3(inPacked.x & 0xffff, inPacked.x >> 16, inPacked.y & 0xffff);
+	return inMin + float3(quantized) * inScale;
+}
+
+// Normal: 16bit snorm octahedral as meshopt_encodeFilterOct, same math as meshopt_decodeFilterOct
+inline float3 DecodeNormalOct16(uint inPacked)
+{
+	float x										= (float)((int)(inPacked << 16) >> 16) / 32767.0f;
+	float y										= (float)((int)inPacked >> 16) / 32767.0f;
+	float z										= 1.0f - (x >= 0 ? x : -x) - (y >= 0 ? y : -y);
+	float t										= z < 0 ? -z : 0.0f;
+	x											+= x >= 0 ? -t : t;
+	y											+= y >= 0 ? -t : t;
+	return normalize(float3(x, y, z));
+}
+
+// UV: half of each component as meshopt_quantizeHalf
+inline float2 DecodeUVHalf(uint inPacked)
+{
+	return float2(f16tof32(inPacked), f16tof32(inPacked >> 16));
+}
+
 static const uint kSpatialHashSize				= 1024 * 1024;
 
+// Counters of spatial cache, cleared each frame. See SpatialCache::FindOrInsert and SpatialCacheUpdateCS
+enum class SpatialCacheCounter : uint
+{
+	Lookup,
+	Hit,
+	Insert,
+	Failure,		// No available cell within SpatialCache::SEARCH_COUNT probes
+	ProbeSum,
+	ProbeMax,
+	Occupied,		// After eviction
+	Evicted,
+
+	Count
+};
+static const uint kSpatialCacheCounterCount		= (uint)SpatialCacheCounter::Count;
+STATITC_ASSERT(kSpatialCacheCounterCount % 4 == 0); // Cleared as uint4
+
+// Layout of reservoirs in screen textures, see Reservoir::PackFull and Reservoir::PackCompact for bits
+// Full:	128 bits, R32G32B32A32_UINT. Light index, float weight, 16-bit UV, float M.
+// Compact:	64 bits, R32G32_UINT. Light index (24 bits) and M (8 bits), half weight, 8-bit UV.
+//			Light index, 16-bit UV, half weight and M add up to 80 bits, so UV is quantized to 1/255 of light extent. Error of that is measured by ReSTIR::RunHarness.
+// [NOTE] Compact packing uses R32G32_UINT, typed UAV load of which requires TypedUAVLoadAdditionalFormats
+#define RESERVOIR_PACKING_COMPACT				0
+#if RESERVOIR_PACKING_COMPACT
+typedef uint2 ReservoirPacked;
+#else
+typedef uint4 ReservoirPacked;
+#endif // RESERVOIR_PACKING_COMPACT
+static const uint kReservoirPackedSizeInBytes	= RESERVOIR_PACKING_COMPACT ? 8 : 16;
+
 enum class RTVDescriptorIndex : uint
 {
 	Invalid = 0,
@@ -149,6 +217,10 @@ enum class ViewDescriptorIndex : uint
 	// [SpatialHash]
 	SpatialHashUAV,
 	SpatialDataUAV,
+	SpatialAgeUAV,
+	SpatialStatsUAV,
+	RadianceCacheAccumulationUAV,
+	RadianceCacheResolvedUAV,
 
 	// [ShaderPrint]
 	ShaderPrintUAV,
@@ -312,6 +384,7 @@ enum class VisualizeMode : uint
 
 	SpatialHash,
 	SpatialData,
+	RadianceCache,
 
 	GENERATE_NEW_LINE_NAME,
 
@@ -556,7 +629,9 @@ struct InstanceFlag
 
 	uint						mInstanceMask : 8				CONSTANT_DEFAULT(0xff);
 
-	uint						mPad : 21						CONSTANT_DEFAULT(0);
+	uint						mIndex16Bit : 1					CONSTANT_DEFAULT(0);	// Width of indices at mIndexByteOffset
+
+	uint						mPad : 20						CONSTANT_DEFAULT(0);
 };
 STATITC_ASSERT(sizeof(InstanceFlag) == sizeof(float) * 1);
 
@@ -601,6 +676,12 @@ struct InstanceData
 	float4x4					mTransform						CONSTANT_DEFAULT(float4x4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1));
 	float4x4					mInverseTranspose				CONSTANT_DEFAULT(float4x4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1));
 
+	float3						mPositionQuantizationMin		CONSTANT_DEFAULT(float3(0.0f, 0.0f, 0.0f));	// See DecodePositionUnorm16
+	float						GENERATE_PAD_NAME				CONSTANT_DEFAULT(0);
+
+	float3						mPositionQuantizationScale		CONSTANT_DEFAULT(float3(0.0f, 0.0f, 0.0f));	// Extent / 65535
+	uint						mIndexByteOffset				CONSTANT_DEFAULT(0);	// Into RaytraceIndicesSRV, see Scene::PackIndices. mIndexOffset is into SceneContent::mIndices.
+
     uint						mVertexOffset					CONSTANT_DEFAULT(0);
 	uint						mVertexCount					CONSTANT_DEFAULT(0);
 	uint						mIndexOffset					CONSTANT_DEFAULT(0);
@@ -782,12 +863,52 @@ struct BRDFExplorerConstants
 	uint						mOverrideInstance				CONSTANT_DEFAULT(0);
 };
 
+enum class SpatialCacheCellSizeMode : uint
+{
+	Fixed = 0,
+	Adaptive,		// Logarithmic levels of distance to camera, as SHARC HashGridGetLevel / HashGridGetVoxelSize
+
+	Count,
+};
+
 struct SpatialCacheConstants
 {
 	uint						mFrameActive					CONSTANT_DEFAULT(0);
 	uint						mFrameCount						CONSTANT_DEFAULT(0);
+	uint						mMaxAge							CONSTANT_DEFAULT(0);	// Frames a cell survives without lookup, 0 -> never evicted
+	SpatialCacheCellSizeMode	mCellSizeMode					CONSTANT_DEFAULT(SpatialCacheCellSizeMode::Fixed);
+
+	float						mCellSize						CONSTANT_DEFAULT(0.05f);	// Fixed
+	float						mCellSizeMin					CONSTANT_DEFAULT(0.001f);	// Adaptive, from scene bounds at load
+	float						mCellSizeMax					CONSTANT_DEFAULT(1.0f);		// Adaptive, from scene bounds at load
+	float						mSceneScale						CONSTANT_DEFAULT(50.0f);	// Adaptive, cells per unit length at unit distance to camera, as SHARC sceneScale
+
+	float						mLogarithmBase					CONSTANT_DEFAULT(2.0f);		// Adaptive, ratio between cell sizes of adjacent levels
+	uint						mRadianceCacheActive			CONSTANT_DEFAULT(0);		// See RadianceCache.h
+	float						mRadianceScale					CONSTANT_DEFAULT(1000.0f);	// Radiance to fixed point of accumulation
+	uint						mRadianceSampleCountMax			CONSTANT_DEFAULT(256);		// History length of resolved radiance
+
+	uint						mRadianceSampleCountMin			CONSTANT_DEFAULT(16);		// Paths terminate into cells with at least this many samples
+	float						mLevelBias						CONSTANT_DEFAULT(2.0f);		// Adaptive, extra levels magnifying content, as SHARC levelBias
 	float						GENERATE_PAD_NAME				CONSTANT_DEFAULT(0);
 	float						GENERATE_PAD_NAME				CONSTANT_DEFAULT(0);
+
+	// Shared with SpatialCacheModel. Adaptive follows SHARC HashGridGetLevel / HashGridGetVoxelSize:
+	// level = clamp(log_b(distance) + mLevelBias, 1, 1023) truncated, cell size = b^(level - mLevelBias) / mSceneScale.
+	// [NOTE] Deviation from SHARC: cell size is then clamped to [mCellSizeMin, mCellSizeMax] from scene bounds, as scenes here are not in meters
+	float CellSize(float3 inPositionWS, float3 inCameraPositionWS)
+	{
+		if (mCellSizeMode == SpatialCacheCellSizeMode::Fixed)
+			return mCellSize;
+
+		float3 offset			= inPositionWS - inCameraPositionWS;
+		float level				= 0.5f * log(dot(offset, offset)) / log(mLogarithmBase) + mLevelBias; // -Inf at camera position
+		level					= level > 1.0f ? level : 1.0f;
+		level					= level < 1023.0f ? level : 1023.0f; // As SHARC HASH_GRID_LEVEL_BIT_MASK
+		float cell_size			= pow(mLogarithmBase, floor(level) - mLevelBias) / mSceneScale;
+		cell_size				= cell_size > mCellSizeMin ? cell_size : mCellSizeMin;
+		return cell_size < mCellSizeMax ? cell_size : mCellSizeMax;
+	}
 };
 
 struct ReSTIRConstants
@@ -796,7 +917,7 @@ struct ReSTIRConstants
 	uint						mInitialSampleCount				CONSTANT_DEFAULT(1);
 	uint						mSampleCountTemporal			CONSTANT_DEFAULT(1);
 	uint						mSampleCountSpatial				CONSTANT_DEFAULT(1);
-	float						GENERATE_PAD_NAME				CONSTANT_DEFAULT(0);
+	float						mSpatialRadius					CONSTANT_DEFAULT(5.0f);	// In pixels
 };
 
 struct RootConstants
@@ -26,8 +26,37 @@ namespace SpatialCache
     static const uint SEARCH_COUNT = 16u;
 
 	static const uint kInvalidCellIndex = 0xFFFFFFFFu;
+	static const uint kTombstone = 0xFFFFFFFFu; // Hash of evicted cell, probing continues past it and insertion reuses it
 
-    static const float kCellSize = 0.05;
+    // See SpatialCacheConstants::mCellSizeMode
+    float CellSize(float3 position)
+    {
+        return mConstants.mSpatialCache.CellSize(position, mConstants.CameraPosition().xyz);
+    }
+
+    // Telemetry, aggregated per wave to keep atomics off the hot path. Read back as Renderer::Runtime::mSpatialStatsBuffer
+    void AddCounter(SpatialCacheCounter inCounter, uint inValue)
+    {
+        USING_RESOURCE(RWStructuredBuffer<uint>, SpatialStatsUAV);
+
+        if (WaveIsFirstLane() && inValue > 0)
+            InterlockedAdd(SpatialStatsUAV[(uint)inCounter], inValue);
+    }
+
+    void UpdateCounters(bool inHit, bool inInserted, bool inFailure, uint inProbeCount)
+    {
+        USING_RESOURCE(RWStructuredBuffer<uint>, SpatialStatsUAV);
+
+        AddCounter(SpatialCacheCounter::Lookup, WaveActiveCountBits(true));
+        AddCounter(SpatialCacheCounter::Hit, WaveActiveCountBits(inHit));
+        AddCounter(SpatialCacheCounter::Insert, WaveActiveCountBits(inInserted));
+        AddCounter(SpatialCacheCounter::Failure, WaveActiveCountBits(inFailure));
+        AddCounter(SpatialCacheCounter::ProbeSum, WaveActiveSum(inProbeCount));
+
+        uint probeMax = WaveActiveMax(inProbeCount);
+        if (WaveIsFirstLane())
+            InterlockedMax(SpatialStatsUAV[(uint)SpatialCacheCounter::ProbeMax], probeMax);
+    }
 
     // https://interplayoflight.wordpress.com/2025/11/23/spatial-hashing-for-raytraced-ambient-occlusion/
     //Adapted from https://gboisse.github.io/posts/this-is-us/
@@ -46,26 +75,92 @@ namespace SpatialCache
         uint cellIndex = hashKey % HASHMAP_SIZE;
 
         uint checksum = xxhash32(cellSize + xxhash32(p.x + xxhash32(p.y + xxhash32(p.z + xxhash32(n.x + xxhash32(n.y + xxhash32(n.z)))))));
-        checksum = max(checksum, 1); // 0 is reserved for available cells
+        checksum = clamp(checksum, 1u, kTombstone - 1u); // 0 is reserved for available cells, kTombstone for evicted ones
 
         // Update data structure
+        uint result = kInvalidCellIndex;
+        uint probeCount = 0;
+        bool inserted = false;
+        uint tombstoneIndex = kInvalidCellIndex;
         for (uint i = 0; i < SEARCH_COUNT; i++)
         {
-            uint cmp;
-            InterlockedCompareExchange(SpatialHashUAV[cellIndex], 0, checksum, cmp);
+            probeCount++;
+
+            // Insert at an available cell only if no tombstone was passed, the key is not in the chain by then
+            uint cmp = SpatialHashUAV[cellIndex];
+            if (cmp == 0 && tombstoneIndex == kInvalidCellIndex)
+                InterlockedCompareExchange(SpatialHashUAV[cellIndex], 0, checksum, cmp);
+
+            if (cmp == checksum)
+            {
+                result = cellIndex;
+                break;
+            }
 
-            if (cmp == 0 || cmp == checksum)
+            if (cmp == 0)
             {
-                return cellIndex;
+                if (tombstoneIndex == kInvalidCellIndex)
+                {
+                    result = cellIndex;
+                    inserted = true;
+                }
+                break;
             }
 
+            // Key may still be further along the chain, the first tombstone is reused once it is not found
+            if (cmp == kTombstone && tombstoneIndex == kInvalidCellIndex)
+                tombstoneIndex = cellIndex;
+
             cellIndex++;
 
             if (cellIndex >= HASHMAP_SIZE)
                 break;
         }
 
-        return kInvalidCellIndex; // out of memory 
+        if (result == kInvalidCellIndex && tombstoneIndex != kInvalidCellIndex)
+        {
+            uint cmp;
+            InterlockedCompareExchange(SpatialHashUAV[tombstoneIndex], kTombstone, checksum, cmp);
+            if (cmp == kTombstone || cmp == checksum)
+            {
+                result = tombstoneIndex;
+                inserted = cmp == kTombstone;
+            }
+        }
+
+        if (result != kInvalidCellIndex)
+        {
+            USING_RESOURCE(RWStructuredBuffer<uint>, SpatialAgeUAV);
+            SpatialAgeUAV[result] = mConstants.mFrameIndex;
+        }
+
+        UpdateCounters(result != kInvalidCellIndex && !inserted, inserted, result == kInvalidCellIndex, probeCount);
+
+        return result; // kInvalidCellIndex -> out of memory
+    }
+
+    // Evict cells not looked up within mMaxAge frames, see SpatialCacheUpdateCS
+    // [NOTE] Evicted cells become kTombstone rather than 0, so probing of FindOrInsert still reaches entries behind them
+    bool Evict(uint inCellIndex)
+    {
+        USING_RESOURCE(RWStructuredBuffer<uint>, SpatialHashUAV);
+        USING_RESOURCE(RWStructuredBuffer<uint>, SpatialDataUAV);
+        USING_RESOURCE(RWStructuredBuffer<uint>, SpatialAgeUAV);
+
+        if (SpatialHashUAV[inCellIndex] == 0 || SpatialHashUAV[inCellIndex] == kTombstone)
+            return false;
+
+        uint age = mConstants.mFrameIndex - SpatialAgeUAV[inCellIndex];
+        if (mConstants.mSpatialCache.mMaxAge == 0 || age <= mConstants.mSpatialCache.mMaxAge)
+        {
+            AddCounter(SpatialCacheCounter::Occupied, WaveActiveCountBits(true));
+            return false;
+        }
+
+        SpatialHashUAV[inCellIndex] = kTombstone;
+        SpatialDataUAV[inCellIndex] = 0;
+        AddCounter(SpatialCacheCounter::Evicted, WaveActiveCountBits(true));
+        return true;
     }
 
     uint LoadData(uint inCellIndex)
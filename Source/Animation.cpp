@@ -0,0 +1,358 @@
+#include "Animation.h"
+
+#include "Validate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <limits>
+#include <random>
+
+static uint32_t sComponentCount(Animation::Path inPath)
+{
+	return inPath == Animation::Path::Rotation ? 4 : 3;
+}
+
+static glm::quat sToQuat(const float* inXYZW)
+{
+	return glm::quat(inXYZW[3], inXYZW[0], inXYZW[1], inXYZW[2]); // glm::quat is wxyz, gltf quat is xyzw
+}
+
+uint32_t Animation::AddNode(const Node& inNode)
+{
+	uint32_t node_index										= static_cast<uint32_t>(mRestNodes.size());
+	if (inNode.mParentIndex != kInvalidIndex && inNode.mParentIndex >= node_index)
+		return kInvalidIndex;
+
+	mRestNodes.push_back(inNode);
+	mNodeAnimated.push_back(0);
+	return node_index;
+}
+
+bool Animation::AddChannel(uint32_t inNodeIndex, Path inPath, Interpolation inInterpolation, std::span<const float> inTimes, std::span<const float> inValues)
+{
+	if (inNodeIndex >= GetNodeCount() || inPath >= Path::Count || inInterpolation >= Interpolation::Count || inTimes.empty())
+		return false;
+
+	uint32_t values_per_key									= sComponentCount(inPath) * (inInterpolation == Interpolation::CubicSpline ? 3 : 1);
+	if (inValues.size() != inTimes.size() * values_per_key || !std::is_sorted(inTimes.begin(), inTimes.end()))
+		return false;
+
+	// One channel per node and path, mNodeAnimated holds a bit per path until Finalize
+	uint8_t path_bit										= static_cast<uint8_t>(1u << static_cast<uint32_t>(inPath));
+	if ((mNodeAnimated[inNodeIndex] & path_bit) != 0)
+		return false;
+	mNodeAnimated[inNodeIndex]								|= path_bit;
+
+	mChannels.push_back(
+	{
+		.mNodeIndex											= inNodeIndex,
+		.mKeyOffset											= static_cast<uint32_t>(mTimes.size()),
+		.mKeyCount											= static_cast<uint32_t>(inTimes.size()),
+		.mValueOffset										= static_cast<uint32_t>(mValues.size()),
+		.mPath												= inPath,
+		.mInterpolation										= inInterpolation,
+	});
+	mTimes.insert(mTimes.end(), inTimes.begin(), inTimes.end());
+	mValues.insert(mValues.end(), inValues.begin(), inValues.end());
+	return true;
+}
+
+void Animation::Finalize()
+{
+	uint32_t node_count										= GetNodeCount();
+	mTranslations.resize(node_count);
+	mRotations.resize(node_count);
+	mScales.resize(node_count);
+	mWorldMatrices.resize(node_count);
+	for (uint32_t node_index = 0; node_index < node_count; node_index++)
+	{
+		mTranslations[node_index]							= mRestNodes[node_index].mTranslation;
+		mRotations[node_index]								= mRestNodes[node_index].mRotation;
+		mScales[node_index]									= mRestNodes[node_index].mScale;
+	}
+
+	// Animated through parent, parents come first
+	mAnimatedNodes.clear();
+	for (uint32_t node_index = 0; node_index < node_count; node_index++)
+	{
+		uint32_t parent_index								= mRestNodes[node_index].mParentIndex;
+		mNodeAnimated[node_index]							= mNodeAnimated[node_index] != 0 || (parent_index != kInvalidIndex && mNodeAnimated[parent_index] != 0);
+		if (mNodeAnimated[node_index] != 0)
+			mAnimatedNodes.push_back(node_index);
+
+		UpdateWorldMatrix(node_index);
+	}
+
+	std::stable_sort(mChannels.begin(), mChannels.end(), [](const Channel& inLHS, const Channel& inRHS)
+	{
+		return std::make_pair(inLHS.mPath, inLHS.mInterpolation) < std::make_pair(inRHS.mPath, inRHS.mInterpolation);
+	});
+
+	mBatches.clear();
+	for (uint32_t channel_index = 0; channel_index < mChannels.size(); channel_index++)
+	{
+		const Channel& channel								= mChannels[channel_index];
+		if (mBatches.empty() || mBatches.back().mPath != channel.mPath || mBatches.back().mInterpolation != channel.mInterpolation)
+			mBatches.push_back({ .mChannelOffset = channel_index, .mPath = channel.mPath, .mInterpolation = channel.mInterpolation });
+		mBatches.back().mChannelCount++;
+	}
+
+	mSampleKeys.resize(mChannels.size());
+	mSampleFractions.resize(mChannels.size());
+	mSampleDurations.resize(mChannels.size());
+
+	mStartTime												= mChannels.empty() ? 0.0f : std::numeric_limits<float>::max();
+	mEndTime												= mChannels.empty() ? 0.0f : -std::numeric_limits<float>::max();
+	for (const Channel& channel : mChannels)
+	{
+		mStartTime											= std::min(mStartTime, mTimes[channel.mKeyOffset]);
+		mEndTime											= std::max(mEndTime, mTimes[channel.mKeyOffset + channel.mKeyCount - 1]);
+	}
+
+	mStats													= {};
+	mStats.mChannelCount									= static_cast<uint32_t>(mChannels.size());
+	mStats.mBatchCount										= static_cast<uint32_t>(mBatches.size());
+	mStats.mAnimatedNodeCount								= static_cast<uint32_t>(mAnimatedNodes.size());
+}
+
+void Animation::Evaluate(float inTime)
+{
+	if (mChannels.empty())
+		return;
+
+	float duration											= mEndTime - mStartTime;
+	float time												= inTime;
+	if (duration > 0.0f && (time < mStartTime || time > mEndTime))
+		time												= mStartTime + std::fmod(std::fmod(time - mStartTime, duration) + duration, duration);
+
+	auto sample_begin										= std::chrono::steady_clock::now();
+	for (const Batch& batch : mBatches)
+	{
+		SearchKeys(batch, time);
+		Blend(batch);
+	}
+
+	auto hierarchy_begin									= std::chrono::steady_clock::now();
+	for (uint32_t node_index : mAnimatedNodes)
+		UpdateWorldMatrix(node_index);
+
+	auto end												= std::chrono::steady_clock::now();
+	mStats.mSampleMS										= std::chrono::duration<float, std::milli>(hierarchy_begin - sample_begin).count();
+	mStats.mHierarchyMS										= std::chrono::duration<float, std::milli>(end - hierarchy_begin).count();
+}
+
+void Animation::SearchKeys(const Batch& inBatch, float inTime)
+{
+	bool step												= inBatch.mInterpolation == Interpolation::Step;
+	for (uint32_t channel_index = inBatch.mChannelOffset; channel_index < inBatch.mChannelOffset + inBatch.mChannelCount; channel_index++)
+	{
+		const Channel& channel								= mChannels[channel_index];
+		const float* times									= mTimes.data() + channel.mKeyOffset;
+		uint32_t last_key									= channel.mKeyCount - 1;
+
+		// Interval [key, key + 1] containing time, clamped to first and last key
+		uint32_t key										= static_cast<uint32_t>(std::upper_bound(times, times + channel.mKeyCount, inTime) - times);
+		key													= std::min(key > 0 ? key - 1 : 0, last_key > 0 ? last_key - 1 : 0);
+		uint32_t next_key									= std::min(key + 1, last_key);
+
+		float duration										= times[next_key] - times[key];
+		float fraction										= duration > 0.0f ? glm::clamp((inTime - times[key]) / duration, 0.0f, 1.0f) : 0.0f;
+		mSampleKeys[channel_index]							= key;
+		mSampleFractions[channel_index]						= step ? (fraction >= 1.0f ? 1.0f : 0.0f) : fraction;
+		mSampleDurations[channel_index]						= duration;
+	}
+}
+
+void Animation::Blend(const Batch& inBatch)
+{
+	uint32_t component_count								= sComponentCount(inBatch.mPath);
+	bool cubic												= inBatch.mInterpolation == Interpolation::CubicSpline;
+	bool slerp												= inBatch.mPath == Path::Rotation && !cubic;
+	uint32_t key_stride										= component_count * (cubic ? 3 : 1);
+	uint32_t value_offset									= cubic ? component_count : 0; // Skip in tangent
+
+	for (uint32_t channel_index = inBatch.mChannelOffset; channel_index < inBatch.mChannelOffset + inBatch.mChannelCount; channel_index++)
+	{
+		const Channel& channel								= mChannels[channel_index];
+		uint32_t key										= mSampleKeys[channel_index];
+		uint32_t next_key									= std::min(key + 1, channel.mKeyCount - 1);
+		float t												= mSampleFractions[channel_index];
+		const float* from									= mValues.data() + channel.mValueOffset + key * key_stride;
+		const float* to										= mValues.data() + channel.mValueOffset + next_key * key_stride;
+
+		float value[4]										= {};
+		if (cubic)
+		{
+			// Hermite of glTF, tangents are scaled by key interval
+			float t2										= t * t;
+			float t3										= t2 * t;
+			float duration									= mSampleDurations[channel_index];
+			float h00										= 2.0f * t3 - 3.0f * t2 + 1.0f;
+			float h10										= (t3 - 2.0f * t2 + t) * duration;
+			float h01										= -2.0f * t3 + 3.0f * t2;
+			float h11										= (t3 - t2) * duration;
+			for (uint32_t component = 0; component < component_count; component++)
+				value[component]							= h00 * from[component_count + component] + h10 * from[2 * component_count + component] + h01 * to[component_count + component] + h11 * to[component];
+		}
+		else if (!slerp)
+		{
+			for (uint32_t component = 0; component < component_count; component++)
+				value[component]							= from[value_offset + component] + (to[value_offset + component] - from[value_offset + component]) * t;
+		}
+
+		uint32_t node_index									= channel.mNodeIndex;
+		switch (inBatch.mPath)
+		{
+		case Path::Translation:								mTranslations[node_index] = glm::vec3(value[0], value[1], value[2]); break;
+		case Path::Scale:									mScales[node_index] = glm::vec3(value[0], value[1], value[2]); break;
+		case Path::Rotation:								mRotations[node_index] = glm::normalize(slerp ? glm::slerp(sToQuat(from), sToQuat(to), t) : sToQuat(value)); break;
+		default:											break;
+		}
+	}
+}
+
+void Animation::UpdateWorldMatrix(uint32_t inNodeIndex)
+{
+	glm::mat4x4 local										= glm::translate(mTranslations[inNodeIndex]) * glm::mat4_cast(mRotations[inNodeIndex]) * glm::scale(mScales[inNodeIndex]);
+	uint32_t parent_index									= mRestNodes[inNodeIndex].mParentIndex;
+	mWorldMatrices[inNodeIndex]								= parent_index == kInvalidIndex ? local : mWorldMatrices[parent_index] * local;
+}
+
+bool Animation::sValidate(std::string& outMessage)
+{
+	auto is_near											= [](glm::vec3 inLHS, glm::vec3 inRHS) { return glm::all(glm::lessThan(glm::abs(inLHS - inRHS), glm::vec3(1.0e-4f))); };
+	auto translation										= [](const glm::mat4x4& inMatrix) { return glm::vec3(inMatrix[3]); };
+
+	// Root (0) animated, child (1) animated, child (2) of root static, sibling (3) static
+	Animation animation;
+	uint32_t root											= animation.AddNode({});
+	uint32_t child											= animation.AddNode({ .mParentIndex = root });
+	uint32_t static_child									= animation.AddNode({ .mParentIndex = root, .mTranslation = glm::vec3(0.0f, 1.0f, 0.0f) });
+	uint32_t static_sibling									= animation.AddNode({ .mTranslation = glm::vec3(5.0f, 0.0f, 0.0f) });
+
+	float sin45												= std::sqrt(0.5f);
+	bool added												= true;
+	added													&= animation.AddChannel(root, Path::Translation, Interpolation::Linear, std::vector<float>{ 0.0f, 1.0f, 2.0f }, std::vector<float>{ 0, 0, 0, 2, 0, 0, 2, 4, 0 });
+	added													&= animation.AddChannel(root, Path::Rotation, Interpolation::Linear, std::vector<float>{ 0.0f, 1.0f }, std::vector<float>{ 0, 0, 0, 1, 0, sin45, 0, sin45 });
+	added													&= animation.AddChannel(child, Path::Scale, Interpolation::Step, std::vector<float>{ 0.0f, 1.0f }, std::vector<float>{ 1, 1, 1, 2, 2, 2 });
+	// Tangents of a straight line from 0 to 1, so cubic spline is linear in time
+	added													&= animation.AddChannel(child, Path::Translation, Interpolation::CubicSpline, std::vector<float>{ 0.0f, 1.0f }, std::vector<float>{ 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0 });
+
+	bool rejected											= true;
+	rejected												&= !animation.AddChannel(root, Path::Translation, Interpolation::Linear, std::vector<float>{ 0.0f }, std::vector<float>{ 0, 0, 0 });
+	rejected												&= !animation.AddChannel(static_sibling, Path::Rotation, Interpolation::Linear, std::vector<float>{ 0.0f }, std::vector<float>{ 0, 0, 0 });
+	rejected												&= !animation.AddChannel(static_sibling, Path::Scale, Interpolation::Linear, std::vector<float>{ 1.0f, 0.0f }, std::vector<float>{ 1, 1, 1, 1, 1, 1 });
+	rejected												&= animation.AddNode({ .mParentIndex = 10 }) == kInvalidIndex;
+	animation.Finalize();
+
+	bool linear												= true;
+	animation.Evaluate(1.0f);
+	linear													&= is_near(translation(animation.GetWorldMatrix(root)), glm::vec3(2, 0, 0));
+	animation.Evaluate(1.5f);
+	linear													&= is_near(translation(animation.GetWorldMatrix(root)), glm::vec3(2, 2, 0));
+
+	animation.Evaluate(0.5f);
+	linear													&= is_near(translation(animation.GetWorldMatrix(root)), glm::vec3(1, 0, 0));
+	bool slerp												= is_near(glm::vec3(animation.GetWorldMatrix(root)[0]), glm::vec3(std::cos(glm::radians(45.0f)), 0.0f, -std::sin(glm::radians(45.0f))));
+
+	bool cubic												= true;
+	animation.Evaluate(0.25f);
+	cubic													&= is_near(translation(animation.GetWorldMatrix(child)), glm::vec3(animation.GetWorldMatrix(root) * glm::vec4(0.25f, 0.0f, 0.0f, 1.0f)));
+	animation.Evaluate(0.75f);
+	cubic													&= is_near(translation(animation.GetWorldMatrix(child)), glm::vec3(animation.GetWorldMatrix(root) * glm::vec4(0.75f, 0.0f, 0.0f, 1.0f)));
+
+	bool step												= true;
+	animation.Evaluate(0.99f);
+	step													&= std::abs(glm::length(glm::vec3(animation.GetWorldMatrix(child)[0])) - 1.0f) < 1.0e-4f;
+	animation.Evaluate(1.0f);
+	step													&= std::abs(glm::length(glm::vec3(animation.GetWorldMatrix(child)[0])) - 2.0f) < 1.0e-4f;
+
+	bool hierarchy											= true;
+	animation.Evaluate(1.5f);
+	hierarchy												&= is_near(translation(animation.GetWorldMatrix(static_child)), glm::vec3(animation.GetWorldMatrix(root) * glm::vec4(0.0f, 1.0f, 0.0f, 1.0f)));
+	hierarchy												&= is_near(translation(animation.GetWorldMatrix(static_sibling)), glm::vec3(5, 0, 0));
+	hierarchy												&= animation.IsAnimated(static_child) && !animation.IsAnimated(static_sibling);
+	hierarchy												&= animation.GetStats().mAnimatedNodeCount == 3 && animation.GetStats().mBatchCount == 4;
+
+	bool looping											= true;
+	animation.Evaluate(0.5f);
+	glm::vec3 first											= translation(animation.GetWorldMatrix(root));
+	animation.Evaluate(0.5f + 2.0f * (animation.GetEndTime() - animation.GetStartTime()));
+	looping													&= is_near(first, translation(animation.GetWorldMatrix(root)));
+	animation.Evaluate(0.5f - (animation.GetEndTime() - animation.GetStartTime()));
+	looping													&= is_near(first, translation(animation.GetWorldMatrix(root)));
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "valid channels added",							added },
+		{ "invalid channels and nodes rejected",			rejected },
+		{ "linear at and between keys",						linear },
+		{ "rotation slerp",									slerp },
+		{ "cubic spline hermite",							cubic },
+		{ "step holds until next key",						step },
+		{ "hierarchy and static nodes",						hierarchy },
+		{ "time loops over duration",						looping },
+	};
+
+	outMessage												= std::format("[Animation] Validate: {} nodes, {} channels in {} batches\n", animation.GetNodeCount(), animation.GetStats().mChannelCount, animation.GetStats().mBatchCount);
+	return gReportValidateChecks(checks, outMessage);
+}
+
+Animation::BenchmarkResult Animation::sBenchmark(uint32_t inNodeCount, uint32_t inIterationCount)
+{
+	constexpr uint32_t kChainLength							= 4;
+	constexpr uint32_t kKeyCount							= 32;
+	constexpr float kKeyInterval							= 1.0f / 30.0f;
+
+	std::mt19937 random_engine(0);
+	std::uniform_real_distribution<float> random(-1.0f, 1.0f);
+	std::vector<float> times(kKeyCount);
+	for (uint32_t key = 0; key < kKeyCount; key++)
+		times[key]											= static_cast<float>(key) * kKeyInterval;
+
+	Animation animation;
+	std::vector<float> values;
+	for (uint32_t node_index = 0; node_index < inNodeCount; node_index++)
+	{
+		animation.AddNode({ .mParentIndex = node_index % kChainLength == 0 ? kInvalidIndex : node_index - 1 });
+
+		values.resize(kKeyCount * 3);
+		std::generate(values.begin(), values.end(), [&]() { return random(random_engine); });
+		animation.AddChannel(node_index, Path::Translation, Interpolation::Linear, times, values);
+
+		values.resize(kKeyCount * 4);
+		for (uint32_t key = 0; key < kKeyCount; key++)
+		{
+			glm::quat rotation								= glm::normalize(glm::quat(random(random_engine), random(random_engine), random(random_engine), random(random_engine)));
+			values[key * 4 + 0]								= rotation.x;
+			values[key * 4 + 1]								= rotation.y;
+			values[key * 4 + 2]								= rotation.z;
+			values[key * 4 + 3]								= rotation.w;
+		}
+		animation.AddChannel(node_index, Path::Rotation, Interpolation::Linear, times, values);
+
+		values.resize(kKeyCount * 3 * 3);
+		std::generate(values.begin(), values.end(), [&]() { return 1.0f + 0.5f * random(random_engine); });
+		animation.AddChannel(node_index, Path::Scale, Interpolation::CubicSpline, times, values);
+	}
+	animation.Finalize();
+
+	BenchmarkResult result;
+	result.mNodeCount										= inNodeCount;
+	result.mChannelCount									= animation.GetStats().mChannelCount;
+	result.mIterationCount									= inIterationCount;
+	for (uint32_t iteration = 0; iteration < inIterationCount; iteration++)
+	{
+		animation.Evaluate(static_cast<float>(iteration) * 0.013f);
+		result.mSampleMS									+= animation.GetStats().mSampleMS;
+		result.mHierarchyMS									+= animation.GetStats().mHierarchyMS;
+	}
+	if (inIterationCount > 0)
+	{
+		result.mSampleMS									/= inIterationCount;
+		result.mHierarchyMS									/= inIterationCount;
+	}
+	return result;
+}
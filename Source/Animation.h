@@ -0,0 +1,137 @@
+#pragma once
+
+// Standard library and glm only, so sampling can be validated and benchmarked without a device
+#include "Thirdparty/glm.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Keyframe animation of a node hierarchy, as glTF channels and samplers
+// Channels are sorted into batches of same path and interpolation, each batch is sampled in two tight passes with branches uniform over the batch: key search, then blend
+// Only nodes affected by a channel, directly or through a parent, are recomposed by Evaluate
+class Animation
+{
+public:
+	static constexpr uint32_t kInvalidIndex					= 0xFFFFFFFF;
+
+	enum class Path : uint8_t
+	{
+		Translation,
+		Rotation,
+		Scale,
+
+		Count
+	};
+
+	enum class Interpolation : uint8_t
+	{
+		Linear,			// Slerp for rotation
+		Step,
+		CubicSpline,	// Hermite with in and out tangent per key, as glTF
+
+		Count
+	};
+
+	struct Node
+	{
+		uint32_t mParentIndex								= kInvalidIndex;	// Parents are added before children
+		glm::vec3 mTranslation								= glm::vec3(0.0f);
+		glm::quat mRotation									= glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 mScale									= glm::vec3(1.0f);
+	};
+
+	struct Stats
+	{
+		uint32_t mChannelCount								= 0;
+		uint32_t mBatchCount								= 0;
+		uint32_t mAnimatedNodeCount							= 0;
+		float mSampleMS										= 0.0f;	// Of last Evaluate
+		float mHierarchyMS									= 0.0f;
+	};
+
+	struct BenchmarkResult
+	{
+		uint32_t mNodeCount									= 0;
+		uint32_t mChannelCount								= 0;
+		uint32_t mIterationCount							= 0;
+		float mSampleMS										= 0.0f;	// Per Evaluate
+		float mHierarchyMS									= 0.0f;
+	};
+
+	uint32_t AddNode(const Node& inNode);
+
+	// inTimes ascending in seconds. inValues has 3 floats (translation, scale) or 4 floats (rotation as xyzw) per key, three times that for CubicSpline (in tangent, value, out tangent)
+	// Fails on mismatched sizes and on second channel of same node and path
+	bool AddChannel(uint32_t inNodeIndex, Path inPath, Interpolation inInterpolation, std::span<const float> inTimes, std::span<const float> inValues);
+
+	// After all nodes and channels are added, world matrices are at rest pose until first Evaluate
+	void Finalize();
+
+	// Loops over [GetStartTime(), GetEndTime()]
+	void Evaluate(float inTime);
+
+	bool IsEmpty() const									{ return mChannels.empty(); }
+	bool IsAnimated(uint32_t inNodeIndex) const				{ return mNodeAnimated[inNodeIndex] != 0; }
+	uint32_t GetNodeCount() const							{ return static_cast<uint32_t>(mRestNodes.size()); }
+	float GetStartTime() const								{ return mStartTime; }
+	float GetEndTime() const								{ return mEndTime; }
+	float GetTimeAt(float inRatio) const					{ return mStartTime + glm::clamp(inRatio, 0.0f, 1.0f) * (mEndTime - mStartTime); }
+	const glm::mat4x4& GetWorldMatrix(uint32_t inNodeIndex) const { return mWorldMatrices[inNodeIndex]; }
+	const Stats& GetStats() const							{ return mStats; }
+
+	// Checks interpolation modes against analytic values at and between keys, slerp, looping and hierarchy composition
+	static bool sValidate(std::string& outMessage);
+
+	// Synthetic chains of 4 nodes, each with translation (linear), rotation (linear) and scale (cubic spline) channels
+	static BenchmarkResult sBenchmark(uint32_t inNodeCount, uint32_t inIterationCount);
+
+private:
+	struct Channel
+	{
+		uint32_t mNodeIndex									= 0;
+		uint32_t mKeyOffset									= 0;	// Into mTimes
+		uint32_t mKeyCount									= 0;
+		uint32_t mValueOffset								= 0;	// Into mValues
+		Path mPath											= Path::Translation;
+		Interpolation mInterpolation						= Interpolation::Linear;
+	};
+
+	struct Batch
+	{
+		uint32_t mChannelOffset								= 0;
+		uint32_t mChannelCount								= 0;
+		Path mPath											= Path::Translation;
+		Interpolation mInterpolation						= Interpolation::Linear;
+	};
+
+	void SearchKeys(const Batch& inBatch, float inTime);
+	void Blend(const Batch& inBatch);
+	void UpdateWorldMatrix(uint32_t inNodeIndex);
+
+	std::vector<Node> mRestNodes;
+
+	// Current pose, structure of arrays indexed by node
+	std::vector<glm::vec3> mTranslations;
+	std::vector<glm::quat> mRotations;
+	std::vector<glm::vec3> mScales;
+	std::vector<glm::mat4x4> mWorldMatrices;
+
+	std::vector<uint8_t> mNodeAnimated;
+	std::vector<uint32_t> mAnimatedNodes;					// Parents first
+
+	std::vector<Channel> mChannels;							// Sorted by batch after Finalize
+	std::vector<Batch> mBatches;
+	std::vector<float> mTimes;
+	std::vector<float> mValues;
+
+	// Per channel output of key search pass, read by blend pass
+	std::vector<uint32_t> mSampleKeys;
+	std::vector<float> mSampleFractions;
+	std::vector<float> mSampleDurations;
+
+	float mStartTime										= 0.0f;
+	float mEndTime											= 0.0f;
+	Stats mStats;
+};
@@ -108,6 +108,8 @@ void Atmosphere::Runtime::Bruneton17::Render(const Profile& inProfile)
 	// Recompute
 	if (mRecomputeRequested || mRecomputeEveryFrame)
 	{
+		PROFILE_SCOPE("Atmosphere::Bruneton17::Bake");
+
 		ComputeTransmittance();
 		
 		gBarrierUAV(gCommandList, nullptr);
@@ -178,6 +180,7 @@ void Atmosphere::Runtime::Bruneton17::ComputeMultipleScattering(uint32_t scatter
 void Atmosphere::Runtime::Hillaire20::Render(const Profile& inProfile)
 {
 	(void)inProfile;
+	PROFILE_SCOPE("Atmosphere::Hillaire20::Render");
 
 	TransLUT();
 
@@ -687,7 +690,9 @@ void Atmosphere::Runtime::Wilkie21::Render(const Profile& inProfile)
 {
 	if (!mBakeRequested)
 		return;
-	
+
+	PROFILE_SCOPE("Atmosphere::Wilkie21::Bake");
+
 	double sun_elevation			= glm::pi<double>() / 2.0 - gConstants.mSunZenith;
 	double sun_azimuth				= gConstants.mSunAzimuth;
 	glm::dvec3 view_direction		= glm::dvec3(0, 0, 1);
@@ -0,0 +1,264 @@
+#include "Batch.h"
+#include "Scene.h"
+
+#include "RayCaster.h"
+#include "SequenceCapture.h"
+
+#include "Thirdparty/tinygltf/json.hpp"
+
+#include <sstream>
+
+Batch gBatch;
+
+int Batch::sFindPresetIndex(const std::string& inName)
+{
+	for (int index = 0; index < ScenePreset::sCount(); index++)
+		if (ScenePreset::sPresets[index].mName == inName)
+			return index;
+	return -1;
+}
+
+bool Batch::Load(const std::filesystem::path& inPath, Backend inBackend)
+{
+	BatchJobFile job_file;
+	std::string error										= job_file.Load(inPath);
+	if (!error.empty())
+	{
+		gTrace(std::format("[Batch] {}: {}\n", inPath.string(), error));
+		return false;
+	}
+
+	// Invalid jobs are reported and skipped, as jobs of unknown presets
+	mJobs													= std::move(job_file.mJobs);
+	for (Job& job : mJobs)
+		if (job.mOutputDirectory.empty())
+			job.mOutputDirectory							= gEnsureDumpDirectoryExists() / "Batch" / job.mName;
+
+	mPath													= inPath;
+	mReportPath												= job_file.mReportPath;
+
+	mReports.assign(mJobs.size(), {});
+	for (size_t job_index = 0; job_index < mJobs.size(); job_index++)
+	{
+		if (!job_file.mErrors[job_index].empty())
+		{
+			mReports[job_index].mError						= job_file.mErrors[job_index];
+			gTrace(std::format("[Batch] Job {}: {}\n", mJobs[job_index].mName, job_file.mErrors[job_index]));
+		}
+		else if (sFindPresetIndex(mJobs[job_index].mPreset) < 0)
+			mReports[job_index].mError						= std::format("Unknown preset \"{}\"", mJobs[job_index].mPreset);
+		else if (!mJobs[job_index].mCameraAnimationPath.empty() && !std::filesystem::exists(mJobs[job_index].mCameraAnimationPath))
+			mReports[job_index].mError						= std::format("Camera animation \"{}\" not found", mJobs[job_index].mCameraAnimationPath);
+	}
+
+	mBackend												= inBackend;
+	mActive													= true;
+	mJobIndex												= -1;
+	mBegin													= std::chrono::steady_clock::now();
+
+	gTrace(std::format("[Batch] {} jobs from {}, backend {}\n", mJobs.size(), inPath.string(), nameof::nameof_enum(mBackend)));
+	return true;
+}
+
+bool Batch::LoadFromCommandLine(std::string_view inCommandLine)
+{
+	std::istringstream arguments{ std::string(inCommandLine) };
+	std::string flag, path, backend;
+	arguments >> flag >> path >> backend;
+
+	if (flag != "-batch" || path.empty())
+	{
+		gTrace("[Batch] Usage: -batch <jobs.json> [-cpu]\n");
+		return false;
+	}
+
+	return Load(path, backend == "-cpu" ? Backend::CPU : Backend::D3D12);
+}
+
+bool Batch::NextJob()
+{
+	// Jobs with errors from Load are not rendered
+	do
+		mJobIndex++;
+	while (mJobIndex < static_cast<int>(mJobs.size()) && !mReports[mJobIndex].mError.empty());
+	return mJobIndex < static_cast<int>(mJobs.size());
+}
+
+void Batch::EndRender()
+{
+	Report& report											= GetReport();
+	report.mRenderMS										= std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - mRenderBegin).count();
+	report.mImageCount										= GetJob().mFrameCount;
+}
+
+void Batch::RunCPU()
+{
+	// [NOTE] Diffuse only with emission of instances, same unit as ScreenColor. Environment is black.
+	FrameEncoder encoder;
+	encoder.Initialize(FrameEncoder::sDefaultThreadCount(), 4);
+
+	RayCaster ray_caster;
+	int loaded_preset_index									= -1;
+	for (mJobIndex = 0; mJobIndex < static_cast<int>(mJobs.size()); mJobIndex++)
+	{
+		const Job& job										= GetJob();
+		Report& report										= GetReport();
+
+		int preset_index									= sFindPresetIndex(job.mPreset);
+		if (preset_index < 0 || !report.mError.empty())
+			continue;
+
+		report.mSceneReused									= preset_index == loaded_preset_index;
+		report.mShadersReused								= true; // No shaders
+		if (!report.mSceneReused)
+		{
+			CPU_TIMING_SCOPE_SIMPLE(&report.mLoadMS);
+
+			ScenePreset::sCurrentIndex						= preset_index;
+			ScenePreset::sPreviousIndex						= preset_index;
+			gScene.Unload();
+			gScene.LoadContent(ScenePreset::sCurrent());
+			ray_caster.Build(gScene.GetSceneContent());
+			loaded_preset_index								= preset_index;
+		}
+		gScene.OverrideCameraAnimation(job.mCameraAnimationPath);
+
+		if (ray_caster.Empty())
+		{
+			report.mError									= "Scene has no triangles";
+			continue;
+		}
+
+		if (!job.mEXR)
+			gTrace(std::format("[Batch] Job {} requested PNG, CPU backend writes EXR\n", job.mName));
+
+		std::filesystem::create_directories(job.mOutputDirectory);
+
+		BeginRender();
+
+		gLoadCamera(); // For emission boost of preset
+		const SceneContent& scene_content					= gScene.GetSceneContent();
+		const uint width									= job.mResolution.x;
+		const uint height									= job.mResolution.y;
+		const uint pixel_count								= width * height;
+		const float emission_scale							= gConstants.mEmissionBoost * kPreExposure;
+		const uint recursion_depth_max						= gConstants.mRecursionDepthCountMax;
+		auto pixel_range									= std::views::iota(0u, pixel_count);
+
+		gConstants.mScreenWidth								= width;
+		gConstants.mScreenHeight							= height;
+		for (uint frame_index = 0; frame_index < job.mFrameCount; frame_index++)
+		{
+			PROFILE_SCOPE("Batch::RenderCPU");
+
+			gLoadCamera();
+			gApplyCameraAnimation(frame_index * 1.0f / job.mFrameCount); // As mSequenceFrameRatio
+			if (job.mCameraPosition.has_value())
+				gConstants.CameraPosition()					= float4(job.mCameraPosition.value(), 1.0f);
+			if (job.mCameraDirection.has_value())
+			{
+				gConstants.CameraFront()					= float4(glm::normalize(job.mCameraDirection.value()), 0.0f);
+				gConstants.CameraUp()						= float4(0, 1, 0, 0);
+				gConstants.CameraLeft()						= float4(glm::cross(float3(gConstants.CameraUp()), float3(gConstants.CameraFront())), 0.0f);
+			}
+			if (job.mHorizontalFovDegree.has_value())
+				gCameraSettings.mHorizontalFovDegree		= job.mHorizontalFovDegree.value();
+			gUpdateCameraMatrices();
+
+			const std::vector<RayCaster::Hit> primary_hits	= ray_caster.CastCamera(gConstants, width, height);
+
+			FrameEncoder::Frame frame;
+			frame.mWidth									= width;
+			frame.mHeight									= height;
+			frame.mFormat									= FrameEncoder::Format::RGBA32F;
+			frame.mPixels.resize(pixel_count * sizeof(float4));
+			frame.mPath										= job.mOutputDirectory / std::format("{:03}.exr", frame_index);
+
+			float4* pixels									= reinterpret_cast<float4*>(frame.mPixels.data());
+			std::transform(std::execution::par, pixel_range.begin(), pixel_range.end(), pixels, [&](uint inPixelIndex)
+			{
+				std::mt19937 random_engine(frame_index * pixel_count + inPixelIndex);
+				std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+
+				float3 sum									= float3(0.0f);
+				for (uint sample_index = 0; sample_index < job.mSampleCount; sample_index++)
+				{
+					float3 throughput						= float3(1.0f);
+					RayCaster::Hit hit						= primary_hits[inPixelIndex];
+					for (uint recursion_depth = 0; hit.mValid; recursion_depth++)
+					{
+						const InstanceData& instance_data	= scene_content.mInstanceDatas[hit.mInstanceIndex];
+						sum									+= throughput * instance_data.mEmission * emission_scale;
+						if (instance_data.mBSDF == BSDF::Light || recursion_depth + 1 > recursion_depth_max)
+							break;
+
+						// Diffuse, cosine term and PDF cancel out
+						throughput							*= instance_data.mAlbedo;
+						if (gMaxComponent(throughput) <= 0.0f)
+							break;
+
+						float3 direction					= RayCaster::sSampleCosineHemisphere(hit.mNormalWS, float2(random01(random_engine), random01(random_engine)));
+						hit									= ray_caster.Intersect(hit.mPositionWS + hit.mNormalWS * 1.0e-4f, direction);
+					}
+				}
+				return float4(sum / static_cast<float>(job.mSampleCount), 1.0f);
+			});
+
+			encoder.Submit(std::move(frame));
+		}
+		encoder.Flush();
+
+		EndRender();
+	}
+
+	encoder.Finalize();
+}
+
+void Batch::WriteReport() const
+{
+	nlohmann::json json;
+	json["job_file"]										= mPath.string();
+	json["backend"]											= std::string(nameof::nameof_enum(mBackend));
+	json["total_ms"]										= std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - mBegin).count();
+
+	uint succeeded_count									= 0;
+	nlohmann::json jobs										= nlohmann::json::array();
+	for (size_t job_index = 0; job_index < mJobs.size(); job_index++)
+	{
+		const Job& job										= mJobs[job_index];
+		const Report& report								= mReports[job_index];
+		bool succeeded										= report.mError.empty() && report.mImageCount == job.mFrameCount;
+		succeeded_count										+= succeeded ? 1 : 0;
+
+		nlohmann::json entry;
+		entry["name"]										= job.mName;
+		entry["preset"]										= job.mPreset;
+		entry["resolution"]									= { job.mResolution.x, job.mResolution.y };
+		entry["sample_count"]								= job.mSampleCount;
+		entry["frame_count"]								= job.mFrameCount;
+		entry["output"]										= job.mOutputDirectory.string();
+		entry["succeeded"]									= succeeded;
+		entry["error"]										= report.mError;
+		entry["scene_reused"]								= report.mSceneReused;
+		entry["shaders_reused"]								= report.mShadersReused;
+		entry["load_ms"]									= report.mLoadMS;
+		entry["compile_ms"]									= report.mCompileMS;
+		entry["render_ms"]									= report.mRenderMS;
+		entry["image_count"]								= report.mImageCount;
+		jobs.push_back(entry);
+	}
+	json["jobs"]											= jobs;
+
+	std::ofstream file(mReportPath);
+	file << json.dump(4);
+
+	std::filesystem::path trace_path						= mReportPath;
+	trace_path.replace_filename(mReportPath.stem().string() + "_trace.json");
+	gProfiler.WriteChromeTrace(trace_path);
+
+	std::filesystem::path timing_path						= mReportPath;
+	timing_path.replace_filename(mReportPath.stem().string() + "_timing.csv");
+	gWriteTimingCSV(timing_path);
+
+	gTrace(std::format("[Batch] {}/{} jobs succeeded, report written to {}\n", succeeded_count, mJobs.size(), mReportPath.string()));
+}
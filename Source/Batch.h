@@ -0,0 +1,65 @@
+#pragma once
+#include "Common.h"
+#include "BatchJob.h"
+
+// Headless batch render of a JSON job file, see Asset/Batch/Example.json
+// Jobs render back to back, the scene is kept while consecutive jobs share a preset and shaders are only recompiled when the generated shader header changes
+// Usage: DXRPlayground.exe -batch <jobs.json> [-cpu]
+class Batch
+{
+public:
+	enum class Backend : uint
+	{
+		D3D12,
+		CPU,		// Diffuse path tracing with RayCaster, no device is created
+
+		Count
+	};
+
+	using Job													= BatchJobFile::Job;
+
+	struct Report
+	{
+		std::string mError;														// Empty -> succeeded
+		bool mSceneReused										= false;
+		bool mShadersReused										= false;
+		float mLoadMS											= 0.0f;
+		float mCompileMS										= 0.0f;
+		float mRenderMS											= 0.0f;			// Including encoding of images
+		uint mImageCount										= 0;
+	};
+
+	bool Load(const std::filesystem::path& inPath, Backend inBackend);
+	bool LoadFromCommandLine(std::string_view inCommandLine);	// -batch <jobs.json> [-cpu]
+	bool IsActive() const										{ return mActive; }
+	Backend GetBackend() const									{ return mBackend; }
+
+	// D3D12 backend, driven by main loop
+	bool NextJob();												// false when all jobs are done
+	int GetJobIndex() const										{ return mJobIndex; }
+	const Job& GetJob() const									{ return mJobs[mJobIndex]; }
+	Report& GetReport()											{ return mReports[mJobIndex]; }
+	void BeginRender()											{ mRenderBegin = std::chrono::steady_clock::now(); }
+	void EndRender();
+
+	// CPU backend, runs all jobs
+	void RunCPU();
+
+	void WriteReport() const;
+
+	static int sFindPresetIndex(const std::string& inName);		// -1 when not found, unlike ScenePreset::sFindIndex
+
+private:
+	std::filesystem::path mPath;
+	std::filesystem::path mReportPath;
+	Backend mBackend											= Backend::D3D12;
+	bool mActive												= false;
+
+	std::vector<Job> mJobs;
+	std::vector<Report> mReports;
+	int mJobIndex												= -1;
+
+	std::chrono::steady_clock::time_point mBegin;
+	std::chrono::steady_clock::time_point mRenderBegin;
+};
+extern Batch gBatch;
@@ -0,0 +1,139 @@
+#include "BatchJob.h"
+
+#include "JSONReader.h"
+#include "Validate.h"
+
+#include <format>
+#include <fstream>
+#include <span>
+#include <sstream>
+
+// Keys of wrong type or size keep their previous value, returns errors of them, empty when valid
+static std::string sReadJob(const nlohmann::json& inJSON, BatchJobFile::Job& ioJob)
+{
+	if (!inJSON.is_object())
+		return "Job is not an object";
+
+	JSONReader reader(inJSON);
+	float values[3];
+	std::string string;
+	if (reader.ReadString("name", string))
+		ioJob.mName											= string;
+	if (reader.ReadString("preset", string))
+		ioJob.mPreset										= string;
+	if (reader.ReadNumbers("resolution", std::span(values, 2), 1.0f, "an array of 2 numbers >= 1"))
+		ioJob.mResolution									= glm::uvec2(static_cast<uint32_t>(values[0]), static_cast<uint32_t>(values[1]));
+	if (reader.ReadNumbers("sample_count", std::span(values, 1), 1.0f, "a number >= 1"))
+		ioJob.mSampleCount									= static_cast<uint32_t>(values[0]);
+	if (reader.ReadNumbers("frame_count", std::span(values, 1), 1.0f, "a number >= 1"))
+		ioJob.mFrameCount									= static_cast<uint32_t>(values[0]);
+	if (reader.ReadNumbers("camera_position", std::span(values, 3), -1.0e9f, "an array of 3 numbers"))
+		ioJob.mCameraPosition								= glm::vec3(values[0], values[1], values[2]);
+	if (reader.ReadNumbers("camera_direction", std::span(values, 3), -1.0e9f, "an array of 3 numbers"))
+		ioJob.mCameraDirection								= glm::vec3(values[0], values[1], values[2]);
+	if (reader.ReadNumbers("fov", std::span(values, 1), 1.0f, "a number >= 1"))
+		ioJob.mHorizontalFovDegree							= values[0];
+	if (reader.ReadString("format", string))
+		ioJob.mEXR											= string == "exr";
+	if (reader.ReadString("output", string))
+		ioJob.mOutputDirectory								= string;
+	if (reader.ReadString("camera_animation", string))
+		ioJob.mCameraAnimationPath							= string;
+	return reader.GetErrors();
+}
+
+std::string BatchJobFile::Load(const std::filesystem::path& inPath)
+{
+	std::ifstream file(inPath);
+	if (!file)
+		return std::format("Failed to open job file {}", inPath.string());
+
+	mReportPath												= inPath;
+	mReportPath.replace_filename(inPath.stem().string() + "_report.json");
+
+	std::stringstream text;
+	text << file.rdbuf();
+	return Parse(text.str());
+}
+
+std::string BatchJobFile::Parse(std::string_view inText)
+{
+	mJobs.clear();
+	mErrors.clear();
+
+	nlohmann::json json										= nlohmann::json::parse(inText, nullptr, false);
+	if (json.is_discarded() || !json.is_object() || !json.contains("jobs") || !json["jobs"].is_array())
+		return "Failed to parse job file, expects an object with \"jobs\" array";
+
+	Job defaults;
+	if (json.contains("defaults"))
+	{
+		std::string errors									= sReadJob(json["defaults"], defaults);
+		if (!errors.empty())
+			return std::format("Invalid defaults: {}", errors);
+	}
+
+	for (const nlohmann::json& job_json : json["jobs"])
+	{
+		Job job												= defaults;
+		job.mName											= std::format("{:03}", mJobs.size());
+		mErrors.push_back(sReadJob(job_json, job));
+
+		// "output" of defaults is shared, each job not giving its own writes into a directory of its name there
+		if (!defaults.mOutputDirectory.empty() && job.mOutputDirectory == defaults.mOutputDirectory)
+			job.mOutputDirectory							= defaults.mOutputDirectory / job.mName;
+		mJobs.push_back(job);
+	}
+
+	if (mJobs.empty())
+		return "No jobs in job file";
+
+	if (json.contains("report") && json["report"].is_string())
+		mReportPath											= json["report"].get<std::string>();
+
+	return {};
+}
+
+bool BatchJobFile::sValidate(std::string& outMessage)
+{
+	BatchJobFile job_file;
+	std::string error										= job_file.Parse(R"({
+		"defaults": { "resolution": [640, 360], "sample_count": 16, "format": "exr", "output": "Batch" },
+		"report": "Report.json",
+		"jobs":
+		[
+			{ "name": "Close", "preset": "CornellBox", "camera_position": [0, 1, 2], "camera_direction": [0, 0, -1], "fov": 60, "output": "Close", "camera_animation": "Camera.gltf" },
+			{ "preset": "CornellBox", "resolution": "big", "sample_count": -1, "camera_position": [1, 2], "format": 1 },
+			42
+		]
+	})");
+
+	const bool parsed										= error.empty() && job_file.mJobs.size() == 3 && job_file.mErrors.size() == 3;
+	const Job empty_job;
+	const Job& valid_job									= parsed ? job_file.mJobs[0] : empty_job;
+	const Job& mistyped_job									= parsed ? job_file.mJobs[1] : empty_job;
+	const std::string& mistyped_error						= parsed ? job_file.mErrors[1] : error;
+
+	auto mentions											= [&](const char* inKey) { return mistyped_error.find(std::format("\"{}\"", inKey)) != std::string::npos; };
+	auto file_error											= [](std::string_view inText) { BatchJobFile file; return !file.Parse(inText).empty(); };
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "job file parsed",								parsed },
+		{ "defaults and keys applied",						parsed && valid_job.mName == "Close" && valid_job.mResolution == glm::uvec2(640, 360) && valid_job.mSampleCount == 16 && valid_job.mEXR
+																&& valid_job.mCameraPosition == glm::vec3(0, 1, 2) && valid_job.mHorizontalFovDegree == 60.0f && valid_job.mOutputDirectory == "Close"
+																&& valid_job.mCameraAnimationPath == "Camera.gltf" },
+		{ "valid job has no error",							parsed && job_file.mErrors[0].empty() },
+		{ "mistyped keys reported",							parsed && mentions("resolution") && mentions("sample_count") && mentions("camera_position") && mentions("format") },
+		{ "mistyped keys keep defaults",					parsed && mistyped_job.mName == "001" && mistyped_job.mResolution == glm::uvec2(640, 360) && mistyped_job.mSampleCount == 16
+																&& !mistyped_job.mCameraPosition.has_value() && mistyped_job.mEXR },
+		{ "default output shared by name",					parsed && mistyped_job.mOutputDirectory == std::filesystem::path("Batch") / "001" && mistyped_job.mCameraAnimationPath.empty() },
+		{ "non-object job reported",						parsed && !job_file.mErrors[2].empty() },
+		{ "report path read",								job_file.mReportPath == "Report.json" },
+		{ "invalid defaults rejected",						file_error(R"({ "defaults": { "frame_count": "one" }, "jobs": [ {} ] })") },
+		{ "missing jobs rejected",							file_error(R"({ "defaults": {} })") && file_error(R"({ "jobs": [] })") && file_error("not json") },
+	};
+
+	outMessage												= std::format("[BatchJobFile] Validate: {} jobs\n", job_file.mJobs.size());
+	return gReportValidateChecks(checks, outMessage);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// Standard library, glm and json only, so job files can be parsed and checked without Windows headers
+#include "Thirdparty/glm.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Job file of Batch, see Asset/Batch/Example.json
+// "defaults" applies to every job before its own keys. Keys of wrong type or size are reported per job, such jobs are not rendered.
+class BatchJobFile
+{
+public:
+	struct Job
+	{
+		std::string mName;														// Index of job when not given
+		std::string mPreset;													// Name of ScenePreset
+		glm::uvec2 mResolution									= glm::uvec2(1280, 720);
+		uint32_t mSampleCount									= 64;			// Accumulated frames per image
+		uint32_t mFrameCount									= 1;			// Images per job, camera animation spans them
+		std::optional<glm::vec3> mCameraPosition;
+		std::optional<glm::vec3> mCameraDirection;
+		std::optional<float> mHorizontalFovDegree;
+		bool mEXR												= false;		// ScreenColor as EXR instead of postprocessed PNG
+		std::filesystem::path mOutputDirectory;									// Empty when not given, "output" of defaults gets the job name appended
+		std::string mCameraAnimationPath;										// glTF played instead of camera animation of preset, empty for the one of preset
+	};
+
+	// Error of the file itself, empty when loaded. Errors of jobs are in mErrors.
+	std::string Load(const std::filesystem::path& inPath);
+	std::string Parse(std::string_view inText);
+
+	std::vector<Job> mJobs;
+	std::vector<std::string> mErrors;											// Per job, empty when valid
+	std::filesystem::path mReportPath;											// "report", otherwise <job file>_report.json next to it
+
+	// Parses job files with valid, mistyped and missing keys and checks values and errors of each job
+	static bool sValidate(std::string& outMessage);
+};
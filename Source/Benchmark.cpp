@@ -0,0 +1,459 @@
+#include "Benchmark.h"
+#include "Scene.h"
+#include "RayCaster.h"
+#include "Cloud.h"
+#include "JSONReader.h"
+
+#include <sstream>
+
+Benchmark gBenchmark;
+
+bool Benchmark::LoadFromCommandLine(std::string_view inCommandLine)
+{
+	std::istringstream arguments{ std::string(inCommandLine) };
+	std::string flag, path, option;
+	arguments >> flag >> path;
+	while (arguments >> option)
+	{
+		if (option == "-cpu")
+			mBackend										= Backend::CPU;
+		else if (option == "-update-baseline")
+			mUpdateBaseline									= true;
+		else if (option == "-no-optimize-meshes")
+			gConfigs.mOptimizeMeshes						= false;
+		else if (option == "-load-threads")
+			arguments >> gConfigs.mLoadThreadCount;
+	}
+
+	if (flag != "-benchmark" || path.empty())
+	{
+		gTrace("[Benchmark] Usage: -benchmark <suite.json> [-cpu] [-update-baseline] [-no-optimize-meshes] [-load-threads <count>]\n");
+		return false;
+	}
+
+	std::ifstream file(path);
+	nlohmann::json json										= nlohmann::json::parse(file, nullptr, false);
+	if (json.is_discarded() || !json.is_object())
+	{
+		gTrace(std::format("[Benchmark] Failed to parse suite {}\n", path));
+		return false;
+	}
+
+	// Keys of wrong type, size or range fail the load, as invalid defaults of a batch job file
+	JSONReader reader(json);
+	float values[2];
+	std::string string;
+	std::vector<std::string> presets;
+	if (reader.ReadStrings("presets", presets))
+	{
+		for (const std::string& name : presets)
+		{
+			if (std::none_of(ScenePreset::sPresets.begin(), ScenePreset::sPresets.end(), [&](const ScenePreset& inPreset) { return inPreset.mName == name; }))
+				gTrace(std::format("[Benchmark] Unknown preset \"{}\" skipped\n", name));
+			else
+				mSettings.mPresets.push_back(name);
+		}
+	}
+	if (reader.ReadNumbers("resolution", std::span(values, 2), 1.0f, "an array of 2 numbers >= 1"))
+		mSettings.mResolution								= uint2(static_cast<uint>(values[0]), static_cast<uint>(values[1]));
+	if (reader.ReadNumbers("warmup_frame_count", std::span(values, 1), 0.0f, "a number >= 0"))
+		mSettings.mWarmupFrameCount							= static_cast<uint>(values[0]);
+	if (reader.ReadNumbers("frame_count", std::span(values, 1), 1.0f, "a number >= 1"))
+		mSettings.mFrameCount								= static_cast<uint>(values[0]);
+	if (reader.ReadNumbers("repeat_count", std::span(values, 1), 1.0f, "a number >= 1"))
+		mSettings.mRepeatCount								= static_cast<uint>(values[0]);
+	reader.ReadBool("compile_shaders", mSettings.mCompileShaders);
+	if (reader.ReadNumbers("threshold_percent", std::span(values, 1), 0.0f, "a number >= 0"))
+		mSettings.mThresholdPercent							= values[0];
+	if (reader.ReadNumbers("threshold_ms", std::span(values, 1), 0.0f, "a number >= 0"))
+		mSettings.mThresholdMS								= values[0];
+	if (reader.ReadNumbers("threshold_mb", std::span(values, 1), 0.0f, "a number >= 0"))
+		mSettings.mThresholdMB								= values[0];
+	if (reader.ReadNumbers("threshold_count", std::span(values, 1), 0.0f, "a number >= 0"))
+		mSettings.mThresholdCount							= values[0];
+
+	// Baselines are per backend as they measure different stages
+	mSuitePath												= path;
+	std::string backend_name								= std::string(nameof::nameof_enum(mBackend));
+	mSettings.mBaselinePath									= mSuitePath;
+	mSettings.mBaselinePath.replace_filename(std::format("{}_baseline_{}.json", mSuitePath.stem().string(), backend_name));
+	if (reader.ReadString("baseline", string))
+		mSettings.mBaselinePath								= string;
+	mSettings.mOutputPath									= gEnsureDumpDirectoryExists() / "Benchmark" / std::format("{}_{}.json", mSuitePath.stem().string(), backend_name);
+	if (reader.ReadString("output", string))
+		mSettings.mOutputPath								= string;
+
+	if (!reader.GetErrors().empty())
+	{
+		gTrace(std::format("[Benchmark] Invalid suite {}: {}\n", path, reader.GetErrors()));
+		return false;
+	}
+
+	if (mSettings.mPresets.empty())
+		for (const ScenePreset& preset : ScenePreset::sPresets)
+			mSettings.mPresets.push_back(std::string(preset.mName));
+
+	mActive													= true;
+	mPhase													= Phase::Load;
+	mPresetIndex											= 0;
+
+	gTrace(std::format("[Benchmark] {} presets from {}, backend {}\n", mSettings.mPresets.size(), mSuitePath.string(), backend_name));
+	return true;
+}
+
+void Benchmark::BeginWarmup()
+{
+	mPhase													= Phase::Warmup;
+	mFrameIndex												= 0;
+}
+
+void Benchmark::EndFrame()
+{
+	switch (mPhase)
+	{
+	case Phase::Warmup:
+		if (++mFrameIndex < mSettings.mWarmupFrameCount)
+			break;
+
+		gStats.mGPUTimingHistory.Clear();
+		gStats.mCPUTimingHistory.Clear();
+		mPhase												= Phase::Measure;
+		mFrameIndex											= 0;
+		break;
+	case Phase::Measure:
+		if (++mFrameIndex < mSettings.mFrameCount)
+			break;
+
+		// Texture decode happens on first frame, so load stats are complete by now
+		CollectLoadStats(GetMetrics());
+		CollectFrameTimings(GetMetrics());
+		gTrace(std::format("[Benchmark] {} done, {} metrics\n", GetPreset(), GetMetrics().size()));
+
+		mPresetIndex++;
+		mPhase												= mPresetIndex < mSettings.mPresets.size() ? Phase::Load : Phase::Done;
+		break;
+	default:
+		break;
+	}
+}
+
+void Benchmark::CollectLoadStats(Metrics& ioMetrics) const
+{
+	const Scene::LoadStats& stats							= gScene.GetLoadStats();
+	auto add												= [&](const char* inName, float inValue, bool inAlways)
+	{
+		if (inAlways || inValue > 0.0f) // Stages skipped without device support are left out of comparison
+			ioMetrics[std::format("load.{}_ms", inName)]	= inValue;
+	};
+
+	add("parse",					stats.mParseMS,						true);
+	add("parse_xml",				stats.mXMLParseMS,					false);
+	add("parse_obj_io",				stats.mObjIOMS,						false);
+	add("parse_merge",				stats.mMergeMS,						false);
+	add("parse_gltf_file",			stats.mGLTFFileMS,					false);
+	add("parse_gltf_traverse",		stats.mGLTFTraverseMS,				false);
+	add("parse_gltf_convert",		stats.mGLTFConvertMS,				false);
+	add("optimize_meshes",			stats.mOptimizeMeshesMS,			false);
+	add("lights",					stats.mLightsMS,					true);
+	add("triangle_lights",			stats.mTriangleLightsMS,			false);
+	add("lss",						stats.mLSSMS,						false);
+	add("meshlets",					stats.mMeshletsMS,					false);
+	add("quantize",					stats.mQuantizeMS,					false);
+	add("textures",					stats.mTexturesMS,					false);
+	add("texture_decode",			stats.mTextureDecodeMS,				false);
+	add("buffers",					stats.mBuffersMS,					false);
+	add("acceleration_structures",	stats.mAccelerationStructuresMS,	false);
+	add("views",					stats.mViewsMS,						false);
+
+	// Shading streams of vertex attributes, quantized ones only when enabled
+	const Scene::GeometryStats& geometry_stats				= gScene.GetGeometryStats();
+	ioMetrics["memory.vertex_attributes_float_mb"]			= static_cast<float>(geometry_stats.mVertexAttributeFloatBytes / 1048576.0);
+	if (geometry_stats.mVertexAttributeQuantizedBytes > 0)
+		ioMetrics["memory.vertex_attributes_quantized_mb"]	= static_cast<float>(geometry_stats.mVertexAttributeQuantizedBytes / 1048576.0);
+	ioMetrics["memory.indices_32bit_mb"]					= static_cast<float>(geometry_stats.mIndexBytes / 1048576.0);
+	ioMetrics["memory.indices_packed_mb"]					= static_cast<float>(geometry_stats.mPackedIndexBytes / 1048576.0);
+	ioMetrics["scene.blas_count"]							= static_cast<float>(geometry_stats.mBLASCount);
+	ioMetrics["scene.emissive_triangle_count"]				= static_cast<float>(gScene.GetSceneContent().mEmissiveTriangleCount);
+	if (geometry_stats.mBLASResultBytes > 0)
+		ioMetrics["memory.blas_mb"]							= static_cast<float>(geometry_stats.mBLASResultBytes / 1048576.0);
+	if (geometry_stats.mBLASCompactedBytes > 0)
+		ioMetrics["memory.blas_compacted_mb"]				= static_cast<float>(geometry_stats.mBLASCompactedBytes / 1048576.0);
+	if (geometry_stats.mLSSSegmentCount > 0)
+	{
+		ioMetrics["scene.lss_segment_count"]				= static_cast<float>(geometry_stats.mLSSSegmentCount);
+		ioMetrics["memory.lss_mb"]							= static_cast<float>(geometry_stats.mLSSBytes / 1048576.0);
+	}
+}
+
+void Benchmark::CollectRayCasterTimings(Metrics& ioMetrics) const
+{
+	const SceneContent& scene_content						= gScene.GetSceneContent();
+
+	RayCaster ray_caster;
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&ioMetrics["cpu_bvh.build_ms"]);
+		ray_caster.Build(scene_content);
+	}
+
+	// Fixed rays between random points in scene bounds, independent of triangle order
+	constexpr uint kRayCount								= 256 * 1024;
+	std::mt19937 random_engine(0);
+	std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+	auto random_point										= [&]() { return glm::mix(scene_content.mBoundsMin, scene_content.mBoundsMax, float3(random01(random_engine), random01(random_engine), random01(random_engine))); };
+	std::vector<std::pair<float3, float3>> rays(kRayCount);
+	for (std::pair<float3, float3>& ray : rays)
+	{
+		float3 origin										= random_point();
+		float3 direction									= random_point() - origin;
+		ray													= { origin, glm::length(direction) > 0.0f ? glm::normalize(direction) : float3(0, 1, 0) };
+	}
+
+	std::atomic<uint> hit_count								= 0;
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&ioMetrics["cpu_bvh.trace_ms"]);
+		std::for_each(std::execution::par, rays.begin(), rays.end(), [&](const std::pair<float3, float3>& inRay)
+		{
+			if (ray_caster.Intersect(inRay.first, inRay.second).mValid)
+				hit_count++;
+		});
+	}
+	gTrace(std::format("[Benchmark] {} CPU BVH: {} of {} rays hit\n", GetPreset(), hit_count.load(), kRayCount));
+}
+
+void Benchmark::CollectAnimationTimings(Metrics& ioMetrics) const
+{
+	// Copy of scene animation, so the scene stays at its load pose
+	Animation animation										= gScene.GetSceneContent().mAnimation;
+	if (animation.IsEmpty())
+		return;
+
+	constexpr uint kIterationCount							= 256;
+	float sample_ms											= 0.0f;
+	float hierarchy_ms										= 0.0f;
+	for (uint iteration = 0; iteration < kIterationCount; iteration++)
+	{
+		animation.Evaluate(animation.GetTimeAt(iteration * 1.0f / kIterationCount));
+		sample_ms											+= animation.GetStats().mSampleMS;
+		hierarchy_ms										+= animation.GetStats().mHierarchyMS;
+	}
+	ioMetrics["cpu_animation.scene_sample_ms"]				= sample_ms / kIterationCount;
+	ioMetrics["cpu_animation.scene_hierarchy_ms"]			= hierarchy_ms / kIterationCount;
+}
+
+void Benchmark::CollectSyntheticAnimationTimings(Metrics& ioMetrics) const
+{
+	// Synthetic thousands of nodes, independent of preset
+	Animation::BenchmarkResult result						= Animation::sBenchmark(4096, 256);
+	ioMetrics["cpu_animation.sample_ms"]					= result.mSampleMS;
+	ioMetrics["cpu_animation.hierarchy_ms"]					= result.mHierarchyMS;
+}
+
+void Benchmark::CollectLSSTimings(Metrics& ioMetrics) const
+{
+	// Meshes shared by instances are generated once, as in Scene::GenerateLSSFromTriangle
+	const SceneContent& scene_content						= gScene.GetSceneContent();
+	std::set<std::tuple<uint, uint, uint, uint>> meshes;
+	for (const InstanceData& instance_data : scene_content.mInstanceDatas)
+		if (instance_data.mIndexCount > 0)
+			meshes.insert({ instance_data.mVertexOffset, instance_data.mVertexCount, instance_data.mIndexOffset, instance_data.mIndexCount });
+
+	std::vector<uint> segments;
+	for (uint mode_index = 0; mode_index < static_cast<uint>(LSSWireframe::Mode::Count); mode_index++)
+	{
+		LSSWireframe::Settings settings						= gScene.mLSSWireframeSettings;
+		settings.mMode										= static_cast<LSSWireframe::Mode>(mode_index);
+
+		LSSWireframe::Stats total_stats;
+		for (const auto& [vertex_offset, vertex_count, index_offset, index_count] : meshes)
+		{
+			LSSWireframe::Stats stats;
+			LSSWireframe::sGenerate(
+				std::span<const VertexType>(scene_content.mVertices.data() + vertex_offset, vertex_count),
+				std::span<const IndexType>(scene_content.mIndices.data() + index_offset, index_count),
+				settings, segments, stats);
+			total_stats										+= stats;
+		}
+
+		std::string mode_name								= std::string(nameof::nameof_enum(settings.mMode));
+		std::transform(mode_name.begin(), mode_name.end(), mode_name.begin(), [](char inChar) { return static_cast<char>(std::tolower(inChar)); });
+		ioMetrics[std::format("cpu_lss.{}_ms", mode_name)]		= total_stats.mGenerateMS;
+		ioMetrics[std::format("cpu_lss.{}_segment_count", mode_name)] = static_cast<float>(total_stats.mSegmentCount);
+		gTrace(std::format("[Benchmark] {} LSS {}: {} triangles -> {} segments, {} boundary, {} non-manifold edges, {:.2f} ms\n", GetPreset(), nameof::nameof_enum(settings.mMode),
+			total_stats.mTriangleCount, total_stats.mSegmentCount, total_stats.mBoundaryEdgeCount, total_stats.mNonManifoldEdgeCount, total_stats.mGenerateMS));
+	}
+}
+
+void Benchmark::CollectCloudNoiseTimings(Metrics& ioMetrics) const
+{
+	// Profile settings at sizes around those of TileableVolumeNoise inputs, scene independent
+	const Cloud::Profile& profile							= gCloud.mProfile;
+	for (const CloudNoise::Settings& volume_settings : { profile.mShapeNoiseVolume, profile.mErosionNoiseVolume })
+		for (uint size : { 32u, 64u, 128u })
+		{
+			CloudNoise::Settings settings					= volume_settings;
+			settings.mSize									= size;
+
+			std::vector<uint8_t> voxels;
+			CloudNoise::Stats stats;
+			CloudNoise::sGenerate(settings, voxels, stats);
+
+			const char* name								= settings.mType == CloudNoise::Type::PerlinWorley ? "shape" : "erosion";
+			ioMetrics[std::format("cpu_cloud_noise.{}_{}_ms", name, size)] = stats.mGenerateMS;
+			gTrace(std::format("[Benchmark] Cloud noise {} {}^3: {:.2f} ms, {:.1f} Mvoxel/s\n", name, size, stats.mGenerateMS, stats.mVoxelCount / (1000.0 * gMax(stats.mGenerateMS, 1.0e-3f))));
+		}
+}
+
+void Benchmark::CollectFrameTimings(Metrics& ioMetrics) const
+{
+	auto add												= [&](const char* inCategory, const TimingHistory& inHistory)
+	{
+		for (uint series_index = 0; series_index < inHistory.GetSeriesCount(); series_index++)
+		{
+			TimingHistory::Statistics statistics			= inHistory.GetSeries(series_index).Compute();
+			if (statistics.mCount == 0)
+				continue;
+
+			ioMetrics[std::format("{}.{}.p50_ms", inCategory, inHistory.GetName(series_index))] = statistics.mP50;
+			ioMetrics[std::format("{}.{}.p95_ms", inCategory, inHistory.GetName(series_index))] = statistics.mP95;
+		}
+	};
+
+	add("gpu", gStats.mGPUTimingHistory);
+	add("cpu", gStats.mCPUTimingHistory);
+}
+
+void Benchmark::RunCPU()
+{
+	// Minimum over repeats, first one also warms file cache
+	auto keep_minimum										= [](uint inRepeatIndex, const Metrics& inRepeatMetrics, Metrics& ioMetrics)
+	{
+		for (const auto& [name, value] : inRepeatMetrics)
+			ioMetrics[name]									= inRepeatIndex == 0 ? value : gMin(ioMetrics[name], value);
+	};
+
+	// Scene independent stages, once per suite rather than per preset
+	for (uint repeat_index = 0; repeat_index < mSettings.mRepeatCount; repeat_index++)
+	{
+		Metrics repeat_metrics;
+		CollectSyntheticAnimationTimings(repeat_metrics);
+		CollectCloudNoiseTimings(repeat_metrics);
+		keep_minimum(repeat_index, repeat_metrics, mResults[kSuiteKey]);
+	}
+
+	for (mPresetIndex = 0; mPresetIndex < mSettings.mPresets.size(); mPresetIndex++)
+	{
+		const ScenePreset& preset							= ScenePreset::sFind(GetPreset());
+		Metrics& metrics									= GetMetrics();
+
+		for (uint repeat_index = 0; repeat_index < mSettings.mRepeatCount; repeat_index++)
+		{
+			gScene.Unload();
+
+			Metrics repeat_metrics;
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&repeat_metrics["load.total_ms"]);
+				gScene.LoadCPU(preset);
+			}
+			CollectLoadStats(repeat_metrics);
+			CollectRayCasterTimings(repeat_metrics);
+			CollectAnimationTimings(repeat_metrics);
+			CollectLSSTimings(repeat_metrics);
+			keep_minimum(repeat_index, repeat_metrics, metrics);
+		}
+
+		gTrace(std::format("[Benchmark] {} done, load {:.2f} ms\n", GetPreset(), metrics["load.total_ms"]));
+	}
+	gScene.Unload();
+
+	mPhase													= Phase::Done;
+}
+
+// Unit and absolute threshold of a metric from the suffix of its name, percent threshold only when unknown
+static std::pair<std::string_view, float> sGetMetricUnit(std::string_view inMetric, const Benchmark::Settings& inSettings)
+{
+	if (inMetric.ends_with("_ms"))
+		return { "ms", inSettings.mThresholdMS };
+	if (inMetric.ends_with("_mb"))
+		return { "MB", inSettings.mThresholdMB };
+	if (inMetric.ends_with("_count"))
+		return { "", inSettings.mThresholdCount };
+	return { "", 0.0f };
+}
+
+int Benchmark::Finish()
+{
+	nlohmann::json results;
+	results["suite"]										= mSuitePath.string();
+	results["backend"]										= std::string(nameof::nameof_enum(mBackend));
+	results["presets"]										= mResults;
+
+	nlohmann::json baseline;
+	bool baseline_exists									= std::filesystem::exists(mSettings.mBaselinePath);
+	if (baseline_exists)
+	{
+		std::ifstream file(mSettings.mBaselinePath);
+		baseline											= nlohmann::json::parse(file, nullptr, false);
+		if (baseline.is_discarded() || !baseline.is_object() || !baseline.contains("presets"))
+		{
+			gTrace(std::format("[Benchmark] Failed to parse baseline {}\n", mSettings.mBaselinePath.string()));
+			baseline_exists									= false;
+		}
+	}
+
+	std::vector<Regression> regressions;
+	uint compared_count										= 0;
+	uint improved_count										= 0;
+	if (baseline_exists)
+	{
+		const nlohmann::json& baseline_presets				= baseline["presets"];
+		for (const auto& [preset, metrics] : mResults)
+		{
+			if (!baseline_presets.contains(preset))
+				continue;
+
+			for (const auto& [metric, value] : metrics)
+			{
+				if (!baseline_presets[preset].contains(metric) || !baseline_presets[preset][metric].is_number())
+					continue;
+
+				auto [unit, threshold]						= sGetMetricUnit(metric, mSettings);
+				float baseline_value						= baseline_presets[preset][metric].get<float>();
+				float delta									= value - baseline_value;
+				float threshold_percent						= baseline_value * mSettings.mThresholdPercent / 100.0f;
+				compared_count++;
+				if (delta > threshold && delta > threshold_percent)
+					regressions.push_back({ .mPreset = preset, .mMetric = metric, .mBaseline = baseline_value, .mCurrent = value, .mUnit = unit });
+				else if (-delta > threshold && -delta > threshold_percent)
+					improved_count++;
+			}
+		}
+	}
+
+	nlohmann::json regressions_json							= nlohmann::json::array();
+	std::string message										= std::format("[Benchmark] {} presets, {} metrics compared, {} improved, {} regressed (threshold {:.1f}% and {:.3f} ms, {:.3f} MB, {:.0f} count)\n",
+		mSettings.mPresets.size(), compared_count, improved_count, regressions.size(), mSettings.mThresholdPercent, mSettings.mThresholdMS, mSettings.mThresholdMB, mSettings.mThresholdCount);
+	for (const Regression& regression : regressions)
+	{
+		float change_percent								= regression.mBaseline > 0.0f ? (regression.mCurrent / regression.mBaseline - 1.0f) * 100.0f : 0.0f;
+		regressions_json.push_back({ { "preset", regression.mPreset }, { "metric", regression.mMetric }, { "baseline", regression.mBaseline }, { "current", regression.mCurrent }, { "unit", std::string(regression.mUnit) }, { "change_percent", change_percent } });
+		message												+= std::format("  [REGRESSION] {} {}: {:.3f} -> {:.3f} {}({:+.1f}%)\n", regression.mPreset, regression.mMetric, regression.mBaseline, regression.mCurrent,
+			regression.mUnit.empty() ? std::string() : std::string(regression.mUnit) + " ", change_percent);
+	}
+
+	if (!baseline_exists || mUpdateBaseline)
+	{
+		std::filesystem::create_directories(std::filesystem::absolute(mSettings.mBaselinePath).parent_path());
+		std::ofstream file(mSettings.mBaselinePath);
+		file << results.dump(4);
+		message												+= std::format("  Baseline written to {}\n", mSettings.mBaselinePath.string());
+	}
+
+	results["regressions"]									= regressions_json;
+	std::filesystem::create_directories(std::filesystem::absolute(mSettings.mOutputPath).parent_path());
+	std::ofstream file(mSettings.mOutputPath);
+	file << results.dump(4);
+	message													+= std::format("  Results written to {}\n", mSettings.mOutputPath.string());
+
+	gTrace(message);
+	return static_cast<int>(regressions.size());
+}
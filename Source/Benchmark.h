@@ -0,0 +1,100 @@
+#pragma once
+#include "Common.h"
+
+#include <map>
+
+// Performance regression suite over ScenePreset, see Asset/Benchmark/Suite.json
+// Each preset is loaded, shaders are compiled, then frames are rendered to collect pass timings. Metrics are compared against a JSON baseline.
+// Usage: DXRPlayground.exe -benchmark <suite.json> [-cpu] [-update-baseline] [-no-optimize-meshes] [-load-threads <count>]
+//   -cpu				CPU stages only (parse, lights, LSS wireframe modes, cloud noise volumes, meshlets, CPU BVH build and trace, animation sampling), no device is created
+//   -update-baseline	Overwrite baseline with this run, also happens when baseline does not exist yet
+//   -no-optimize-meshes	Keep source triangle order, to compare against a baseline with Scene::OptimizeMeshes
+//   -load-threads		Threads of parallel scene conversion, 0 for all, 1 for serial, see Configs::mLoadThreadCount
+// Exit code is the number of regressions.
+class Benchmark
+{
+public:
+	enum class Backend : uint
+	{
+		D3D12,
+		CPU,
+
+		Count
+	};
+
+	enum class Phase : uint
+	{
+		Load,		// Next frame loads preset, done by main loop
+		Warmup,
+		Measure,
+		Done,
+	};
+
+	struct Settings
+	{
+		std::vector<std::string> mPresets;												// Empty -> all of ScenePreset::sPresets
+		uint2 mResolution										= uint2(1280, 720);
+		uint mWarmupFrameCount									= 16;
+		uint mFrameCount										= 128;
+		uint mRepeatCount										= 3;			// CPU backend, minimum is kept
+		bool mCompileShaders									= true;			// Recompile per preset to measure it
+		float mThresholdPercent									= 10.0f;		// Regression when slower by both
+		float mThresholdMS										= 0.05f;		// Absolute thresholds by metric suffix
+		float mThresholdMB										= 0.01f;
+		float mThresholdCount									= 0.0f;
+		std::filesystem::path mBaselinePath;
+		std::filesystem::path mOutputPath;
+	};
+
+	using Metrics												= std::map<std::string, float>; // Name -> milliseconds (_ms), megabytes (_mb) or count (_count), lower is better
+	static constexpr const char* kSuiteKey						= "(suite)";	// Results of scene independent stages, measured once per suite
+
+	struct Regression
+	{
+		std::string mPreset;
+		std::string mMetric;
+		float mBaseline											= 0.0f;
+		float mCurrent											= 0.0f;
+		std::string_view mUnit;
+	};
+
+	bool LoadFromCommandLine(std::string_view inCommandLine);
+	bool IsActive() const										{ return mActive; }
+	Backend GetBackend() const									{ return mBackend; }
+	const Settings& GetSettings() const							{ return mSettings; }
+
+	// D3D12 backend, driven by main loop
+	Phase GetPhase() const										{ return mPhase; }
+	const std::string& GetPreset() const						{ return mSettings.mPresets[mPresetIndex]; }
+	Metrics& GetMetrics()										{ return mResults[GetPreset()]; }
+	void BeginWarmup();											// After preset is loaded
+	void EndFrame();
+
+	// CPU backend, runs all presets
+	void RunCPU();
+
+	// Write results, compare against baseline, returns regression count
+	int Finish();
+
+private:
+	void CollectLoadStats(Metrics& ioMetrics) const;
+	void CollectFrameTimings(Metrics& ioMetrics) const;
+	void CollectRayCasterTimings(Metrics& ioMetrics) const;
+	void CollectAnimationTimings(Metrics& ioMetrics) const;
+	void CollectSyntheticAnimationTimings(Metrics& ioMetrics) const;
+	void CollectLSSTimings(Metrics& ioMetrics) const;
+	void CollectCloudNoiseTimings(Metrics& ioMetrics) const;
+
+	Settings mSettings;
+	Backend mBackend											= Backend::D3D12;
+	bool mActive												= false;
+	bool mUpdateBaseline										= false;
+	std::filesystem::path mSuitePath;
+
+	Phase mPhase												= Phase::Load;
+	uint mPresetIndex											= 0;
+	uint mFrameIndex											= 0;
+
+	std::map<std::string, Metrics> mResults;
+};
+extern Benchmark gBenchmark;
@@ -14,6 +14,19 @@ void Cloud::Update()
 	constants.mRaymarch			= mProfile.mRaymarch;
 	constants.mGeometry			= mProfile.mGeometry;
 	constants.mShapeNoise		= mProfile.mShapeNoise;
+
+	// Check if recompute is required
+	static Profile sProfileCache = mProfile;
+	if (sProfileCache.mGenerateNoise != mProfile.mGenerateNoise || sProfileCache.mShapeNoiseVolume != mProfile.mShapeNoiseVolume || sProfileCache.mErosionNoiseVolume != mProfile.mErosionNoiseVolume)
+	{
+		sProfileCache = mProfile;
+		mRecomputeRequested = true;
+	}
+
+	uint shape_size				= mProfile.mGenerateNoise ? mProfile.mShapeNoiseVolume.mSize : Runtime::kPackedShapeSize;
+	uint erosion_size			= mProfile.mGenerateNoise ? mProfile.mErosionNoiseVolume.mSize : Runtime::kPackedErosionSize;
+	if (mRuntime.mShapeNoise3DTexture.mWidth != shape_size || mRuntime.mErosionNoise3DTexture.mWidth != erosion_size)
+		mResizeRequested = true;
 }
 
 void Cloud::Render(ID3D12GraphicsCommandList4* inCommandList)
@@ -21,21 +34,34 @@ void Cloud::Render(ID3D12GraphicsCommandList4* inCommandList)
 	if (!mEnabled)
 		return;
 
-	// Texture
-	for (auto&& texture : mRuntime.mTextures)
-		texture.UpdateGPU(inCommandList);
-
-	if (mRecomputeRequested)
+	// Volumes are baked once sizes match
+	if (mRecomputeRequested && !mResizeRequested)
 	{
+		PROFILE_SCOPE("Cloud::Bake");
+
+		if (mProfile.mGenerateNoise)
+		{
+			// Generated on CPU, uploaded as is
+			auto bake = [&](const CloudNoise::Settings& inSettings, BakedNoise& outBaked, Texture& ioTexture)
+			{
+				outBaked.mSettings = inSettings;
+				CloudNoise::sGenerate(inSettings, outBaked.mVoxels, outBaked.mStats);
+
+				ioTexture.mUploadData = outBaked.mVoxels;
+				ioTexture.mLoaded = false;
+				ioTexture.UpdateGPU(inCommandList);
+			};
+			bake(mProfile.mShapeNoiseVolume, mShapeNoiseBaked, mRuntime.mShapeNoise3DTexture);
+			bake(mProfile.mErosionNoiseVolume, mErosionNoiseBaked, mRuntime.mErosionNoise3DTexture);
+		}
+		else
 		{
-			mRuntime.mShapeNoise3DTexture.UpdateGPU(inCommandList);
+			// Packed 2D inputs reshaped into 3D
+			mRuntime.mShapeNoise2DTexture.UpdateGPU(inCommandList);
+			mRuntime.mErosionNoise2DTexture.UpdateGPU(inCommandList);
 
 			gRenderer.Setup(mRuntime.mShapeNoiseShader);
 			gCommandList->Dispatch(mRuntime.mShapeNoise3DTexture.mWidth / 8, mRuntime.mShapeNoise3DTexture.mHeight / 8, mRuntime.mShapeNoise3DTexture.mDepth);
-		}
-
-		{
-			mRuntime.mErosionNoise3DTexture.UpdateGPU(inCommandList);
 
 			gRenderer.Setup(mRuntime.mErosionNoiseShader);
 			gCommandList->Dispatch(mRuntime.mErosionNoise3DTexture.mWidth / 8, mRuntime.mErosionNoise3DTexture.mHeight / 8, mRuntime.mErosionNoise3DTexture.mDepth);
@@ -65,6 +91,49 @@ void Cloud::Finalize()
 	mRuntime.Reset();
 }
 
+void Cloud::Resize()
+{
+	mResizeRequested = false;
+	if (!mEnabled)
+		return;
+
+	uint shape_size		= mProfile.mGenerateNoise ? mProfile.mShapeNoiseVolume.mSize : Runtime::kPackedShapeSize;
+	uint erosion_size	= mProfile.mGenerateNoise ? mProfile.mErosionNoiseVolume.mSize : Runtime::kPackedErosionSize;
+	mRuntime.mShapeNoise3DTexture.Dimension(glm::uvec3(shape_size)).Initialize();
+	mRuntime.mErosionNoise3DTexture.Dimension(glm::uvec3(erosion_size)).Initialize();
+
+	mRecomputeRequested = true;
+}
+
+void Cloud::SaveNoise()
+{
+	// Volumes as uploaded, not regenerated
+	for (const BakedNoise* baked : { &mShapeNoiseBaked, &mErosionNoiseBaked })
+	{
+		const CloudNoise::Settings& settings = baked->mSettings;
+		const std::vector<uint8_t>& voxels = baked->mVoxels;
+		if (voxels.size() != static_cast<size_t>(settings.mSize) * settings.mSize * settings.mSize)
+		{
+			gTrace("[Cloud] Noise not baked yet, nothing saved\n");
+			return;
+		}
+
+		DirectX::ScratchImage image;
+		gValidate(image.Initialize3D(DXGI_FORMAT_R8_UNORM, settings.mSize, settings.mSize, settings.mSize, 1));
+		for (uint z = 0; z < settings.mSize; z++)
+		{
+			const DirectX::Image* slice = image.GetImage(0, 0, z);
+			for (uint y = 0; y < settings.mSize; y++)
+				memcpy(slice->pixels + y * slice->rowPitch, voxels.data() + (static_cast<size_t>(z) * settings.mSize + y) * settings.mSize, settings.mSize);
+		}
+
+		std::filesystem::path path = gEnsureDumpDirectoryExists();
+		path += std::format("CloudNoise.{}.{}.dds", nameof::nameof_enum(settings.mType), settings.mSize);
+		gValidate(DirectX::SaveToDDSFile(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::DDS_FLAGS_NONE, path.c_str()));
+		gTrace(std::format("[Cloud] Saved {}, generated in {:.2f} ms\n", path.string(), baked->mStats.mGenerateMS));
+	}
+}
+
 void Cloud::ImGuiShowMenus()
 {
 	if (!mEnabled)
@@ -124,6 +193,43 @@ void Cloud::ImGuiShowMenus()
 		ImGui::SliderFloat("Frequency", &gCloud.mProfile.mShapeNoise.mFrequency, 0.0f, 1.0f);
 		ImGui::SliderFloat("Power", &gCloud.mProfile.mShapeNoise.mPower, 0.0f, 100.0f);
 		ImGui::SliderFloat("Scale", &gCloud.mProfile.mShapeNoise.mScale, 0.0f, 5.0f);
+		ImGui::NewLine();
+
+		ImGui::Checkbox("Generate Volumes", &gCloud.mProfile.mGenerateNoise);
+		if (gCloud.mProfile.mGenerateNoise)
+		{
+			auto volume = [](const char* inName, CloudNoise::Settings& ioSettings, const BakedNoise& inBaked)
+			{
+				if (ImGui::TreeNodeEx(inName, ImGuiTreeNodeFlags_DefaultOpen))
+				{
+					ImGui::SliderUint("Size", &ioSettings.mSize, 8, 256);
+					if (ioSettings.mType == CloudNoise::Type::PerlinWorley)
+					{
+						ImGui::SliderUint("Perlin Frequency", &ioSettings.mPerlinFrequency, 1, 32);
+						ImGui::SliderUint("Perlin Octaves", &ioSettings.mPerlinOctaves, 0, 6);
+					}
+					ImGui::SliderUint("Worley Cell Count", &ioSettings.mWorleyCellCount, 1, 32);
+					ImGui::SliderUint("Worley Octaves", &ioSettings.mWorleyOctaves, 0, 6);
+					ImGui::SliderFloat("Gain", &ioSettings.mGain, 0.0f, 1.0f);
+					ImGui::SliderUint("Seed", &ioSettings.mSeed, 0, 1024);
+					ImGui::Text("%.3f ms, range [%.2f, %.2f], mean %.2f", inBaked.mStats.mGenerateMS, inBaked.mStats.mMin, inBaked.mStats.mMax, inBaked.mStats.mMean);
+
+					ImGui::TreePop();
+				}
+			};
+			volume("Shape Volume", gCloud.mProfile.mShapeNoiseVolume, gCloud.mShapeNoiseBaked);
+			volume("Erosion Volume", gCloud.mProfile.mErosionNoiseVolume, gCloud.mErosionNoiseBaked);
+
+			if (ImGui::Button("Save DDS"))
+				gCloud.SaveNoise();
+			ImGui::SameLine();
+			if (ImGui::Button("Validate"))
+			{
+				std::string message;
+				CloudNoise::sValidate(message);
+				gTrace(message);
+			}
+		}
 
 		SMALL_BUTTON(Profile::ShapeNoiseReference::Default);
 
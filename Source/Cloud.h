@@ -1,5 +1,6 @@
 #pragma once
 #include "Common.h"
+#include "CloudNoise.h"
 
 // [Schneider15] The Real-Time Volumetric Cloudscapes of Horizon Zero Dawn
 // [Schneider16] GPU Pro 7 Advanced Rendering Techniques, Real-Time Volumetric Cloudscapes
@@ -42,9 +43,20 @@ public:
 				profile.mShapeNoise.mFrequency					= 0.02f;
 				profile.mShapeNoise.mPower						= 60.0f;
 				profile.mShapeNoise.mScale						= 1.0f;
+
+				// Sizes and frequencies of TileableVolumeNoise inputs
+				profile.mGenerateNoise							= true;
+				profile.mShapeNoiseVolume						= {};
+				profile.mErosionNoiseVolume						= {};
+				profile.mErosionNoiseVolume.mType				= CloudNoise::Type::Worley;
+				profile.mErosionNoiseVolume.mSize				= 32;
+				profile.mErosionNoiseVolume.mWorleyCellCount	= 2;
 			}
 		};
 		CloudConstants::ShapeNoise mShapeNoise;
+		bool mGenerateNoise										= true;	// Otherwise reshape packed TileableVolumeNoise inputs, at Runtime::kPacked*Size
+		CloudNoise::Settings mShapeNoiseVolume;
+		CloudNoise::Settings mErosionNoiseVolume;
 
 		Profile()
 		{
@@ -65,6 +77,8 @@ public:
 		std::span<Shader> mShaders				= std::span<Shader>(&mShapeNoiseShader, &mSentinelShader);
 		
 		// Textures
+		static constexpr uint kPackedShapeSize		= 128;
+		static constexpr uint kPackedErosionSize	= 32;
 		Texture mShapeNoise3DTexture			= Texture().Width(128).Height(128).Depth(128).Format(DXGI_FORMAT_R8_UNORM).
 															UAVIndex(ViewDescriptorIndex::CloudShapeNoise3DUAV).SRVIndex(ViewDescriptorIndex::CloudShapeNoise3DSRV).Name("Cloud.ShapeNoise");
 		Texture mErosionNoise3DTexture			= Texture().Width(32).Height(32).Depth(32).Format(DXGI_FORMAT_R8_UNORM).
@@ -76,8 +90,7 @@ public:
 															UAVIndex(ViewDescriptorIndex::CloudErosionNoise2DUAV).SRVIndex(ViewDescriptorIndex::CloudErosionNoise2DSRV).Name("Cloud.ErosionNoise.Input").Path(L"Asset/TileableVolumeNoise/noiseErosionPacked.tga");
 		
 		Texture mSentinelTexture				= Texture();
-		// std::span<Texture> mTextures			= std::span<Texture>(&mShapeNoise3DTexture, &mSentinelTexture);
-		std::span<Texture> mTextures			= std::span<Texture>(&mSentinelTexture, &mSentinelTexture);
+		std::span<Texture> mTextures			= std::span<Texture>(&mShapeNoise3DTexture, &mSentinelTexture);
 	};
 	Runtime mRuntime;
 
@@ -85,10 +98,23 @@ public:
 	void Finalize();
 	void Update();
 	void Render(ID3D12GraphicsCommandList4* inCommandList);
+	void Resize();
+	void SaveNoise();
 	void ImGuiShowMenus();
 	void ImGuiShowTextures();
 
 	bool mRecomputeRequested = true;
+	bool mResizeRequested = false; // Volumes get new size, recreated once GPU is idle
 	bool mEnabled = false;
+
+	// Generated volumes as baked, kept for SaveNoise since upload data of textures is released
+	struct BakedNoise
+	{
+		CloudNoise::Settings mSettings;							// Of last bake, profile may have changed since
+		std::vector<uint8_t> mVoxels;
+		CloudNoise::Stats mStats;
+	};
+	BakedNoise mShapeNoiseBaked;
+	BakedNoise mErosionNoiseBaked;
 };
 extern Cloud gCloud;
\ No newline at end of file
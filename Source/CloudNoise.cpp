@@ -0,0 +1,550 @@
+#include "CloudNoise.h"
+
+#include "Validate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <execution>
+#include <format>
+#include <random>
+#include <ranges>
+
+static uint32_t sHash(uint32_t inValue)
+{
+	// lowbias32 finalizer
+	inValue													^= inValue >> 16;
+	inValue													*= 0x7FEB352Du;
+	inValue													^= inValue >> 15;
+	inValue													*= 0x846CA68Bu;
+	inValue													^= inValue >> 16;
+	return inValue;
+}
+
+static uint32_t sHash(int inX, int inY, int inZ, uint32_t inSeed)
+{
+	return sHash(static_cast<uint32_t>(inX) + sHash(static_cast<uint32_t>(inY) + sHash(static_cast<uint32_t>(inZ) + sHash(inSeed))));
+}
+
+static int sWrap(int inIndex, int inPeriod)
+{
+	int index												= inIndex % inPeriod;
+	return index < 0 ? index + inPeriod : index;
+}
+
+static float sFade(float inT)
+{
+	return inT * inT * inT * (inT * (inT * 6.0f - 15.0f) + 10.0f);
+}
+
+// Seeds of octaves, Perlin and Worley use separate streams
+static uint32_t sOctaveSeed(uint32_t inSeed, uint32_t inOctave, bool inWorley)
+{
+	return sHash(inSeed * 2 + (inWorley ? 1 : 0)) + inOctave * 0x9E3779B9u;
+}
+
+// [Perlin02] Improving Noise, 12 cube edge directions padded to 16
+static glm::vec3 sGradient(int inX, int inY, int inZ, uint32_t inSeed)
+{
+	static const glm::vec3 kGradients[16]					=
+	{
+		{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+		{ 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+		{ 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 },
+		{ 1, 1, 0 }, { -1, 1, 0 }, { 0, -1, 1 }, { 0, -1, -1 },
+	};
+	return kGradients[sHash(inX, inY, inZ, inSeed) & 15];
+}
+
+// Feature point of a Worley cell, in cell units relative to cell corner
+static glm::vec3 sFeaturePoint(int inX, int inY, int inZ, uint32_t inSeed)
+{
+	uint32_t hash_xy										= sHash(inX, inY, inZ, inSeed);
+	uint32_t hash_z											= sHash(hash_xy);
+	constexpr float kScale									= 1.0f / 65536.0f;
+	return glm::vec3((hash_xy & 0xFFFF) * kScale, (hash_xy >> 16) * kScale, (hash_z & 0xFFFF) * kScale);
+}
+
+static float sOctaveWeightSum(float inGain, uint32_t inOctaveCount)
+{
+	float sum												= 0.0f;
+	float weight											= 1.0f;
+	for (uint32_t octave = 0; octave < inOctaveCount; octave++, weight *= inGain)
+		sum													+= weight;
+	return std::max(sum, 1.0e-6f);
+}
+
+// Perlin FBM in [-1, 1] made billowy, then remapped into [worley, 1] so Worley FBM is lower bound
+static float sCombine(CloudNoise::Type inType, float inPerlin, float inWorley)
+{
+	if (inType == CloudNoise::Type::Worley)
+		return inWorley;
+
+	float perlin											= std::min(std::abs(inPerlin), 1.0f);
+	return inWorley + perlin * (1.0f - inWorley);
+}
+
+static float sPerlin(const glm::vec3& inPosition, int inPeriod, uint32_t inSeed)
+{
+	float p[3]												= { inPosition.x * inPeriod, inPosition.y * inPeriod, inPosition.z * inPeriod };
+	int cell[3];
+	float fraction[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float cell_floor									= std::floor(p[axis]);
+		cell[axis]											= static_cast<int>(cell_floor);
+		fraction[axis]										= p[axis] - cell_floor;
+	}
+
+	float corners[8];
+	for (int corner = 0; corner < 8; corner++)
+	{
+		int offset[3]										= { corner & 1, (corner >> 1) & 1, (corner >> 2) & 1 };
+		glm::vec3 gradient									= sGradient(sWrap(cell[0] + offset[0], inPeriod), sWrap(cell[1] + offset[1], inPeriod), sWrap(cell[2] + offset[2], inPeriod), inSeed);
+		corners[corner]										= gradient.x * (fraction[0] - offset[0]) + gradient.y * (fraction[1] - offset[1]) + gradient.z * (fraction[2] - offset[2]);
+	}
+
+	float u													= sFade(fraction[0]);
+	float v													= sFade(fraction[1]);
+	float w													= sFade(fraction[2]);
+	float x00												= corners[0] + u * (corners[1] - corners[0]);
+	float x10												= corners[2] + u * (corners[3] - corners[2]);
+	float x01												= corners[4] + u * (corners[5] - corners[4]);
+	float x11												= corners[6] + u * (corners[7] - corners[6]);
+	float xy0												= x00 + v * (x10 - x00);
+	float xy1												= x01 + v * (x11 - x01);
+	return xy0 + w * (xy1 - xy0);
+}
+
+// 1 at feature points, 0 at one cell away or further
+static float sWorley(const glm::vec3& inPosition, int inCellCount, uint32_t inSeed)
+{
+	float p[3]												= { inPosition.x * inCellCount, inPosition.y * inCellCount, inPosition.z * inCellCount };
+	int cell[3]												= { static_cast<int>(std::floor(p[0])), static_cast<int>(std::floor(p[1])), static_cast<int>(std::floor(p[2])) };
+
+	float distance_squared									= 3.0f;
+	for (int z = cell[2] - 1; z <= cell[2] + 1; z++)
+		for (int y = cell[1] - 1; y <= cell[1] + 1; y++)
+			for (int x = cell[0] - 1; x <= cell[0] + 1; x++)
+			{
+				glm::vec3 point								= sFeaturePoint(sWrap(x, inCellCount), sWrap(y, inCellCount), sWrap(z, inCellCount), inSeed);
+				float dx									= p[0] - (x + point.x);
+				float dy									= p[1] - (y + point.y);
+				float dz									= p[2] - (z + point.z);
+				distance_squared							= std::min(distance_squared, dx * dx + dy * dy + dz * dz);
+			}
+	return 1.0f - std::min(std::sqrt(distance_squared), 1.0f);
+}
+
+float CloudNoise::sSample(const Settings& inSettings, const glm::vec3& inPosition)
+{
+	float perlin											= 0.0f;
+	if (inSettings.mType == Type::PerlinWorley)
+	{
+		float weight										= 1.0f;
+		for (uint32_t octave = 0; octave < inSettings.mPerlinOctaves; octave++, weight *= inSettings.mGain)
+			perlin											+= weight * sPerlin(inPosition, static_cast<int>(std::max(inSettings.mPerlinFrequency, 1u) << octave), sOctaveSeed(inSettings.mSeed, octave, false));
+		perlin												/= sOctaveWeightSum(inSettings.mGain, inSettings.mPerlinOctaves);
+	}
+
+	float worley											= 0.0f;
+	float weight											= 1.0f;
+	for (uint32_t octave = 0; octave < inSettings.mWorleyOctaves; octave++, weight *= inSettings.mGain)
+		worley												+= weight * sWorley(inPosition, static_cast<int>(std::max(inSettings.mWorleyCellCount, 1u) << octave), sOctaveSeed(inSettings.mSeed, octave, true));
+	worley													/= sOctaveWeightSum(inSettings.mGain, inSettings.mWorleyOctaves);
+
+	return sCombine(inSettings.mType, perlin, worley);
+}
+
+namespace
+{
+	// Voxels along x of one octave, split into runs of one lattice cell
+	struct Axis
+	{
+		struct Run
+		{
+			uint32_t mBegin									= 0;
+			uint32_t mEnd									= 0;
+			int mCell										= 0;
+		};
+
+		int mPeriod											= 1;
+		uint32_t mSeed										= 0;
+		float mWeight										= 0.0f;
+		std::vector<float> mPosition;						// In cells
+		std::vector<float> mFraction;						// Within cell
+		std::vector<float> mFade;
+		std::vector<Run> mRuns;
+		std::vector<uint32_t> mCellBegin;					// [cell] first voxel in cell or after it, period + 1 entries
+
+		Axis(const std::vector<float>& inPosition, int inPeriod, uint32_t inSeed, float inWeight)
+			: mPeriod(inPeriod), mSeed(inSeed), mWeight(inWeight)
+		{
+			uint32_t size									= static_cast<uint32_t>(inPosition.size());
+			mPosition.resize(size);
+			mFraction.resize(size);
+			mFade.resize(size);
+			for (uint32_t x = 0; x < size; x++)
+			{
+				// Same arithmetic as scalar path, so both land in same cell
+				float p										= inPosition[x] * inPeriod;
+				float cell_floor							= std::floor(p);
+				int cell									= static_cast<int>(cell_floor);
+				mPosition[x]								= p;
+				mFraction[x]								= p - cell_floor;
+				mFade[x]									= sFade(mFraction[x]);
+				if (mRuns.empty() || mRuns.back().mCell != cell)
+					mRuns.push_back({ x, x, cell });
+				mRuns.back().mEnd							= x + 1;
+			}
+
+			// Sizes below period skip cells, those get empty spans
+			mCellBegin.resize(inPeriod + 1);
+			uint32_t voxel									= 0;
+			for (int cell = 0; cell <= inPeriod; cell++)
+			{
+				while (voxel < size && static_cast<int>(std::floor(mPosition[voxel])) < cell)
+					voxel++;
+				mCellBegin[cell]							= voxel;
+			}
+		}
+
+		// Cell and fraction of a row coordinate, as above
+		void Locate(float inPosition, int& outCell, float& outPosition, float& outFraction) const
+		{
+			outPosition										= inPosition * mPeriod;
+			float cell_floor								= std::floor(outPosition);
+			outCell											= static_cast<int>(cell_floor);
+			outFraction										= outPosition - cell_floor;
+		}
+	};
+
+	// Gradients or feature points of lattice lines along x around a row, rows in same cell reuse them
+	struct LineCache
+	{
+		int mCellY											= INT_MIN;
+		int mCellZ											= INT_MIN;
+		std::vector<glm::vec3> mValues;						// [line][wrapped x cell], lines over y, z offsets of sLines
+	};
+}
+
+static const glm::vec3* sLines(const Axis& inAxis, int inCellY, int inCellZ, int inOffsetMin, int inOffsetMax, bool inWorley, LineCache& ioCache)
+{
+	if (ioCache.mCellY == inCellY && ioCache.mCellZ == inCellZ)
+		return ioCache.mValues.data();
+
+	ioCache.mCellY											= inCellY;
+	ioCache.mCellZ											= inCellZ;
+	ioCache.mValues.clear();
+	for (int z = inCellZ + inOffsetMin; z <= inCellZ + inOffsetMax; z++)
+		for (int y = inCellY + inOffsetMin; y <= inCellY + inOffsetMax; y++)
+			for (int x = 0; x < inAxis.mPeriod; x++)
+			{
+				int wrapped_y								= sWrap(y, inAxis.mPeriod);
+				int wrapped_z								= sWrap(z, inAxis.mPeriod);
+				ioCache.mValues.push_back(inWorley ? sFeaturePoint(x, wrapped_y, wrapped_z, inAxis.mSeed) : sGradient(x, wrapped_y, wrapped_z, inAxis.mSeed));
+			}
+	return ioCache.mValues.data();
+}
+
+// Adds weighted octave into ioRow
+static void sPerlinRow(const Axis& inAxis, float inY, float inZ, LineCache& ioCache, float* ioRow)
+{
+	int cell_y, cell_z;
+	float position_y, position_z, fraction_y, fraction_z;
+	inAxis.Locate(inY, cell_y, position_y, fraction_y);
+	inAxis.Locate(inZ, cell_z, position_z, fraction_z);
+	float fade_y											= sFade(fraction_y);
+	float fade_z											= sFade(fraction_z);
+	float weight											= inAxis.mWeight;
+	const float* fraction_x									= inAxis.mFraction.data();
+	const float* fade_x										= inAxis.mFade.data();
+	const glm::vec3* gradients								= sLines(inAxis, cell_y, cell_z, 0, 1, false, ioCache);
+
+	for (const Axis::Run& run : inAxis.mRuns)
+	{
+		// Corner value is gradient.x * (fraction_x - offset_x) + invariant part
+		float gradient_x[8];
+		float invariant[8];
+		for (int corner = 0; corner < 8; corner++)
+		{
+			int offset[3]									= { corner & 1, (corner >> 1) & 1, (corner >> 2) & 1 };
+			const glm::vec3& gradient						= gradients[(offset[2] * 2 + offset[1]) * inAxis.mPeriod + sWrap(run.mCell + offset[0], inAxis.mPeriod)];
+			gradient_x[corner]								= gradient.x;
+			invariant[corner]								= -gradient.x * offset[0] + gradient.y * (fraction_y - offset[1]) + gradient.z * (fraction_z - offset[2]);
+		}
+
+		for (uint32_t x = run.mBegin; x < run.mEnd; x++)
+		{
+			float f											= fraction_x[x];
+			float u											= fade_x[x];
+			float c0										= gradient_x[0] * f + invariant[0];
+			float c1										= gradient_x[1] * f + invariant[1];
+			float c2										= gradient_x[2] * f + invariant[2];
+			float c3										= gradient_x[3] * f + invariant[3];
+			float c4										= gradient_x[4] * f + invariant[4];
+			float c5										= gradient_x[5] * f + invariant[5];
+			float c6										= gradient_x[6] * f + invariant[6];
+			float c7										= gradient_x[7] * f + invariant[7];
+			float x00										= c0 + u * (c1 - c0);
+			float x10										= c2 + u * (c3 - c2);
+			float x01										= c4 + u * (c5 - c4);
+			float x11										= c6 + u * (c7 - c6);
+			float xy0										= x00 + fade_y * (x10 - x00);
+			float xy1										= x01 + fade_y * (x11 - x01);
+			ioRow[x]										+= weight * (xy0 + fade_z * (xy1 - xy0));
+		}
+	}
+}
+
+// Adds weighted octave into ioRow, ioDistanceSquared is scratch of row size
+// Voxels test the points of their cell and both neighbors, so each point is tested by one span of three cells.
+// Spans are three times longer than runs of one cell, which keeps vectorized loops full at high octaves.
+static void sWorleyRow(const Axis& inAxis, float inY, float inZ, LineCache& ioCache, float* ioDistanceSquared, float* ioRow)
+{
+	int cell_y, cell_z;
+	float position_y, position_z, fraction_y, fraction_z;
+	inAxis.Locate(inY, cell_y, position_y, fraction_y);
+	inAxis.Locate(inZ, cell_z, position_z, fraction_z);
+	const float* position_x									= inAxis.mPosition.data();
+	uint32_t size											= static_cast<uint32_t>(inAxis.mPosition.size());
+	const glm::vec3* points									= sLines(inAxis, cell_y, cell_z, -1, 1, true, ioCache);
+
+	std::fill(ioDistanceSquared, ioDistanceSquared + size, 3.0f);
+	for (int line = 0; line < 9; line++)
+	{
+		int y												= cell_y + line % 3 - 1;
+		int z												= cell_z + line / 3 - 1;
+
+		// Unwrapped cells, -1 and mPeriod are neighbors across wrap faces
+		for (int x = -1; x <= inAxis.mPeriod; x++)
+		{
+			uint32_t begin									= inAxis.mCellBegin[std::clamp(x - 1, 0, inAxis.mPeriod)];
+			uint32_t end									= inAxis.mCellBegin[std::clamp(x + 2, 0, inAxis.mPeriod)];
+			if (begin == end)
+				continue;
+
+			const glm::vec3& point							= points[line * inAxis.mPeriod + sWrap(x, inAxis.mPeriod)];
+			float point_x									= x + point.x;
+			float dy										= position_y - (y + point.y);
+			float dz										= position_z - (z + point.z);
+			float distance_yz								= dy * dy + dz * dz;
+			for (uint32_t voxel = begin; voxel < end; voxel++)
+			{
+				float dx									= position_x[voxel] - point_x;
+				ioDistanceSquared[voxel]					= std::min(ioDistanceSquared[voxel], dx * dx + distance_yz);
+			}
+		}
+	}
+
+	float weight											= inAxis.mWeight;
+	for (uint32_t voxel = 0; voxel < size; voxel++)
+		ioRow[voxel]										+= weight * (1.0f - std::min(std::sqrt(ioDistanceSquared[voxel]), 1.0f));
+}
+
+void CloudNoise::sGenerate(const Settings& inSettings, std::vector<uint8_t>& outVoxels, Stats& outStats)
+{
+	auto start												= std::chrono::high_resolution_clock::now();
+
+	uint32_t size											= std::max(inSettings.mSize, 1u);
+	std::vector<float> position(size);
+	for (uint32_t x = 0; x < size; x++)
+		position[x]											= (x + 0.5f) / size;
+
+	// Octave weights normalized here, so rows only accumulate
+	std::vector<Axis> perlin_axes;
+	std::vector<Axis> worley_axes;
+	if (inSettings.mType == Type::PerlinWorley)
+	{
+		float weight_sum									= sOctaveWeightSum(inSettings.mGain, inSettings.mPerlinOctaves);
+		float weight										= 1.0f;
+		for (uint32_t octave = 0; octave < inSettings.mPerlinOctaves; octave++, weight *= inSettings.mGain)
+			perlin_axes.emplace_back(position, static_cast<int>(std::max(inSettings.mPerlinFrequency, 1u) << octave), sOctaveSeed(inSettings.mSeed, octave, false), weight / weight_sum);
+	}
+	{
+		float weight_sum									= sOctaveWeightSum(inSettings.mGain, inSettings.mWorleyOctaves);
+		float weight										= 1.0f;
+		for (uint32_t octave = 0; octave < inSettings.mWorleyOctaves; octave++, weight *= inSettings.mGain)
+			worley_axes.emplace_back(position, static_cast<int>(std::max(inSettings.mWorleyCellCount, 1u) << octave), sOctaveSeed(inSettings.mSeed, octave, true), weight / weight_sum);
+	}
+
+	// Slices in parallel, rows of a slice share scratch
+	struct SliceStats
+	{
+		float mMin											= 1.0f;
+		float mMax											= 0.0f;
+		double mSum											= 0.0;
+	};
+	std::vector<SliceStats> slice_stats(size);
+	outVoxels.resize(static_cast<size_t>(size) * size * size);
+	auto slice_range										= std::views::iota(0u, size);
+	std::for_each(std::execution::par, slice_range.begin(), slice_range.end(), [&](uint32_t inZ)
+	{
+		std::vector<float> perlin(size);
+		std::vector<float> worley(size);
+		std::vector<float> distance_squared(size);
+		std::vector<LineCache> perlin_caches(perlin_axes.size());
+		std::vector<LineCache> worley_caches(worley_axes.size());
+		SliceStats& stats									= slice_stats[inZ];
+
+		for (uint32_t y = 0; y < size; y++)
+		{
+			std::fill(perlin.begin(), perlin.end(), 0.0f);
+			std::fill(worley.begin(), worley.end(), 0.0f);
+			for (size_t axis_index = 0; axis_index < perlin_axes.size(); axis_index++)
+				sPerlinRow(perlin_axes[axis_index], position[y], position[inZ], perlin_caches[axis_index], perlin.data());
+			for (size_t axis_index = 0; axis_index < worley_axes.size(); axis_index++)
+				sWorleyRow(worley_axes[axis_index], position[y], position[inZ], worley_caches[axis_index], distance_squared.data(), worley.data());
+
+			uint8_t* voxels									= outVoxels.data() + (static_cast<size_t>(inZ) * size + y) * size;
+			for (uint32_t x = 0; x < size; x++)
+			{
+				float value									= std::clamp(sCombine(inSettings.mType, perlin[x], worley[x]), 0.0f, 1.0f);
+				voxels[x]									= static_cast<uint8_t>(value * 255.0f + 0.5f);
+				stats.mMin									= std::min(stats.mMin, value);
+				stats.mMax									= std::max(stats.mMax, value);
+				stats.mSum									+= value;
+			}
+		}
+	});
+
+	outStats												= {};
+	outStats.mVoxelCount									= outVoxels.size();
+	outStats.mMin											= 1.0f;
+	double sum												= 0.0;
+	for (const SliceStats& stats : slice_stats)
+	{
+		outStats.mMin										= std::min(outStats.mMin, stats.mMin);
+		outStats.mMax										= std::max(outStats.mMax, stats.mMax);
+		sum													+= stats.mSum;
+	}
+	outStats.mMean											= static_cast<float>(sum / static_cast<double>(outStats.mVoxelCount));
+	outStats.mGenerateMS									= std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+bool CloudNoise::sValidate(std::string& outMessage)
+{
+	Settings shape_settings;
+	shape_settings.mSize									= 48;
+	Settings erosion_settings;
+	erosion_settings.mType									= Type::Worley;
+	erosion_settings.mSize									= 32;
+	erosion_settings.mWorleyCellCount						= 2;
+
+	// Sample at period offsets in each axis
+	std::mt19937 random_engine(0);
+	std::uniform_real_distribution<float> position_distribution(-1.0f, 2.0f);
+	bool periodic											= true;
+	for (uint32_t sample_index = 0; sample_index < 256; sample_index++)
+	{
+		glm::vec3 position(position_distribution(random_engine), position_distribution(random_engine), position_distribution(random_engine));
+		for (const Settings& settings : { shape_settings, erosion_settings })
+		{
+			float value										= sSample(settings, position);
+			periodic										&= std::abs(value - sSample(settings, position + glm::vec3(1.0f, 0.0f, 0.0f))) < 1.0e-3f;
+			periodic										&= std::abs(value - sSample(settings, position + glm::vec3(0.0f, 1.0f, 0.0f))) < 1.0e-3f;
+			periodic										&= std::abs(value - sSample(settings, position + glm::vec3(0.0f, 0.0f, 1.0f))) < 1.0e-3f;
+			periodic										&= std::abs(value - sSample(settings, position + glm::vec3(-2.0f, 3.0f, -1.0f))) < 1.0e-3f;
+		}
+	}
+
+	// Size and frequencies not dividing each other, every voxel within one step of scalar reference
+	bool matches_reference									= true;
+	{
+		Settings settings									= shape_settings;
+		settings.mSize										= 21;
+		settings.mPerlinFrequency							= 3;
+		settings.mWorleyCellCount							= 5;
+		for (Type type : { Type::PerlinWorley, Type::Worley })
+		{
+			settings.mType									= type;
+			std::vector<uint8_t> voxels;
+			Stats stats;
+			sGenerate(settings, voxels, stats);
+			matches_reference								&= voxels.size() == static_cast<size_t>(settings.mSize) * settings.mSize * settings.mSize;
+			for (uint32_t z = 0; z < settings.mSize && matches_reference; z++)
+				for (uint32_t y = 0; y < settings.mSize; y++)
+					for (uint32_t x = 0; x < settings.mSize; x++)
+					{
+						glm::vec3 position((x + 0.5f) / settings.mSize, (y + 0.5f) / settings.mSize, (z + 0.5f) / settings.mSize);
+						float reference						= std::clamp(sSample(settings, position), 0.0f, 1.0f) * 255.0f;
+						matches_reference					&= std::abs(voxels[(static_cast<size_t>(z) * settings.mSize + y) * settings.mSize + x] - reference) <= 1.0f;
+					}
+		}
+	}
+
+	// Steps across wrap faces are as large as steps between interior neighbors
+	auto seam_ratio											= [](const std::vector<uint8_t>& inVoxels, uint32_t inSize)
+	{
+		auto at												= [&](uint32_t inX, uint32_t inY, uint32_t inZ) { return static_cast<float>(inVoxels[(static_cast<size_t>(inZ) * inSize + inY) * inSize + inX]); };
+		double interior										= 0.0;
+		double seam											= 0.0;
+		for (uint32_t a = 0; a < inSize; a++)
+			for (uint32_t b = 0; b < inSize; b++)
+			{
+				seam										+= std::abs(at(inSize - 1, a, b) - at(0, a, b)) + std::abs(at(a, inSize - 1, b) - at(a, 0, b)) + std::abs(at(a, b, inSize - 1) - at(a, b, 0));
+				interior									+= std::abs(at(inSize / 2 - 1, a, b) - at(inSize / 2, a, b)) + std::abs(at(a, inSize / 2 - 1, b) - at(a, inSize / 2, b)) + std::abs(at(a, b, inSize / 2 - 1) - at(a, b, inSize / 2));
+			}
+		return static_cast<float>(seam / std::max(interior, 1.0));
+	};
+
+	std::vector<uint8_t> shape_voxels;
+	std::vector<uint8_t> erosion_voxels;
+	Stats shape_stats;
+	Stats erosion_stats;
+	sGenerate(shape_settings, shape_voxels, shape_stats);
+	sGenerate(erosion_settings, erosion_voxels, erosion_stats);
+	float shape_seam_ratio									= seam_ratio(shape_voxels, shape_settings.mSize);
+	float erosion_seam_ratio								= seam_ratio(erosion_voxels, erosion_settings.mSize);
+	bool seamless											= shape_seam_ratio < 1.25f && erosion_seam_ratio < 1.25f;
+
+	bool value_range										= true;
+	for (const Stats& stats : { shape_stats, erosion_stats })
+		value_range											&= stats.mMax - stats.mMin > 0.5f && stats.mMean > 0.1f && stats.mMean < 0.9f;
+
+	bool deterministic										= true;
+	{
+		std::vector<uint8_t> voxels;
+		Stats stats;
+		sGenerate(shape_settings, voxels, stats);
+		deterministic										&= voxels == shape_voxels;
+	}
+
+	bool seeded												= true;
+	{
+		Settings settings									= shape_settings;
+		settings.mSeed										= 1;
+		std::vector<uint8_t> voxels;
+		Stats stats;
+		sGenerate(settings, voxels, stats);
+		seeded												&= voxels != shape_voxels;
+	}
+
+	bool tiny_sizes											= true;
+	for (uint32_t size : { 1u, 2u, 3u })
+	{
+		Settings settings									= shape_settings;
+		settings.mSize										= size;
+		std::vector<uint8_t> voxels;
+		Stats stats;
+		sGenerate(settings, voxels, stats);
+		tiny_sizes											&= voxels.size() == static_cast<size_t>(size) * size * size;
+	}
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "periodic in all axes",							periodic },
+		{ "volume matches scalar reference",				matches_reference },
+		{ "wrap faces seamless",							seamless },
+		{ "value range",									value_range },
+		{ "deterministic",									deterministic },
+		{ "seed changes volume",							seeded },
+		{ "tiny sizes",										tiny_sizes },
+	};
+
+	outMessage												= std::format("[CloudNoise] Validate: shape {}^3 {:.2f} ms, range [{:.2f}, {:.2f}] mean {:.2f}, seam ratio {:.2f}; erosion {}^3 {:.2f} ms, range [{:.2f}, {:.2f}] mean {:.2f}, seam ratio {:.2f}\n",
+		shape_settings.mSize, shape_stats.mGenerateMS, shape_stats.mMin, shape_stats.mMax, shape_stats.mMean, shape_seam_ratio,
+		erosion_settings.mSize, erosion_stats.mGenerateMS, erosion_stats.mMin, erosion_stats.mMax, erosion_stats.mMean, erosion_seam_ratio);
+	return gReportValidateChecks(checks, outMessage);
+}
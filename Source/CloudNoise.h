@@ -0,0 +1,58 @@
+#pragma once
+
+// Standard library and glm only, so volumes can be generated, validated and benchmarked without a device
+#include "Thirdparty/glm.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Tileable noise volumes of cloud shape and erosion, as R8 voxels in x, y, z order
+// [Schneider15] Perlin-Worley shape: billowy Perlin FBM remapped with Worley FBM as lower bound. Erosion: Worley FBM only.
+// [Hillaire16] Physically Based Sky, Atmosphere and Cloud Rendering in Frostbite, https://github.com/sebh/TileableVolumeNoise
+// Lattice and cells wrap at integer frequencies, so the volume tiles at any size. Rows along x are split into runs of one lattice cell,
+// corner gradients are loop invariant within a run. Each feature point is tested over one span of three cells, so inner loops are
+// branchless over contiguous floats and vectorize.
+class CloudNoise
+{
+public:
+	enum class Type : uint8_t
+	{
+		PerlinWorley,
+		Worley,
+
+		Count
+	};
+
+	struct Settings
+	{
+		Type mType												= Type::PerlinWorley;
+		uint32_t mSize											= 128;		// Voxels per axis
+		uint32_t mPerlinFrequency								= 8;		// Lattice cells per tile at first octave
+		uint32_t mPerlinOctaves									= 3;
+		uint32_t mWorleyCellCount								= 8;		// Cells per tile at first octave
+		uint32_t mWorleyOctaves									= 3;
+		float mGain												= 0.5f;		// Amplitude ratio of octaves, frequency doubles
+		uint32_t mSeed											= 0;
+
+		bool operator==(const Settings& inOther) const = default;
+	};
+
+	struct Stats
+	{
+		uint64_t mVoxelCount									= 0;
+		float mMin												= 0.0f;
+		float mMax												= 0.0f;
+		float mMean												= 0.0f;
+		float mGenerateMS										= 0.0f;
+	};
+
+	// mSize^3 voxels in [0, 255]. Stats of this call overwrite outStats.
+	static void sGenerate(const Settings& inSettings, std::vector<uint8_t>& outVoxels, Stats& outStats);
+
+	// Scalar reference of one voxel, inPosition in tiles (period 1). Used to check sGenerate.
+	static float sSample(const Settings& inSettings, const glm::vec3& inPosition);
+
+	// Checks periodicity, match of sGenerate against sSample, seams of volume, value range, determinism and seed
+	static bool sValidate(std::string& outMessage);
+};
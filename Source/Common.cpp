@@ -45,6 +45,179 @@ uint32_t							gFrameIndex = 0;
 CPUContext							gCPUContext;
 Constants							gConstants = {};
 
+// Upload
+UploadHeap							gUploadHeap;
+CopyQueue							gCopyQueue;
+
+void UploadHeap::Initialize(std::string_view inName, uint64_t inBlockSize, uint32_t inRetainedBlockCount)
+{
+	mName = inName;
+	mArena.mBlockSize = inBlockSize;
+	mArena.mRetainedBlockCount = inRetainedBlockCount;
+	mArena.mCreateBlock = [this](uint32_t inBlockIndex, uint64_t inSize)
+	{
+		if (mBlocks.size() <= inBlockIndex)
+			mBlocks.resize(inBlockIndex + 1);
+
+		Block& block = mBlocks[inBlockIndex];
+		D3D12_RESOURCE_DESC desc = gGetBufferResourceDesc(inSize);
+		D3D12_HEAP_PROPERTIES props = gGetUploadHeapProperties();
+		gValidate(gDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&block.mResource)));
+		gSetName(block.mResource, mName, ".Block", gToString(inBlockIndex));
+
+		// Persistent map - https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12resource-map#advanced-usage-models
+		block.mResource->Map(0, nullptr, reinterpret_cast<void**>(&block.mCPUAddress));
+	};
+
+	mArena.mReleaseBlock = [this](uint32_t inBlockIndex)
+	{
+		mBlocks[inBlockIndex] = {};
+	};
+}
+
+void UploadHeap::Finalize()
+{
+	mArena.Reset();
+	mBlocks = {};
+}
+
+UploadHeap::Allocation UploadHeap::Allocate(uint64_t inSize, uint64_t inAlignment)
+{
+	UploadArena::Allocation allocation = mArena.Allocate(inSize, inAlignment);
+	const Block& block = mBlocks[allocation.mBlockIndex];
+
+	return
+	{
+		.mResource = block.mResource.Get(),
+		.mOffset = allocation.mOffset,
+		.mSize = allocation.mSize,
+		.mCPUAddress = block.mCPUAddress + allocation.mOffset,
+		.mGPUAddress = block.mResource->GetGPUVirtualAddress() + allocation.mOffset,
+	};
+}
+
+UploadHeap::Allocation UploadHeap::Upload(const void* inData, uint64_t inSize, uint64_t inAlignment)
+{
+	Allocation allocation = Allocate(inSize, inAlignment);
+	memcpy(allocation.mCPUAddress, inData, inSize);
+	return allocation;
+}
+
+void CopyQueue::Initialize()
+{
+	D3D12_COMMAND_QUEUE_DESC desc = {};
+	desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	desc.NodeMask = 1;
+	gValidate(gDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(&mQueue)));
+	mQueue->SetName(L"CopyQueue");
+
+	gValidate(gDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+	mFence->SetName(L"CopyQueue.Fence");
+	mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	gValidate(gDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, AcquireSlot().mCommandAllocator.Get(), nullptr, IID_PPV_ARGS(&mCommandList)));
+	mCommandList->SetName(L"CopyQueue.CommandList");
+	mCommandList->Close();
+
+	// One block per batch, nothing retained as uploads happen on scene load only
+	mStaging.Initialize("CopyQueue.Staging", CopyPlan::kDefaultBatchSize, 0);
+}
+
+void CopyQueue::Finalize()
+{
+	WaitIdle();
+	mStaging.Finalize();
+
+	mCommandList = nullptr;
+	mSlots.clear();
+	mFence = nullptr;
+	mQueue = nullptr;
+	CloseHandle(mFenceEvent);
+	mFenceEvent = nullptr;
+}
+
+void CopyQueue::Wait(uint64_t inFenceValue)
+{
+	if (inFenceValue == 0 || mFence->GetCompletedValue() >= inFenceValue)
+		return;
+
+	mFence->SetEventOnCompletion(inFenceValue, mFenceEvent);
+	WaitForSingleObject(mFenceEvent, INFINITE);
+}
+
+CopyQueue::Slot& CopyQueue::AcquireSlot()
+{
+	uint64_t completed_value = mFence->GetCompletedValue();
+	for (Slot& slot : mSlots)
+		if (slot.mFenceValue <= completed_value)
+			return slot;
+
+	Slot& slot = mSlots.emplace_back();
+	gValidate(gDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&slot.mCommandAllocator)));
+	slot.mCommandAllocator->SetName((L"CopyQueue.CommandAllocator_" + std::to_wstring(mSlots.size() - 1)).c_str());
+	mStats.mSlotCount = static_cast<uint32_t>(mSlots.size());
+	return slot;
+}
+
+void CopyQueue::Upload(std::span<const Request> inRequests)
+{
+	PROFILE_SCOPE("CopyQueue::Upload");
+	CPU_TIMING_SCOPE_SIMPLE(&mStats.mSubmitMS);
+
+	std::vector<uint64_t> sizes;
+	for (const Request& request : inRequests)
+		sizes.push_back(request.mData != nullptr ? request.mSize : 0);
+
+	CopyPlan plan;
+	plan.Build(sizes);
+
+	for (const CopyPlan::Batch& batch : plan.mBatches)
+	{
+		// Staging and allocator of completed batches are reused, the ones of batches still copying are left alone
+		Slot& slot = AcquireSlot();
+		mStaging.Recycle(mFence->GetCompletedValue());
+
+		UploadHeap::Allocation staging = mStaging.Allocate(batch.mSize, CopyPlan::kDefaultAlignment);
+		slot.mCommandAllocator->Reset();
+		mCommandList->Reset(slot.mCommandAllocator.Get(), nullptr);
+
+		for (const CopyPlan::Copy& copy : batch.mCopies)
+		{
+			const Request& request = inRequests[copy.mBufferIndex];
+			memcpy(staging.mCPUAddress + copy.mSourceOffset, static_cast<const uint8_t*>(request.mData) + copy.mDestinationOffset, copy.mSize);
+			mCommandList->CopyBufferRegion(request.mDestination, copy.mDestinationOffset, staging.mResource, staging.mOffset + copy.mSourceOffset, copy.mSize);
+		}
+
+		mCommandList->Close();
+		mQueue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList* const*>(mCommandList.GetAddressOf()));
+		slot.mFenceValue = ++mFenceLastSignaledValue;
+		mQueue->Signal(mFence.Get(), slot.mFenceValue);
+		mStaging.Retire(slot.mFenceValue);
+	}
+
+	mStats.mBatchCount = static_cast<uint32_t>(plan.mBatches.size());
+	mStats.mBytes = plan.mTotalBytes;
+	mStats.mPaddingBytes = plan.mPaddingBytes;
+}
+
+void CopyQueue::QueueWait(ID3D12CommandQueue* inQueue)
+{
+	if (mFenceLastSignaledValue == 0)
+		return;
+
+	inQueue->Wait(mFence.Get(), mFenceLastSignaledValue);
+}
+
+void CopyQueue::ReleaseStaging()
+{
+	if (mFenceLastSignaledValue == 0 || mFence->GetCompletedValue() < mFenceLastSignaledValue || mStaging.GetStats().mBlockCount == 0)
+		return;
+
+	mStaging.Recycle(mFenceLastSignaledValue);
+	mStaging.Trim();
+}
+
 void Buffer::Initialize()
 {
 	uint byte_count = gAlignUp(mStride * mElementCount, static_cast<uint>(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT));
@@ -130,9 +303,15 @@ void Buffer::Initialize()
 		}
 	}
 
-	if (mUpload || mUploadOnce)
+	if (mUploadOnce)
+	{
+		mUploadOnceAllocation = gUploadHeap.Allocate(byte_count);
+		mUploadPointer[0] = mUploadOnceAllocation.mCPUAddress;
+	}
+
+	if (mUpload)
 	{
-		for (int i = 0; i < (mUploadOnce ? 1 : kFrameInFlightCount); i++)
+		for (int i = 0; i < kFrameInFlightCount; i++)
 		{
 			D3D12_RESOURCE_DESC upload_resource_desc = gGetBufferResourceDesc(byte_count);
 			D3D12_HEAP_PROPERTIES upload_props = gGetUploadHeapProperties();
@@ -168,12 +347,16 @@ void Buffer::UpdateGPU(ID3D12GraphicsCommandList4* inCommandList)
 
 	if (mUploadOnce)
 	{
-		gAssert(mUploadResource[0]);
+		gAssert(mUploadOnceAllocation.mResource != nullptr);
 
 		{
 			BarrierScope scope(inCommandList, mResource.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
-			inCommandList->CopyResource(mResource.Get(), mUploadResource[0].Get());
+			inCommandList->CopyBufferRegion(mResource.Get(), 0, mUploadOnceAllocation.mResource, mUploadOnceAllocation.mOffset, mUploadOnceAllocation.mSize);
 		}
+
+		// Arena recycles it once the copy is done
+		mUploadOnceAllocation = {};
+		mUploadPointer[0] = nullptr;
 	}
 
 	mLoaded = true;
@@ -306,6 +489,8 @@ void Texture::UpdateGPU(ID3D12GraphicsCommandList4* inCommandList)
 	// Load file
 	if (!mPath.empty())
 	{
+		PROFILE_SCOPE("Texture::Decode");
+
 		std::filesystem::path extension = mPath.extension();
 		if (extension == ".dds" || extension == ".tga")
 		{
@@ -320,9 +505,9 @@ void Texture::UpdateGPU(ID3D12GraphicsCommandList4* inCommandList)
 			// Upload
 			std::vector<D3D12_SUBRESOURCE_DATA> subresources;
 			PrepareUpload(gDevice, scratch_image.GetImages(), scratch_image.GetImageCount(), scratch_image.GetMetadata(), subresources);
-			InitializeUpload();
+			UploadHeap::Allocation upload = gUploadHeap.Allocate(GetSubresourceSize(), D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
 			BarrierScope expected_scope(inCommandList, mResource.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
-			UpdateSubresources(inCommandList, mResource.Get(), mUploadResource.Get(), 0, 0, mSubresourceCount, subresources.data());
+			UpdateSubresources(inCommandList, mResource.Get(), upload.mResource, upload.mOffset, 0, mSubresourceCount, subresources.data());
 		}
 		else if (extension == ".hdr")
 		{
@@ -376,9 +561,9 @@ void Texture::UpdateGPU(ID3D12GraphicsCommandList4* inCommandList)
 		subresource.pData = mUploadData.data();
 		subresource.RowPitch = mWidth * GetPixelSize();
 		subresource.SlicePitch = mWidth * mHeight * GetPixelSize();
-		InitializeUpload();
+		UploadHeap::Allocation upload = gUploadHeap.Allocate(GetSubresourceSize(), D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT); // Fresh memory per upload, previous one may still be read by frames in flight
 		BarrierScope expected_scope(inCommandList, mResource.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
-		UpdateSubresources(inCommandList, mResource.Get(), mUploadResource.Get(), 0, 0, mSubresourceCount, &subresource);
+		UpdateSubresources(inCommandList, mResource.Get(), upload.mResource, upload.mOffset, 0, mSubresourceCount, &subresource);
 
 		mUploadData.clear();
 	}
@@ -386,18 +571,6 @@ void Texture::UpdateGPU(ID3D12GraphicsCommandList4* inCommandList)
 	mLoaded = true;
 }
 
-void Texture::InitializeUpload()
-{
-	if (mUploadResource != nullptr)
-		return;
-	
-	UINT64 byte_count = GetSubresourceSize();
-	D3D12_RESOURCE_DESC desc = gGetBufferResourceDesc(byte_count);
-	D3D12_HEAP_PROPERTIES upload_properties = gGetUploadHeapProperties();
-	gValidate(gDevice->CreateCommittedResource(&upload_properties, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mUploadResource)));
-	gSetName(mUploadResource, "Texture.", mName, ".Upload");
-}
-
 namespace ImGui 
 {
 	float gDpiScale = 1.0f;
@@ -491,6 +664,24 @@ namespace ImGui
 	}
 }
 
+void gWriteTimingCSV(const std::filesystem::path& inPath)
+{
+	std::ofstream file(inPath);
+	TimingHistory::sWriteCSVHeader(file);
+	gStats.mGPUTimingHistory.WriteCSV(file, "gpu");
+	gStats.mCPUTimingHistory.WriteCSV(file, "cpu");
+
+	// Measured once, not per frame
+	TimingHistory once;
+	once.Add("Startup", gStats.mCPUTimingMS.mStartup);
+	once.Add("LoadScene", gStats.mCPUTimingMS.mLoadScene);
+	once.Add("CompileShaders", gStats.mCPUTimingMS.mCompileShaders);
+	once.Add("PrepareLights", gStats.mCPUTimingMS.mPrepareLights);
+	once.WriteCSV(file, "cpu_once");
+
+	gTrace(std::format("[TimingHistory] {} GPU and {} CPU series written to {}\n", gStats.mGPUTimingHistory.GetSeriesCount(), gStats.mCPUTimingHistory.GetSeriesCount(), inPath.string()));
+}
+
 void gDumpLuminance()
 {
 	gCPUContext.mDumpTextureProxy.mResource = gRenderer.mRuntime.mScreenColorTexture.mResource;
@@ -522,4 +713,33 @@ void gLoadCamera()
 		gCameraSettings.mHorizontalFovDegree = gScene.GetSceneContent().mFov.value();
 }
 
+void gApplyCameraAnimation(float inRatio)
+{
+	glm::mat4x4 matrix;
+	if (!gScene.SampleCameraAnimation(inRatio, matrix))
+		return;
+
+	// Camera looks down -Z, as glTF. Scale is ignored.
+	gConstants.CameraPosition()				= glm::vec4(glm::vec3(matrix[3]), 1);
+	gConstants.CameraLeft()					= glm::vec4(glm::normalize(glm::vec3(matrix[0])), 0);
+	gConstants.CameraUp()					= glm::vec4(glm::normalize(glm::vec3(matrix[1])), 0);
+	gConstants.CameraFront()				= glm::vec4(-glm::normalize(glm::vec3(matrix[2])), 0);
+}
+
+void gUpdateCameraMatrices()
+{
+	float horizontal_fov_radian				= gCameraSettings.mHorizontalFovDegree * glm::pi<float>() / 180.0f;
+	float horizontal_tan					= glm::tan(horizontal_fov_radian * 0.5f);
+	float vertical_tan						= horizontal_tan * (gConstants.mScreenHeight * 1.0f / gConstants.mScreenWidth);
+	float vertical_fov_radian				= glm::atan(vertical_tan) * 2.0f;
+
+	gConstants.mViewMatrix					= glm::lookAtRH(float3(gConstants.CameraPosition()), float3(gConstants.CameraPosition() + gConstants.CameraFront()), float3(gConstants.CameraUp()));
+	gConstants.mProjectionMatrix			= glm::perspectiveFovRH_ZO(vertical_fov_radian, (float)gConstants.mScreenWidth, (float)gConstants.mScreenHeight, 0.1f, 1000.0f);
+	gConstants.mViewProjectionMatrix		= gConstants.mProjectionMatrix * gConstants.mViewMatrix;
+
+	gConstants.mInverseViewMatrix			= glm::inverse(gConstants.mViewMatrix);
+	gConstants.mInverseProjectionMatrix		= glm::inverse(gConstants.mProjectionMatrix);
+	gConstants.mInverseViewProjectionMatrix = glm::inverse(gConstants.mViewProjectionMatrix);
+}
+
 std::chrono::steady_clock::time_point CPUTimingScope::sTimestampProcessBegin = std::chrono::steady_clock::now();
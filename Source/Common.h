@@ -23,9 +23,11 @@ using Microsoft::WRL::ComPtr;
 #include <span>
 #include <chrono>
 #include <set>
+#include <unordered_set>
 #include <ranges>
 #include <execution>
 #include <random>
+#include <numeric>
 
 #include "Thirdparty/glm.h"
 #include "Thirdparty/nameof/include/nameof.hpp"
@@ -39,6 +41,11 @@ using Microsoft::WRL::ComPtr;
 
 #include "../Shader/Shared.h"
 
+#include "Profiler.h"
+#include "TimingHistory.h"
+#include "UploadArena.h"
+#include "CopyPlan.h"
+
 // Common helpers
 #define gAssert assert
 #define gVerify(condition)				\
@@ -349,6 +356,7 @@ struct Stats
 		float								mReservoirTemporal = 0;
 		float								mReservoirSpatial = 0;
 		float								mRayQuery = 0;
+		float								mSpatialCache = 0;
 		float								mHitShader = 0;
 		float								mSlangShader = 0;
 		float								mComposite = 0;
@@ -359,10 +367,18 @@ struct Stats
 	struct CPUTimingMS
 	{
 		float								mStartup = 0;
+		float								mLoadScene = 0;
+		float								mCompileShaders = 0;
+		float								mPrepareLights = 0;
 	};
 	CPUTimingMS								mCPUTimingMS;
+
+	// Rolling history of above per frame, named as GPU_TIMING_SCOPE
+	TimingHistory							mGPUTimingHistory;
+	TimingHistory							mCPUTimingHistory;
 };
 extern Stats								gStats;
+void gWriteTimingCSV(const std::filesystem::path& inPath);
 
 struct Configs
 {
@@ -370,6 +386,11 @@ struct Configs
 
 	bool									mShaderDebug = true;
 	bool									mUseTexture = true;
+	bool									mQuantizeVertexAttributes = false;	// Scene and shaders, see Scene::QuantizeVertexAttributes
+	bool									mOptimizeMeshes = true;				// See Scene::OptimizeMeshes
+	uint									mLoadThreadCount = 0;				// Parallel scene conversion, 0 for std::execution::par, 1 for serial
+	bool									mAnimateInstances = true;			// See Scene::UpdateAnimation
+	bool									mCompactBLAS = true;				// See Scene::CompactBLASes
 
 	bool									mTestHitShader = false;
 
@@ -544,6 +565,99 @@ struct Shader
 	Data mData;
 };
 
+// Upload memory of load time copies, suballocated from a few persistently mapped blocks, see UploadArena
+// Copies reading an allocation must be recorded in the frame it is allocated, allocations are retired with the fence of that frame
+class UploadHeap
+{
+public:
+	struct Allocation
+	{
+		ID3D12Resource*						mResource = nullptr;
+		uint64_t							mOffset = 0;
+		uint64_t							mSize = 0;
+		uint8_t*							mCPUAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS			mGPUAddress = 0;
+	};
+
+	void Initialize(std::string_view inName, uint64_t inBlockSize = UploadArena::kDefaultBlockSize, uint32_t inRetainedBlockCount = UploadArena::kDefaultRetainedBlockCount);
+	void Finalize();
+
+	Allocation Allocate(uint64_t inSize, uint64_t inAlignment = D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
+	Allocation Upload(const void* inData, uint64_t inSize, uint64_t inAlignment = D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT);
+
+	void Retire(uint64_t inFenceValue)				{ mArena.Retire(inFenceValue); }
+	void Recycle(uint64_t inCompletedFenceValue)	{ mArena.Recycle(inCompletedFenceValue); }
+	void Trim()										{ mArena.Trim(); }
+	const UploadArena::Stats& GetStats() const		{ return mArena.GetStats(); }
+	void ResetPeaks()								{ mArena.ResetPeaks(); }
+
+private:
+	struct Block
+	{
+		ComPtr<ID3D12Resource>				mResource;
+		uint8_t*							mCPUAddress = nullptr;
+	};
+	std::string								mName;
+	std::vector<Block>						mBlocks;
+	UploadArena								mArena;
+};
+extern UploadHeap							gUploadHeap;
+
+// Uploads buffers on a copy queue, transfers overlap with CPU work following them, e.g. shader compilation
+// CPU never waits for the copy queue while staging, a batch reuses the slot and staging of a completed one or gets new ones
+// Staging is bounded by the batches of CopyPlan the copy queue lags behind, whole upload at worst, and released once all uploads are done
+class CopyQueue
+{
+public:
+	struct Request
+	{
+		ID3D12Resource*						mDestination = nullptr;		// In COMMON state, buffers are promoted and decay implicitly on copy queue
+		const void*							mData = nullptr;
+		uint64_t							mSize = 0;
+	};
+
+	struct Stats
+	{
+		uint32_t							mBatchCount = 0;
+		uint32_t							mSlotCount = 0;				// Batches in flight at once so far
+		uint64_t							mBytes = 0;
+		uint64_t							mPaddingBytes = 0;
+		float								mSubmitMS = 0;				// CPU time of staging and submit
+	};
+
+	void Initialize();
+	void Finalize();
+
+	void Upload(std::span<const Request> inRequests);					// Data is staged before return
+	void QueueWait(ID3D12CommandQueue* inQueue);						// GPU side wait for uploads so far, before their destinations are used
+	void ReleaseStaging();												// Once all uploads are done
+	void WaitIdle()									{ Wait(mFenceLastSignaledValue); }
+
+	const Stats& GetStats() const					{ return mStats; }
+	const UploadArena::Stats& GetStagingStats() const	{ return mStaging.GetStats(); }
+
+private:
+	struct Slot
+	{
+		ComPtr<ID3D12CommandAllocator>		mCommandAllocator;
+		uint64_t							mFenceValue = 0;
+	};
+
+	void Wait(uint64_t inFenceValue);
+
+	ComPtr<ID3D12CommandQueue>				mQueue;
+	ComPtr<ID3D12GraphicsCommandList>		mCommandList;
+	ComPtr<ID3D12Fence>						mFence;
+	HANDLE									mFenceEvent = nullptr;
+	uint64_t								mFenceLastSignaledValue = 0;
+	Slot& AcquireSlot();
+
+	std::vector<Slot>						mSlots;
+	UploadHeap								mStaging;
+	Stats									mStats;
+};
+extern CopyQueue							gCopyQueue;
+
 struct Texture;
 
 struct Buffer
@@ -580,6 +694,7 @@ struct Buffer
 	void*									mUploadPointer[kFrameInFlightCount] = { nullptr };
 	ComPtr<ID3D12Resource>					mReadbackResource[kFrameInFlightCount];
 	void*									mReadbackPointer[kFrameInFlightCount] = { nullptr };
+	UploadHeap::Allocation					mUploadOnceAllocation;
 
 	bool									mLoaded = false;
 };
@@ -613,10 +728,8 @@ struct Texture
 	uint64_t GetSubresourceSize() const;
 	void Initialize();
 	void UpdateGPU(ID3D12GraphicsCommandList4* inCommandList);
-	void InitializeUpload();
 
 	ComPtr<ID3D12Resource> mResource;
-	ComPtr<ID3D12Resource> mUploadResource;
 
 	int mSubresourceCount = 1; // TODO: Support multiple subresources
 	bool mLoaded = false;
@@ -966,17 +1079,19 @@ inline void gOpenSceneDirectoryInExplorer(const std::string_view inPath)
 
 void gDumpLuminance();
 void gLoadCamera();
+void gApplyCameraAnimation(float inRatio);
+void gUpdateCameraMatrices();
 
 struct CPUTimingScope
 {
 	CPUTimingScope()
 	{
-		mTimestampBegin = std::chrono::high_resolution_clock::now();
+		mTimestampBegin = std::chrono::steady_clock::now();
 	}
 
 	~CPUTimingScope()
 	{
-		auto timestamp_end = std::chrono::high_resolution_clock::now();
+		auto timestamp_end = std::chrono::steady_clock::now();
 		std::chrono::duration<float, std::milli> duration_ms = timestamp_end - mTimestampBegin;
 
 		if (mDurationMSPtr != nullptr)
@@ -986,6 +1101,8 @@ struct CPUTimingScope
 
 		if (!mTraceName.empty())
 		{
+			gProfiler.RecordScope(gProfiler.Intern(mTraceName), mTimestampBegin, timestamp_end);
+
 			std::string message = std::format("[CPUTimingScope] {} takes {:.2f} ms\n", mTraceName.data(), duration_ms.count());
 			gTrace(message);
 		}
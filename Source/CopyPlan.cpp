@@ -0,0 +1,112 @@
+#include "CopyPlan.h"
+
+#include "Validate.h"
+
+#include <algorithm>
+#include <format>
+#include <random>
+
+static uint64_t sAlignUp(uint64_t inValue, uint64_t inAlignment)
+{
+	return (inValue + inAlignment - 1) / inAlignment * inAlignment;
+}
+
+void CopyPlan::Build(std::span<const uint64_t> inBufferSizes, uint64_t inBatchSize, uint64_t inAlignment)
+{
+	uint64_t alignment										= std::max<uint64_t>(inAlignment, 1);
+	mBatches.clear();
+	mTotalBytes												= 0;
+	mPaddingBytes											= 0;
+	mBatchSize												= std::max(inBatchSize, alignment);
+
+	// Linear packing in given order, so buffers needed first can be placed first
+	uint64_t cursor											= mBatchSize;
+	for (uint32_t buffer_index = 0; buffer_index < inBufferSizes.size(); buffer_index++)
+	{
+		uint64_t remaining									= inBufferSizes[buffer_index];
+		uint64_t destination_offset							= 0;
+		mTotalBytes											+= remaining;
+
+		while (remaining > 0)
+		{
+			uint64_t source_offset							= sAlignUp(cursor, alignment);
+			if (source_offset >= mBatchSize)
+			{
+				mBatches.emplace_back();
+				cursor										= 0;
+				source_offset								= 0;
+			}
+
+			uint64_t size									= std::min(remaining, mBatchSize - source_offset);
+			Batch& batch									= mBatches.back();
+			batch.mCopies.push_back({ .mBufferIndex = buffer_index, .mSourceOffset = source_offset, .mDestinationOffset = destination_offset, .mSize = size });
+
+			mPaddingBytes									+= source_offset - cursor;
+			cursor											= source_offset + size;
+			batch.mSize										= cursor;
+			destination_offset								+= size;
+			remaining										-= size;
+		}
+	}
+}
+
+bool CopyPlan::sValidate(std::string& outMessage)
+{
+	constexpr uint64_t kBatchSize							= 4ull << 20;
+	constexpr uint32_t kBufferCount							= 500;
+
+	std::mt19937 random_engine(0);
+	std::uniform_int_distribution<uint32_t> kind_distribution(0, 15);
+	std::uniform_int_distribution<uint64_t> small_distribution(1, 1000);
+	std::uniform_int_distribution<uint64_t> medium_distribution(1000, 1ull << 20);
+	std::vector<uint64_t> sizes(kBufferCount);
+	for (uint64_t& size : sizes)
+	{
+		uint32_t kind										= kind_distribution(random_engine);
+		size												= kind == 0 ? 0 : kind == 1 ? kBatchSize * 7 / 2 : kind < 8 ? small_distribution(random_engine) : medium_distribution(random_engine);
+	}
+
+	CopyPlan plan;
+	plan.Build(sizes, kBatchSize, kDefaultAlignment);
+
+	bool covered											= true;
+	bool in_bounds											= true;
+	bool aligned											= true;
+	bool disjoint											= true;
+	bool batches_full										= true;
+	uint64_t staging_bytes									= 0;
+	std::vector<uint64_t> copied(kBufferCount, 0);			// Next expected destination offset
+	for (size_t batch_index = 0; batch_index < plan.mBatches.size(); batch_index++)
+	{
+		const Batch& batch									= plan.mBatches[batch_index];
+		in_bounds											&= batch.mSize <= kBatchSize && !batch.mCopies.empty();
+		batches_full										&= batch_index + 1 == plan.mBatches.size() || sAlignUp(batch.mSize, kDefaultAlignment) >= kBatchSize;
+		staging_bytes										+= batch.mSize;
+
+		uint64_t previous_end								= 0;
+		for (const Copy& copy : batch.mCopies)
+		{
+			aligned											&= copy.mSourceOffset % kDefaultAlignment == 0;
+			in_bounds										&= copy.mSourceOffset + copy.mSize <= batch.mSize && copy.mSize > 0;
+			disjoint										&= copy.mSourceOffset >= previous_end;
+			covered											&= copy.mDestinationOffset == copied[copy.mBufferIndex];
+			copied[copy.mBufferIndex]						+= copy.mSize;
+			previous_end									= copy.mSourceOffset + copy.mSize;
+		}
+	}
+	covered													&= copied == sizes;
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "every byte copied once in order",				covered },
+		{ "copies in batch bounds",							in_bounds },
+		{ "source offsets aligned",							aligned },
+		{ "copies disjoint in staging",						disjoint },
+		{ "batches filled before next",						batches_full },
+		{ "staging is data plus padding",					staging_bytes == plan.mTotalBytes + plan.mPaddingBytes },
+	};
+
+	outMessage												= std::format("[CopyPlan] Validate: {} buffers, {:.2f} MB in {} batches of {:.2f} MB, padding {} bytes\n",
+		kBufferCount, plan.mTotalBytes / 1048576.0, plan.mBatches.size(), kBatchSize / 1048576.0, plan.mPaddingBytes);
+	return gReportValidateChecks(checks, outMessage);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Standard library only, plans staged buffer uploads without a device
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Splits uploads of buffers into batches of bounded staging size
+// Each batch is one staging allocation and one command list, buffers larger than a batch are copied in chunks over several batches
+class CopyPlan
+{
+public:
+	static constexpr uint64_t kDefaultBatchSize				= 32ull << 20;
+	static constexpr uint64_t kDefaultAlignment				= 256;
+
+	struct Copy
+	{
+		uint32_t mBufferIndex								= 0;	// Into sizes given to Build
+		uint64_t mSourceOffset								= 0;	// In staging of batch
+		uint64_t mDestinationOffset							= 0;	// In buffer
+		uint64_t mSize										= 0;
+	};
+
+	struct Batch
+	{
+		uint64_t mSize										= 0;	// Staging bytes including alignment padding
+		std::vector<Copy> mCopies;
+	};
+
+	void Build(std::span<const uint64_t> inBufferSizes, uint64_t inBatchSize = kDefaultBatchSize, uint64_t inAlignment = kDefaultAlignment);
+
+	std::vector<Batch> mBatches;
+	uint64_t mTotalBytes									= 0;
+	uint64_t mPaddingBytes									= 0;
+	uint64_t mBatchSize										= 0;
+
+	// Plans random buffer sizes and checks every byte is copied once, within batch bounds and aligned
+	static bool sValidate(std::string& outMessage);
+};
@@ -7,6 +7,11 @@
 
 #include "Atmosphere.h"
 #include "Cloud.h"
+#include "SpatialCacheModel.h"
+#include "SequenceCapture.h"
+#include "Batch.h"
+#include "Benchmark.h"
+#include "Validate.h"
 
 #include "ImGui/imgui_impl_win32.h"
 #include "ImGui/imgui_impl_dx12.h"
@@ -16,7 +21,6 @@
 #include "Thirdparty/filewatch/FileWatch.hpp"
 #pragma warning(pop)
 
-#include "wincodec.h" // GUID_ContainerFormatPng
 
 extern "C" { __declspec(dllexport) extern const UINT			D3D12SDKVersion = 619; }
 extern "C" { __declspec(dllexport) extern const char8_t*		D3D12SDKPath = u8".\\D3D12\\"; }
@@ -36,6 +40,10 @@ static void sCleanupDeviceD3D();
 static void sWaitForGPU();
 static void sUpdate();
 static void sLoadScene(bool inLoadCamera);
+static void sReloadShader();
+static void sBeginBatchJob();
+static void sBeginBenchmarkPreset();
+static int sValidate();
 static void sRender();
 static int sStartup(WNDCLASSEX& wc, HWND& hwnd);
 static LRESULT WINAPI sWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -156,46 +164,24 @@ static void sUpdate()
 		bool apply_sequence_camera				= gConstants.mSequenceEnabled && (gRenderer.mSequenceFrameRecording >= 0 || gRenderer.mSequenceCameraEnabled);
 
 		// Camera Animation
-		const SceneContent::Camera& camera		= gScene.GetSceneContent().mCamera;
-		if (apply_sequence_camera && camera.mHasAnimation)
-		{
-			if (!camera.mAnimation.mTranslation.empty())
-			{
-				auto [from, to, fraction]		= gMakeLerpTuple(camera.mAnimation.mTranslation, gConstants.mSequenceFrameRatio);
-				gConstants.CameraPosition()		= glm::vec4(glm::lerp(from, to, fraction), 1);
-			}
-			if (!camera.mAnimation.mRotation.empty())
-			{
-				constexpr glm::vec3 cLeft		= glm::vec3(1.0f, 0.0f, 0.0f);
-				constexpr glm::vec3 cFront		= glm::vec3(0.0f, 0.0f, -1.0f);
-				constexpr glm::vec3 cUp			= glm::vec3(0.0f, 1.0f, 0.0f);
-
-				auto [from, to, fraction]		= gMakeLerpTuple(camera.mAnimation.mRotation, gConstants.mSequenceFrameRatio);
-				glm::quat rotation				= glm::slerp(glm::quat(from.w, from), glm::quat(to.w, to), fraction); // glm::quat is wxyz, gltf quat is xyzw
+		if (apply_sequence_camera)
+			gApplyCameraAnimation(gConstants.mSequenceFrameRatio);
 
-				gConstants.CameraLeft()			= glm::vec4(rotation * cLeft, 0);
-				gConstants.CameraUp()			= glm::vec4(rotation * cUp, 0);
-				gConstants.CameraFront()		= glm::vec4(rotation * cFront, 0);
-			}
-			// mAnimation.mScale is ignored
+		// Instance Animation, follows sequence when recording so frames are reproducible
+		if (gConfigs.mAnimateInstances && gScene.HasAnimatedInstances())
+		{
+			const Animation& animation			= gScene.GetSceneContent().mAnimation;
+			gScene.UpdateAnimation(apply_sequence_camera ? animation.GetTimeAt(gConstants.mSequenceFrameRatio) : gConstants.mTime);
+			gRenderer.mFrameResetRequested		= true;
 		}
 	}
 
 	// Setup matrices
-	{
-		float horizontal_fov_radian				= gCameraSettings.mHorizontalFovDegree * glm::pi<float>() / 180.0f;
-		float horizontal_tan					= glm::tan(horizontal_fov_radian * 0.5f);
-		float vertical_tan						= horizontal_tan * (gConstants.mScreenHeight * 1.0f / gConstants.mScreenWidth);
-		float vertical_fov_radian				= glm::atan(vertical_tan) * 2.0f;
-		
-		gConstants.mViewMatrix					= glm::lookAtRH(float3(gConstants.CameraPosition()), float3(gConstants.CameraPosition() + gConstants.CameraFront()), float3(gConstants.CameraUp()));
-		gConstants.mProjectionMatrix			= glm::perspectiveFovRH_ZO(vertical_fov_radian, (float)gConstants.mScreenWidth, (float)gConstants.mScreenHeight, 0.1f, 1000.0f);
-		gConstants.mViewProjectionMatrix		= gConstants.mProjectionMatrix * gConstants.mViewMatrix;
+	gUpdateCameraMatrices();
 
-		gConstants.mInverseViewMatrix			= glm::inverse(gConstants.mViewMatrix);
-		gConstants.mInverseProjectionMatrix		= glm::inverse(gConstants.mProjectionMatrix);
-		gConstants.mInverseViewProjectionMatrix = glm::inverse(gConstants.mViewProjectionMatrix);
-	}
+	// Spatial cache stream for SpatialCacheModel
+	if (gSpatialCacheModel.mRecording)
+		gSpatialCacheModel.Record(gScene.GetSceneContent(), gConstants, gSpatialCacheModel.mRecordSize.x, gSpatialCacheModel.mRecordSize.y);
 
 	gAtmosphere.Update();
 	gCloud.Update();
@@ -207,12 +193,64 @@ int WinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PSTR lpCmdLine
 	HWND hwnd = 0;
 	WNDCLASSEX wc = {};
 
-	if (lpCmdLine != nullptr && std::string_view(lpCmdLine).starts_with("-headless"))
+	std::string_view command_line = lpCmdLine != nullptr ? lpCmdLine : "";
+	if (command_line.starts_with("-headless"))
 		gHeadless = true;
 
+	// -validate, runs self checks that need no device. Exit code is the number of failures.
+	if (command_line.starts_with("-validate"))
+		return sValidate();
+
+	// -batch <jobs.json> [-cpu]
+	if (command_line.starts_with("-batch"))
+	{
+		if (!gBatch.LoadFromCommandLine(command_line))
+			return 1;
+
+		if (gBatch.GetBackend() == Batch::Backend::CPU)
+		{
+			gBatch.RunCPU();
+			gBatch.WriteReport();
+			return 0;
+		}
+
+		gHeadless = true;
+		if (!gBatch.NextJob())
+		{
+			gBatch.WriteReport(); // Every job has an error
+			return 1;
+		}
+
+		int preset_index = Batch::sFindPresetIndex(gBatch.GetJob().mPreset);
+		if (preset_index >= 0)
+		{
+			ScenePreset::sCurrentIndex = preset_index;
+			ScenePreset::sPreviousIndex = preset_index;
+		}
+	}
+
+	// -benchmark <suite.json> [-cpu] [-update-baseline] [-no-optimize-meshes] [-load-threads <count>]
+	if (command_line.starts_with("-benchmark"))
+	{
+		if (!gBenchmark.LoadFromCommandLine(command_line))
+			return 1;
+
+		if (gBenchmark.GetBackend() == Benchmark::Backend::CPU)
+		{
+			gBenchmark.RunCPU();
+			return gBenchmark.Finish();
+		}
+
+		gHeadless = true;
+		ScenePreset::sCurrentIndex = ScenePreset::sFindIndex(gBenchmark.GetPreset());
+		ScenePreset::sPreviousIndex = ScenePreset::sCurrentIndex;
+	}
+
+	gProfiler.SetThreadName("Main");
+
 	CPUTimingScope application_timing_scope;
 	application_timing_scope.mTraceName = "Application";
-	application_timing_scope.mFileName = gHeadless ? "stat.txt" : "";
+	application_timing_scope.mFileName = gHeadless && !gBatch.IsActive() && !gBenchmark.IsActive() ? "stat.txt" : "";
 
 	int error_code = sStartup(wc, hwnd);
 	if (error_code != 0) return error_code;
@@ -244,17 +282,58 @@ int WinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PSTR lpCmdLine
 			ImGui::NewFrame();
 		}
 
-		sUpdate();
-		sRender();
+		{
+			PROFILE_SCOPE("Frame");
+
+			float update_ms = 0.0f;
+			float render_ms = 0.0f;
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&update_ms);
+				sUpdate();
+			}
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&render_ms);
+				sRender();
+			}
+			gStats.mCPUTimingHistory.Add("Update", update_ms);
+			gStats.mCPUTimingHistory.Add("Render", render_ms); // Including wait on swap chain and frame fence
+		}
+
+		if (gBenchmark.IsActive())
+		{
+			gBenchmark.EndFrame();
+			if (gBenchmark.GetPhase() == Benchmark::Phase::Done)
+				break;
+		}
 
 		if (gHeadless && gHeadlessDone)
+		{
+			// Next batch job starts in sRender once the sequence is stopped
+			if (gBatch.IsActive())
+			{
+				gSequenceCapture.Flush();
+				gBatch.EndRender();
+				gHeadlessDone = false;
+				if (gBatch.NextJob())
+					continue;
+				gBatch.WriteReport();
+			}
 			break;
+		}
 	}
 
+	int exit_code = gBenchmark.IsActive() ? gBenchmark.Finish() : 0;
+
 	// Shutdown
 	{
 		sWaitForGPU();
 
+		gSequenceCapture.Finalize();
+		if (gHeadless && !gBatch.IsActive()) // Batch writes its trace and timings along with report
+		{
+			gProfiler.WriteChromeTrace(gEnsureDumpDirectoryExists() / "ProfilerTrace.json");
+			gWriteTimingCSV(gEnsureDumpDirectoryExists() / "Timing.csv");
+		}
 		gAtmosphere.Finalize();
 		gCloud.Finalize();
 
@@ -270,6 +349,9 @@ int WinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PSTR lpCmdLine
 
 		gRenderer.Finalize();
 
+		gUploadHeap.Finalize();
+		gCopyQueue.Finalize();
+
 		sCleanupDeviceD3D();
 
 		if (!gHeadless)
@@ -279,7 +361,7 @@ int WinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, PSTR lpCmdLine
 		}
 	}
 
-	return 0;
+	return exit_code;
 }
 
 int sStartup(WNDCLASSEX& wc, HWND& hwnd)
@@ -365,6 +447,10 @@ int sStartup(WNDCLASSEX& wc, HWND& hwnd)
 		ImGui_ImplDX12_CreateDeviceObjects();
 	}
 
+	// Upload
+	gUploadHeap.Initialize("UploadHeap");
+	gCopyQueue.Initialize();
+
 	// Renderer
 	gRenderer.Initialize();
 
@@ -392,6 +478,7 @@ int sStartup(WNDCLASSEX& wc, HWND& hwnd)
 		});
 
 	gCommandList->Close();
+	gCopyQueue.QueueWait(gCommandQueue);
 	gCommandQueue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList* const*>(&gCommandList));
 	UINT64 signal_value = ++gFenceLastSignaledValue;
 	gCommandQueue->Signal(gIncrementalFence, signal_value); // abuse fence to wait only during initialization
@@ -405,7 +492,7 @@ int sStartup(WNDCLASSEX& wc, HWND& hwnd)
 		::UpdateWindow(hwnd);
 	}
 
-	if (gHeadless)
+	if (gHeadless && !gBatch.IsActive() && !gBenchmark.IsActive()) // Batch starts sequence per job, see sBeginBatchJob. Benchmark captures nothing.
 	{
 		// Start Sequence
 		gConstants.mSequenceEnabled = 1;
@@ -422,8 +509,10 @@ void sLoadScene(bool inLoadCamera)
 {
 	CPUTimingScope timing_scope;
 	timing_scope.mTraceName = "sLoadScene";
+	timing_scope.mDurationMSPtr = &gStats.mCPUTimingMS.mLoadScene;
 
 	sWaitForGPU();
+	gCopyQueue.WaitIdle(); // Uploads of previous scene, in case no frame was submitted since
 
 	auto& preset = ScenePreset::sCurrent();
 
@@ -439,7 +528,17 @@ void sLoadScene(bool inLoadCamera)
 		gAtmosphere.mProfile.mMode = gScene.GetSceneContent().mAtmosphereMode.value();
 	gAtmosphere.mProfile.mConstantColor = preset.mConstantColor;
 
-	gRenderer.mReloadShader = true;
+	// Adaptive cell sizes of spatial cache span from details to large features of the scene
+	const SceneContent& scene_content = gScene.GetSceneContent();
+	float scene_diagonal = gMax(glm::length(scene_content.mBoundsMax - scene_content.mBoundsMin), 1.0e-3f);
+	gConstants.mSpatialCache.mCellSizeMin = scene_diagonal / 4096.0f;
+	gConstants.mSpatialCache.mCellSizeMax = scene_diagonal / 64.0f;
+
+	// Scene changes USE_BSDF_* permutations and atmosphere mode (baked unless dynamic mode switch) through generated header
+	if (gRenderer.mCompiler.SharedHeader() != gRenderer.mCompiler.mCompiledSharedHeader)
+		gRenderer.mReloadShader = true;
+	gAtmosphere.mRuntime.mBruneton17.mRecomputeRequested = true;
+	gCloud.mRecomputeRequested = true;
 	gRenderer.mFrameResetRequested = true;
 	gRenderer.mSpatialCacheResetRequested = true;
 
@@ -447,6 +546,130 @@ void sLoadScene(bool inLoadCamera)
 		gLoadCamera();
 }
 
+void sReloadShader()
+{
+	CPUTimingScope timing_scope;
+	timing_scope.mDurationMSPtr = &gStats.mCPUTimingMS.mCompileShaders;
+
+	gRenderer.mReloadShader = false;
+
+	sWaitForGPU();
+
+	gRenderer.FinalizeShaders();
+	gRenderer.InitializeShaders();
+
+	gRenderer.mFrameResetRequested = true;
+
+	gAtmosphere.mRuntime.mBruneton17.mRecomputeRequested = true;
+	gCloud.mRecomputeRequested = true;
+}
+
+// Called after command list is reset, as sLoadScene records uploads of the scene
+void sBeginBatchJob()
+{
+	const Batch::Job& job = gBatch.GetJob();
+	Batch::Report& report = gBatch.GetReport();
+
+	int preset_index = Batch::sFindPresetIndex(job.mPreset);
+	if (preset_index < 0)
+		preset_index = ScenePreset::sCurrentIndex; // Not expected, Batch::NextJob skips jobs with errors
+
+	// Scene of first job is loaded by sStartup
+	bool first_job = gBatch.GetJobIndex() == 0;
+	bool scene_loaded = preset_index == ScenePreset::sCurrentIndex;
+	report.mSceneReused = scene_loaded && !first_job;
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&report.mLoadMS);
+
+		if (gRenderer.mScreenSize != job.mResolution)
+		{
+			sWaitForGPU();
+			gRenderer.mScreenSize = job.mResolution;
+			gRenderer.InitializeScreenSizeTextures();
+		}
+
+		if (scene_loaded)
+			gLoadCamera();
+		else
+		{
+			ScenePreset::sCurrentIndex = preset_index;
+			ScenePreset::sPreviousIndex = preset_index;
+			sLoadScene(true);
+		}
+	}
+	if (first_job && scene_loaded)
+		report.mLoadMS += gStats.mCPUTimingMS.mLoadScene;
+
+	gScene.OverrideCameraAnimation(job.mCameraAnimationPath); // Played by sUpdate over the sequence
+
+	if (job.mCameraPosition.has_value())
+		gConstants.CameraPosition() = float4(job.mCameraPosition.value(), 1.0f);
+	if (job.mCameraDirection.has_value())
+	{
+		gConstants.CameraFront() = float4(glm::normalize(job.mCameraDirection.value()), 0.0f);
+		gConstants.CameraUp() = float4(0, 1, 0, 0);
+		gConstants.CameraLeft() = float4(glm::cross(float3(gConstants.CameraUp()), float3(gConstants.CameraFront())), 0.0f);
+	}
+	if (job.mHorizontalFovDegree.has_value())
+		gCameraSettings.mHorizontalFovDegree = job.mHorizontalFovDegree.value();
+
+	report.mShadersReused = !gRenderer.mReloadShader;
+	if (gRenderer.mReloadShader)
+	{
+		sReloadShader();
+		report.mCompileMS = gStats.mCPUTimingMS.mCompileShaders;
+	}
+
+	// Sequence
+	std::filesystem::create_directories(job.mOutputDirectory);
+	gRenderer.mSequenceDirectory = job.mOutputDirectory;
+	gRenderer.mSequenceEXR = job.mEXR;
+	gRenderer.mFrameUnlimited = false;
+	gRenderer.mFrameCount = static_cast<int>(job.mSampleCount);
+	gRenderer.mFrameResetRequested = true;
+
+	gConstants.mSequenceFrameCount = static_cast<int>(job.mFrameCount);
+	gConstants.mSequenceEnabled = 1;
+	gConstants.mCurrentFrameIndex = 0;
+	gConstants.mSequenceFrameIndex = 0;
+	gRenderer.mSequenceFrameRecording = 0;
+
+	gBatch.BeginRender();
+}
+
+// Called after command list is reset, as sLoadScene records uploads of the scene
+void sBeginBenchmarkPreset()
+{
+	const Benchmark::Settings& settings = gBenchmark.GetSettings();
+	Benchmark::Metrics& metrics = gBenchmark.GetMetrics();
+
+	if (gRenderer.mScreenSize != settings.mResolution)
+	{
+		sWaitForGPU();
+		gRenderer.mScreenSize = settings.mResolution;
+		gRenderer.InitializeScreenSizeTextures();
+	}
+
+	// Always reload, so first preset is measured with warm file cache as others
+	ScenePreset::sCurrentIndex = ScenePreset::sFindIndex(gBenchmark.GetPreset());
+	ScenePreset::sPreviousIndex = ScenePreset::sCurrentIndex;
+	sLoadScene(true);
+	metrics["load.total_ms"] = gStats.mCPUTimingMS.mLoadScene;
+
+	if (settings.mCompileShaders || gRenderer.mReloadShader)
+	{
+		sReloadShader();
+		if (settings.mCompileShaders)
+			metrics["compile_ms"] = gStats.mCPUTimingMS.mCompileShaders;
+	}
+
+	// Keep all passes running, accumulation would otherwise stop
+	gRenderer.mFrameUnlimited = true;
+	gRenderer.mFrameResetRequested = true;
+
+	gBenchmark.BeginWarmup();
+}
+
 void sRender()
 {
 	HANDLE wait_objects[]						= { nullptr, nullptr };
@@ -465,6 +688,9 @@ void sRender()
 	}
 	WaitForMultipleObjects(wait_object_count, wait_objects, TRUE, INFINITE);
 
+	gUploadHeap.Recycle(gIncrementalFence->GetCompletedValue());
+	gCopyQueue.ReleaseStaging();
+
 	// Frame Context
 	uint32_t back_buffer_index					= 0;
 	ID3D12Resource* back_buffer					= nullptr;
@@ -482,6 +708,14 @@ void sRender()
 		command_list->Reset(frame_context.mCommandAllocator.Get(), nullptr);
 	}
 
+	// Batch Job
+	if (gBatch.IsActive() && gRenderer.mSequenceFrameRecording < 0)
+		sBeginBatchJob();
+
+	// Benchmark
+	if (gBenchmark.IsActive() && gBenchmark.GetPhase() == Benchmark::Phase::Load)
+		sBeginBenchmarkPreset();
+
 	// Reload Scene
 	{
 		if (ScenePreset::sPreviousIndex != ScenePreset::sCurrentIndex)
@@ -498,18 +732,13 @@ void sRender()
 
 	// Reload Shader
 	if (gRenderer.mReloadShader)
-	{
-		gRenderer.mReloadShader = false;
+		sReloadShader();
 
+	// Resize Cloud Volumes
+	if (gCloud.mResizeRequested)
+	{
 		sWaitForGPU();
-
-		gRenderer.FinalizeShaders();
-		gRenderer.InitializeShaders();
-
-		gRenderer.mFrameResetRequested = true;
-
-		gAtmosphere.mRuntime.mBruneton17.mRecomputeRequested = true;
-		gCloud.mRecomputeRequested = true;
+		gCloud.Resize();
 	}
 
 	// Update and Upload Constants
@@ -585,6 +814,10 @@ void sRender()
 		gBarrierTransition(gCommandList, gRenderer.mRuntime.mConstantsBuffer.mResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 	}
 
+	// Acceleration structures and animation, before anything traces against instances
+	gScene.CompactBLASes(command_list);
+	gScene.UpdateAnimationGPU(command_list);
+
 	// Renderer
 	{
 		GPU_TIMING_SCOPE("Renderer", command_list, &gStats.mGPUTimingMS.mRenderer);
@@ -730,6 +963,18 @@ void sRender()
 		gBarrierUAV(command_list, nullptr);
 	}
 
+	// SpatialCache
+	// [NOTE] Sweeps whole table, only needed for eviction, radiance cache resolve and occupancy of telemetry
+	if (gConstants.mSpatialCache.mMaxAge != 0 || gConstants.mSpatialCache.mRadianceCacheActive != 0 || gRenderer.mSpatialCacheTelemetryVisible)
+	{
+		GPU_TIMING_SCOPE("SpatialCache", command_list, &gStats.mGPUTimingMS.mSpatialCache);
+
+		gRenderer.Setup(gRenderer.mRuntime.mSpatialCacheUpdateShader);
+		command_list->Dispatch(gAlignUpDiv(kSpatialHashSize, 64u), 1, 1);
+
+		gBarrierUAV(command_list, nullptr);
+	}
+
 	// Test Hit Shader
 	if (gConfigs.mTestHitShader)
 	{
@@ -824,8 +1069,19 @@ void sRender()
 	{
 		PIXScopedEvent(gCommandList, PIX_COLOR(0, 255, 0), "Readback SceneColor with postprocess for Sequence");
 
-		gRenderer.Setup(gRenderer.mRuntime.mReadbackShader);
-		gCommandList->Dispatch(gAlignUpDiv(gRenderer.mScreenSize.x, 8u), gAlignUpDiv(gRenderer.mScreenSize.y, 8u), 1);
+		const Texture* texture = &gRenderer.mRuntime.mScreenColorTexture; // EXR, without postprocess
+		if (!gRenderer.mSequenceEXR)
+		{
+			gRenderer.Setup(gRenderer.mRuntime.mReadbackShader);
+			gCommandList->Dispatch(gAlignUpDiv(gRenderer.mScreenSize.x, 8u), gAlignUpDiv(gRenderer.mScreenSize.y, 8u), 1);
+			gBarrierUAV(gCommandList, nullptr);
+
+			texture = &gRenderer.mRuntime.mScreenReadbackTexture;
+		}
+
+		// [NOTE] Copy is encoded once the fence signaled in Finish Frame below completes, see SequenceCapture::Poll
+		std::filesystem::path path = gRenderer.mSequenceDirectory / std::format("{:03}.{}", gRenderer.mSequenceFrameRecording, gRenderer.mSequenceEXR ? "exr" : "png");
+		gSequenceCapture.Capture(gCommandList, *texture, path, gFenceLastSignaledValue + 1);
 	}
 
 	// Readback
@@ -859,6 +1115,7 @@ void sRender()
 
 		gGPUTiming.FrameEnd(command_list, gRenderer.mRuntime.mQueryBuffer.mReadbackResource[gGetFrameContextIndex()].Get());
 		gCommandList->Close();
+		gCopyQueue.QueueWait(gCommandQueue); // Scene loaded in this frame
 		gCommandQueue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList* const*>(&gCommandList));
 	}
 
@@ -881,17 +1138,10 @@ void sRender()
 		}
 	}
 
-	// Dump Texture for Sequence
+	// Advance Sequence
 	// [NOTE] Don't use global state here, those are updated by UI above. Otherwise readback is not done for current frame due to execution order
 	if (sequence_recording || sequence_dump_png)
 	{
-		DirectX::ScratchImage image;
-		DirectX::CaptureTexture(gCommandQueue, gRenderer.mRuntime.mScreenReadbackTexture.mResource.Get(), false, image, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COMMON);
-
-		wchar_t filename[256];
-		swprintf_s(filename, L"%03u.png", gRenderer.mSequenceFrameRecording);
-		DirectX::SaveToWICFile(image.GetImages(), image.GetImageCount(), DirectX::WIC_FLAGS_NONE, GUID_ContainerFormatPng, filename);
-
 		if (sequence_recording)
 		{
 			gConstants.mSequenceFrameIndex++;
@@ -925,6 +1175,9 @@ void sRender()
 		UINT64 signal_value = ++gFenceLastSignaledValue;
 		gCommandQueue->Signal(gIncrementalFence, signal_value);
 		frame_context.mFenceValue = signal_value;
+		gUploadHeap.Retire(signal_value);
+
+		gSequenceCapture.Poll();
 
 		if (!gRenderer.mFramePaused)
 			gConstants.mCurrentFrameIndex++;
@@ -948,6 +1201,23 @@ static void sMessageCallback(D3D12_MESSAGE_CATEGORY inCategory, D3D12_MESSAGE_SE
 		gAssert(false);
 }
 
+// Same checks as Validate buttons of GUI, results are written to validate.txt
+static int sValidate()
+{
+	std::span<const ValidateEntry> portable_entries = gPortableValidateEntries();
+	std::vector<ValidateEntry> entries(portable_entries.begin(), portable_entries.end());
+	entries.push_back({ "SpatialCache", &SpatialCacheModel::sValidate });
+	entries.push_back({ "VertexQuantization", &Scene::sValidateVertexQuantization });
+
+	std::string report;
+	int failure_count = gRunValidateEntries(entries, report);
+
+	gTrace(report);
+	std::ofstream file("validate.txt");
+	file << report;
+	return failure_count;
+}
+
 // Helper functions
 static bool sCreateDeviceD3D(HWND hWnd)
 {
@@ -0,0 +1,335 @@
+#include "FrameEncoder.h"
+
+#include "Profiler.h"
+#include "Validate.h"
+
+#include "Thirdparty/glm.h"
+#include "Thirdparty/glm/glm/gtc/packing.hpp"
+#include "Thirdparty/tinygltf/stb_image.h"
+#include "Thirdparty/tinygltf/stb_image_write.h"
+#include "Thirdparty/tinyexr.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <random>
+
+static float sElapsedMS(std::chrono::steady_clock::time_point inBegin)
+{
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - inBegin).count();
+}
+
+uint32_t FrameEncoder::sBytesPerPixel(Format inFormat)
+{
+	switch (inFormat)
+	{
+	case Format::RGBA8:		return 4;
+	case Format::RGBA16F:	return 8;
+	case Format::RGBA32F:	return 16;
+	default:				return 0;
+	}
+}
+
+const char* FrameEncoder::sGetName(Format inFormat)
+{
+	switch (inFormat)
+	{
+	case Format::RGBA8:		return "RGBA8";
+	case Format::RGBA16F:	return "RGBA16F";
+	case Format::RGBA32F:	return "RGBA32F";
+	default:				return "Unknown";
+	}
+}
+
+void FrameEncoder::Initialize(uint32_t inThreadCount, uint32_t inQueueCapacity)
+{
+	Finalize();
+
+	mQueueCapacity											= std::max(inQueueCapacity, 1u);
+	mStopping												= false;
+	mStats													= {};
+	for (uint32_t i = 0; i < std::max(inThreadCount, 1u); i++)
+		mThreads.emplace_back(&FrameEncoder::WorkerLoop, this);
+}
+
+void FrameEncoder::Finalize()
+{
+	{
+		std::lock_guard lock(mMutex);
+		mStopping											= true;
+	}
+	mWorkAvailable.notify_all();
+
+	for (std::thread& thread : mThreads)
+		thread.join();
+	mThreads.clear();
+}
+
+void FrameEncoder::Submit(Frame&& ioFrame)
+{
+	if (mThreads.empty())
+		Initialize(sDefaultThreadCount(), 16);
+
+	float blocked_ms										= 0.0f;
+	{
+		std::unique_lock lock(mMutex);
+		if (mQueue.size() >= mQueueCapacity)
+		{
+			auto begin										= std::chrono::steady_clock::now();
+			mWorkDone.wait(lock, [&]() { return mQueue.size() < mQueueCapacity; });
+			blocked_ms										= sElapsedMS(begin);
+		}
+
+		mQueue.push_back(std::move(ioFrame));
+		mStats.mSubmittedCount++;
+		mStats.mSubmitBlockedMS								+= blocked_ms;
+		mStats.mQueueDepthMax								= std::max(mStats.mQueueDepthMax, static_cast<uint32_t>(mQueue.size()));
+		PROFILE_COUNTER("FrameEncoder::QueueDepth", mQueue.size());
+	}
+	mWorkAvailable.notify_one();
+}
+
+void FrameEncoder::Flush()
+{
+	std::unique_lock lock(mMutex);
+	mWorkDone.wait(lock, [&]() { return mQueue.empty() && mBusyCount == 0; });
+}
+
+FrameEncoder::Stats FrameEncoder::GetStats() const
+{
+	std::lock_guard lock(mMutex);
+	Stats stats												= mStats;
+	stats.mQueueDepth										= static_cast<uint32_t>(mQueue.size());
+	return stats;
+}
+
+void FrameEncoder::WorkerLoop()
+{
+	gProfiler.SetThreadName("FrameEncoder");
+
+	while (true)
+	{
+		Frame frame;
+		{
+			std::unique_lock lock(mMutex);
+			mWorkAvailable.wait(lock, [&]() { return mStopping || !mQueue.empty(); });
+			if (mQueue.empty())
+				return; // Stopping, remaining frames are encoded before exit
+
+			frame											= std::move(mQueue.front());
+			mQueue.pop_front();
+			mBusyCount++;
+		}
+		mWorkDone.notify_all(); // Queue entry freed
+
+		auto begin											= std::chrono::steady_clock::now();
+		std::string error;
+		bool succeeded										= false;
+		{
+			PROFILE_SCOPE("FrameEncoder::Encode");
+			succeeded										= sEncode(frame, error);
+		}
+		float encode_ms										= sElapsedMS(begin);
+
+		{
+			std::lock_guard lock(mMutex);
+			mBusyCount--;
+			mStats.mEncodedCount							+= succeeded ? 1 : 0;
+			mStats.mFailedCount								+= succeeded ? 0 : 1;
+			mStats.mEncodeMS								+= encode_ms;
+			if (!succeeded)
+				mStats.mLastError							= std::move(error);
+		}
+		mWorkDone.notify_all();
+	}
+}
+
+bool FrameEncoder::sEncode(const Frame& inFrame, std::string& outError)
+{
+	std::string path										= inFrame.mPath.string();
+	int width												= static_cast<int>(inFrame.mWidth);
+	int height												= static_cast<int>(inFrame.mHeight);
+	if (inFrame.mPixels.size() != static_cast<size_t>(inFrame.mWidth) * inFrame.mHeight * sBytesPerPixel(inFrame.mFormat))
+	{
+		outError											= std::format("{} pixel bytes do not match {}x{} {} of {}", inFrame.mPixels.size(), width, height, sGetName(inFrame.mFormat), path);
+		return false;
+	}
+
+	switch (inFrame.mFormat)
+	{
+	case Format::RGBA8:
+	{
+		// [NOTE] stb_image_write instead of WIC, which needs COM initialized on every worker
+		if (stbi_write_png(path.c_str(), width, height, 4, inFrame.mPixels.data(), width * 4) == 0)
+		{
+			outError										= std::format("Failed to save {}", path);
+			return false;
+		}
+		return true;
+	}
+	case Format::RGBA16F:
+	case Format::RGBA32F:
+	{
+		std::vector<float> converted;
+		const float* data									= reinterpret_cast<const float*>(inFrame.mPixels.data());
+		if (inFrame.mFormat == Format::RGBA16F)
+		{
+			const uint16_t* halfs							= reinterpret_cast<const uint16_t*>(inFrame.mPixels.data());
+			converted.resize(inFrame.mPixels.size() / sizeof(uint16_t));
+			for (size_t i = 0; i < converted.size(); i++)
+				converted[i]								= glm::unpackHalf1x16(halfs[i]);
+			data											= converted.data();
+		}
+
+		const char* error									= nullptr;
+		if (SaveEXR(data, width, height, 4, 1 /* save_as_fp16 */, path.c_str(), &error) != TINYEXR_SUCCESS)
+		{
+			outError										= std::format("Failed to save {}: {}", path, error != nullptr ? error : "");
+			FreeEXRErrorMessage(error);
+			return false;
+		}
+		return true;
+	}
+	default:
+		outError											= std::format("Unsupported format {} for {}", static_cast<uint32_t>(inFrame.mFormat), path);
+		return false;
+	}
+}
+
+// Gradient with a moving band and noise so PNG compression does not degenerate
+static void sGenerate(uint32_t inFrameIndex, float inNoise, std::mt19937& ioRandomEngine, FrameEncoder::Frame& ioFrame)
+{
+	std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+	uint32_t pixel_size										= FrameEncoder::sBytesPerPixel(ioFrame.mFormat);
+	ioFrame.mPixels.resize(static_cast<size_t>(ioFrame.mWidth) * ioFrame.mHeight * pixel_size);
+	for (uint32_t y = 0; y < ioFrame.mHeight; y++)
+		for (uint32_t x = 0; x < ioFrame.mWidth; x++)
+		{
+			float band										= ((x + inFrameIndex * 8) % ioFrame.mWidth) < ioFrame.mWidth / 8 ? 1.0f : 0.0f;
+			glm::vec4 color									= glm::vec4(x * 1.0f / ioFrame.mWidth, y * 1.0f / ioFrame.mHeight, band, 1.0f) * (1.0f - inNoise) + random01(ioRandomEngine) * inNoise;
+			uint8_t* pixel									= &ioFrame.mPixels[(static_cast<size_t>(y) * ioFrame.mWidth + x) * pixel_size];
+			switch (ioFrame.mFormat)
+			{
+			case FrameEncoder::Format::RGBA8:				for (int c = 0; c < 4; c++) pixel[c] = static_cast<uint8_t>(color[c] * 255.0f); break;
+			case FrameEncoder::Format::RGBA16F:				for (int c = 0; c < 4; c++) reinterpret_cast<uint16_t*>(pixel)[c] = static_cast<uint16_t>(glm::packHalf1x16(color[c])); break;
+			case FrameEncoder::Format::RGBA32F:				for (int c = 0; c < 4; c++) reinterpret_cast<float*>(pixel)[c] = color[c]; break;
+			default:										break;
+			}
+		}
+}
+
+FrameEncoder::BenchmarkResult FrameEncoder::sBenchmark(uint32_t inWidth, uint32_t inHeight, uint32_t inFrameCount, Format inFormat, uint32_t inThreadCount, const std::filesystem::path& inDirectory)
+{
+	std::filesystem::create_directories(inDirectory);
+
+	// Generated outside of timing
+	std::vector<Frame> frames(inFrameCount);
+	std::mt19937 random_engine(0);
+	for (uint32_t frame_index = 0; frame_index < inFrameCount; frame_index++)
+	{
+		Frame& frame										= frames[frame_index];
+		frame.mWidth										= inWidth;
+		frame.mHeight										= inHeight;
+		frame.mFormat										= inFormat;
+		frame.mPath											= inDirectory / std::format("{:03}.{}", frame_index, inFormat == Format::RGBA8 ? "png" : "exr");
+		sGenerate(frame_index, 0.1f, random_engine, frame);
+	}
+
+	FrameEncoder encoder;
+	encoder.Initialize(inThreadCount, 16);
+
+	BenchmarkResult result;
+	result.mFrameCount										= inFrameCount;
+	result.mThreadCount										= encoder.GetThreadCount();
+	auto begin												= std::chrono::steady_clock::now();
+	for (Frame& frame : frames)
+		encoder.Submit(std::move(frame));
+	encoder.Flush();
+	result.mTotalMS											= sElapsedMS(begin);
+	result.mStats											= encoder.GetStats();
+	result.mFramesPerSecond									= result.mTotalMS > 0.0f ? inFrameCount * 1000.0f / result.mTotalMS : 0.0f;
+	return result;
+}
+
+bool FrameEncoder::sValidate(std::string& outMessage)
+{
+	constexpr uint32_t kWidth								= 37;	// Odd sizes, rows are not padded
+	constexpr uint32_t kHeight								= 5;
+
+	std::filesystem::path directory							= std::filesystem::temp_directory_path() / "DXRPlaygroundValidate" / "FrameEncoder";
+	std::filesystem::create_directories(directory);
+
+	std::vector<Frame> frames;
+	std::mt19937 random_engine(0);
+	for (uint32_t format_index = 0; format_index < static_cast<uint32_t>(Format::Count); format_index++)
+	{
+		Frame& frame										= frames.emplace_back();
+		frame.mWidth										= kWidth;
+		frame.mHeight										= kHeight;
+		frame.mFormat										= static_cast<Format>(format_index);
+		frame.mPath											= directory / std::format("{}.{}", sGetName(frame.mFormat), frame.mFormat == Format::RGBA8 ? "png" : "exr");
+		sGenerate(format_index, 0.5f, random_engine, frame);
+	}
+	std::vector<Frame> expected_frames						= frames;
+
+	Frame unwritable										= frames[0];
+	unwritable.mPath										= directory / "Missing" / "Unwritable.png";
+	Frame mismatched										= frames[0];
+	mismatched.mPixels.pop_back();
+
+	// Queue smaller than frame count, so Submit also blocks
+	FrameEncoder encoder;
+	encoder.Initialize(2, 1);
+	for (Frame& frame : frames)
+		encoder.Submit(std::move(frame));
+	encoder.Submit(std::move(unwritable));
+	encoder.Submit(std::move(mismatched));
+	encoder.Flush();
+	Stats stats												= encoder.GetStats();
+
+	// PNG is lossless, EXR is saved as half
+	bool png_round_trip										= false;
+	bool exr_round_trip										= true;
+	for (const Frame& expected : expected_frames)
+	{
+		std::string path									= expected.mPath.string();
+		if (expected.mFormat == Format::RGBA8)
+		{
+			int width = 0, height = 0, channel_count = 0;
+			uint8_t* data									= stbi_load(path.c_str(), &width, &height, &channel_count, 4);
+			png_round_trip									= data != nullptr && width == static_cast<int>(kWidth) && height == static_cast<int>(kHeight) && std::equal(expected.mPixels.begin(), expected.mPixels.end(), data);
+			stbi_image_free(data);
+			continue;
+		}
+
+		float* data											= nullptr;
+		int width = 0, height = 0;
+		const char* error									= nullptr;
+		bool loaded											= LoadEXR(&data, &width, &height, path.c_str(), &error) == TINYEXR_SUCCESS && width == static_cast<int>(kWidth) && height == static_cast<int>(kHeight);
+		for (size_t i = 0; loaded && i < kWidth * kHeight * 4; i++)
+		{
+			float value										= expected.mFormat == Format::RGBA16F
+				? glm::unpackHalf1x16(reinterpret_cast<const uint16_t*>(expected.mPixels.data())[i])
+				: reinterpret_cast<const float*>(expected.mPixels.data())[i];
+			loaded											&= std::abs(data[i] - value) <= 1.0e-3f;
+		}
+		exr_round_trip										&= loaded;
+		FreeEXRErrorMessage(error);
+		free(data);
+	}
+	std::filesystem::remove_all(directory);
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "all frames encoded or failed",					stats.mSubmittedCount == 5 && stats.mEncodedCount + stats.mFailedCount == 5 },
+		{ "png round trip",									png_round_trip },
+		{ "exr round trip from half and float",				exr_round_trip },
+		{ "unwritable and mismatched frames failed",		stats.mEncodedCount == 3 && stats.mFailedCount == 2 && !stats.mLastError.empty() },
+		{ "queue bounded by capacity",						stats.mQueueDepthMax <= 1 },
+	};
+
+	outMessage												= std::format("[FrameEncoder] Validate: {} frames {}x{}, {} failed, submit blocked {:.2f} ms, last error \"{}\"\n",
+		stats.mSubmittedCount, kWidth, kHeight, stats.mFailedCount, stats.mSubmitBlockedMS, stats.mLastError);
+	return gReportValidateChecks(checks, outMessage);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Standard library, glm, stb_image_write and tinyexr only, so frames can be encoded, validated and benchmarked without a device
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Encodes frames to PNG / EXR on a pool of worker threads, independent of D3D12 so it can be fed synthetic frames
+class FrameEncoder
+{
+public:
+	enum class Format : uint8_t
+	{
+		RGBA8,		// PNG
+		RGBA16F,	// EXR
+		RGBA32F,	// EXR
+
+		Count
+	};
+
+	struct Frame
+	{
+		uint32_t mWidth											= 0;
+		uint32_t mHeight										= 0;
+		Format mFormat											= Format::RGBA8;
+		std::vector<uint8_t> mPixels;															// Tightly packed rows of sBytesPerPixel(mFormat)
+		std::filesystem::path mPath;
+	};
+
+	struct Stats
+	{
+		uint64_t mSubmittedCount								= 0;
+		uint64_t mEncodedCount									= 0;
+		uint64_t mFailedCount									= 0;
+		uint32_t mQueueDepth									= 0;
+		uint32_t mQueueDepthMax									= 0;
+		float mSubmitBlockedMS									= 0.0f;		// Producer waiting for a free queue entry
+		float mEncodeMS											= 0.0f;		// Summed over workers
+		std::string mLastError;
+	};
+
+	struct BenchmarkResult
+	{
+		uint32_t mFrameCount									= 0;
+		uint32_t mThreadCount									= 0;
+		float mTotalMS											= 0.0f;
+		float mFramesPerSecond									= 0.0f;
+		Stats mStats;
+	};
+
+	~FrameEncoder()												{ Finalize(); }
+
+	void Initialize(uint32_t inThreadCount, uint32_t inQueueCapacity);
+	void Finalize();											// Encode queued frames then join workers
+
+	void Submit(Frame&& ioFrame);								// Blocks while queue is full
+	void Flush();												// Wait until all submitted frames are encoded
+
+	Stats GetStats() const;
+	uint32_t GetThreadCount() const								{ return static_cast<uint32_t>(mThreads.size()); }
+
+	// Encode inFrameCount generated frames into inDirectory, measures throughput and queue depth without GPU
+	static BenchmarkResult sBenchmark(uint32_t inWidth, uint32_t inHeight, uint32_t inFrameCount, Format inFormat, uint32_t inThreadCount, const std::filesystem::path& inDirectory);
+
+	// Round trip of PNG and EXR frames through the worker pool, and failure of an unwritable path
+	static bool sValidate(std::string& outMessage);
+
+	static uint32_t sBytesPerPixel(Format inFormat);
+	static const char* sGetName(Format inFormat);
+	static uint32_t sDefaultThreadCount()						{ return std::max(std::thread::hardware_concurrency() / 2, 1u); }
+
+private:
+	void WorkerLoop();
+	static bool sEncode(const Frame& inFrame, std::string& outError);
+
+	std::vector<std::thread> mThreads;
+	std::deque<Frame> mQueue;
+	uint32_t mQueueCapacity										= 0;
+	uint32_t mBusyCount											= 0;
+	bool mStopping												= false;
+	Stats mStats;
+
+	mutable std::mutex mMutex;
+	std::condition_variable mWorkAvailable;
+	std::condition_variable mWorkDone;
+};
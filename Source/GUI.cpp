@@ -4,6 +4,10 @@
 #include "Scene.h"
 #include "Atmosphere.h"
 #include "Cloud.h"
+#include "ReSTIR.h"
+#include "SpatialCacheModel.h"
+#include "SequenceCapture.h"
+#include "RadianceCacheIntegrator.h"
 
 void gPrepareImGui()
 {
@@ -211,6 +215,13 @@ void gPrepareImGui()
 
 				if (SliderInt("Spatial Sample Count", reinterpret_cast<int*>(&gConstants.mReSTIR.mSampleCountSpatial), 0, 8))
 					gRenderer.mFrameResetRequested = true;
+
+				if (SliderFloat("Spatial Radius", &gConstants.mReSTIR.mSpatialRadius, 1.0f, 32.0f))
+					gRenderer.mFrameResetRequested = true;
+
+				// Initialize: 1 write, Temporal: 2 reads 1 write, Spatial: 1 + N reads 1 write, RayQuery: 1 read
+				uint access_count = 7 + gConstants.mReSTIR.mSampleCountSpatial;
+				Text("Reservoir %u bytes, up to %u bytes/pixel/frame", kReservoirPackedSizeInBytes, access_count * kReservoirPackedSizeInBytes);
 			}
 		}
 
@@ -318,6 +329,7 @@ void gPrepareImGui()
 		//	gCloud.ImGuiShowMenus();
 		//}
 
+		gRenderer.mSpatialCacheTelemetryVisible = false;
 		if (CollapsingHeader("Spatial Cache"))
 		{
 			Checkbox("Active", (bool*)&gConstants.mSpatialCache.mFrameActive);
@@ -330,6 +342,120 @@ void gPrepareImGui()
 
 			if (Button("Reset"))
 				gRenderer.mSpatialCacheResetRequested = true;
+
+			SliderInt("Max Age", (int*)&gConstants.mSpatialCache.mMaxAge, 0, 256, gConstants.mSpatialCache.mMaxAge == 0 ? "Never Evict" : "%d");
+
+			for (int i = 0; i < static_cast<int>(SpatialCacheCellSizeMode::Count); i++)
+			{
+				const auto& name = nameof::nameof_enum(static_cast<SpatialCacheCellSizeMode>(i));
+				RadioButton(name.data(), reinterpret_cast<int*>(&gConstants.mSpatialCache.mCellSizeMode), i);
+				if (i != static_cast<int>(SpatialCacheCellSizeMode::Count) - 1)
+					SameLine();
+			}
+			if (gConstants.mSpatialCache.mCellSizeMode == SpatialCacheCellSizeMode::Fixed)
+				SliderFloat("Cell Size", &gConstants.mSpatialCache.mCellSize, 0.001f, 1.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
+			else
+			{
+				InputFloat("Cell Size Min", &gConstants.mSpatialCache.mCellSizeMin, 0, 0, "%.4f");
+				InputFloat("Cell Size Max", &gConstants.mSpatialCache.mCellSizeMax, 0, 0, "%.4f");
+				SliderFloat("Scene Scale", &gConstants.mSpatialCache.mSceneScale, 1.0f, 1000.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+				SliderFloat("Logarithm Base", &gConstants.mSpatialCache.mLogarithmBase, 1.1f, 8.0f, "%.2f");
+				SliderFloat("Level Bias", &gConstants.mSpatialCache.mLevelBias, -4.0f, 8.0f, "%.1f");
+			}
+
+			if (TreeNodeEx("Telemetry", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				gRenderer.mSpatialCacheTelemetryVisible = true;
+
+				std::span<uint> counters = gRenderer.mRuntime.mSpatialStatsBuffer.GetReadback<uint>(gGetFrameContextIndex());
+				auto counter = [&](SpatialCacheCounter inCounter) { return counters[static_cast<uint>(inCounter)]; };
+				float lookup_count = static_cast<float>(gMax(counter(SpatialCacheCounter::Lookup), 1u));
+
+				Text("Occupancy %.2f%% (%u / %u)", 100.0f * counter(SpatialCacheCounter::Occupied) / kSpatialHashSize, counter(SpatialCacheCounter::Occupied), kSpatialHashSize);
+				Text("Lookup %u, Hit %.2f%%, Insert %u, Failure %u", counter(SpatialCacheCounter::Lookup), 100.0f * counter(SpatialCacheCounter::Hit) / lookup_count, counter(SpatialCacheCounter::Insert), counter(SpatialCacheCounter::Failure));
+				Text("Probe Mean %.2f, Max %u", counter(SpatialCacheCounter::ProbeSum) / lookup_count, counter(SpatialCacheCounter::ProbeMax));
+				Text("Evicted %u", counter(SpatialCacheCounter::Evicted));
+
+				TreePop();
+			}
+
+			if (TreeNodeEx("CPU Model"))
+			{
+				Checkbox("Record", &gSpatialCacheModel.mRecording);
+				SameLine();
+				if (Button("Clear"))
+					gSpatialCacheModel.ClearRecord();
+				InputInt2("Record Size", (int*)&gSpatialCacheModel.mRecordSize.x);
+				Text("%u frames, %llu samples", gSpatialCacheModel.GetFrameCount(), gSpatialCacheModel.GetSampleCount());
+
+				if (Button("Save"))
+					gSpatialCacheModel.Save("Asset/SpatialCache/Stream.bin");
+				SameLine();
+				if (Button("Load"))
+					gSpatialCacheModel.Load("Asset/SpatialCache/Stream.bin");
+
+				if (Button("Replay"))
+				{
+					SpatialCacheModel::Settings settings = SpatialCacheModel::Settings::sFromConstants();
+					gSpatialCacheModel.Replay(std::span<const SpatialCacheModel::Settings>(&settings, 1));
+				}
+				SameLine();
+				if (Button("Compare Cell Size"))
+					gSpatialCacheModel.CompareCellSizeModes();
+				SameLine();
+				if (Button("Run Sweep"))
+					gSpatialCacheModel.RunSweep("Asset/SpatialCache/Sweep.json");
+				SameLine();
+				if (Button("Validate"))
+				{
+					std::string message;
+					SpatialCacheModel::sValidate(message);
+					gTrace(message);
+				}
+
+				for (const SpatialCacheModel::Result& result : gSpatialCacheModel.GetResults())
+				{
+					const SpatialCacheModel::Settings& settings = result.mSettings;
+					Text("T%u %s C%.3f A%u: hit %.3f, distinct %u, fail %.4f, probe %.2f/%u, occ %.3f, alias %llu", settings.mTableSize, nameof::nameof_enum(settings.mConstants.mCellSizeMode).data(), result.mMeanCellSize, settings.mConstants.mMaxAge,
+						result.mHitRate, result.mDistinctCellCount, result.mFailureRate, result.mMeanProbeLength, result.mMaxProbeLength, result.mPeakOccupancy, result.mAliasCount);
+				}
+
+				TreePop();
+			}
+
+			if (TreeNodeEx("Radiance Cache"))
+			{
+				Checkbox("Active", (bool*)&gConstants.mSpatialCache.mRadianceCacheActive);
+				SliderFloat("Radiance Scale", &gConstants.mSpatialCache.mRadianceScale, 1.0f, 100000.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+				SliderInt("Sample Count Min", (int*)&gConstants.mSpatialCache.mRadianceSampleCountMin, 1, 256);
+				SliderInt("Sample Count Max", (int*)&gConstants.mSpatialCache.mRadianceSampleCountMax, 1, 1024);
+
+				if (Button("Run Integrator"))
+					gRadianceCacheIntegrator.Run(gScene.GetSceneContent(), RadianceCacheIntegrator::Settings::sFromConstants());
+
+				if (gRadianceCacheIntegrator.GetReferenceMS() > 0.0f)
+				{
+					Text("Reference %.2f ms", gRadianceCacheIntegrator.GetReferenceMS());
+					for (int i = 0; i < static_cast<int>(RadianceCacheIntegrator::Mode::Count); i++)
+					{
+						const RadianceCacheIntegrator::Result& result = gRadianceCacheIntegrator.GetResult(static_cast<RadianceCacheIntegrator::Mode>(i));
+						Text("%s: %.3f ms, bias %+.4f, variance %.4f, terminated %.3f, converged %u frames / %.2f ms", nameof::nameof_enum(static_cast<RadianceCacheIntegrator::Mode>(i)).data(),
+							result.mFrameMS, result.mBias, result.mRelativeVariance, result.mTerminatedRate, result.mConvergedFrameCount, result.mConvergedMS);
+					}
+
+					if (ImPlot::BeginPlot("Relative RMSE", ImVec2(-1, 200)))
+					{
+						for (int i = 0; i < static_cast<int>(RadianceCacheIntegrator::Mode::Count); i++)
+						{
+							const RadianceCacheIntegrator::Result& result = gRadianceCacheIntegrator.GetResult(static_cast<RadianceCacheIntegrator::Mode>(i));
+							ImPlot::PlotLine(nameof::nameof_enum(static_cast<RadianceCacheIntegrator::Mode>(i)).data(), result.mRelativeRMSE.data(), static_cast<int>(result.mRelativeRMSE.size()));
+						}
+						ImPlot::EndPlot();
+					}
+				}
+
+				TreePop();
+			}
 		}
 
 		if (CollapsingHeader("BRDF Explorer"))
@@ -401,6 +527,33 @@ void gPrepareImGui()
 
 				SliderFloat("Radius", &gNVAPI.mLSSWireframeRadius, 0.001f, 0.1f);
 
+				LSSWireframe::Settings& settings = gScene.mLSSWireframeSettings;
+				Text("Mode");
+				int mode = static_cast<int>(settings.mMode);
+				for (int i = 0; i < static_cast<int>(LSSWireframe::Mode::Count); i++)
+				{
+					const auto& name = nameof::nameof_enum(static_cast<LSSWireframe::Mode>(i));
+					SameLine();
+					if (RadioButton(name.data(), &mode, i))
+					{
+						settings.mMode = static_cast<LSSWireframe::Mode>(mode);
+						gRenderer.mReloadScene = true;
+					}
+				}
+				if (settings.mMode == LSSWireframe::Mode::FeatureEdges && SliderFloat("Feature Angle", &settings.mFeatureAngle, 0.0f, 180.0f))
+					gRenderer.mReloadScene = true;
+				if (Checkbox("Per Edge Radius", &settings.mPerEdgeRadius))
+					gRenderer.mReloadScene = true;
+
+				const Scene::GeometryStats& stats = gScene.GetGeometryStats();
+				Text("%llu triangles -> %llu segments, %.2f MB, %.3f ms", stats.mLSSTriangleCount, stats.mLSSSegmentCount, stats.mLSSBytes / 1048576.0, gScene.GetLoadStats().mLSSMS);
+				if (Button("Validate"))
+				{
+					std::string message;
+					LSSWireframe::sValidate(message);
+					gTrace(message);
+				}
+
 				TreePop();
 			}
 
@@ -453,6 +606,39 @@ void gPrepareImGui()
 
 				gRenderer.mSequenceFrameRecording = 0;
 			}
+
+			if (TreeNodeEx("Capture"))
+			{
+				Checkbox("EXR", &gRenderer.mSequenceEXR);
+				SliderInt("Encoder Threads", (int*)&gSequenceCapture.mThreadCount, 1, static_cast<int>(gMax(std::thread::hardware_concurrency(), 1u)));
+				SliderInt("Encoder Queue", (int*)&gSequenceCapture.mQueueCapacity, 1, 64);
+				if (Button("Restart Encoder"))
+				{
+					gSequenceCapture.Flush();
+					gSequenceCapture.GetEncoder().Initialize(gSequenceCapture.mThreadCount, gSequenceCapture.mQueueCapacity);
+				}
+
+				const SequenceCapture::Stats& capture_stats = gSequenceCapture.GetStats();
+				FrameEncoder::Stats encoder_stats = gSequenceCapture.GetEncoder().GetStats();
+				Text("Captured %llu, in flight %u, ring stalls %llu (%.2f ms)", capture_stats.mCapturedCount, capture_stats.mSlotsInFlight, capture_stats.mRingStallCount, capture_stats.mRingStallMS);
+				Text("Encoded %llu, failed %llu, queue %u (max %u), submit blocked %.2f ms", encoder_stats.mEncodedCount, encoder_stats.mFailedCount, encoder_stats.mQueueDepth, encoder_stats.mQueueDepthMax, encoder_stats.mSubmitBlockedMS);
+				if (!encoder_stats.mLastError.empty())
+					TextWrapped("Last error: %s", encoder_stats.mLastError.c_str());
+
+				static FrameEncoder::BenchmarkResult sBenchmarkResult;
+				if (Button("Benchmark Encoder"))
+				{
+					FrameEncoder::Format format = gRenderer.mSequenceEXR ? FrameEncoder::Format::RGBA32F : FrameEncoder::Format::RGBA8;
+					sBenchmarkResult = FrameEncoder::sBenchmark(gRenderer.mScreenSize.x, gRenderer.mScreenSize.y, 64, format, gSequenceCapture.mThreadCount, gEnsureDumpDirectoryExists() / "EncoderBenchmark");
+					gTrace(std::format("[FrameEncoder] Benchmark {} frames {}x{} {} with {} threads: {:.2f} ms, {:.2f} frames/s, queue depth max {}, submit blocked {:.2f} ms, failed {}\n",
+						sBenchmarkResult.mFrameCount, gRenderer.mScreenSize.x, gRenderer.mScreenSize.y, FrameEncoder::sGetName(format), sBenchmarkResult.mThreadCount, sBenchmarkResult.mTotalMS, sBenchmarkResult.mFramesPerSecond,
+						sBenchmarkResult.mStats.mQueueDepthMax, sBenchmarkResult.mStats.mSubmitBlockedMS, sBenchmarkResult.mStats.mFailedCount));
+				}
+				if (sBenchmarkResult.mFrameCount > 0)
+					Text("%u frames, %u threads: %.2f frames/s, queue max %u", sBenchmarkResult.mFrameCount, sBenchmarkResult.mThreadCount, sBenchmarkResult.mFramesPerSecond, sBenchmarkResult.mStats.mQueueDepthMax);
+
+				TreePop();
+			}
 		}
 
 		if (CollapsingHeader("Display"))
@@ -472,6 +658,23 @@ void gPrepareImGui()
 			if (Checkbox("Use Texture", &gConfigs.mUseTexture))
 				gRenderer.mReloadShader = true;
 
+			if (Checkbox("Quantize Vertex Attributes", &gConfigs.mQuantizeVertexAttributes))
+			{
+				gRenderer.mReloadScene = true;
+				gRenderer.mReloadShader = true;
+			}
+
+			if (Checkbox("Optimize Meshes", &gConfigs.mOptimizeMeshes))
+				gRenderer.mReloadScene = true;
+
+			if (SliderInt("Load Threads (0 = all)", (int*)&gConfigs.mLoadThreadCount, 0, static_cast<int>(gMax(std::thread::hardware_concurrency(), 1u))))
+				gRenderer.mReloadScene = true;
+
+			Checkbox("Animate Instances", &gConfigs.mAnimateInstances);
+
+			if (Checkbox("Compact BLAS", &gConfigs.mCompactBLAS))
+				gRenderer.mReloadScene = true;
+
 			if (Checkbox("Test Hit Shader", &gConfigs.mTestHitShader))
 				gRenderer.mReloadShader = true;
 
@@ -549,6 +752,7 @@ void gPrepareImGui()
 					"PrimitiveCount",
 					"ScratchMB",
 					"ResultMB",
+					"CompactedMB",
 				};
 				int column_count = (int)std::size(columns);
 
@@ -681,6 +885,10 @@ void gPrepareImGui()
 						std::string bvh_data_size_in_mb = std::format("{:.2f} ", instance_info.mStats.mResultDataSizeInBytes / 1024.0f / 1024.0f);
 						Text(bvh_data_size_in_mb.c_str());
 
+						TableSetColumnIndex(column_index++);
+						std::string compacted_data_size_in_mb = std::format("{:.2f} ", instance_info.mStats.mCompactedDataSizeInBytes / 1024.0f / 1024.0f);
+						Text(compacted_data_size_in_mb.c_str());
+
 						PopID();
 						gAssert(column_index == column_count);
 					}
@@ -774,6 +982,7 @@ void gPrepareImGui()
 					InputFloat("Depths",			&gStats.mGPUTimingMS.mDepths,			0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
 					InputFloat("PrepareLights",		&gStats.mGPUTimingMS.mPrepareLights,	0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
 					InputFloat("RayQuery",			&gStats.mGPUTimingMS.mRayQuery,			0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					InputFloat("SpatialCache",		&gStats.mGPUTimingMS.mSpatialCache,		0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
 					InputFloat("Composite",			&gStats.mGPUTimingMS.mComposite,		0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
 					InputFloat("ImGui",				&gStats.mGPUTimingMS.mImGui,			0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
 
@@ -796,7 +1005,278 @@ void gPrepareImGui()
 
 				if (TreeNodeEx("CPU Timing (MS)", ImGuiTreeNodeFlags_DefaultOpen))
 				{
-					InputFloat("Startup", &gStats.mCPUTimingMS.mStartup, 0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					InputFloat("Startup",			&gStats.mCPUTimingMS.mStartup,			0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					InputFloat("LoadScene",			&gStats.mCPUTimingMS.mLoadScene,		0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					InputFloat("CompileShaders",	&gStats.mCPUTimingMS.mCompileShaders,	0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					InputFloat("PrepareLights",		&gStats.mCPUTimingMS.mPrepareLights,	0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("Timing History (MS)"))
+				{
+					auto history_table = [](const char* inLabel, const TimingHistory& inHistory)
+					{
+						static const int kColumnCount = 7;
+						if (!BeginTable(inLabel, kColumnCount, ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_Borders))
+							return;
+
+						{
+							int column_index = 0;
+							TableNextRow(ImGuiTableRowFlags_Headers);
+							TableSetColumnIndex(column_index++); Text("%s", inLabel);
+							TableSetColumnIndex(column_index++); Text("Mean");
+							TableSetColumnIndex(column_index++); Text("P50");
+							TableSetColumnIndex(column_index++); Text("P95");
+							TableSetColumnIndex(column_index++); Text("P99");
+							TableSetColumnIndex(column_index++); Text("Max");
+							TableSetColumnIndex(column_index++); Text("Outliers");
+							gAssert(column_index == kColumnCount);
+						}
+
+						for (uint series_index = 0; series_index < inHistory.GetSeriesCount(); series_index++)
+						{
+							TimingHistory::Statistics statistics = inHistory.GetSeries(series_index).Compute();
+							TableNextRow();
+							if (statistics.mOutlierCount > 0)
+								TableSetBgColor(ImGuiTableBgTarget_RowBg1, GetColorU32(ImVec4(0.8f, 0.2f, 0.2f, 0.4f)));
+
+							int column_index = 0;
+							TableSetColumnIndex(column_index++); Text("%s", inHistory.GetName(series_index).c_str());
+							TableSetColumnIndex(column_index++); Text("%.3f", statistics.mMean);
+							TableSetColumnIndex(column_index++); Text("%.3f", statistics.mP50);
+							TableSetColumnIndex(column_index++); Text("%.3f", statistics.mP95);
+							TableSetColumnIndex(column_index++); Text("%.3f", statistics.mP99);
+							TableSetColumnIndex(column_index++); Text("%.3f", statistics.mMax);
+							TableSetColumnIndex(column_index++); Text("%u", statistics.mOutlierCount);
+						}
+						EndTable();
+					};
+
+					Text("Last %u frames, outlier above P50 + %.0f x MAD", TimingHistory::kDefaultCapacity, TimingHistory::kOutlierMADScale);
+					history_table("GPU", gStats.mGPUTimingHistory);
+					history_table("CPU", gStats.mCPUTimingHistory);
+
+					if (Button("Export CSV"))
+						gWriteTimingCSV(gEnsureDumpDirectoryExists() / "Timing.csv");
+					SameLine();
+					if (Button("Clear"))
+					{
+						gStats.mGPUTimingHistory.Clear();
+						gStats.mCPUTimingHistory.Clear();
+					}
+					SameLine();
+					if (Button("Validate"))
+					{
+						std::string message;
+						TimingHistory::sValidate(message);
+						gTrace(message);
+					}
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("Profiler"))
+				{
+					bool enabled = gProfiler.IsEnabled();
+					if (Checkbox("Enabled", &enabled))
+						gProfiler.SetEnabled(enabled);
+					Text("%llu events on %u threads", gProfiler.GetRecordedCount(), gProfiler.GetThreadCount());
+
+					if (Button("Write Chrome Trace"))
+					{
+						std::filesystem::path path = gEnsureDumpDirectoryExists() / "ProfilerTrace.json";
+						gTrace(std::format("[Profiler] {} {}\n", gProfiler.WriteChromeTrace(path) ? "Trace written to" : "Failed to write", path.string()));
+					}
+					SameLine();
+					if (Button("Clear"))
+						gProfiler.Clear();
+
+					static Profiler::BenchmarkResult sBenchmarkResult;
+					if (Button("Benchmark Overhead"))
+					{
+						sBenchmarkResult = Profiler::sBenchmark(1000000);
+						gTrace(std::format("[Profiler] Benchmark {} iterations: disabled {:.2f} ns, enabled {:.2f} ns, enabled on {} threads {:.2f} ns per scope, counter {:.2f} ns\n",
+							sBenchmarkResult.mIterationCount, sBenchmarkResult.mDisabledNS, sBenchmarkResult.mEnabledNS, sBenchmarkResult.mThreadCount, sBenchmarkResult.mEnabledContendedNS, sBenchmarkResult.mCounterNS));
+					}
+					if (sBenchmarkResult.mIterationCount > 0)
+						Text("Per scope: disabled %.2f ns, enabled %.2f ns, %u threads %.2f ns", sBenchmarkResult.mDisabledNS, sBenchmarkResult.mEnabledNS, sBenchmarkResult.mThreadCount, sBenchmarkResult.mEnabledContendedNS);
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("Upload Heap"))
+				{
+					const UploadArena::Stats& stats = gUploadHeap.GetStats();
+					Text("In flight %.2f MB, peak %.2f MB", stats.mInFlightBytes / 1048576.0, stats.mPeakInFlightBytes / 1048576.0);
+					Text("Committed %.2f MB in %u blocks, peak %.2f MB in %u blocks", stats.mCommittedBytes / 1048576.0, stats.mBlockCount, stats.mPeakCommittedBytes / 1048576.0, stats.mPeakBlockCount);
+					Text("%llu allocations, %.2f MB", stats.mAllocationCount, stats.mAllocatedBytes / 1048576.0);
+					Text("Fragmentation %.1f%% (padding %.2f MB, abandoned %.2f MB)", stats.Fragmentation() * 100.0f, stats.mPaddingBytes / 1048576.0, stats.mAbandonedBytes / 1048576.0);
+					Text("Blocks created %u, recycled %u, released %u", stats.mCreatedBlockCount, stats.mRecycledBlockCount, stats.mReleasedBlockCount);
+
+					if (Button("Reset Peaks"))
+						gUploadHeap.ResetPeaks();
+					SameLine();
+					if (Button("Validate"))
+					{
+						std::string message;
+						UploadArena::sValidate(message);
+						gTrace(message);
+						CopyPlan::sValidate(message);
+						gTrace(message);
+					}
+
+					Separator();
+					const CopyQueue::Stats& copy_stats = gCopyQueue.GetStats();
+					const UploadArena::Stats& staging_stats = gCopyQueue.GetStagingStats();
+					Text("Copy queue: last upload %.2f MB in %u batches, submit %.3f ms, %u slots", copy_stats.mBytes / 1048576.0, copy_stats.mBatchCount, copy_stats.mSubmitMS, copy_stats.mSlotCount);
+					Text("Copy queue: staging %.2f MB, peak %.2f MB", staging_stats.mCommittedBytes / 1048576.0, staging_stats.mPeakCommittedBytes / 1048576.0);
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("Geometry"))
+				{
+					const Scene::GeometryStats& stats = gScene.GetGeometryStats();
+					const Scene::LoadStats& load_stats = gScene.GetLoadStats();
+					Text("Parse %.3f ms, XML %.3f ms, OBJ I/O %.3f ms, merge %.3f ms", load_stats.mParseMS, load_stats.mXMLParseMS, load_stats.mObjIOMS, load_stats.mMergeMS);
+					Text("glTF file %.3f ms, traverse %.3f ms, convert %.3f ms", load_stats.mGLTFFileMS, load_stats.mGLTFTraverseMS, load_stats.mGLTFConvertMS);
+					Text("Instances %d sharing %u BLAS, %llu vertices without sharing", gScene.GetInstanceCount(), stats.mBLASCount, stats.mInstancedVertexCount);
+					Text("Vertices %llu, %llu as loaded, optimize %.3f ms", stats.mVertexCount, stats.mSourceVertexCount, gScene.GetLoadStats().mOptimizeMeshesMS);
+					Text("Indices %.2f MB, packed %.2f MB, %u of %d instances 16bit", stats.mIndexBytes / 1048576.0, stats.mPackedIndexBytes / 1048576.0, stats.mIndex16BitInstanceCount, gScene.GetInstanceCount());
+					Text("Vertex attributes %.2f MB", stats.mVertexAttributeFloatBytes / 1048576.0);
+					if (stats.mVertexAttributeQuantizedBytes > 0)
+					{
+						Text("Quantized %.2f MB (%.1f%%), %.3f ms", stats.mVertexAttributeQuantizedBytes / 1048576.0, stats.mVertexAttributeQuantizedBytes * 100.0 / stats.mVertexAttributeFloatBytes, gScene.GetLoadStats().mQuantizeMS);
+						Text("Resident %.2f MB (%.1f%%), float positions kept for BLAS", stats.mVertexAttributeResidentBytes / 1048576.0, stats.mVertexAttributeResidentBytes * 100.0 / stats.mVertexAttributeFloatBytes);
+					}
+					else
+						Text("Not quantized");
+					if (stats.mBLASCompactedCount > 0)
+						Text("BLAS %.2f MB, compacted %.2f MB (%.1f%%), pooled %.2f MB", stats.mBLASResultBytes / 1048576.0, stats.mBLASCompactedBytes / 1048576.0, stats.mBLASCompactedBytes * 100.0 / stats.mBLASResultBytes, stats.mBLASPoolBytes / 1048576.0);
+					else
+						Text("BLAS %.2f MB, not compacted", stats.mBLASResultBytes / 1048576.0);
+
+					if (Button("Validate"))
+					{
+						std::string message;
+						Scene::sValidateVertexQuantization(message);
+						gTrace(message);
+					}
+					SameLine();
+					if (Button("BLAS Report"))
+					{
+						std::string report;
+						gScene.ReportBLASMemory(report);
+						gTrace(report);
+					}
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("Animation"))
+				{
+					const SceneContent& scene_content = gScene.GetSceneContent();
+					const Animation::Stats& stats = scene_content.mAnimation.GetStats();
+					Text("Nodes %u, animated %u, instances %zu", scene_content.mAnimation.GetNodeCount(), stats.mAnimatedNodeCount, scene_content.mAnimatedInstances.size());
+					Text("Channels %u in %u batches, %.2f s to %.2f s", stats.mChannelCount, stats.mBatchCount, scene_content.mAnimation.GetStartTime(), scene_content.mAnimation.GetEndTime());
+					Text("Sample %.3f ms, hierarchy %.3f ms", stats.mSampleMS, stats.mHierarchyMS);
+
+					if (Button("Validate"))
+					{
+						std::string message;
+						Animation::sValidate(message);
+						gTrace(message);
+					}
+					SameLine();
+					static Animation::BenchmarkResult sBenchmarkResult;
+					if (Button("Benchmark"))
+					{
+						sBenchmarkResult = Animation::sBenchmark(4096, 256);
+						gTrace(std::format("[Animation] Benchmark {} nodes, {} channels, {} iterations: sample {:.3f} ms, hierarchy {:.3f} ms\n",
+							sBenchmarkResult.mNodeCount, sBenchmarkResult.mChannelCount, sBenchmarkResult.mIterationCount, sBenchmarkResult.mSampleMS, sBenchmarkResult.mHierarchyMS));
+					}
+					if (sBenchmarkResult.mIterationCount > 0)
+						Text("%u nodes: sample %.3f ms, hierarchy %.3f ms", sBenchmarkResult.mNodeCount, sBenchmarkResult.mSampleMS, sBenchmarkResult.mHierarchyMS);
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("TLAS Update"))
+				{
+					if (gScene.mTLAS != nullptr)
+					{
+						TLASUpdatePolicy& policy = gScene.mTLAS->GetUpdatePolicy();
+						const TLASUpdatePolicy::Stats& stats = policy.GetStats();
+						Text("%s, last %s", gScene.mTLAS->IsUpdatable() ? "Updatable" : "Static", nameof::nameof_enum(stats.mLastAction).data());
+						Text("Modified %u, written %u in %u ranges", stats.mModifiedCount, stats.mWrittenCount, stats.mRangeCount);
+						Text("Refits %llu, rebuilds %llu, %u refits and peak motion %.3f since rebuild", stats.mRefitCount, stats.mRebuildCount, stats.mRefitsSinceRebuild, stats.mPeakMotionRatio);
+						SliderFloat("Rebuild Motion Ratio", &policy.mSettings.mRebuildMotionRatio, 0.0f, 4.0f);
+						SliderInt("Rebuild Refit Count", (int*)&policy.mSettings.mRebuildRefitCount, 0, 1024);
+						SliderInt("Merge Gap", (int*)&policy.mSettings.mMergeGap, 0, 64);
+					}
+
+					if (Button("Validate"))
+					{
+						std::string message;
+						TLASUpdatePolicy::sValidate(message);
+						gTrace(message);
+					}
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("Light BVH"))
+				{
+					LightBVH::Stats stats = gScene.GetLightBVH().GetStats();
+					InputFloat("Build (MS)",		&stats.mBuildMS,			0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					InputScalar("Emitters",			ImGuiDataType_U32,			&stats.mEmitterCount,		nullptr, nullptr, nullptr, ImGuiInputTextFlags_ReadOnly);
+					InputScalar("Nodes",			ImGuiDataType_U32,			&stats.mNodeCount,			nullptr, nullptr, nullptr, ImGuiInputTextFlags_ReadOnly);
+					InputScalar("Depth",			ImGuiDataType_U32,			&stats.mDepth,				nullptr, nullptr, nullptr, ImGuiInputTextFlags_ReadOnly);
+					InputScalar("Node Bytes",		ImGuiDataType_U64,			&stats.mNodeSizeInBytes,	nullptr, nullptr, nullptr, ImGuiInputTextFlags_ReadOnly);
+
+					if (Button("Evaluate"))
+						gScene.EvaluateLightBVH();
+
+					InputFloat("Evaluate (MS)",		&stats.mEvaluateMS,			0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					InputScalar("Shading Points",	ImGuiDataType_U32,			&stats.mShadingPointCount,	nullptr, nullptr, nullptr, ImGuiInputTextFlags_ReadOnly);
+					InputFloat("Variance Uniform",	&stats.mUniformVariance,	0, 0, "%.4f", ImGuiInputTextFlags_ReadOnly);
+					InputFloat("Variance BVH",		&stats.mBVHVariance,		0, 0, "%.4f", ImGuiInputTextFlags_ReadOnly);
+
+					TreePop();
+				}
+
+				if (TreeNodeEx("ReSTIR"))
+				{
+					if (Button("Run Harness"))
+						gReSTIR.RunHarness(256, 256, 16);
+
+					ReSTIR::Stats stats = gReSTIR.GetStats();
+					InputFloat("Harness (MS)",		&stats.mHarnessMS,			0, 0, "%.3f", ImGuiInputTextFlags_ReadOnly);
+					for (uint packing = 0; packing < static_cast<uint>(ReSTIR::Packing::Count); packing++)
+					{
+						ReSTIR::HarnessResult& result = stats.mResults[packing];
+						Text("%-8s bias %+.4f, rmse %.4f, %.1f bytes/pixel", nameof::nameof_enum(static_cast<ReSTIR::Packing>(packing)).data(), result.mBias, result.mRelativeRMSE, result.mBytesPerPixel);
+					}
+
+					if (Button("Simulate"))
+					{
+						ReSTIR::Settings settings = ReSTIR::Settings::sFromConstants();
+						gReSTIR.Simulate(gScene.GetSceneContent(), std::span<const ReSTIR::Settings>(&settings, 1));
+					}
+					SameLine();
+					if (Button("Run Sweep"))
+						gReSTIR.RunSweep(gScene.GetSceneContent(), "Asset/ReSTIR/Sweep.json");
+
+					for (const ReSTIR::SimulationResult& result : gReSTIR.GetSimulationResults())
+					{
+						const ReSTIR::Settings& settings = result.mSettings;
+						float resampling_ms = 0.0f;
+						for (uint stage = static_cast<uint>(ReSTIR::Stage::Initialize); stage < static_cast<uint>(ReSTIR::Stage::Count); stage++)
+							resampling_ms += result.mStageMS[stage];
+						Text("I%u T%u S%u R%.1f M%.0f: bias %+.4f, rel mse %.4f, %.2f ms", settings.mInitialSampleCount, settings.mTemporalSampleCount, settings.mSpatialSampleCount, settings.mSpatialRadius, settings.mMCap,
+							result.mBias, result.mRelativeMSE, resampling_ms);
+					}
 
 					TreePop();
 				}
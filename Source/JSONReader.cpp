@@ -0,0 +1,73 @@
+#include "JSONReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+void JSONReader::Error(const std::string& inKey, const char* inExpected)
+{
+	mErrors													+= std::format("{}\"{}\" is not {}", mErrors.empty() ? "" : "; ", inKey, inExpected);
+}
+
+bool JSONReader::ReadNumbers(const std::string& inKey, std::span<float> outValues, float inMin, const char* inExpected)
+{
+	if (!mJSON.contains(inKey))
+		return false;
+
+	const nlohmann::json& value								= mJSON[inKey];
+	bool scalar												= outValues.size() == 1 && value.is_number();
+	bool valid												= scalar || (value.is_array() && value.size() == outValues.size());
+	for (size_t index = 0; valid && index < outValues.size(); index++)
+	{
+		const nlohmann::json& element						= scalar ? value : value[index];
+		valid												= element.is_number() && std::isfinite(element.get<double>()) && element.get<double>() >= inMin && element.get<double>() <= 1.0e9;
+		if (valid)
+			outValues[index]								= element.get<float>();
+	}
+	if (!valid)
+		Error(inKey, inExpected);
+	return valid;
+}
+
+bool JSONReader::ReadString(const std::string& inKey, std::string& outValue)
+{
+	if (!mJSON.contains(inKey))
+		return false;
+	if (!mJSON[inKey].is_string())
+	{
+		Error(inKey, "a string");
+		return false;
+	}
+	outValue												= mJSON[inKey].get<std::string>();
+	return true;
+}
+
+bool JSONReader::ReadStrings(const std::string& inKey, std::vector<std::string>& outValues)
+{
+	if (!mJSON.contains(inKey))
+		return false;
+
+	const nlohmann::json& value								= mJSON[inKey];
+	if (!value.is_array() || std::any_of(value.begin(), value.end(), [](const nlohmann::json& inElement) { return !inElement.is_string(); }))
+	{
+		Error(inKey, "an array of strings");
+		return false;
+	}
+	outValues.clear();
+	for (const nlohmann::json& element : value)
+		outValues.push_back(element.get<std::string>());
+	return true;
+}
+
+bool JSONReader::ReadBool(const std::string& inKey, bool& outValue)
+{
+	if (!mJSON.contains(inKey))
+		return false;
+	if (!mJSON[inKey].is_boolean())
+	{
+		Error(inKey, "a boolean");
+		return false;
+	}
+	outValue												= mJSON[inKey].get<bool>();
+	return true;
+}
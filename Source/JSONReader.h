@@ -0,0 +1,30 @@
+#pragma once
+
+// Standard library and json only, shared by job files of Batch and suites of Benchmark
+#include "Thirdparty/tinygltf/json.hpp"
+
+#include <span>
+#include <string>
+#include <vector>
+
+// Reads keys of a JSON object with type, size and range checks
+// Keys of wrong type, size or range keep their previous value and are reported in GetErrors()
+class JSONReader
+{
+public:
+	explicit JSONReader(const nlohmann::json& inJSON) : mJSON(inJSON) {}
+
+	// Each returns true when the key exists and is valid, false when missing or invalid
+	bool ReadNumbers(const std::string& inKey, std::span<float> outValues, float inMin, const char* inExpected); // Array of outValues.size() numbers, or a number when size is 1
+	bool ReadString(const std::string& inKey, std::string& outValue);
+	bool ReadStrings(const std::string& inKey, std::vector<std::string>& outValues);
+	bool ReadBool(const std::string& inKey, bool& outValue);
+
+	const std::string& GetErrors() const						{ return mErrors; }	// Empty when every key read so far is valid
+
+private:
+	void Error(const std::string& inKey, const char* inExpected);
+
+	const nlohmann::json& mJSON;
+	std::string mErrors;
+};
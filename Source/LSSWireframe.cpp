@@ -0,0 +1,403 @@
+#include "LSSWireframe.h"
+
+#include "Validate.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <format>
+#include <numbers>
+#include <ranges>
+#include <set>
+
+static uint64_t sEdgeKey(uint32_t inA, uint32_t inB)
+{
+	return (static_cast<uint64_t>(std::min(inA, inB)) << 32) | std::max(inA, inB);
+}
+
+static uint64_t sEdgeHash(uint64_t inKey)
+{
+	// splitmix64 finalizer
+	inKey													^= inKey >> 30;
+	inKey													*= 0xBF58476D1CE4E5B9ull;
+	inKey													^= inKey >> 27;
+	inKey													*= 0x94D049BB133111EBull;
+	inKey													^= inKey >> 31;
+	return inKey;
+}
+
+LSSWireframe::Stats& LSSWireframe::Stats::operator+=(const Stats& inOther)
+{
+	mTriangleCount											+= inOther.mTriangleCount;
+	mSegmentCount											+= inOther.mSegmentCount;
+	mUniqueEdgeCount										+= inOther.mUniqueEdgeCount;
+	mBoundaryEdgeCount										+= inOther.mBoundaryEdgeCount;
+	mNonManifoldEdgeCount									+= inOther.mNonManifoldEdgeCount;
+	mGenerateMS												+= inOther.mGenerateMS;
+	return *this;
+}
+
+void LSSWireframe::sGenerate(std::span<const glm::vec3> inVertices, std::span<const uint32_t> inIndices, const Settings& inSettings, std::vector<uint32_t>& outSegments, Stats& outStats)
+{
+	auto start												= std::chrono::high_resolution_clock::now();
+
+	constexpr uint32_t kEdgesPerTriangle					= 3;
+	uint32_t triangle_count									= static_cast<uint32_t>(inIndices.size() / 3);
+	uint32_t edge_count										= triangle_count * kEdgesPerTriangle;
+	auto edge_vertex										= [&](uint32_t inEdgeIndex, uint32_t inEnd)
+	{
+		uint32_t triangle_index								= inEdgeIndex / kEdgesPerTriangle;
+		uint32_t corner										= (inEdgeIndex + inEnd) % kEdgesPerTriangle;
+		return inIndices[triangle_index * 3 + corner];
+	};
+
+	outStats												= {};
+	outStats.mTriangleCount									= triangle_count;
+	outSegments.clear();
+
+	if (inSettings.mMode == Mode::Triangles)
+	{
+		outSegments.resize(edge_count * 2);
+		for (uint32_t edge_index = 0; edge_index < edge_count; edge_index++)
+		{
+			outSegments[edge_index * 2 + 0]					= edge_vertex(edge_index, 0);
+			outSegments[edge_index * 2 + 1]					= edge_vertex(edge_index, 1);
+		}
+	}
+	else
+	{
+		bool feature_only									= inSettings.mMode == Mode::FeatureEdges;
+		std::vector<glm::vec3> normals;
+		if (feature_only)
+		{
+			normals.resize(triangle_count);
+			auto triangle_range								= std::views::iota(0u, triangle_count);
+			std::for_each(std::execution::par, triangle_range.begin(), triangle_range.end(), [&](uint32_t inTriangleIndex)
+			{
+				const glm::vec3& p0							= inVertices[inIndices[inTriangleIndex * 3 + 0]];
+				const glm::vec3& p1							= inVertices[inIndices[inTriangleIndex * 3 + 1]];
+				const glm::vec3& p2							= inVertices[inIndices[inTriangleIndex * 3 + 2]];
+				glm::vec3 normal							= glm::cross(p1 - p0, p2 - p0);
+				float length								= glm::length(normal);
+				normals[inTriangleIndex]					= length > 0.0f ? normal / length : glm::vec3(0.0f);
+			});
+		}
+		float cos_feature_angle								= std::cos(inSettings.mFeatureAngle * std::numbers::pi_v<float> / 180.0f);
+
+		// Edges are processed in blocks of triangle order in parallel, each block counts into its own histogram
+		uint32_t block_count								= (edge_count + kBlockEdgeCount - 1) / kBlockEdgeCount;
+		auto block_range									= std::views::iota(0u, block_count);
+		auto block_edges									= [&](uint32_t inBlockIndex) { return std::views::iota(inBlockIndex * kBlockEdgeCount, std::min((inBlockIndex + 1) * kBlockEdgeCount, edge_count)); };
+
+		// Counting sort of edges by shard, stable so each shard sees its edges in triangle order
+		uint32_t shard_count								= std::bit_ceil(std::max(inSettings.mShardCount, 1u));
+		auto shard_of										= [&](uint64_t inKey) { return static_cast<uint32_t>(sEdgeHash(inKey) & (shard_count - 1)); };
+		auto degenerate										= [](uint64_t inKey) { return (inKey >> 32) == (inKey & 0xFFFFFFFF); };
+		std::vector<uint64_t> keys(edge_count);
+		std::vector<uint32_t> block_cursors(static_cast<size_t>(block_count) * shard_count, 0);	// [block][shard] count, then offset into shard_edges
+		std::for_each(std::execution::par, block_range.begin(), block_range.end(), [&](uint32_t inBlockIndex)
+		{
+			uint32_t* counts								= block_cursors.data() + static_cast<size_t>(inBlockIndex) * shard_count;
+			for (uint32_t edge_index : block_edges(inBlockIndex))
+			{
+				keys[edge_index]							= sEdgeKey(edge_vertex(edge_index, 0), edge_vertex(edge_index, 1));
+				if (!degenerate(keys[edge_index]))
+					counts[shard_of(keys[edge_index])]++;
+			}
+		});
+
+		// Shard major, then block order
+		std::vector<uint32_t> shard_offsets(shard_count + 1, 0);
+		uint32_t offset										= 0;
+		for (uint32_t shard_index = 0; shard_index < shard_count; shard_index++)
+		{
+			shard_offsets[shard_index]						= offset;
+			for (uint32_t block_index = 0; block_index < block_count; block_index++)
+			{
+				uint32_t& cursor							= block_cursors[static_cast<size_t>(block_index) * shard_count + shard_index];
+				uint32_t count								= cursor;
+				cursor										= offset;
+				offset										+= count;
+			}
+		}
+		shard_offsets[shard_count]							= offset;
+
+		std::vector<uint32_t> shard_edges(offset);
+		std::for_each(std::execution::par, block_range.begin(), block_range.end(), [&](uint32_t inBlockIndex)
+		{
+			uint32_t* cursors								= block_cursors.data() + static_cast<size_t>(inBlockIndex) * shard_count;
+			for (uint32_t edge_index : block_edges(inBlockIndex))
+			{
+				if (!degenerate(keys[edge_index]))
+					shard_edges[cursors[shard_of(keys[edge_index])]++] = edge_index;
+			}
+		});
+
+		// Open addressing per shard, keep flag on first occurrence of each kept edge
+		std::vector<uint8_t> keep(edge_count, 0);
+		std::vector<Stats> shard_stats(shard_count);
+		auto shard_range									= std::views::iota(0u, shard_count);
+		std::for_each(std::execution::par, shard_range.begin(), shard_range.end(), [&](uint32_t inShardIndex)
+		{
+			struct Entry
+			{
+				uint64_t mKey								= 0;
+				uint32_t mFirstEdge							= 0;
+				uint32_t mSecondEdge						= 0;
+				uint32_t mCount								= 0;
+			};
+
+			std::span<const uint32_t> edges(shard_edges.data() + shard_offsets[inShardIndex], shard_offsets[inShardIndex + 1] - shard_offsets[inShardIndex]);
+			std::vector<Entry> entries(std::bit_ceil(std::max(static_cast<uint32_t>(edges.size()) * 2, 2u)));
+			uint32_t mask									= static_cast<uint32_t>(entries.size()) - 1;
+			for (uint32_t edge_index : edges)
+			{
+				uint64_t key								= keys[edge_index];
+				// Shard is picked by low bits of hash, probe with high bits
+				uint32_t slot								= static_cast<uint32_t>(sEdgeHash(key) >> 32) & mask;
+				while (entries[slot].mCount != 0 && entries[slot].mKey != key)
+					slot									= (slot + 1) & mask;
+
+				Entry& entry								= entries[slot];
+				if (entry.mCount == 0)
+				{
+					entry.mKey								= key;
+					entry.mFirstEdge						= edge_index;
+				}
+				else if (entry.mCount == 1)
+					entry.mSecondEdge						= edge_index;
+				entry.mCount++;
+			}
+
+			Stats& stats									= shard_stats[inShardIndex];
+			for (const Entry& entry : entries)
+			{
+				if (entry.mCount == 0)
+					continue;
+
+				stats.mUniqueEdgeCount++;
+				stats.mBoundaryEdgeCount					+= entry.mCount == 1 ? 1 : 0;
+				stats.mNonManifoldEdgeCount					+= entry.mCount > 2 ? 1 : 0;
+
+				bool kept									= true;
+				if (feature_only && entry.mCount == 2)
+				{
+					// Degenerate triangles have zero normal, their edges are not features
+					const glm::vec3& n0						= normals[entry.mFirstEdge / kEdgesPerTriangle];
+					const glm::vec3& n1						= normals[entry.mSecondEdge / kEdgesPerTriangle];
+					bool degenerate							= n0 == glm::vec3(0.0f) || n1 == glm::vec3(0.0f);
+					kept									= !degenerate && glm::dot(n0, n1) < cos_feature_angle;
+				}
+				keep[entry.mFirstEdge]						= kept ? 1 : 0;
+				stats.mSegmentCount							+= kept ? 1 : 0;
+			}
+		});
+
+		for (const Stats& stats : shard_stats)
+			outStats										+= stats;
+
+		// Compaction in triangle order keeps segments of a triangle close, as Triangles mode. Blocks count kept edges, then write from their prefix.
+		std::vector<uint32_t> block_segment_offsets(block_count + 1, 0);
+		std::for_each(std::execution::par, block_range.begin(), block_range.end(), [&](uint32_t inBlockIndex)
+		{
+			for (uint32_t edge_index : block_edges(inBlockIndex))
+				block_segment_offsets[inBlockIndex + 1]		+= keep[edge_index];
+		});
+		for (uint32_t block_index = 0; block_index < block_count; block_index++)
+			block_segment_offsets[block_index + 1]			+= block_segment_offsets[block_index];
+
+		outSegments.resize(static_cast<size_t>(block_segment_offsets[block_count]) * 2);
+		std::for_each(std::execution::par, block_range.begin(), block_range.end(), [&](uint32_t inBlockIndex)
+		{
+			uint32_t* segments								= outSegments.data() + static_cast<size_t>(block_segment_offsets[inBlockIndex]) * 2;
+			for (uint32_t edge_index : block_edges(inBlockIndex))
+			{
+				if (keep[edge_index] == 0)
+					continue;
+
+				*segments++									= edge_vertex(edge_index, 0);
+				*segments++									= edge_vertex(edge_index, 1);
+			}
+		});
+	}
+
+	outStats.mTriangleCount									= triangle_count;
+	outStats.mSegmentCount									= outSegments.size() / 2;
+	outStats.mGenerateMS									= std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void LSSWireframe::sEdgeRadii(std::span<const glm::vec3> inVertices, std::span<const uint32_t> inSegments, float inRadius, std::vector<float>& outRadii)
+{
+	size_t segment_count									= inSegments.size() / 2;
+	outRadii.resize(segment_count);
+
+	double length_sum										= 0.0;
+	for (size_t segment_index = 0; segment_index < segment_count; segment_index++)
+	{
+		outRadii[segment_index]								= glm::length(inVertices[inSegments[segment_index * 2 + 1]] - inVertices[inSegments[segment_index * 2 + 0]]);
+		length_sum											+= outRadii[segment_index];
+	}
+
+	float mean_length										= segment_count > 0 ? static_cast<float>(length_sum / segment_count) : 0.0f;
+	for (float& radius : outRadii)
+		radius												= inRadius * (mean_length > 0.0f ? glm::clamp(radius / mean_length, kMinRadiusScale, 1.0f) : 1.0f);
+}
+
+bool LSSWireframe::sValidate(std::string& outMessage)
+{
+	// Reference set of sorted pairs, and check that segments are unique and non-degenerate
+	auto reference_edges									= [](std::span<const uint32_t> inIndices)
+	{
+		std::set<uint64_t> edges;
+		for (size_t triangle_index = 0; triangle_index < inIndices.size() / 3; triangle_index++)
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t a									= inIndices[triangle_index * 3 + corner];
+				uint32_t b									= inIndices[triangle_index * 3 + (corner + 1) % 3];
+				if (a != b)
+					edges.insert(sEdgeKey(a, b));
+			}
+		return edges;
+	};
+	auto segment_edges										= [](const std::vector<uint32_t>& inSegments, bool& outUnique)
+	{
+		std::set<uint64_t> edges;
+		outUnique											= true;
+		for (size_t segment_index = 0; segment_index < inSegments.size() / 2; segment_index++)
+		{
+			uint32_t a										= inSegments[segment_index * 2 + 0];
+			uint32_t b										= inSegments[segment_index * 2 + 1];
+			outUnique										&= a != b && edges.insert(sEdgeKey(a, b)).second;
+		}
+		return edges;
+	};
+
+	// Grid of kGridSize x kGridSize quads on XZ, two triangles each, optionally folded by 90 degrees at middle column
+	constexpr uint32_t kGridSize							= 96;
+	auto grid												= [&](bool inFolded, std::vector<glm::vec3>& outVertices, std::vector<uint32_t>& outIndices)
+	{
+		outVertices.clear();
+		outIndices.clear();
+		for (uint32_t z = 0; z <= kGridSize; z++)
+			for (uint32_t x = 0; x <= kGridSize; x++)
+			{
+				float fx									= static_cast<float>(x);
+				float fz									= static_cast<float>(z);
+				float half									= kGridSize * 0.5f;
+				outVertices.push_back(inFolded && fx > half ? glm::vec3(half, fx - half, fz) : glm::vec3(fx, 0.0f, fz));
+			}
+		for (uint32_t z = 0; z < kGridSize; z++)
+			for (uint32_t x = 0; x < kGridSize; x++)
+			{
+				uint32_t v00								= z * (kGridSize + 1) + x;
+				uint32_t v10								= v00 + 1;
+				uint32_t v01								= v00 + kGridSize + 1;
+				uint32_t v11								= v01 + 1;
+				outIndices.insert(outIndices.end(), { v00, v01, v10, v10, v01, v11 });
+			}
+	};
+
+	Settings triangles_settings								= { .mMode = Mode::Triangles };
+	Settings shared_settings								= { .mMode = Mode::SharedEdges };
+	Settings feature_settings								= { .mMode = Mode::FeatureEdges };
+	std::vector<glm::vec3> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> segments;
+	Stats stats;
+	bool unique												= false;
+
+	bool triangles_mode										= true;
+	grid(false, vertices, indices);
+	sGenerate(vertices, indices, triangles_settings, segments, stats);
+	triangles_mode											&= stats.mSegmentCount == indices.size() && segments.size() == indices.size() * 2;
+	triangles_mode											&= segments[0] == indices[0] && segments[1] == indices[1] && segments[4] == indices[2] && segments[5] == indices[0];
+
+	// Grid: (n+1) * n edges per direction, plus n * n diagonals. Its edges span several blocks.
+	bool shared_grid										= indices.size() > 2 * kBlockEdgeCount;
+	sGenerate(vertices, indices, shared_settings, segments, stats);
+	uint64_t grid_edge_count								= 2ull * kGridSize * (kGridSize + 1) + kGridSize * kGridSize;
+	shared_grid												&= stats.mSegmentCount == grid_edge_count && stats.mUniqueEdgeCount == grid_edge_count && stats.mBoundaryEdgeCount == 4ull * kGridSize;
+	shared_grid												&= segment_edges(segments, unique) == reference_edges(indices) && unique;
+
+	bool shard_independent									= true;
+	for (uint32_t shard_count : { 1u, 7u, 256u })
+	{
+		std::vector<uint32_t> shard_segments;
+		Settings settings									= shared_settings;
+		settings.mShardCount								= shard_count;
+		sGenerate(vertices, indices, settings, shard_segments, stats);
+		shard_independent									&= shard_segments == segments; // Triangle order, regardless of shards
+	}
+
+	bool feature_flat										= true;
+	sGenerate(vertices, indices, feature_settings, segments, stats);
+	feature_flat											&= stats.mSegmentCount == 4ull * kGridSize;
+
+	bool feature_folded										= true;
+	grid(true, vertices, indices);
+	sGenerate(vertices, indices, feature_settings, segments, stats);
+	feature_folded											&= stats.mSegmentCount == 4ull * kGridSize + kGridSize; // Boundary and fold line
+	Settings wide_settings									= feature_settings;
+	wide_settings.mFeatureAngle								= 95.0f;
+	sGenerate(vertices, indices, wide_settings, segments, stats);
+	feature_folded											&= stats.mSegmentCount == 4ull * kGridSize;
+
+	// Closed cube, 8 vertices and 12 triangles: 18 edges, 12 of them along cube edges
+	bool closed_cube										= true;
+	{
+		std::vector<glm::vec3> cube_vertices;
+		for (uint32_t corner = 0; corner < 8; corner++)
+			cube_vertices.push_back(glm::vec3(static_cast<float>(corner & 1), static_cast<float>((corner >> 1) & 1), static_cast<float>((corner >> 2) & 1)));
+		std::vector<uint32_t> cube_indices					=
+		{
+			0, 2, 1,  1, 2, 3,		// -Z
+			4, 5, 6,  5, 7, 6,		// +Z
+			0, 1, 4,  1, 5, 4,		// -Y
+			2, 6, 3,  3, 6, 7,		// +Y
+			0, 4, 2,  2, 4, 6,		// -X
+			1, 3, 5,  3, 7, 5,		// +X
+		};
+		sGenerate(cube_vertices, cube_indices, shared_settings, segments, stats);
+		closed_cube											&= stats.mSegmentCount == 18 && stats.mBoundaryEdgeCount == 0 && stats.mNonManifoldEdgeCount == 0;
+		sGenerate(cube_vertices, cube_indices, feature_settings, segments, stats);
+		closed_cube											&= stats.mSegmentCount == 12;
+	}
+
+	// Repeated index in a triangle, and a fin on an edge shared by 3 triangles
+	bool degenerate_non_manifold							= true;
+	{
+		std::vector<glm::vec3> fin_vertices					= { glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1) };
+		std::vector<uint32_t> fin_indices					= { 0, 1, 2,  1, 0, 3,  0, 1, 4,  2, 2, 4 };
+		sGenerate(fin_vertices, fin_indices, shared_settings, segments, stats);
+		degenerate_non_manifold								&= stats.mNonManifoldEdgeCount == 1 && segment_edges(segments, unique) == reference_edges(fin_indices) && unique;
+		sGenerate(fin_vertices, fin_indices, feature_settings, segments, stats);
+		degenerate_non_manifold								&= segment_edges(segments, unique).contains(sEdgeKey(0, 1)) && unique;
+	}
+
+	bool edge_radii											= true;
+	{
+		std::vector<glm::vec3> radius_vertices				= { glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.1f, 0.0f, 0.0f), glm::vec3(11.1f, 0.0f, 0.0f) };
+		std::vector<uint32_t> radius_segments				= { 0, 1,  1, 2,  2, 3 };
+		std::vector<float> radii;
+		sEdgeRadii(radius_vertices, radius_segments, 2.0f, radii);
+		// Mean length 3.7
+		edge_radii											&= radii.size() == 3 && std::abs(radii[0] - 2.0f / 3.7f) < 1.0e-4f && radii[1] == 2.0f * kMinRadiusScale && radii[2] == 2.0f;
+	}
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "triangles mode matches triangle list",			triangles_mode },
+		{ "grid edges shared once",							shared_grid },
+		{ "output independent of shard count",				shard_independent },
+		{ "flat grid features are boundary",				feature_flat },
+		{ "folded grid features follow angle",				feature_folded },
+		{ "closed cube edges and features",					closed_cube },
+		{ "degenerate and non-manifold edges",				degenerate_non_manifold },
+		{ "edge radii scale and clamp",						edge_radii },
+	};
+
+	outMessage												= std::format("[LSSWireframe] Validate: {}x{} grid, {} edges\n", kGridSize, kGridSize, grid_edge_count);
+	return gReportValidateChecks(checks, outMessage);
+}
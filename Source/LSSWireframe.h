@@ -0,0 +1,58 @@
+#pragma once
+
+// Standard library and glm only, so edge extraction can be validated and benchmarked without a device
+#include "Thirdparty/glm.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Segments of LSS wireframe from a triangle list
+// Triangles mode emits 3 segments per triangle, so interior edges are stored twice. Other modes key edges by their sorted vertex pair,
+// hash them in parallel shards (by hash of key, so both occurrences of an edge land in same shard), and keep first occurrence of each.
+class LSSWireframe
+{
+public:
+	enum class Mode : uint8_t
+	{
+		Triangles,		// 3 segments per triangle, as triangle list
+		SharedEdges,	// Each edge once
+		FeatureEdges,	// Boundary, non-manifold, and edges with dihedral angle above Settings::mFeatureAngle
+
+		Count
+	};
+
+	struct Settings
+	{
+		Mode mMode												= Mode::SharedEdges;
+		float mFeatureAngle										= 30.0f;	// Degrees between triangle normals
+		bool mPerEdgeRadius										= false;	// Segments get own vertices, radius scaled by edge length, see sEdgeRadii
+		uint32_t mShardCount									= 64;		// Power of 2
+	};
+
+	struct Stats
+	{
+		uint64_t mTriangleCount									= 0;
+		uint64_t mSegmentCount									= 0;
+		uint64_t mUniqueEdgeCount								= 0;		// Without degenerate edges, 0 in Triangles mode
+		uint64_t mBoundaryEdgeCount								= 0;
+		uint64_t mNonManifoldEdgeCount							= 0;
+		float mGenerateMS										= 0.0f;
+
+		Stats& operator+=(const Stats& inOther);
+	};
+
+	// Key pass, shard histograms, scatter and compaction run on blocks of this many edges in parallel, dedupe on shards in parallel
+	static constexpr uint32_t kBlockEdgeCount					= 16384;
+
+	// inIndices are local to inVertices, outSegments are pairs of them (LSS list format). Stats of this call overwrite outStats.
+	static void sGenerate(std::span<const glm::vec3> inVertices, std::span<const uint32_t> inIndices, const Settings& inSettings, std::vector<uint32_t>& outSegments, Stats& outStats);
+
+	// Per segment inRadius scaled by edge length over mean edge length, clamped to [kMinRadiusScale, 1], so short edges in dense regions do not merge into blobs
+	static constexpr float kMinRadiusScale						= 0.25f;
+	static void sEdgeRadii(std::span<const glm::vec3> inVertices, std::span<const uint32_t> inSegments, float inRadius, std::vector<float>& outRadii);
+
+	// Checks edge counts of closed and open meshes against reference sets, feature angle on folded grid, shard independence and degenerate edges
+	static bool sValidate(std::string& outMessage);
+};
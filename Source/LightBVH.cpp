@@ -0,0 +1,523 @@
+#include "LightBVH.h"
+#include "Scene.h"
+
+static float sSafeSqrt(float inValue)
+{
+	return glm::sqrt(gMax(inValue, 0.0f));
+}
+
+// cos(max(0, a - b)) and sin(max(0, a - b)) from sin and cos of a, b
+static float sCosSubClamped(float inSinA, float inCosA, float inSinB, float inCosB)
+{
+	if (inCosA > inCosB)
+		return 1.0f;
+	return inCosA * inCosB + inSinA * inSinB;
+}
+
+static float sSinSubClamped(float inSinA, float inCosA, float inSinB, float inCosB)
+{
+	if (inCosA > inCosB)
+		return 0.0f;
+	return inSinA * inCosB - inCosA * inSinB;
+}
+
+float LightBVH::Bounds::Importance(float3 inPositionWS, float3 inNormalWS) const
+{
+	if (!IsValid())
+		return 0.0f;
+
+	float3 centroid							= Centroid();
+	float3 vector_from_light				= inPositionWS - centroid;
+	float distance_squared					= glm::dot(vector_from_light, vector_from_light);
+	float3 direction_from_light				= distance_squared > 0.0f ? vector_from_light / glm::sqrt(distance_squared) : mAxis;
+
+	// Bound angle subtended by bounds with its bounding sphere
+	float radius_squared					= glm::dot(mMax - centroid, mMax - centroid);
+	float cos_theta_b						= distance_squared < radius_squared ? -1.0f : sSafeSqrt(1.0f - radius_squared / distance_squared);
+	float sin_theta_b						= sSafeSqrt(1.0f - cos_theta_b * cos_theta_b);
+
+	// Avoid singularity when the point is close to the bounds, as [Pharr23]
+	distance_squared						= gMax(distance_squared, glm::length(mMax - mMin) * 0.5f);
+
+	float cos_theta_w						= glm::dot(mAxis, direction_from_light);
+	if (mTwoSided)
+		cos_theta_w							= glm::abs(cos_theta_w);
+	float sin_theta_w						= sSafeSqrt(1.0f - cos_theta_w * cos_theta_w);
+	float sin_theta_o						= sSafeSqrt(1.0f - mCosThetaO * mCosThetaO);
+
+	// Minimal angle between emission cone and direction to the point
+	float cos_theta_x						= sCosSubClamped(sin_theta_w, cos_theta_w, sin_theta_o, mCosThetaO);
+	float sin_theta_x						= sSinSubClamped(sin_theta_w, cos_theta_w, sin_theta_o, mCosThetaO);
+	float cos_theta_p						= sCosSubClamped(sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+	if (cos_theta_p <= mCosThetaE)
+		return 0.0f;
+
+	float importance						= mPower * cos_theta_p / distance_squared;
+
+	// Incident angle on the surface
+	if (inNormalWS != float3(0.0f))
+	{
+		float cos_theta_i					= glm::abs(glm::dot(direction_from_light, inNormalWS));
+		float sin_theta_i					= sSafeSqrt(1.0f - cos_theta_i * cos_theta_i);
+		importance							*= sCosSubClamped(sin_theta_i, cos_theta_i, sin_theta_b, cos_theta_b);
+	}
+
+	return gMax(importance, 0.0f);
+}
+
+LightBVH::Bounds LightBVH::Bounds::sUnion(const Bounds& inA, const Bounds& inB)
+{
+	if (!inA.IsValid())
+		return inB;
+	if (!inB.IsValid())
+		return inA;
+
+	Bounds bounds;
+	bounds.mMin								= glm::min(inA.mMin, inB.mMin);
+	bounds.mMax								= glm::max(inA.mMax, inB.mMax);
+	bounds.mCosThetaE						= gMin(inA.mCosThetaE, inB.mCosThetaE);
+	bounds.mPower							= inA.mPower + inB.mPower;
+	bounds.mTwoSided						= inA.mTwoSided || inB.mTwoSided;
+
+	// Bounding cone of two cones
+	bounds.mAxis							= inA.mAxis;
+	bounds.mCosThetaO						= -1.0f; // Entire sphere by default
+
+	float theta_a							= glm::acos(glm::clamp(inA.mCosThetaO, -1.0f, 1.0f));
+	float theta_b							= glm::acos(glm::clamp(inB.mCosThetaO, -1.0f, 1.0f));
+	float theta_d							= glm::acos(glm::clamp(glm::dot(inA.mAxis, inB.mAxis), -1.0f, 1.0f));
+	if (gMin(theta_d + theta_b, MATH_PI) <= theta_a)
+	{
+		bounds.mAxis						= inA.mAxis;
+		bounds.mCosThetaO					= inA.mCosThetaO;
+		return bounds;
+	}
+	if (gMin(theta_d + theta_a, MATH_PI) <= theta_b)
+	{
+		bounds.mAxis						= inB.mAxis;
+		bounds.mCosThetaO					= inB.mCosThetaO;
+		return bounds;
+	}
+
+	float theta_o							= (theta_a + theta_d + theta_b) * 0.5f;
+	float3 rotation_axis					= glm::cross(inA.mAxis, inB.mAxis);
+	if (theta_o >= MATH_PI || glm::dot(rotation_axis, rotation_axis) == 0.0f)
+		return bounds;
+
+	// Rotate axis of A toward B
+	float theta_r							= theta_o - theta_a;
+	bounds.mAxis							= glm::normalize(float3(glm::rotate(theta_r, glm::normalize(rotation_axis)) * float4(inA.mAxis, 0.0f)));
+	bounds.mCosThetaO						= glm::cos(theta_o);
+	return bounds;
+}
+
+// Surface area orientation heuristic, see LightBVHSampler::EvaluateCost in [Pharr23]
+static float sEvaluateCost(const LightBVH::Bounds& inBounds, const LightBVH::Bounds& inParentBounds, int inDimension)
+{
+	if (!inBounds.IsValid())
+		return 0.0f;
+
+	float theta_o							= glm::acos(glm::clamp(inBounds.mCosThetaO, -1.0f, 1.0f));
+	float theta_e							= glm::acos(glm::clamp(inBounds.mCosThetaE, -1.0f, 1.0f));
+	float theta_w							= gMin(theta_o + theta_e, MATH_PI);
+	float sin_theta_o						= sSafeSqrt(1.0f - inBounds.mCosThetaO * inBounds.mCosThetaO);
+	float m_omega							= 2.0f * MATH_PI * (1.0f - inBounds.mCosThetaO) +
+												MATH_PI / 2.0f * (2.0f * theta_w * sin_theta_o - glm::cos(theta_o - 2.0f * theta_w) - 2.0f * theta_o * sin_theta_o + inBounds.mCosThetaO);
+
+	float3 parent_diagonal					= inParentBounds.mMax - inParentBounds.mMin;
+	float k_r								= gMaxComponent(parent_diagonal) / parent_diagonal[inDimension];
+
+	float3 diagonal							= inBounds.mMax - inBounds.mMin;
+	float surface_area						= 2.0f * (diagonal.x * diagonal.y + diagonal.x * diagonal.z + diagonal.y * diagonal.z);
+
+	return inBounds.mPower * m_omega * k_r * surface_area;
+}
+
+void LightBVH::Build(const SceneContent& inSceneContent)
+{
+	Clear();
+
+	CPU_TIMING_SCOPE("LightBVH::Build", &mStats.mBuildMS);
+
+	uint light_count = static_cast<uint>(inSceneContent.mLights.size());
+	mEmitters.resize(light_count + inSceneContent.mEmissiveTriangleCount);
+
+	// Analytical lights
+	for (uint light_index = 0; light_index < light_count; light_index++)
+	{
+		const Light& light					= inSceneContent.mLights[light_index];
+		Emitter& emitter					= mEmitters[light_index];
+		emitter.mLightIndex					= light_index;
+		emitter.mInstanceIndex				= light.mInstanceID;
+
+		Bounds& bounds						= emitter.mBounds;
+		switch (light.mType)
+		{
+		case LightType::Sphere:
+		{
+			float radius					= light.mHalfExtends.x;
+			bounds.mMin						= light.mPosition - float3(radius);
+			bounds.mMax						= light.mPosition + float3(radius);
+			bounds.mCosThetaO				= -1.0f;	// Normals toward all directions
+			bounds.mCosThetaE				= 0.0f;		// Lambertian
+			bounds.mPower					= RGBToLuminance(light.mEmission) * 4.0f * MATH_PI * radius * radius * MATH_PI;
+		}
+		break;
+		case LightType::Rectangle:
+		{
+			float3 tangent					= light.mTangent * light.mHalfExtends.x;
+			float3 bitangent				= light.mBitangent * light.mHalfExtends.y;
+			for (float3 corner : { tangent + bitangent, tangent - bitangent, -tangent + bitangent, -tangent - bitangent })
+			{
+				bounds.mMin					= glm::min(bounds.mMin, light.mPosition + corner);
+				bounds.mMax					= glm::max(bounds.mMax, light.mPosition + corner);
+			}
+			bounds.mAxis					= light.mNormal;
+			bounds.mCosThetaO				= 1.0f;
+			bounds.mCosThetaE				= 0.0f;
+			bounds.mPower					= RGBToLuminance(light.mEmission) * 4.0f * light.mHalfExtends.x * light.mHalfExtends.y * MATH_PI;
+		}
+		break;
+		default: break;
+		}
+	}
+
+	// Emissive triangles, world space data is prepared in Scene::GenerateTriangleLights
+	// [NOTE] Emission texture is not taken into account, power might be overestimated
+	gAssert(inSceneContent.mTriangleLights.size() == inSceneContent.mEmissiveTriangleCount);
+	std::transform(std::execution::par, inSceneContent.mTriangleLights.begin(), inSceneContent.mTriangleLights.end(), mEmitters.begin() + light_count, [&](const SceneContent::TriangleLight& inTriangleLight)
+	{
+		Emitter emitter;
+		emitter.mInstanceIndex				= inTriangleLight.mInstanceIndex;
+		emitter.mTriangleIndex				= inTriangleLight.mPrimitiveIndex;
+
+		float3 cross_product				= glm::cross(inTriangleLight.mEdge1, inTriangleLight.mEdge2);
+		float cross_product_length			= glm::length(cross_product);
+		if (cross_product_length == 0.0f)
+			return emitter; // Degenerated, leave power as 0
+
+		bool two_sided						= inSceneContent.mInstanceDatas[inTriangleLight.mInstanceIndex].mFlags.mTwoSided != 0;
+		float3 base							= inTriangleLight.mBase;
+
+		Bounds& bounds						= emitter.mBounds;
+		bounds.mMin							= glm::min(glm::min(base, base + inTriangleLight.mEdge1), base + inTriangleLight.mEdge2);
+		bounds.mMax							= glm::max(glm::max(base, base + inTriangleLight.mEdge1), base + inTriangleLight.mEdge2);
+		bounds.mAxis						= cross_product / cross_product_length;
+		bounds.mCosThetaO					= 1.0f;
+		bounds.mCosThetaE					= 0.0f;
+		bounds.mPower						= RGBToLuminance(inTriangleLight.mRadiance) * cross_product_length * 0.5f * MATH_PI * (two_sided ? 2.0f : 1.0f);
+		bounds.mTwoSided					= two_sided;
+		return emitter;
+	});
+
+	std::erase_if(mEmitters, [](const Emitter& inEmitter) { return !inEmitter.mBounds.IsValid(); });
+
+	mStats.mEmitterCount = static_cast<uint>(mEmitters.size());
+	if (mEmitters.empty())
+		return;
+
+	mLeafEmitterIndices.resize(mEmitters.size());
+	std::iota(mLeafEmitterIndices.begin(), mLeafEmitterIndices.end(), 0u);
+	mEmitterBitTrails.resize(mEmitters.size());
+	mNodes.reserve(mEmitters.size() * 2 - 1);
+	BuildRecursive(mLeafEmitterIndices, 0, 0);
+
+	mStats.mNodeCount = static_cast<uint>(mNodes.size());
+	mStats.mNodeSizeInBytes = mNodes.size() * sizeof(Node) + mEmitterBitTrails.size() * sizeof(uint64_t) + mLeafEmitterIndices.size() * sizeof(uint);
+}
+
+uint LightBVH::BuildRecursive(std::span<uint> ioEmitterIndices, uint64_t inBitTrail, uint inDepth)
+{
+	gAssert(!ioEmitterIndices.empty());
+
+	mStats.mDepth = gMax(mStats.mDepth, inDepth + 1);
+
+	uint node_index = static_cast<uint>(mNodes.size());
+	mNodes.push_back({});
+
+	// [NOTE] Degenerated splits (e.g. many coincident emitters) may run out of bit trail, remaining emitters share one leaf then
+	if (ioEmitterIndices.size() == 1 || inDepth >= kMaxDepth)
+	{
+		Node& node							= mNodes[node_index];
+		node.mSecondChildOrEmitterOffset	= static_cast<uint>(ioEmitterIndices.data() - mLeafEmitterIndices.data());
+		node.mEmitterCount					= static_cast<uint>(ioEmitterIndices.size());
+		node.mLeaf							= true;
+
+		for (uint emitter_index : ioEmitterIndices)
+		{
+			node.mBounds					= Bounds::sUnion(node.mBounds, mEmitters[emitter_index].mBounds);
+			mEmitterBitTrails[emitter_index] = inBitTrail;
+		}
+		return node_index;
+	}
+
+	Bounds bounds;
+	float3 centroid_min						= float3(std::numeric_limits<float>::max());
+	float3 centroid_max						= float3(-std::numeric_limits<float>::max());
+	for (uint emitter_index : ioEmitterIndices)
+	{
+		const Bounds& emitter_bounds		= mEmitters[emitter_index].mBounds;
+		bounds								= Bounds::sUnion(bounds, emitter_bounds);
+		centroid_min						= glm::min(centroid_min, emitter_bounds.Centroid());
+		centroid_max						= glm::max(centroid_max, emitter_bounds.Centroid());
+	}
+
+	// Binned split
+	constexpr int kBucketCount				= 12;
+	auto get_bucket_index = [&](uint inEmitterIndex, int inDimension)
+	{
+		float ratio							= (mEmitters[inEmitterIndex].mBounds.Centroid()[inDimension] - centroid_min[inDimension]) / (centroid_max[inDimension] - centroid_min[inDimension]);
+		return glm::clamp(static_cast<int>(ratio * kBucketCount), 0, kBucketCount - 1);
+	};
+
+	float best_cost							= std::numeric_limits<float>::max();
+	int best_dimension						= -1;
+	int best_bucket							= -1;
+	for (int dimension = 0; dimension < 3; dimension++)
+	{
+		if (centroid_max[dimension] == centroid_min[dimension])
+			continue;
+
+		Bounds buckets[kBucketCount];
+		for (uint emitter_index : ioEmitterIndices)
+		{
+			Bounds& bucket					= buckets[get_bucket_index(emitter_index, dimension)];
+			bucket							= Bounds::sUnion(bucket, mEmitters[emitter_index].mBounds);
+		}
+
+		for (int split = 1; split < kBucketCount; split++)
+		{
+			Bounds below;
+			Bounds above;
+			for (int bucket_index = 0; bucket_index < split; bucket_index++)
+				below						= Bounds::sUnion(below, buckets[bucket_index]);
+			for (int bucket_index = split; bucket_index < kBucketCount; bucket_index++)
+				above						= Bounds::sUnion(above, buckets[bucket_index]);
+
+			float cost						= sEvaluateCost(below, bounds, dimension) + sEvaluateCost(above, bounds, dimension);
+			if (cost > 0.0f && cost < best_cost)
+			{
+				best_cost					= cost;
+				best_dimension				= dimension;
+				best_bucket					= split;
+			}
+		}
+	}
+
+	size_t middle = ioEmitterIndices.size() / 2;
+	if (best_dimension != -1)
+	{
+		auto iter = std::partition(ioEmitterIndices.begin(), ioEmitterIndices.end(), [&](uint inEmitterIndex) { return get_bucket_index(inEmitterIndex, best_dimension) < best_bucket; });
+		size_t partitioned_middle = static_cast<size_t>(iter - ioEmitterIndices.begin());
+		if (partitioned_middle != 0 && partitioned_middle != ioEmitterIndices.size())
+			middle = partitioned_middle;
+	}
+
+	BuildRecursive(ioEmitterIndices.subspan(0, middle), inBitTrail, inDepth + 1);
+	uint second_child_index = BuildRecursive(ioEmitterIndices.subspan(middle), inBitTrail | (1ull << inDepth), inDepth + 1);
+
+	Node& node								= mNodes[node_index];
+	node.mBounds							= bounds;
+	node.mSecondChildOrEmitterOffset		= second_child_index;
+	node.mLeaf								= false;
+	return node_index;
+}
+
+void LightBVH::Clear()
+{
+	mEmitters = {};
+	mNodes = {};
+	mEmitterBitTrails = {};
+	mLeafEmitterIndices = {};
+	mStats = {};
+}
+
+bool LightBVH::SampleEmitter(float3 inPositionWS, float3 inNormalWS, float inRandom01, Sample& outSample) const
+{
+	if (mNodes.empty())
+		return false;
+
+	float u = inRandom01;
+	float pmf = 1.0f;
+	uint node_index = 0;
+	while (true)
+	{
+		const Node& node = mNodes[node_index];
+		if (node.mLeaf)
+		{
+			if (node_index == 0 && node.mBounds.Importance(inPositionWS, inNormalWS) <= 0.0f)
+				return false;
+
+			uint emitter_offset = gMin(static_cast<uint>(u * node.mEmitterCount), node.mEmitterCount - 1);
+			outSample.mEmitterIndex = mLeafEmitterIndices[node.mSecondChildOrEmitterOffset + emitter_offset];
+			outSample.mPMF = pmf / node.mEmitterCount;
+			return true;
+		}
+
+		uint child_indices[2] = { node_index + 1, node.mSecondChildOrEmitterOffset };
+		float importances[2] = { mNodes[child_indices[0]].mBounds.Importance(inPositionWS, inNormalWS), mNodes[child_indices[1]].mBounds.Importance(inPositionWS, inNormalWS) };
+		float importance_sum = importances[0] + importances[1];
+		if (importance_sum <= 0.0f)
+			return false;
+
+		// Pick a child and remap random number for next level
+		float probability_first = importances[0] / importance_sum;
+		if (u < probability_first)
+		{
+			node_index = child_indices[0];
+			pmf *= probability_first;
+			u = gMin(u / probability_first, 0x1.fffffep-1f);
+		}
+		else
+		{
+			node_index = child_indices[1];
+			pmf *= 1.0f - probability_first;
+			u = gMin((u - probability_first) / (1.0f - probability_first), 0x1.fffffep-1f);
+		}
+	}
+}
+
+float LightBVH::PMF(float3 inPositionWS, float3 inNormalWS, uint inEmitterIndex) const
+{
+	if (mNodes.empty() || inEmitterIndex >= mEmitters.size())
+		return 0.0f;
+
+	uint64_t bit_trail = mEmitterBitTrails[inEmitterIndex];
+	float pmf = 1.0f;
+	uint node_index = 0;
+	while (!mNodes[node_index].mLeaf)
+	{
+		const Node& node = mNodes[node_index];
+		uint child_indices[2] = { node_index + 1, node.mSecondChildOrEmitterOffset };
+		float importances[2] = { mNodes[child_indices[0]].mBounds.Importance(inPositionWS, inNormalWS), mNodes[child_indices[1]].mBounds.Importance(inPositionWS, inNormalWS) };
+		float importance_sum = importances[0] + importances[1];
+		if (importance_sum <= 0.0f)
+			return 0.0f;
+
+		uint child = static_cast<uint>(bit_trail & 1);
+		pmf *= importances[child] / importance_sum;
+		node_index = child_indices[child];
+		bit_trail >>= 1;
+	}
+
+	const Node& leaf = mNodes[node_index];
+	gAssert(std::find(mLeafEmitterIndices.begin() + leaf.mSecondChildOrEmitterOffset, mLeafEmitterIndices.begin() + leaf.mSecondChildOrEmitterOffset + leaf.mEmitterCount, inEmitterIndex) != mLeafEmitterIndices.begin() + leaf.mSecondChildOrEmitterOffset + leaf.mEmitterCount);
+	return pmf / leaf.mEmitterCount;
+}
+
+void LightBVH::Evaluate(const SceneContent& inSceneContent, uint inShadingPointCount, uint inSampleCount)
+{
+	mStats.mShadingPointCount = 0;
+	mStats.mUniformVariance = 0.0f;
+	mStats.mBVHVariance = 0.0f;
+
+	if (mEmitters.empty() || inShadingPointCount == 0 || inSampleCount == 0)
+		return;
+
+	CPU_TIMING_SCOPE("LightBVH::Evaluate", &mStats.mEvaluateMS);
+
+	// Shading points on non-emissive triangles
+	std::vector<uint> receiver_instance_indices;
+	for (uint instance_index = 0; instance_index < inSceneContent.mInstanceDatas.size(); instance_index++)
+	{
+		const InstanceData& instance_data = inSceneContent.mInstanceDatas[instance_index];
+		if (instance_data.mIndexCount >= kIndexCountPerTriangle && gMaxComponent(instance_data.mEmission) == 0.0f)
+			receiver_instance_indices.push_back(instance_index);
+	}
+	if (receiver_instance_indices.empty())
+		return;
+
+	// Unshadowed contribution with emitter as point light at its centroid
+	auto contribution = [&](const Emitter& inEmitter, float3 inPositionWS, float3 inNormalWS)
+	{
+		float3 vector_to_light				= inEmitter.mBounds.Centroid() - inPositionWS;
+		float distance_squared				= gMax(glm::dot(vector_to_light, vector_to_light), 1.0e-4f);
+		float3 direction_to_light			= vector_to_light / glm::sqrt(distance_squared);
+		float cos_surface					= gMax(glm::dot(inNormalWS, direction_to_light), 0.0f);
+		float cos_light						= glm::dot(inEmitter.mBounds.mAxis, -direction_to_light);
+		if (inEmitter.mBounds.mCosThetaO <= -1.0f)
+			cos_light						= 1.0f;
+		else if (inEmitter.mBounds.mTwoSided)
+			cos_light						= glm::abs(cos_light);
+		return inEmitter.mBounds.mPower * cos_surface * gMax(cos_light, 0.0f) / distance_squared;
+	};
+
+	struct Result
+	{
+		bool mValid = false;
+		float mUniformVariance = 0.0f;
+		float mBVHVariance = 0.0f;
+	};
+	std::vector<Result> results(inShadingPointCount);
+
+	auto shading_point_range = std::views::iota(0u, inShadingPointCount);
+	std::for_each(std::execution::par, shading_point_range.begin(), shading_point_range.end(), [&](uint inShadingPointIndex)
+	{
+		std::mt19937 engine(inShadingPointIndex);
+		std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+		const InstanceData& instance_data	= inSceneContent.mInstanceDatas[receiver_instance_indices[engine() % receiver_instance_indices.size()]];
+		uint triangle_index					= engine() % (instance_data.mIndexCount / kIndexCountPerTriangle);
+		float3 positions[kIndexCountPerTriangle];
+		for (uint i = 0; i < kIndexCountPerTriangle; i++)
+		{
+			IndexType index					= inSceneContent.mIndices[instance_data.mIndexOffset + triangle_index * kIndexCountPerTriangle + i];
+			positions[i]					= float3(instance_data.mTransform * float4(inSceneContent.mVertices[instance_data.mVertexOffset + index], 1.0f));
+		}
+
+		float3 cross_product				= glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+		if (glm::dot(cross_product, cross_product) == 0.0f)
+			return;
+
+		float xi1							= glm::sqrt(distribution(engine));
+		float xi2							= distribution(engine);
+		float3 position						= positions[0] * (1.0f - xi1) + positions[1] * (xi1 * (1.0f - xi2)) + positions[2] * (xi1 * xi2);
+		float3 normal						= glm::normalize(cross_product);
+
+		// Reference
+		float reference						= 0.0f;
+		for (const Emitter& emitter : mEmitters)
+			reference						+= contribution(emitter, position, normal);
+		if (reference <= 0.0f)
+			return;
+
+		// Relative variance of one-sample estimators
+		double uniform_variance				= 0.0;
+		double bvh_variance					= 0.0;
+		for (uint sample_index = 0; sample_index < inSampleCount; sample_index++)
+		{
+			uint uniform_emitter_index		= gMin(static_cast<uint>(distribution(engine) * static_cast<float>(mEmitters.size())), static_cast<uint>(mEmitters.size() - 1));
+			float uniform_estimate			= contribution(mEmitters[uniform_emitter_index], position, normal) * static_cast<float>(mEmitters.size());
+			uniform_variance				+= glm::pow(uniform_estimate / reference - 1.0f, 2.0f);
+
+			Sample sample;
+			float bvh_estimate				= 0.0f;
+			if (SampleEmitter(position, normal, distribution(engine), sample) && sample.mPMF > 0.0f)
+				bvh_estimate				= contribution(mEmitters[sample.mEmitterIndex], position, normal) / sample.mPMF;
+			bvh_variance					+= glm::pow(bvh_estimate / reference - 1.0f, 2.0f);
+		}
+
+		results[inShadingPointIndex]		= { true, static_cast<float>(uniform_variance / inSampleCount), static_cast<float>(bvh_variance / inSampleCount) };
+	});
+
+	for (const Result& result : results)
+	{
+		if (!result.mValid)
+			continue;
+
+		mStats.mShadingPointCount++;
+		mStats.mUniformVariance += result.mUniformVariance;
+		mStats.mBVHVariance += result.mBVHVariance;
+	}
+
+	if (mStats.mShadingPointCount > 0)
+	{
+		mStats.mUniformVariance /= mStats.mShadingPointCount;
+		mStats.mBVHVariance /= mStats.mShadingPointCount;
+	}
+
+	std::string message = std::format("[LightBVH] {} emitters, {} nodes ({:.2f} KB), built in {:.2f} ms. Relative variance over {} points: uniform {:.4f}, bvh {:.4f} ({:.2f}x)\n",
+		mStats.mEmitterCount, mStats.mNodeCount, mStats.mNodeSizeInBytes / 1024.0f, mStats.mBuildMS,
+		mStats.mShadingPointCount, mStats.mUniformVariance, mStats.mBVHVariance, mStats.mBVHVariance > 0.0f ? mStats.mUniformVariance / mStats.mBVHVariance : 0.0f);
+	gTrace(message);
+}
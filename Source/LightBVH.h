@@ -0,0 +1,96 @@
+#pragma once
+#include "Common.h"
+
+// Light BVH for many-light importance sampling
+// [Conty18] Importance Sampling of Many Lights With Adaptive Tree Splitting
+// [Pharr23] Physically Based Rendering 4th, 12.6.3 BVH Light Sampling
+
+struct SceneContent;
+
+class LightBVH
+{
+public:
+	// Spatial and directional bounds of emitted power
+	struct Bounds
+	{
+		float3 mMin												= float3(std::numeric_limits<float>::max());
+		float3 mMax												= float3(-std::numeric_limits<float>::max());
+		float3 mAxis											= float3(0.0f, 0.0f, 1.0f);
+		float mCosThetaO										= 1.0f;		// Spread of normals around mAxis
+		float mCosThetaE										= 1.0f;		// Spread of emission around normals
+		float mPower											= 0.0f;
+		bool mTwoSided											= false;
+
+		bool IsValid() const									{ return mPower > 0.0f; }
+		float3 Centroid() const									{ return (mMin + mMax) * 0.5f; }
+		float Importance(float3 inPositionWS, float3 inNormalWS) const;
+
+		static Bounds sUnion(const Bounds& inA, const Bounds& inB);
+	};
+
+	// Either a Light in SceneContent::mLights or a SceneContent::TriangleLight in SceneContent::mTriangleLights
+	struct Emitter
+	{
+		static constexpr uint kInvalidIndex						= 0xFFFFFFFF;
+
+		Bounds mBounds;
+		uint mLightIndex										= kInvalidIndex;
+		uint mInstanceIndex										= kInvalidIndex;
+		uint mTriangleIndex										= kInvalidIndex;	// Within instance
+	};
+
+	// Depth-first layout, first child is next to its parent
+	struct Node
+	{
+		Bounds mBounds;
+		uint mSecondChildOrEmitterOffset						= 0;		// Leaf: into mLeafEmitterIndices
+		uint mEmitterCount										= 0;		// Leaf: more than one only when forced at kMaxDepth, picked uniformly
+		bool mLeaf												= false;
+	};
+
+	static constexpr uint kMaxDepth								= 63;		// Bit trail has one bit per split, split at depth d sets bit d
+
+	struct Sample
+	{
+		uint mEmitterIndex										= Emitter::kInvalidIndex;
+		float mPMF												= 0.0f;
+	};
+
+	struct Stats
+	{
+		float mBuildMS											= 0.0f;
+		uint mEmitterCount										= 0;
+		uint mNodeCount											= 0;
+		uint mDepth												= 0;
+		uint64_t mNodeSizeInBytes								= 0;
+
+		// Filled by Evaluate()
+		float mEvaluateMS										= 0.0f;
+		uint mShadingPointCount									= 0;
+		float mUniformVariance									= 0.0f;
+		float mBVHVariance										= 0.0f;
+	};
+
+	void Build(const SceneContent& inSceneContent);
+	void Clear();
+
+	bool SampleEmitter(float3 inPositionWS, float3 inNormalWS, float inRandom01, Sample& outSample) const;
+	float PMF(float3 inPositionWS, float3 inNormalWS, uint inEmitterIndex) const;
+
+	// Compare variance of unshadowed direct lighting estimated with BVH selection against uniform selection, on points picked from scene geometry
+	void Evaluate(const SceneContent& inSceneContent, uint inShadingPointCount, uint inSampleCount);
+
+	bool Empty() const											{ return mNodes.empty(); }
+	const std::vector<Emitter>& GetEmitters() const				{ return mEmitters; }
+	const Stats& GetStats() const								{ return mStats; }
+
+private:
+	uint BuildRecursive(std::span<uint> ioEmitterIndices, uint64_t inBitTrail, uint inDepth);
+
+	std::vector<Emitter> mEmitters;
+	std::vector<Node> mNodes;
+	std::vector<uint64_t> mEmitterBitTrails;					// Path from root to leaf of each emitter, 0 -> first child, 1 -> second child
+	std::vector<uint> mLeafEmitterIndices;						// Emitters ordered by leaf
+
+	Stats mStats;
+};
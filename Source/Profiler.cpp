@@ -0,0 +1,328 @@
+#include "Profiler.h"
+
+#include "Validate.h"
+
+#include <format>
+#include <fstream>
+#include <thread>
+
+Profiler gProfiler;
+
+Profiler::ThreadRing& Profiler::GetThreadRing()
+{
+	// Returns the ring to its profiler when the thread exits
+	struct RingOwner
+	{
+		~RingOwner()
+		{
+			if (mRing != nullptr)
+				mProfiler->ReleaseThreadRing(*mRing);
+		}
+
+		Profiler* mProfiler									= nullptr;
+		ThreadRing* mRing									= nullptr;
+	};
+	thread_local RingOwner sOwner;
+	if (sOwner.mRing != nullptr)
+		return *sOwner.mRing;
+
+	std::lock_guard lock(mMutex);
+	ThreadRing* ring										= nullptr;
+	for (const std::unique_ptr<ThreadRing>& released_ring : mRings)
+		if (released_ring->mReleased)
+		{
+			ring											= released_ring.get();
+			break;
+		}
+	if (ring == nullptr)
+	{
+		mRings.push_back(std::make_unique<ThreadRing>());
+		ring												= mRings.back().get();
+		ring->mThreadIndex									= static_cast<uint32_t>(mRings.size() - 1);
+	}
+	// Writer of a released ring has exited, so events of the previous thread can be dropped
+	ring->mReleased											= false;
+	ring->mWriteCount.store(0, std::memory_order_relaxed);
+	ring->mClearCount.store(0, std::memory_order_relaxed);
+	ring->mThreadName										= std::format("Thread {}", ring->mThreadIndex);
+
+	sOwner.mProfiler										= this;
+	sOwner.mRing											= ring;
+	return *ring;
+}
+
+void Profiler::ReleaseThreadRing(ThreadRing& ioRing)
+{
+	std::lock_guard lock(mMutex);
+	ioRing.mReleased										= true;
+}
+
+void Profiler::sWrite(ThreadRing& ioRing, const Event& inEvent)
+{
+	uint64_t write_count									= ioRing.mWriteCount.load(std::memory_order_relaxed);
+	ioRing.mEvents[write_count % kRingSize]					= inEvent;
+	ioRing.mWriteCount.store(write_count + 1, std::memory_order_release);
+}
+
+uint64_t Profiler::sGetFirstIndex(const ThreadRing& inRing, uint64_t inWriteCount)
+{
+	return std::max(inRing.mClearCount.load(std::memory_order_acquire), inWriteCount > kRingSize ? inWriteCount - kRingSize : 0);
+}
+
+bool Profiler::sRead(const ThreadRing& inRing, uint64_t inIndex, Event& outEvent)
+{
+	outEvent												= inRing.mEvents[inIndex % kRingSize];
+
+	// Once mWriteCount reaches inIndex + kRingSize, the owner may be overwriting the slot with a newer event
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return inRing.mWriteCount.load(std::memory_order_relaxed) < inIndex + kRingSize;
+}
+
+void Profiler::SetThreadName(std::string_view inName)
+{
+	ThreadRing& ring										= GetThreadRing();
+	std::lock_guard lock(mMutex);
+	ring.mThreadName										= inName;
+}
+
+const char* Profiler::Intern(std::string_view inName)
+{
+	std::lock_guard lock(mMutex);
+	return mInternedNames.emplace(inName).first->c_str();
+}
+
+void Profiler::RecordScope(const char* inName, std::chrono::steady_clock::time_point inBegin, std::chrono::steady_clock::time_point inEnd)
+{
+	if (!IsEnabled())
+		return;
+
+	ThreadRing& ring										= GetThreadRing();
+	Event event;
+	event.mName												= inName;
+	event.mBeginNS											= ToNS(inBegin);
+	event.mDurationNS										= std::chrono::duration_cast<std::chrono::nanoseconds>(inEnd - inBegin).count();
+	sWrite(ring, event);
+}
+
+void Profiler::RecordCounter(const char* inName, double inValue)
+{
+	if (!IsEnabled())
+		return;
+
+	ThreadRing& ring										= GetThreadRing();
+	Event event;
+	event.mName												= inName;
+	event.mBeginNS											= ToNS(std::chrono::steady_clock::now());
+	event.mValue											= inValue;
+	event.mType												= EventType::Counter;
+	sWrite(ring, event);
+}
+
+static std::string sEscapeJSON(std::string_view inText)
+{
+	std::string escaped;
+	escaped.reserve(inText.size());
+	for (char c : inText)
+	{
+		switch (c)
+		{
+		case '"':	escaped += "\\\""; break;
+		case '\\':	escaped += "\\\\"; break;
+		case '\n':	escaped += "\\n"; break;
+		case '\t':	escaped += "\\t"; break;
+		default:	escaped += static_cast<unsigned char>(c) < 0x20 ? ' ' : c; break;
+		}
+	}
+	return escaped;
+}
+
+bool Profiler::WriteChromeTrace(const std::filesystem::path& inPath) const
+{
+	std::ofstream file(inPath);
+	if (!file)
+		return false;
+
+	// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first												= true;
+	auto separator											= [&]() { file << (first ? "" : ",\n"); first = false; };
+
+	std::lock_guard lock(mMutex);
+	for (const std::unique_ptr<ThreadRing>& ring : mRings)
+	{
+		separator();
+		file << std::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"{}"}}}})", ring->mThreadIndex, sEscapeJSON(ring->mThreadName));
+
+		uint64_t write_count								= ring->mWriteCount.load(std::memory_order_acquire);
+		for (uint64_t index = sGetFirstIndex(*ring, write_count); index < write_count; index++)
+		{
+			Event event;
+			if (!sRead(*ring, index, event) || event.mName == nullptr)
+				continue;
+
+			separator();
+			std::string name								= sEscapeJSON(event.mName);
+			double timestamp_us								= event.mBeginNS / 1000.0;
+			if (event.mType == EventType::Scope)
+				file << std::format(R"({{"name":"{}","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f}}})", name, ring->mThreadIndex, timestamp_us, event.mDurationNS / 1000.0);
+			else
+				file << std::format(R"({{"name":"{}","ph":"C","pid":0,"tid":{},"ts":{:.3f},"args":{{"value":{}}}}})", name, ring->mThreadIndex, timestamp_us, event.mValue);
+		}
+	}
+	file << "\n]}\n";
+	return true;
+}
+
+void Profiler::Clear()
+{
+	std::lock_guard lock(mMutex);
+	for (const std::unique_ptr<ThreadRing>& ring : mRings)
+		ring->mClearCount.store(ring->mWriteCount.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+uint64_t Profiler::GetRecordedCount() const
+{
+	std::lock_guard lock(mMutex);
+	uint64_t count											= 0;
+	for (const std::unique_ptr<ThreadRing>& ring : mRings)
+	{
+		uint64_t write_count								= ring->mWriteCount.load(std::memory_order_acquire);
+		count												+= write_count - sGetFirstIndex(*ring, write_count);
+	}
+	return count;
+}
+
+uint32_t Profiler::GetThreadCount() const
+{
+	std::lock_guard lock(mMutex);
+	return static_cast<uint32_t>(mRings.size());
+}
+
+Profiler::BenchmarkResult Profiler::sBenchmark(uint32_t inIterationCount)
+{
+	bool was_enabled										= gProfiler.IsEnabled();
+	BenchmarkResult result;
+	result.mIterationCount									= inIterationCount;
+	result.mThreadCount										= std::max(std::thread::hardware_concurrency(), 1u);
+
+	// Two nested scopes per iteration as in instrumented code
+	auto run_scopes											= [inIterationCount]()
+	{
+		for (uint32_t i = 0; i < inIterationCount; i++)
+		{
+			PROFILE_SCOPE("Profiler::Benchmark::Outer");
+			PROFILE_SCOPE("Profiler::Benchmark::Inner");
+		}
+	};
+	auto ns_per_scope										= [inIterationCount](auto inFunction)
+	{
+		auto begin											= std::chrono::steady_clock::now();
+		inFunction();
+		std::chrono::duration<double, std::nano> duration	= std::chrono::steady_clock::now() - begin;
+		return static_cast<float>(duration.count() / (inIterationCount * 2.0));
+	};
+
+	gProfiler.SetEnabled(false);
+	result.mDisabledNS										= ns_per_scope(run_scopes);
+
+	gProfiler.SetEnabled(true);
+	result.mEnabledNS										= ns_per_scope(run_scopes);
+
+	result.mEnabledContendedNS								= ns_per_scope([&]()
+	{
+		std::vector<std::thread> threads;
+		for (uint32_t i = 0; i < result.mThreadCount; i++)
+			threads.emplace_back([&]() { gProfiler.SetThreadName("Profiler::Benchmark"); run_scopes(); });
+		for (std::thread& thread : threads)
+			thread.join();
+	});
+
+	result.mCounterNS										= ns_per_scope([inIterationCount]()
+	{
+		for (uint32_t i = 0; i < inIterationCount * 2; i++)
+			PROFILE_COUNTER("Profiler::Benchmark::Counter", i);
+	});
+
+	gProfiler.Clear();
+	gProfiler.SetEnabled(was_enabled);
+	return result;
+}
+
+bool Profiler::sValidate(std::string& outMessage)
+{
+	auto write												= [](ThreadRing& ioRing, uint64_t inCount)
+	{
+		for (uint64_t i = 0; i < inCount; i++)
+		{
+			Event event;
+			event.mName										= "Profiler::Validate";
+			event.mValue									= static_cast<double>(ioRing.mWriteCount.load(std::memory_order_relaxed));
+			event.mType										= EventType::Counter;
+			sWrite(ioRing, event);
+		}
+	};
+	auto live_count											= [](const ThreadRing& inRing)
+	{
+		uint64_t write_count								= inRing.mWriteCount.load(std::memory_order_relaxed);
+		return write_count - sGetFirstIndex(inRing, write_count);
+	};
+
+	// Ring of a single thread, as each thread owns one
+	ThreadRing ring;
+	write(ring, 5);
+	bool recorded											= live_count(ring) == 5;
+
+	// Clear only moves mClearCount, mWriteCount stays with its owner
+	ring.mClearCount.store(ring.mWriteCount.load());
+	bool cleared											= live_count(ring) == 0;
+	write(ring, 2);
+	bool recorded_after_clear								= live_count(ring) == 2;
+
+	// Wrap keeps the newest kRingSize events, with one more written the oldest slots may be mid overwrite
+	write(ring, kRingSize);
+	uint64_t first_index									= sGetFirstIndex(ring, ring.mWriteCount.load());
+	bool wrapped											= live_count(ring) == kRingSize;
+	write(ring, 1);
+	Event event;
+	bool overwritten_skipped								= !sRead(ring, first_index, event) && !sRead(ring, first_index + 1, event);
+	bool newest_read										= sRead(ring, first_index + 2, event) && event.mValue == static_cast<double>(first_index + 2);
+
+	// Ring of an exited thread is reused and reset by the next one
+	bool was_enabled										= gProfiler.IsEnabled();
+	gProfiler.SetEnabled(true);
+	auto record_on_thread									= [](uint32_t inCount) { std::thread([inCount]() { for (uint32_t i = 0; i < inCount; i++) PROFILE_COUNTER("Profiler::Validate", i); }).join(); };
+	record_on_thread(kRingSize + 1);
+	uint32_t thread_count									= gProfiler.GetThreadCount();
+	uint64_t recorded_count									= gProfiler.GetRecordedCount();
+	record_on_thread(1);
+	bool ring_reused										= gProfiler.GetThreadCount() == thread_count;
+	bool reused_ring_reset									= gProfiler.GetRecordedCount() <= recorded_count - kRingSize + 1;
+
+	// Clear races with a recording thread, events written before it must not come back
+	std::atomic<bool> stop									= false;
+	std::thread recorder([&]() { while (!stop.load()) PROFILE_COUNTER("Profiler::Validate", 0); });
+	for (uint32_t i = 0; i < 1000; i++)
+		gProfiler.Clear();
+	stop.store(true);
+	recorder.join();
+	uint64_t count_after_race								= gProfiler.GetRecordedCount();
+	gProfiler.Clear();
+	bool cleared_while_recording							= gProfiler.GetRecordedCount() == 0 && count_after_race <= kRingSize;
+	gProfiler.SetEnabled(was_enabled);
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "events recorded",								recorded },
+		{ "clear drops events",								cleared },
+		{ "events recorded after clear",					recorded_after_clear },
+		{ "wrap keeps newest ring size",					wrapped },
+		{ "slots being overwritten skipped",				overwritten_skipped },
+		{ "newest events read",								newest_read },
+		{ "ring of exited thread reused",					ring_reused },
+		{ "reused ring reset",								reused_ring_reset },
+		{ "clear while recording",							cleared_while_recording },
+	};
+
+	outMessage												= std::format("[Profiler] Validate: ring of {} events, {} threads, {} events before reuse\n", kRingSize, thread_count, recorded_count);
+	return gReportValidateChecks(checks, outMessage);
+}
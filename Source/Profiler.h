@@ -0,0 +1,138 @@
+#pragma once
+
+// Standard library only, so tools and the CPU batch backend can use it without Windows headers
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Hierarchical CPU profiler with nested scopes and counters, exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+// Nesting is implied by timestamps of scopes on the same thread, as in the trace format
+// Each thread records into its own ring without locking, oldest events are overwritten once a ring wraps
+// Rings of exited threads keep their events for export until a thread started later reuses them, so short lived workers don't grow memory
+class Profiler
+{
+public:
+	static constexpr uint32_t kRingSize						= 1 << 14;	// Events per thread
+
+	enum class EventType : uint8_t
+	{
+		Scope,
+		Counter,
+	};
+
+	struct Event
+	{
+		const char* mName									= nullptr;	// String literal or from Intern()
+		int64_t mBeginNS									= 0;		// Since mOrigin
+		int64_t mDurationNS									= 0;
+		double mValue										= 0.0;		// Counter only
+		EventType mType										= EventType::Scope;
+	};
+
+	struct ThreadRing
+	{
+		uint32_t mThreadIndex								= 0;
+		std::string mThreadName;
+		std::unique_ptr<Event[]> mEvents					= std::make_unique<Event[]>(kRingSize);
+		std::atomic<uint64_t> mWriteCount					= 0;		// Written by owner thread only, or on reuse once it exited
+		std::atomic<uint64_t> mClearCount					= 0;		// mWriteCount at last Clear(), events before it are not exported
+		bool mReleased										= false;	// Owner thread exited, guarded by mMutex
+	};
+
+	// RAII scope, costs one relaxed load when disabled
+	class Scope
+	{
+	public:
+		explicit Scope(const char* inName);
+		~Scope();
+
+	private:
+		const char* mName									= nullptr;
+		ThreadRing* mRing									= nullptr;
+		std::chrono::steady_clock::time_point mBegin;
+	};
+
+	struct BenchmarkResult
+	{
+		uint32_t mIterationCount							= 0;
+		uint32_t mThreadCount								= 0;
+		float mDisabledNS									= 0.0f;		// Per scope
+		float mEnabledNS									= 0.0f;		// Per scope, single thread
+		float mEnabledContendedNS							= 0.0f;		// Per scope of wall time, mThreadCount threads recording at once
+		float mCounterNS									= 0.0f;		// Per counter
+	};
+
+	bool IsEnabled() const									{ return mEnabled.load(std::memory_order_relaxed); }
+	void SetEnabled(bool inEnabled)							{ mEnabled.store(inEnabled, std::memory_order_relaxed); }
+
+	void SetThreadName(std::string_view inName);
+	const char* Intern(std::string_view inName);			// Stable pointer for names built at runtime
+
+	void RecordScope(const char* inName, std::chrono::steady_clock::time_point inBegin, std::chrono::steady_clock::time_point inEnd);
+	void RecordCounter(const char* inName, double inValue);
+
+	// Events overwritten by their thread during export are skipped
+	bool WriteChromeTrace(const std::filesystem::path& inPath) const;
+	void Clear();											// Safe while threads record, as it only moves mClearCount
+
+	uint64_t GetRecordedCount() const;
+	uint32_t GetThreadCount() const;
+
+	// Measures per scope overhead disabled / enabled / enabled on all hardware threads, clears recorded events
+	static BenchmarkResult sBenchmark(uint32_t inIterationCount);
+
+	// Ring wrap, clear while recording, skip of overwritten events and reuse of rings of exited threads
+	static bool sValidate(std::string& outMessage);
+
+private:
+	ThreadRing& GetThreadRing();
+	void ReleaseThreadRing(ThreadRing& ioRing);
+	int64_t ToNS(std::chrono::steady_clock::time_point inTime) const { return std::chrono::duration_cast<std::chrono::nanoseconds>(inTime - mOrigin).count(); }
+	static void sWrite(ThreadRing& ioRing, const Event& inEvent);
+	static uint64_t sGetFirstIndex(const ThreadRing& inRing, uint64_t inWriteCount);
+	static bool sRead(const ThreadRing& inRing, uint64_t inIndex, Event& outEvent);
+
+	std::atomic<bool> mEnabled								= true;
+	std::chrono::steady_clock::time_point mOrigin			= std::chrono::steady_clock::now();
+
+	mutable std::mutex mMutex;								// Guards registration of rings and interned names, not recording
+	std::vector<std::unique_ptr<ThreadRing>> mRings;		// Outlive their threads so exited workers still export, released ones are reused
+	std::unordered_set<std::string> mInternedNames;
+};
+extern Profiler gProfiler;
+
+inline Profiler::Scope::Scope(const char* inName)
+{
+	if (!gProfiler.IsEnabled())
+		return;
+
+	mName													= inName;
+	mRing													= &gProfiler.GetThreadRing();
+	mBegin													= std::chrono::steady_clock::now();
+}
+
+inline Profiler::Scope::~Scope()
+{
+	if (mRing == nullptr)
+		return;
+
+	auto end												= std::chrono::steady_clock::now();
+
+	Event event;
+	event.mName												= mName;
+	event.mBeginNS											= gProfiler.ToNS(mBegin);
+	event.mDurationNS										= std::chrono::duration_cast<std::chrono::nanoseconds>(end - mBegin).count();
+	sWrite(*mRing, event);
+}
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(inName) Profiler::Scope PROFILER_CONCAT(profiler_scope_, __LINE__)(inName)
+#define PROFILE_COUNTER(inName, inValue) do { if (gProfiler.IsEnabled()) gProfiler.RecordCounter(inName, static_cast<double>(inValue)); } while (0)
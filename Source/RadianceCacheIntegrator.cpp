@@ -0,0 +1,260 @@
+#include "RadianceCacheIntegrator.h"
+#include "Scene.h"
+
+#include "RayCaster.h"
+
+#include "../Shader/RadianceCache.h"
+
+RadianceCacheIntegrator gRadianceCacheIntegrator;
+
+struct PathVertex
+{
+	SpatialCacheModel::CellKey mKey;
+	RadianceCache::Vertex mVertex							= {};
+};
+
+struct Path
+{
+	float3 mEmission										= float3(0.0f);
+	bool mTerminated										= false;
+	uint mVertexCount										= 0;
+	PathVertex mVertices[RadianceCache::kVertexCountMax];
+};
+
+struct Tracer
+{
+	const SceneContent& mSceneContent;
+	const RayCaster& mRayCaster;
+	const RadianceCacheIntegrator::Settings& mSettings;
+	float3 mCameraPositionWS								= float3(0.0f);
+	float mEmissionScale									= 1.0f;
+
+	// Cache to terminate into, nullptr -> uncached
+	const SpatialCacheModel::Table* mTable					= nullptr;
+	const std::vector<float4>* mResolved					= nullptr;
+
+	// Same structure as RayQueryCS, without NEE
+	Path Trace(RayCaster::Hit inPrimaryHit, std::mt19937& ioRandomEngine) const
+	{
+		std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+
+		Path path;
+		float3 throughput									= float3(1.0f);
+		RayCaster::Hit hit									= inPrimaryHit;
+		for (uint recursion_depth = 0; hit.mValid; recursion_depth++)
+		{
+			const InstanceData& instance_data				= mSceneContent.mInstanceDatas[hit.mInstanceIndex];
+			float3 emission									= instance_data.mEmission * mEmissionScale;
+			if (instance_data.mBSDF == BSDF::Light)
+			{
+				path.mEmission								+= throughput * emission;
+				break;
+			}
+
+			if (mTable != nullptr)
+			{
+				SpatialCacheModel::CellKey key				= SpatialCacheModel::CellKey::sGenerate(hit.mPositionWS, hit.mNormalWS, mCameraPositionWS, mSettings.mCache);
+				if (recursion_depth > 0)
+				{
+					uint cell_index							= mTable->Find(key);
+					if (cell_index != SpatialCacheModel::Table::kInvalidCellIndex && RadianceCache::IsConverged((*mResolved)[cell_index], mSettings.mCache.mConstants))
+					{
+						path.mEmission						+= throughput * float3((*mResolved)[cell_index]);
+						path.mTerminated					= true;
+						break;
+					}
+				}
+
+				if (path.mVertexCount < RadianceCache::kVertexCountMax)
+				{
+					PathVertex& vertex						= path.mVertices[path.mVertexCount++];
+					vertex.mKey								= key;
+					vertex.mVertex.mThroughput				= throughput;
+					vertex.mVertex.mEmission				= path.mEmission;
+				}
+			}
+
+			path.mEmission									+= throughput * emission;
+
+			if (recursion_depth + 1 > mSettings.mRecursionDepthCountMax)
+				break;
+
+			// Diffuse, cosine term and PDF cancel out
+			throughput										*= instance_data.mAlbedo;
+			if (gMaxComponent(throughput) <= 0.0f)
+				break;
+
+			float3 direction								= RayCaster::sSampleCosineHemisphere(hit.mNormalWS, float2(random01(ioRandomEngine), random01(ioRandomEngine)));
+			hit												= mRayCaster.Intersect(hit.mPositionWS + hit.mNormalWS * 1.0e-4f, direction);
+		}
+		return path;
+	}
+};
+
+RadianceCacheIntegrator::Settings RadianceCacheIntegrator::Settings::sFromConstants()
+{
+	Settings settings;
+	settings.mRecursionDepthCountMax						= gConstants.mRecursionDepthCountMax;
+	settings.mCache											= SpatialCacheModel::Settings::sFromConstants();
+	settings.mCache.mUseNormal								= true; // As RayQueryCS
+	return settings;
+}
+
+void RadianceCacheIntegrator::Run(const SceneContent& inSceneContent, const Settings& inSettings)
+{
+	for (Result& result : mResults)
+		result												= {};
+	mReferenceMS											= 0.0f;
+
+	RayCaster ray_caster;
+	ray_caster.Build(inSceneContent);
+	if (ray_caster.Empty() || inSettings.mWidth == 0 || inSettings.mHeight == 0 || inSettings.mCache.mTableSize == 0)
+	{
+		gTrace("[RadianceCache] Nothing to integrate, scene or settings are empty\n");
+		return;
+	}
+
+	const uint pixel_count									= inSettings.mWidth * inSettings.mHeight;
+	const std::vector<RayCaster::Hit> primary_hits			= ray_caster.CastCamera(gConstants, inSettings.mWidth, inSettings.mHeight);
+	auto pixel_range										= std::views::iota(0u, pixel_count);
+	auto engine												= [&](uint inFrameIndex, uint inPixelIndex) { return std::mt19937(inFrameIndex * pixel_count + inPixelIndex); };
+
+	Tracer tracer { .mSceneContent = inSceneContent, .mRayCaster = ray_caster, .mSettings = inSettings };
+	tracer.mCameraPositionWS								= float3(gConstants.mCameraTransform[3]);
+	tracer.mEmissionScale									= gConstants.mEmissionBoost * kPreExposure; // Same unit as RayQueryCS for mRadianceScale
+
+	// Reference, uncached with seeds beyond those of frames
+	std::vector<float> references(pixel_count);
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mReferenceMS);
+		std::transform(std::execution::par, pixel_range.begin(), pixel_range.end(), references.begin(), [&](uint inPixelIndex)
+		{
+			std::mt19937 random_engine						= engine(inSettings.mFrameCount + 1, inPixelIndex);
+			double sum										= 0.0;
+			for (uint sample_index = 0; sample_index < inSettings.mReferenceSampleCount; sample_index++)
+				sum											+= RGBToLuminance(tracer.Trace(primary_hits[inPixelIndex], random_engine).mEmission);
+			return static_cast<float>(sum / gMax(inSettings.mReferenceSampleCount, 1u));
+		});
+	}
+
+	for (uint mode = 0; mode < static_cast<uint>(Mode::Count); mode++)
+	{
+		Result& result										= mResults[mode];
+		bool cached											= static_cast<Mode>(mode) == Mode::Cached;
+
+		SpatialCacheModel::Table table(inSettings.mCache.mTableSize, inSettings.mCache.mSearchCount);
+		std::vector<uint4> accumulations(cached ? inSettings.mCache.mTableSize : 0, uint4(0, 0, 0, 0));
+		std::vector<float4> resolved(cached ? inSettings.mCache.mTableSize : 0, float4(0.0f));
+		tracer.mTable										= cached ? &table : nullptr;
+		tracer.mResolved									= cached ? &resolved : nullptr;
+
+		std::vector<double> sums(pixel_count, 0.0);
+		std::vector<double> squared_sums(pixel_count, 0.0);
+		std::vector<Path> paths(pixel_count);
+		uint64_t terminated_count							= 0;
+		float total_ms										= 0.0f;
+
+		for (uint frame_index = 0; frame_index < inSettings.mFrameCount; frame_index++)
+		{
+			float frame_ms									= 0.0f;
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&frame_ms);
+
+				std::transform(std::execution::par, pixel_range.begin(), pixel_range.end(), paths.begin(), [&](uint inPixelIndex)
+				{
+					std::mt19937 random_engine				= engine(frame_index, inPixelIndex);
+					return tracer.Trace(primary_hits[inPixelIndex], random_engine);
+				});
+
+				if (cached)
+				{
+					// Update, serial as FindOrInsert of Table is not thread safe
+					for (const Path& path : paths)
+					{
+						for (uint vertex_index = 0; vertex_index < path.mVertexCount; vertex_index++)
+						{
+							const PathVertex& vertex		= path.mVertices[vertex_index];
+							SpatialCacheModel::Table::Lookup lookup = table.FindOrInsert(vertex.mKey, frame_index);
+							if (lookup.mCellIndex != SpatialCacheModel::Table::kInvalidCellIndex)
+								accumulations[lookup.mCellIndex] = RadianceCache::AddAccumulation(accumulations[lookup.mCellIndex], RadianceCache::ToAccumulation(RadianceCache::VertexRadiance(vertex.mVertex, path.mEmission), inSettings.mCache.mConstants.mRadianceScale));
+						}
+					}
+
+					// SpatialCacheUpdateCS
+					for (uint cell_index = 0; cell_index < table.Size(); cell_index++)
+					{
+						if (table.Evict(cell_index, frame_index, inSettings.mCache.mConstants.mMaxAge))
+						{
+							accumulations[cell_index]		= uint4(0, 0, 0, 0);
+							resolved[cell_index]			= float4(0.0f);
+						}
+						else if (accumulations[cell_index].w > 0)
+						{
+							resolved[cell_index]			= RadianceCache::Resolve(resolved[cell_index], accumulations[cell_index], inSettings.mCache.mConstants);
+							accumulations[cell_index]		= uint4(0, 0, 0, 0);
+						}
+					}
+				}
+			}
+			total_ms										+= frame_ms;
+
+			double squared_error_sum						= 0.0;
+			uint valid_pixel_count							= 0;
+			for (uint pixel_index = 0; pixel_index < pixel_count; pixel_index++)
+			{
+				double value								= RGBToLuminance(paths[pixel_index].mEmission);
+				sums[pixel_index]							+= value;
+				squared_sums[pixel_index]					+= value * value;
+				terminated_count							+= paths[pixel_index].mTerminated ? 1 : 0;
+
+				if (references[pixel_index] <= 0.0f)
+					continue;
+
+				double relative_error						= sums[pixel_index] / (frame_index + 1) / references[pixel_index] - 1.0;
+				squared_error_sum							+= relative_error * relative_error;
+				valid_pixel_count++;
+			}
+
+			float relative_rmse								= valid_pixel_count > 0 ? static_cast<float>(glm::sqrt(squared_error_sum / valid_pixel_count)) : 0.0f;
+			result.mRelativeRMSE.push_back(relative_rmse);
+			if (result.mConvergedFrameCount == 0 && relative_rmse < inSettings.mConvergenceThreshold)
+			{
+				result.mConvergedFrameCount					= frame_index + 1;
+				result.mConvergedMS							= total_ms;
+			}
+		}
+
+		double estimate_sum									= 0.0;
+		double reference_sum								= 0.0;
+		double relative_variance_sum						= 0.0;
+		uint valid_pixel_count								= 0;
+		double frame_count									= gMax(inSettings.mFrameCount, 1u);
+		for (uint pixel_index = 0; pixel_index < pixel_count; pixel_index++)
+		{
+			if (references[pixel_index] <= 0.0f)
+				continue;
+
+			double mean										= sums[pixel_index] / frame_count;
+			double variance									= gMax(squared_sums[pixel_index] / frame_count - mean * mean, 0.0);
+			estimate_sum									+= mean;
+			reference_sum									+= references[pixel_index];
+			relative_variance_sum							+= variance / (static_cast<double>(references[pixel_index]) * references[pixel_index]);
+			valid_pixel_count++;
+		}
+
+		result.mFrameMS										= static_cast<float>(total_ms / frame_count);
+		result.mBias										= reference_sum > 0.0 ? static_cast<float>(estimate_sum / reference_sum - 1.0) : 0.0f;
+		result.mRelativeVariance							= valid_pixel_count > 0 ? static_cast<float>(relative_variance_sum / valid_pixel_count) : 0.0f;
+		result.mTerminatedRate								= static_cast<float>(terminated_count / (frame_count * pixel_count));
+	}
+
+	std::string message = std::format("[RadianceCache] Integrated {}x{} pixels, {} frames, reference {:.2f} ms ({} spp)\n", inSettings.mWidth, inSettings.mHeight, inSettings.mFrameCount, mReferenceMS, inSettings.mReferenceSampleCount);
+	message += "  mode     | frame_ms bias     rel_variance terminated | converged_frames converged_ms\n";
+	for (uint mode = 0; mode < static_cast<uint>(Mode::Count); mode++)
+	{
+		const Result& result								= mResults[mode];
+		message += std::format("  {:8} | {:8.3f} {:+.4f} {:12.4f} {:10.4f} | {:16} {:12.2f}\n", nameof::nameof_enum(static_cast<Mode>(mode)),
+			result.mFrameMS, result.mBias, result.mRelativeVariance, result.mTerminatedRate, result.mConvergedFrameCount, result.mConvergedMS);
+	}
+	gTrace(message);
+}
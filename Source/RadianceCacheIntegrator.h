@@ -0,0 +1,55 @@
+#pragma once
+#include "Common.h"
+
+#include "SpatialCacheModel.h"
+
+struct SceneContent;
+
+// CPU path tracer to evaluate the radiance cache in Shader/RadianceCache.h, with same update / resolve / query and SpatialCacheModel::Table as hash map
+// Diffuse only with BSDF sampling, emission from instances and no sky, enough to compare cached paths against uncached ones
+class RadianceCacheIntegrator
+{
+public:
+	enum class Mode : uint
+	{
+		Uncached,
+		Cached,
+
+		Count
+	};
+
+	struct Settings
+	{
+		uint mWidth												= 160;
+		uint mHeight											= 90;
+		uint mFrameCount										= 64;
+		uint mReferenceSampleCount								= 256;
+		uint mRecursionDepthCountMax							= 4;
+		float mConvergenceThreshold								= 0.1f;		// Relative RMSE of accumulated image
+
+		SpatialCacheModel::Settings mCache;									// Cell size, history length and termination from gConstants.mSpatialCache
+
+		static Settings sFromConstants();
+	};
+
+	struct Result
+	{
+		float mFrameMS											= 0.0f;		// Average
+		float mBias												= 0.0f;		// Relative error of accumulated image against reference
+		float mRelativeVariance									= 0.0f;		// Per-pixel variance across frames over squared reference
+		float mTerminatedRate									= 0.0f;		// Paths terminated into cache
+		uint mConvergedFrameCount								= 0;		// Frames until relative RMSE of accumulated image is below threshold, 0 -> not converged
+		float mConvergedMS										= 0.0f;
+		std::vector<float> mRelativeRMSE;									// Of accumulated image per frame
+	};
+
+	void Run(const SceneContent& inSceneContent, const Settings& inSettings);
+
+	const Result& GetResult(Mode inMode) const					{ return mResults[static_cast<uint>(inMode)]; }
+	float GetReferenceMS() const								{ return mReferenceMS; }
+
+private:
+	Result mResults[static_cast<uint>(Mode::Count)];
+	float mReferenceMS											= 0.0f;
+};
+extern RadianceCacheIntegrator gRadianceCacheIntegrator;
@@ -0,0 +1,98 @@
+#include "RayCaster.h"
+#include "Scene.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4100 4189 4458) // See Thirdparty.cpp
+#endif
+#include "tiny_bvh.h"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+RayCaster::RayCaster() = default;
+RayCaster::~RayCaster() = default;
+
+void RayCaster::Build(const SceneContent& inSceneContent)
+{
+	mTriangleVertices.clear();
+	mTriangleInstanceIndices.clear();
+	mBVH = std::make_unique<tinybvh::BVH>();
+
+	for (uint instance_index = 0; instance_index < inSceneContent.mInstanceDatas.size(); instance_index++)
+	{
+		const InstanceData& instance_data					= inSceneContent.mInstanceDatas[instance_index];
+		for (uint index = 0; index + kIndexCountPerTriangle <= instance_data.mIndexCount; index += kIndexCountPerTriangle)
+		{
+			for (uint i = 0; i < kIndexCountPerTriangle; i++)
+			{
+				IndexType vertex_index						= inSceneContent.mIndices[instance_data.mIndexOffset + index + i];
+				mTriangleVertices.push_back(instance_data.mTransform * float4(inSceneContent.mVertices[instance_data.mVertexOffset + vertex_index], 1.0f));
+			}
+			mTriangleInstanceIndices.push_back(instance_index);
+		}
+	}
+
+	static_assert(sizeof(float4) == sizeof(tinybvh::bvhvec4));
+	if (!mTriangleInstanceIndices.empty())
+		mBVH->Build(reinterpret_cast<const tinybvh::bvhvec4*>(mTriangleVertices.data()), static_cast<uint>(mTriangleInstanceIndices.size()));
+}
+
+RayCaster::Hit RayCaster::Intersect(float3 inOrigin, float3 inDirection, float inTMax) const
+{
+	Hit hit;
+	if (Empty())
+		return hit;
+
+	tinybvh::Ray ray(tinybvh::bvhvec3(inOrigin.x, inOrigin.y, inOrigin.z), tinybvh::bvhvec3(inDirection.x, inDirection.y, inDirection.z), inTMax);
+	mBVH->Intersect(ray);
+	if (ray.hit.t >= inTMax)
+		return hit;
+
+	const float4* vertices									= &mTriangleVertices[ray.hit.prim * kIndexCountPerTriangle];
+	float3 normal											= glm::normalize(glm::cross(float3(vertices[1] - vertices[0]), float3(vertices[2] - vertices[0])));
+	if (glm::dot(normal, inDirection) > 0.0f)
+		normal												= -normal;
+
+	hit.mValid												= true;
+	hit.mT													= ray.hit.t;
+	hit.mPositionWS											= inOrigin + inDirection * ray.hit.t;
+	hit.mNormalWS											= normal;
+	hit.mInstanceIndex										= mTriangleInstanceIndices[ray.hit.prim];
+	return hit;
+}
+
+std::vector<RayCaster::Hit> RayCaster::CastCamera(const Constants& inConstants, uint inWidth, uint inHeight) const
+{
+	std::vector<Hit> hits(inWidth * inHeight);
+
+	auto pixel_range										= std::views::iota(0u, inWidth * inHeight);
+	std::transform(std::execution::par, pixel_range.begin(), pixel_range.end(), hits.begin(), [&](uint inPixelIndex)
+	{
+		float2 screen_coords								= float2(static_cast<float>(inPixelIndex % inWidth), static_cast<float>(inPixelIndex / inWidth)) + 0.5f;
+		float2 ndc_xy										= screen_coords / float2(static_cast<float>(inWidth), static_cast<float>(inHeight)) * 2.0f - 1.0f;
+		ndc_xy.y											= -ndc_xy.y;
+		float4 point_on_near_plane							= inConstants.mInverseProjectionMatrix * float4(ndc_xy, 0.0f, 1.0f);
+		float3 ray_direction_vs								= glm::normalize(float3(point_on_near_plane) / point_on_near_plane.w);
+		float3 ray_direction_ws								= float3(inConstants.mInverseViewMatrix * float4(ray_direction_vs, 0.0f));
+		float3 ray_origin_ws								= float3(inConstants.mCameraTransform[3]);
+		return Intersect(ray_origin_ws, ray_direction_ws);
+	});
+
+	return hits;
+}
+
+// Cosine-weighted hemisphere around inNormal, orthonormal basis from [Duff17] Building an Orthonormal Basis, Revisited
+float3 RayCaster::sSampleCosineHemisphere(float3 inNormal, float2 inRandom01)
+{
+	float radius											= glm::sqrt(inRandom01.x);
+	float phi												= 2.0f * MATH_PI * inRandom01.y;
+	float3 local											= float3(radius * glm::cos(phi), radius * glm::sin(phi), glm::sqrt(gMax(0.0f, 1.0f - inRandom01.x)));
+
+	float sign												= inNormal.z >= 0.0f ? 1.0f : -1.0f;
+	float a													= -1.0f / (sign + inNormal.z);
+	float b													= inNormal.x * inNormal.y * a;
+	float3 tangent											= float3(1.0f + sign * inNormal.x * inNormal.x * a, sign * b, -sign * inNormal.x);
+	float3 bitangent										= float3(b, sign + inNormal.y * inNormal.y * a, -inNormal.y);
+	return glm::normalize(tangent * local.x + bitangent * local.y + inNormal * local.z);
+}
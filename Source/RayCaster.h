@@ -0,0 +1,38 @@
+#pragma once
+#include "Common.h"
+
+struct SceneContent;
+
+namespace tinybvh { class BVH; }
+
+// CPU ray casting against world space triangles of all instances, for tools running without GPU
+class RayCaster
+{
+public:
+	struct Hit
+	{
+		bool mValid											= false;
+		float mT											= 0.0f;
+		float3 mPositionWS									= float3(0.0f);
+		float3 mNormalWS									= float3(0.0f);		// Geometric, facing the ray
+		uint mInstanceIndex									= 0;
+	};
+
+	RayCaster();
+	~RayCaster();
+
+	void Build(const SceneContent& inSceneContent);
+	bool Empty() const										{ return mTriangleInstanceIndices.empty(); }
+
+	Hit Intersect(float3 inOrigin, float3 inDirection, float inTMax = 10000.0f) const;
+
+	// Primary rays of gConstants camera, same as RayQuery.hpp with OffsetMode::HalfPixel. Row major.
+	std::vector<Hit> CastCamera(const Constants& inConstants, uint inWidth, uint inHeight) const;
+
+	static float3 sSampleCosineHemisphere(float3 inNormal, float2 inRandom01);
+
+private:
+	std::vector<float4> mTriangleVertices;					// Layout of tinybvh::bvhvec4
+	std::vector<uint> mTriangleInstanceIndices;
+	std::unique_ptr<tinybvh::BVH> mBVH;
+};
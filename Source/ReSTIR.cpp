@@ -0,0 +1,644 @@
+#include "ReSTIR.h"
+#include "Scene.h"
+
+#include "RayCaster.h"
+#include "Sweep.h"
+
+ReSTIR gReSTIR;
+
+static constexpr uint kLightCount							= 64;
+
+// Pixels face a direction varying across the screen, lights are spread around with varying power.
+// Support of the target function changes between neighbors, like visibility and orientation do on GPU.
+static float sFacing(uint2 inPixel, uint inWidth, uint inLightIndex)
+{
+	float pixel_angle										= 2.0f * MATH_PI * (inPixel.x + 0.5f) / inWidth + 0.5f * glm::sin(inPixel.y * 0.05f);
+	float light_angle										= 2.0f * MATH_PI * inLightIndex / kLightCount;
+	float power												= 1.0f + (inLightIndex % 7);
+	return power * glm::pow(gMax(glm::cos(pixel_angle - light_angle), 0.0f), 4.0f);
+}
+
+static float sTargetFunction(uint2 inPixel, uint inWidth, uint inLightIndex, float2 inUV)
+{
+	return sFacing(inPixel, inWidth, inLightIndex) * (0.5f + inUV.x * inUV.y);
+}
+
+// \sum_l \int sTargetFunction du dv, UV uniform on [0, 1]^2
+static float sReference(uint2 inPixel, uint inWidth)
+{
+	float reference											= 0.0f;
+	for (uint light_index = 0; light_index < kLightCount; light_index++)
+		reference											+= sFacing(inPixel, inWidth, light_index) * 0.75f;
+	return reference;
+}
+
+uint ReSTIR::sPackedSizeInBytes(Packing inPacking)
+{
+	switch (inPacking)
+	{
+	case Packing::None:		return sizeof(Reservoir);
+	case Packing::Full:		return sizeof(uint4);
+	case Packing::Compact:	return sizeof(uint2);
+	default:				return 0;
+	}
+}
+
+// What a reusing pixel sees after the reservoir went through a screen texture
+Reservoir ReSTIR::sRoundTrip(Reservoir inReservoir, Packing inPacking)
+{
+	Reservoir reservoir										= Reservoir::Generate();
+	switch (inPacking)
+	{
+	case Packing::None:
+		reservoir.mLightIndex								= inReservoir.mLightIndex;
+		reservoir.mUV										= inReservoir.mUV;
+		reservoir.mContributionWeight						= inReservoir.mContributionWeight;
+		reservoir.mM										= inReservoir.mM;
+		break;
+	case Packing::Full:		reservoir.UnpackFull(inReservoir.PackFull()); break;
+	case Packing::Compact:	reservoir.UnpackCompact(inReservoir.PackCompact()); break;
+	default: break;
+	}
+	return reservoir;
+}
+
+void ReSTIR::RunHarness(uint inWidth, uint inHeight, uint inFrameCount)
+{
+	CPU_TIMING_SCOPE("ReSTIR::RunHarness", &mStats.mHarnessMS);
+
+	mStats.mPixelCount										= inWidth * inHeight;
+	mStats.mFrameCount										= inFrameCount;
+	for (uint packing = 0; packing < static_cast<uint>(Packing::Count); packing++)
+		mStats.mResults[packing]							= Run(static_cast<Packing>(packing), inWidth, inHeight, inFrameCount);
+
+	std::string message = std::format("[ReSTIR] {}x{} pixels, {} frames, {} lights, initial {} temporal {} spatial {}\n", inWidth, inHeight, inFrameCount, kLightCount,
+		gConstants.mReSTIR.mInitialSampleCount, gConstants.mReSTIR.mSampleCountTemporal, gConstants.mReSTIR.mSampleCountSpatial);
+	for (uint packing = 0; packing < static_cast<uint>(Packing::Count); packing++)
+	{
+		const HarnessResult& result							= mStats.mResults[packing];
+		message += std::format("  {:8} bias {:+.4f}, relative RMSE {:.4f}, {:.1f} bytes/pixel\n",
+			nameof::nameof_enum(static_cast<Packing>(packing)), result.mBias, result.mRelativeRMSE, result.mBytesPerPixel);
+	}
+	gTrace(message);
+}
+
+ReSTIR::HarnessResult ReSTIR::Run(Packing inPacking, uint inWidth, uint inHeight, uint inFrameCount)
+{
+	HarnessResult result;
+
+	uint pixel_count										= inWidth * inHeight;
+	if (pixel_count == 0 || inFrameCount == 0)
+		return result;
+
+	const ReSTIRConstants& constants						= gConstants.mReSTIR;
+	const uint initial_sample_count							= gMax(1u, constants.mInitialSampleCount);
+
+	// Screen textures
+	std::vector<Reservoir> initial_reservoirs(pixel_count, Reservoir::Generate());
+	std::vector<Reservoir> temporal_reservoirs(pixel_count, Reservoir::Generate());
+	std::vector<Reservoir> spatial_reservoirs(pixel_count, Reservoir::Generate());
+
+	std::vector<uint> access_counts(pixel_count, 0);
+	std::vector<double> estimate_sums(pixel_count, 0.0);
+	std::vector<double> squared_error_sums(pixel_count, 0.0);
+	std::vector<float> references(pixel_count);
+
+	auto pixel_range										= std::views::iota(0u, pixel_count);
+	auto pixel											= [&](uint inPixelIndex) { return uint2(inPixelIndex % inWidth, inPixelIndex / inWidth); };
+	std::transform(std::execution::par, pixel_range.begin(), pixel_range.end(), references.begin(), [&](uint inPixelIndex) { return sReference(pixel(inPixelIndex), inWidth); });
+
+	// Target function is re-evaluated at the reusing pixel, as done after Unpack in RayQuery.hpp
+	auto load												= [&](const std::vector<Reservoir>& inReservoirs, uint inReadPixelIndex, uint inPixelIndex)
+	{
+		access_counts[inPixelIndex]++;
+		Reservoir reservoir									= inReservoirs[inReadPixelIndex];
+		if (reservoir.IsValid())
+			reservoir.mTargetFunction						= sTargetFunction(pixel(inPixelIndex), inWidth, reservoir.mLightIndex, reservoir.mUV);
+		return reservoir;
+	};
+	auto store												= [&](std::vector<Reservoir>& outReservoirs, uint inPixelIndex, const Reservoir& inReservoir)
+	{
+		access_counts[inPixelIndex]++;
+		outReservoirs[inPixelIndex]							= sRoundTrip(inReservoir, inPacking);
+	};
+
+	for (uint frame_index = 0; frame_index < inFrameCount; frame_index++)
+	{
+		auto engine											= [&](uint inPixelIndex, uint inStage) { return std::mt19937((frame_index * pixel_count + inPixelIndex) * 4 + inStage); };
+		std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+		// ReservoirInitializeCS
+		std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+		{
+			std::mt19937 random_engine						= engine(inPixelIndex, 0);
+			std::uniform_real_distribution<float> random01	= distribution;
+
+			Reservoir reservoir								= Reservoir::Generate();
+			for (uint sample_index = 0; sample_index < initial_sample_count; sample_index++)
+			{
+				Reservoir sample_reservoir					= Reservoir::Generate();
+				sample_reservoir.mLightIndex				= gMin(static_cast<uint>(random01(random_engine) * kLightCount), kLightCount - 1);
+				sample_reservoir.mUV						= float2(random01(random_engine), random01(random_engine));
+				sample_reservoir.mTargetFunction			= sTargetFunction(pixel(inPixelIndex), inWidth, sample_reservoir.mLightIndex, sample_reservoir.mUV);
+				sample_reservoir.mContributionWeight		= static_cast<float>(kLightCount);	// 1 / source pdf
+				reservoir.Stream(sample_reservoir, 1.0f, random01(random_engine));
+			}
+			reservoir.ComputeContributionWeight(true);
+			store(initial_reservoirs, inPixelIndex, reservoir);
+		});
+
+		// ReservoirTemporalCS
+		std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+		{
+			std::mt19937 random_engine						= engine(inPixelIndex, 1);
+			std::uniform_real_distribution<float> random01	= distribution;
+
+			Reservoir initial_reservoir						= load(initial_reservoirs, inPixelIndex, inPixelIndex);
+			Reservoir temporal_reservoir					= Reservoir::Generate();
+			if (frame_index > 0 && constants.mSampleCountTemporal != 0)
+				temporal_reservoir							= load(temporal_reservoirs, inPixelIndex, inPixelIndex);
+
+			Reservoir reservoir								= Reservoir::Generate();
+			reservoir.Stream(initial_reservoir, 1.0f, 0.0f);
+			reservoir.Stream(temporal_reservoir, 1.0f, random01(random_engine));
+			reservoir.ComputeContributionWeight(true);
+			store(temporal_reservoirs, inPixelIndex, reservoir);
+		});
+
+		// ReservoirSpatialCS
+		std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+		{
+			std::mt19937 random_engine						= engine(inPixelIndex, 2);
+			std::uniform_real_distribution<float> random01	= distribution;
+
+			Reservoir temporal_reservoir					= load(temporal_reservoirs, inPixelIndex, inPixelIndex);
+			Reservoir spatial_reservoir						= Reservoir::Generate();
+			for (uint sample_index = 0; sample_index < constants.mSampleCountSpatial; sample_index++)
+			{
+				float r										= constants.mSpatialRadius * random01(random_engine);
+				float theta									= 2.0f * MATH_PI * random01(random_engine);
+				int2 coords									= int2(pixel(inPixelIndex)) + int2(static_cast<int>(r * glm::cos(theta)), static_cast<int>(r * glm::sin(theta)));
+				if (coords.x < 0 || coords.y < 0 || coords.x >= static_cast<int>(inWidth) || coords.y >= static_cast<int>(inHeight))
+					continue;
+
+				Reservoir neighbor_reservoir				= load(temporal_reservoirs, coords.y * inWidth + coords.x, inPixelIndex);
+				if (!neighbor_reservoir.IsValid())
+					continue;
+				spatial_reservoir.Stream(neighbor_reservoir, 1.0f, random01(random_engine));
+			}
+			spatial_reservoir.ComputeContributionWeight(true);
+
+			Reservoir reservoir								= Reservoir::Generate();
+			reservoir.Stream(temporal_reservoir, 1.0f, 0.0f);
+			reservoir.Stream(spatial_reservoir, 1.0f, random01(random_engine));
+			reservoir.ComputeContributionWeight(true);
+			store(spatial_reservoirs, inPixelIndex, reservoir);
+		});
+
+		// RayQueryCS, unshadowed
+		std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+		{
+			Reservoir reservoir								= load(spatial_reservoirs, inPixelIndex, inPixelIndex);
+			float estimate									= reservoir.IsValid() ? reservoir.mTargetFunction * reservoir.mContributionWeight : 0.0f;
+			estimate_sums[inPixelIndex]						+= estimate;
+			if (references[inPixelIndex] > 0.0f)
+				squared_error_sums[inPixelIndex]			+= glm::pow(estimate / references[inPixelIndex] - 1.0f, 2.0f);
+		});
+	}
+
+	double estimate_sum										= 0.0;
+	double reference_sum									= 0.0;
+	double squared_error_sum								= 0.0;
+	uint valid_pixel_count									= 0;
+	uint64_t access_count									= 0;
+	for (uint pixel_index = 0; pixel_index < pixel_count; pixel_index++)
+	{
+		access_count										+= access_counts[pixel_index];
+		if (references[pixel_index] <= 0.0f)
+			continue;
+
+		estimate_sum										+= estimate_sums[pixel_index] / inFrameCount;
+		reference_sum										+= references[pixel_index];
+		squared_error_sum									+= squared_error_sums[pixel_index] / inFrameCount;
+		valid_pixel_count++;
+	}
+
+	result.mBias											= reference_sum > 0.0 ? static_cast<float>(estimate_sum / reference_sum - 1.0) : 0.0f;
+	result.mRelativeRMSE									= valid_pixel_count > 0 ? static_cast<float>(glm::sqrt(squared_error_sum / valid_pixel_count)) : 0.0f;
+	result.mBytesPerPixel									= static_cast<float>(static_cast<double>(access_count) * sPackedSizeInBytes(inPacking) / (static_cast<double>(pixel_count) * inFrameCount));
+	return result;
+}
+
+ReSTIR::Settings ReSTIR::Settings::sFromConstants()
+{
+	Settings settings;
+	settings.mInitialSampleCount							= gConstants.mReSTIR.mInitialSampleCount;
+	settings.mTemporalSampleCount							= gConstants.mReSTIR.mSampleCountTemporal;
+	settings.mSpatialSampleCount							= gConstants.mReSTIR.mSampleCountSpatial;
+	settings.mSpatialRadius									= gConstants.mReSTIR.mSpatialRadius;
+	return settings;
+}
+
+// Surfaces are treated as diffuse with InstanceData::mAlbedo, textures are ignored
+struct Surface
+{
+	bool mValid											= false;
+	float3 mPositionWS									= float3(0.0f);
+	float3 mNormalWS									= float3(0.0f);
+	float3 mAlbedo										= float3(0.0f);
+};
+
+// See LightEvaluation::GenerateContext with ContextType::UV
+struct LightSample
+{
+	float3 mL											= float3(0.0f);
+	float mSolidAnglePDF								= 0.0f;
+};
+
+struct Simulation
+{
+	const SceneContent& mSceneContent;
+	uint mWidth											= 0;
+	uint mHeight										= 0;
+
+	RayCaster mRayCaster;
+
+	std::vector<Surface> mSurfaces;
+	std::vector<float> mReferences;
+
+	uint PixelCount() const								{ return mWidth * mHeight; }
+	uint2 Pixel(uint inPixelIndex) const				{ return uint2(inPixelIndex % mWidth, inPixelIndex / mWidth); }
+	float LightCount() const							{ return static_cast<float>(mSceneContent.mLights.size()); }
+
+	void GenerateGBuffer()
+	{
+		std::vector<RayCaster::Hit> hits				= mRayCaster.CastCamera(gConstants, mWidth, mHeight);
+		mSurfaces.resize(PixelCount());
+		std::transform(std::execution::par, hits.begin(), hits.end(), mSurfaces.begin(), [&](const RayCaster::Hit& inHit)
+		{
+			Surface surface;
+			if (!inHit.mValid || mSceneContent.mInstanceDatas[inHit.mInstanceIndex].mBSDF == BSDF::Light)
+				return surface;
+
+			surface.mValid								= true;
+			surface.mPositionWS							= inHit.mPositionWS + inHit.mNormalWS * 1.0e-4f;
+			surface.mNormalWS							= inHit.mNormalWS;
+			surface.mAlbedo								= mSceneContent.mInstanceDatas[inHit.mInstanceIndex].mAlbedo;
+			return surface;
+		});
+	}
+
+	LightSample GenerateLightSample(uint inLightIndex, float2 inUV, float3 inPositionWS) const
+	{
+		const Light& light								= mSceneContent.mLights[inLightIndex];
+		const float3 vector_to_light					= light.mPosition - inPositionWS;
+
+		LightSample sample;
+		switch (light.mType)
+		{
+		case LightType::Sphere:
+		{
+			float radius_squared						= light.mHalfExtends.x * light.mHalfExtends.x;
+			float distance_to_light_position_squared	= glm::dot(vector_to_light, vector_to_light);
+			float sin_theta_max_squared					= radius_squared / distance_to_light_position_squared;
+			float cos_theta_max							= glm::sqrt(1.0f - glm::clamp(sin_theta_max_squared, 0.0f, 1.0f));
+			sample.mSolidAnglePDF						= 1.0f / (2.0f * MATH_PI * (1.0f - cos_theta_max));
+
+			float cos_theta								= glm::mix(cos_theta_max, 1.0f, inUV.x);
+			float sin_theta								= glm::sqrt(gMax(1.0f - cos_theta * cos_theta, 0.0f));
+			float phi									= 2.0f * MATH_PI * inUV.y;
+
+			// GenerateTangentSpace
+			float3 w									= glm::normalize(vector_to_light);
+			float3 a									= (glm::abs(w.x) > 0.9f) ? float3(0.0f, 1.0f, 0.0f) : float3(1.0f, 0.0f, 0.0f);
+			float3 v									= glm::normalize(glm::cross(w, a));
+			float3 u									= glm::cross(w, v);
+			sample.mL									= (u * glm::cos(phi) + v * glm::sin(phi)) * sin_theta + w * cos_theta;
+		}
+		break;
+		case LightType::Rectangle:
+		{
+			float3 vector_to_sample						= vector_to_light;
+			vector_to_sample							+= light.mTangent * light.mHalfExtends.x * (inUV.x * 2.0f - 1.0f);
+			vector_to_sample							+= light.mBitangent * light.mHalfExtends.y * (inUV.y * 2.0f - 1.0f);
+			sample.mL									= glm::normalize(vector_to_sample);
+
+			float distance_to_sample_squared			= glm::dot(vector_to_sample, vector_to_sample);
+			float surface_area							= 4.0f * light.mHalfExtends.x * light.mHalfExtends.y;
+			float denom									= gMax(glm::dot(-sample.mL, light.mNormal), 0.0f);
+			sample.mSolidAnglePDF						= denom == 0.0f ? 0.0f : distance_to_sample_squared / (surface_area * denom);
+		}
+		break;
+		default: break;
+		}
+		return sample;
+	}
+
+	// Unshadowed luminance of light sample over its pdf, target function \hat{p} of RayQuery.hpp
+	float TargetFunction(const Surface& inSurface, uint inLightIndex, float2 inUV) const
+	{
+		if (!inSurface.mValid)
+			return 0.0f;
+
+		LightSample sample								= GenerateLightSample(inLightIndex, inUV, inSurface.mPositionWS);
+		float sample_pdf								= sample.mSolidAnglePDF / LightCount();
+		if (sample_pdf <= 0.0f || !std::isfinite(sample_pdf))
+			return 0.0f;
+
+		float3 bsdf										= inSurface.mAlbedo / MATH_PI;
+		float n_dot_l									= gMax(glm::dot(inSurface.mNormalWS, sample.mL), 0.0f);
+		return RGBToLuminance(mSceneContent.mLights[inLightIndex].mEmission * bsdf) * n_dot_l / sample_pdf;
+	}
+
+	// Shadow ray is accepted only when it hits the light instance, as RayQuery.hpp
+	bool Visible(const Surface& inSurface, uint inLightIndex, float3 inL) const
+	{
+		RayCaster::Hit hit								= mRayCaster.Intersect(inSurface.mPositionWS, inL);
+		return hit.mValid && hit.mInstanceIndex == mSceneContent.mLights[inLightIndex].mInstanceID;
+	}
+
+	// Light contribution in luminance, see light_emission in RayQuery.hpp
+	float Shade(const Surface& inSurface, uint inLightIndex, float2 inUV, float inContributionWeight) const
+	{
+		LightSample sample								= GenerateLightSample(inLightIndex, inUV, inSurface.mPositionWS);
+		if (sample.mSolidAnglePDF <= 0.0f || !std::isfinite(sample.mSolidAnglePDF) || !Visible(inSurface, inLightIndex, sample.mL))
+			return 0.0f;
+
+		float3 bsdf										= inSurface.mAlbedo / MATH_PI;
+		float n_dot_l									= gMax(glm::dot(inSurface.mNormalWS, sample.mL), 0.0f);
+		return RGBToLuminance(mSceneContent.mLights[inLightIndex].mEmission * bsdf) * n_dot_l / sample.mSolidAnglePDF * inContributionWeight;
+	}
+
+	// Uniform light selection and uniform UV, with visibility
+	void GenerateReference(uint inSampleCount)
+	{
+		mReferences.resize(PixelCount());
+
+		auto pixel_range								= std::views::iota(0u, PixelCount());
+		std::transform(std::execution::par, pixel_range.begin(), pixel_range.end(), mReferences.begin(), [&](uint inPixelIndex)
+		{
+			const Surface& surface						= mSurfaces[inPixelIndex];
+			if (!surface.mValid)
+				return 0.0f;
+
+			std::mt19937 engine(inPixelIndex);
+			std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+			double sum									= 0.0;
+			for (uint sample_index = 0; sample_index < inSampleCount; sample_index++)
+			{
+				uint light_index						= gMin(static_cast<uint>(random01(engine) * LightCount()), static_cast<uint>(mSceneContent.mLights.size() - 1));
+				float2 uv								= float2(random01(engine), random01(engine));
+				sum										+= Shade(surface, light_index, uv, LightCount());
+			}
+			return static_cast<float>(sum / inSampleCount);
+		});
+	}
+};
+
+// With inMCap == 0 every valid input counts as one sample, as Reservoir::Stream. Otherwise its M, capped, is used as MIS weight and added to M.
+static bool sStream(Reservoir& ioReservoir, Reservoir inReservoir, float inMCap, float inRandom01)
+{
+	float m												= inMCap > 0.0f ? glm::clamp(inReservoir.mM, 1.0f, inMCap) : 1.0f;
+	bool selected										= ioReservoir.Stream(inReservoir, m, inRandom01);
+	if (inReservoir.IsValid())
+		ioReservoir.mM									+= m - 1.0f;
+	return selected;
+}
+
+void ReSTIR::Simulate(const SceneContent& inSceneContent, std::span<const Settings> inSettings)
+{
+	mSimulationResults.clear();
+	if (inSettings.empty() || inSceneContent.mLights.empty() || inSettings[0].mWidth == 0 || inSettings[0].mHeight == 0)
+	{
+		gTrace("[ReSTIR] Nothing to simulate, scene has no light or settings are empty\n");
+		return;
+	}
+
+	Simulation simulation { .mSceneContent = inSceneContent, .mWidth = inSettings[0].mWidth, .mHeight = inSettings[0].mHeight };
+
+	float gbuffer_ms										= 0.0f;
+	float reference_ms										= 0.0f;
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&gbuffer_ms);
+		simulation.mRayCaster.Build(inSceneContent);
+		if (simulation.mRayCaster.Empty())
+			return;
+		simulation.GenerateGBuffer();
+	}
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&reference_ms);
+		simulation.GenerateReference(inSettings[0].mReferenceSampleCount);
+	}
+
+	const uint pixel_count									= simulation.PixelCount();
+	const uint width										= simulation.mWidth;
+	const uint height										= simulation.mHeight;
+	auto pixel_range										= std::views::iota(0u, pixel_count);
+
+	for (const Settings& settings : inSettings)
+	{
+		SimulationResult& result							= mSimulationResults.emplace_back();
+		result.mSettings									= settings;
+		result.mSettings.mWidth								= width;
+		result.mSettings.mHeight							= height;
+		result.mSettings.mReferenceSampleCount				= inSettings[0].mReferenceSampleCount;
+		result.mStageMS[static_cast<uint>(Stage::GBuffer)]	= gbuffer_ms;
+		result.mStageMS[static_cast<uint>(Stage::Reference)]= reference_ms;
+
+		const uint initial_sample_count						= gMax(1u, settings.mInitialSampleCount);
+		const uint frame_count								= gMax(1u, settings.mFrameCount);
+
+		std::vector<Reservoir> initial_reservoirs(pixel_count, Reservoir::Generate());
+		std::vector<Reservoir> temporal_reservoirs(pixel_count, Reservoir::Generate());
+		std::vector<Reservoir> spatial_reservoirs(pixel_count, Reservoir::Generate());
+		std::vector<double> estimate_sums(pixel_count, 0.0);
+		std::vector<double> squared_error_sums(pixel_count, 0.0);
+
+		auto load											= [&](const std::vector<Reservoir>& inReservoirs, uint inReadPixelIndex, uint inPixelIndex)
+		{
+			Reservoir reservoir								= inReservoirs[inReadPixelIndex];
+			if (reservoir.IsValid())
+				reservoir.mTargetFunction					= simulation.TargetFunction(simulation.mSurfaces[inPixelIndex], reservoir.mLightIndex, reservoir.mUV);
+			return reservoir;
+		};
+
+		for (uint frame_index = 0; frame_index < frame_count; frame_index++)
+		{
+			auto engine										= [&](uint inPixelIndex, uint inStage) { return std::mt19937((frame_index * pixel_count + inPixelIndex) * 4 + inStage); };
+			auto stage_ms									= [&](Stage inStage) { return &result.mStageMS[static_cast<uint>(inStage)]; };
+			float duration_ms								= 0.0f;
+
+			// ReservoirInitializeCS
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&duration_ms);
+				std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+				{
+					const Surface& surface					= simulation.mSurfaces[inPixelIndex];
+					if (!surface.mValid)
+						return;
+
+					std::mt19937 random_engine				= engine(inPixelIndex, 0);
+					std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+
+					Reservoir reservoir						= Reservoir::Generate();
+					for (uint sample_index = 0; sample_index < initial_sample_count; sample_index++)
+					{
+						Reservoir sample_reservoir			= Reservoir::Generate();
+						sample_reservoir.mLightIndex		= gMin(static_cast<uint>(random01(random_engine) * simulation.LightCount()), static_cast<uint>(inSceneContent.mLights.size() - 1));
+						sample_reservoir.mUV				= float2(random01(random_engine), random01(random_engine));
+						sample_reservoir.mTargetFunction	= simulation.TargetFunction(surface, sample_reservoir.mLightIndex, sample_reservoir.mUV);
+						sample_reservoir.mContributionWeight = simulation.LightCount();	// 1 / UniformSelectPDF
+						reservoir.Stream(sample_reservoir, 1.0f, random01(random_engine));
+					}
+					reservoir.ComputeContributionWeight(true);
+					initial_reservoirs[inPixelIndex]		= sRoundTrip(reservoir, settings.mPacking);
+				});
+			}
+			*stage_ms(Stage::Initialize)					+= duration_ms / frame_count;
+
+			// ReservoirTemporalCS
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&duration_ms);
+				std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+				{
+					if (!simulation.mSurfaces[inPixelIndex].mValid)
+						return;
+
+					std::mt19937 random_engine				= engine(inPixelIndex, 1);
+					std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+
+					Reservoir initial_reservoir				= load(initial_reservoirs, inPixelIndex, inPixelIndex);
+					Reservoir temporal_reservoir			= Reservoir::Generate();
+					if (frame_index > 0 && settings.mTemporalSampleCount != 0)
+						temporal_reservoir					= load(temporal_reservoirs, inPixelIndex, inPixelIndex);
+
+					Reservoir reservoir						= Reservoir::Generate();
+					sStream(reservoir, initial_reservoir, settings.mMCap, 0.0f);
+					sStream(reservoir, temporal_reservoir, settings.mMCap, random01(random_engine));
+					reservoir.ComputeContributionWeight(true);
+					temporal_reservoirs[inPixelIndex]		= sRoundTrip(reservoir, settings.mPacking);
+				});
+			}
+			*stage_ms(Stage::Temporal)						+= duration_ms / frame_count;
+
+			// ReservoirSpatialCS
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&duration_ms);
+				std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+				{
+					if (!simulation.mSurfaces[inPixelIndex].mValid)
+						return;
+
+					std::mt19937 random_engine				= engine(inPixelIndex, 2);
+					std::uniform_real_distribution<float> random01(0.0f, 1.0f);
+
+					Reservoir temporal_reservoir			= load(temporal_reservoirs, inPixelIndex, inPixelIndex);
+					Reservoir spatial_reservoir				= Reservoir::Generate();
+					for (uint sample_index = 0; sample_index < settings.mSpatialSampleCount; sample_index++)
+					{
+						float r								= settings.mSpatialRadius * random01(random_engine);
+						float theta							= 2.0f * MATH_PI * random01(random_engine);
+						int2 coords							= int2(simulation.Pixel(inPixelIndex)) + int2(static_cast<int>(r * glm::cos(theta)), static_cast<int>(r * glm::sin(theta)));
+						if (coords.x < 0 || coords.y < 0 || coords.x >= static_cast<int>(width) || coords.y >= static_cast<int>(height))
+							continue;
+
+						Reservoir neighbor_reservoir		= load(temporal_reservoirs, coords.y * width + coords.x, inPixelIndex);
+						if (!neighbor_reservoir.IsValid())
+							continue;
+						sStream(spatial_reservoir, neighbor_reservoir, settings.mMCap, random01(random_engine));
+					}
+					spatial_reservoir.ComputeContributionWeight(true);
+
+					Reservoir reservoir						= Reservoir::Generate();
+					sStream(reservoir, temporal_reservoir, settings.mMCap, 0.0f);
+					sStream(reservoir, spatial_reservoir, settings.mMCap, random01(random_engine));
+					reservoir.ComputeContributionWeight(true);
+					spatial_reservoirs[inPixelIndex]		= sRoundTrip(reservoir, settings.mPacking);
+				});
+			}
+			*stage_ms(Stage::Spatial)						+= duration_ms / frame_count;
+
+			// RayQueryCS
+			{
+				CPU_TIMING_SCOPE_SIMPLE(&duration_ms);
+				std::for_each(std::execution::par, pixel_range.begin(), pixel_range.end(), [&](uint inPixelIndex)
+				{
+					const Surface& surface					= simulation.mSurfaces[inPixelIndex];
+					float reference							= simulation.mReferences[inPixelIndex];
+					if (!surface.mValid)
+						return;
+
+					Reservoir reservoir						= load(spatial_reservoirs, inPixelIndex, inPixelIndex);
+					float estimate							= reservoir.IsValid() ? simulation.Shade(surface, reservoir.mLightIndex, reservoir.mUV, reservoir.mContributionWeight) : 0.0f;
+					estimate_sums[inPixelIndex]				+= estimate;
+					if (reference > 0.0f)
+						squared_error_sums[inPixelIndex]	+= glm::pow(estimate / reference - 1.0f, 2.0f);
+				});
+			}
+			*stage_ms(Stage::Shade)							+= duration_ms / frame_count;
+		}
+
+		double estimate_sum									= 0.0;
+		double reference_sum								= 0.0;
+		double squared_error_sum							= 0.0;
+		uint valid_pixel_count								= 0;
+		for (uint pixel_index = 0; pixel_index < pixel_count; pixel_index++)
+		{
+			if (simulation.mReferences[pixel_index] <= 0.0f)
+				continue;
+
+			estimate_sum									+= estimate_sums[pixel_index] / frame_count;
+			reference_sum									+= simulation.mReferences[pixel_index];
+			squared_error_sum								+= squared_error_sums[pixel_index] / frame_count;
+			valid_pixel_count++;
+		}
+		result.mBias										= reference_sum > 0.0 ? static_cast<float>(estimate_sum / reference_sum - 1.0) : 0.0f;
+		result.mRelativeMSE									= valid_pixel_count > 0 ? static_cast<float>(squared_error_sum / valid_pixel_count) : 0.0f;
+	}
+
+	std::string message = std::format("[ReSTIR] Simulated {}x{} pixels, {} lights, G-buffer {:.2f} ms, reference {:.2f} ms ({} spp)\n", width, height, inSceneContent.mLights.size(), gbuffer_ms, reference_ms, inSettings[0].mReferenceSampleCount);
+	message += "  initial temporal spatial radius  m_cap packing  | initialize_ms temporal_ms spatial_ms shade_ms | bias     rel_mse\n";
+	for (const SimulationResult& result : mSimulationResults)
+	{
+		const Settings& settings							= result.mSettings;
+		message += std::format("  {:7} {:8} {:7} {:6.1f} {:6.1f} {:8} | {:13.3f} {:11.3f} {:10.3f} {:8.3f} | {:+.4f} {:.4f}\n",
+			settings.mInitialSampleCount, settings.mTemporalSampleCount, settings.mSpatialSampleCount, settings.mSpatialRadius, settings.mMCap, nameof::nameof_enum(settings.mPacking),
+			result.mStageMS[static_cast<uint>(Stage::Initialize)], result.mStageMS[static_cast<uint>(Stage::Temporal)], result.mStageMS[static_cast<uint>(Stage::Spatial)], result.mStageMS[static_cast<uint>(Stage::Shade)],
+			result.mBias, result.mRelativeMSE);
+	}
+	gTrace(message);
+}
+
+void ReSTIR::RunSweep(const SceneContent& inSceneContent, const std::filesystem::path& inPath)
+{
+	// Resolution and reference are shared by all settings of Simulate
+	const SweepParameter<Settings> kParameters[] =
+	{
+		{ "width",					[](Settings& ioSettings, float inValue) { ioSettings.mWidth = static_cast<uint>(inValue); }, false },
+		{ "height",					[](Settings& ioSettings, float inValue) { ioSettings.mHeight = static_cast<uint>(inValue); }, false },
+		{ "reference_samples",		[](Settings& ioSettings, float inValue) { ioSettings.mReferenceSampleCount = static_cast<uint>(inValue); }, false },
+		{ "frames",					[](Settings& ioSettings, float inValue) { ioSettings.mFrameCount = static_cast<uint>(inValue); } },
+		{ "initial_sample_count",	[](Settings& ioSettings, float inValue) { ioSettings.mInitialSampleCount = static_cast<uint>(inValue); } },
+		{ "temporal_sample_count",	[](Settings& ioSettings, float inValue) { ioSettings.mTemporalSampleCount = static_cast<uint>(inValue); } },
+		{ "spatial_sample_count",	[](Settings& ioSettings, float inValue) { ioSettings.mSpatialSampleCount = static_cast<uint>(inValue); } },
+		{ "spatial_radius",			[](Settings& ioSettings, float inValue) { ioSettings.mSpatialRadius = inValue; } },
+		{ "m_cap",					[](Settings& ioSettings, float inValue) { ioSettings.mMCap = inValue; } },
+		{ "packing",				[](Settings& ioSettings, float inValue) { ioSettings.mPacking = static_cast<Packing>(gMin(static_cast<uint>(inValue), static_cast<uint>(Packing::Count) - 1)); } },
+	};
+
+	std::vector<Settings> settings;
+	if (!gLoadSweep<Settings>("ReSTIR", inPath, kParameters, Settings::sFromConstants(), settings))
+		return;
+
+	Simulate(inSceneContent, settings);
+
+	gWriteSweepCSV<SimulationResult>("ReSTIR", inPath, "initial_sample_count,temporal_sample_count,spatial_sample_count,spatial_radius,m_cap,packing,gbuffer_ms,reference_ms,initialize_ms,temporal_ms,spatial_ms,shade_ms,bias,relative_mse",
+		mSimulationResults, [](const SimulationResult& inResult)
+	{
+		const Settings& setting								= inResult.mSettings;
+		std::string line									= std::format("{},{},{},{},{},{}", setting.mInitialSampleCount, setting.mTemporalSampleCount, setting.mSpatialSampleCount, setting.mSpatialRadius, setting.mMCap, nameof::nameof_enum(setting.mPacking));
+		for (float stage_ms : inResult.mStageMS)
+			line											+= std::format(",{}", stage_ms);
+		return line + std::format(",{},{}", inResult.mBias, inResult.mRelativeMSE);
+	});
+}
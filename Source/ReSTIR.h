@@ -0,0 +1,98 @@
+#pragma once
+#include "Common.h"
+
+#include "../Shader/Reservoir.h"
+
+struct SceneContent;
+
+// CPU-side ReSTIR DI, runs the resampling of ReservoirInitializeCS / ReservoirTemporalCS / ReservoirSpatialCS in Shader/RayQuery.hpp with the same Reservoir
+//   Harness: synthetic pixels whose reference is known in closed form, to check packing
+//   Simulator: G-buffer ray cast on CPU from the loaded scene, to tune ReSTIRConstants and beyond
+class ReSTIR
+{
+public:
+	enum class Packing : uint
+	{
+		None,		// Reservoir kept in float
+		Full,		// Reservoir::PackFull
+		Compact,	// Reservoir::PackCompact
+
+		Count
+	};
+
+	struct HarnessResult
+	{
+		float mBias											= 0.0f;		// Relative error of per-pixel mean over frames against reference
+		float mRelativeRMSE									= 0.0f;		// Of single frame estimates
+		float mBytesPerPixel								= 0.0f;		// Reservoir bytes read and written per pixel per frame
+	};
+
+	struct Stats
+	{
+		float mHarnessMS									= 0.0f;
+		uint mPixelCount									= 0;
+		uint mFrameCount									= 0;
+		HarnessResult mResults[static_cast<uint>(Packing::Count)];
+	};
+
+	void RunHarness(uint inWidth, uint inHeight, uint inFrameCount);
+
+	const Stats& GetStats() const							{ return mStats; }
+
+	struct Settings
+	{
+		uint mWidth											= 320;
+		uint mHeight										= 180;
+		uint mFrameCount									= 8;
+		uint mReferenceSampleCount							= 256;
+
+		uint mInitialSampleCount							= 1;
+		uint mTemporalSampleCount							= 1;
+		uint mSpatialSampleCount							= 1;
+		float mSpatialRadius								= 5.0f;		// In pixels
+		float mMCap											= 0.0f;		// 0 -> every input reservoir counts as one sample, as RayQuery.hpp does
+		Packing mPacking									= RESERVOIR_PACKING_COMPACT ? Packing::Compact : Packing::Full;
+
+		static Settings sFromConstants();
+	};
+
+	enum class Stage : uint
+	{
+		GBuffer,
+		Reference,
+		Initialize,
+		Temporal,
+		Spatial,
+		Shade,
+
+		Count
+	};
+
+	struct SimulationResult
+	{
+		Settings mSettings;
+		float mStageMS[static_cast<uint>(Stage::Count)]		= {};		// GBuffer and Reference are shared by all results of a sweep
+		float mBias											= 0.0f;		// Relative error of per-pixel mean over frames against reference
+		float mRelativeMSE									= 0.0f;		// Of single frame estimates
+	};
+
+	// All settings share width, height and reference sample count of the first one
+	void Simulate(const SceneContent& inSceneContent, std::span<const Settings> inSettings);
+
+	// JSON with base settings and arrays of values to sweep, e.g.
+	// { "width": 320, "height": 180, "frames": 8, "sweep": { "initial_sample_count": [1, 4, 8], "spatial_radius": [5, 10], "m_cap": [0, 20] } }
+	// Results are written next to it as .csv
+	void RunSweep(const SceneContent& inSceneContent, const std::filesystem::path& inPath);
+
+	const std::vector<SimulationResult>& GetSimulationResults() const { return mSimulationResults; }
+
+	static uint sPackedSizeInBytes(Packing inPacking);
+	static Reservoir sRoundTrip(Reservoir inReservoir, Packing inPacking);
+
+private:
+	HarnessResult Run(Packing inPacking, uint inWidth, uint inHeight, uint inFrameCount);
+
+	Stats mStats;
+	std::vector<SimulationResult> mSimulationResults;
+};
+extern ReSTIR gReSTIR;
@@ -404,9 +404,8 @@ ShaderTable Renderer::Compiler::CreateShaderTable(const Shader& inShader, const
 	return shader_table;
 }
 
-ComPtr<IDxcBlob> Renderer::Compiler::Compile(const std::string_view& inFilename, const std::string_view& inEntryPoint, const std::string_view& inProfile)
+std::string Renderer::Compiler::SharedHeader() const
 {
-	// Generated header
 	std::string shader_header;
 
 	// AtmosphereMode
@@ -417,12 +416,6 @@ ComPtr<IDxcBlob> Renderer::Compiler::Compile(const std::string_view& inFilename,
 	if (!gCloud.mProfile.mDynamicModeSwitch)
 		shader_header += std::format("#define k{} {}::{}\n", nameof::nameof_enum_type<CloudMode>(), nameof::nameof_enum_type<CloudMode>(), nameof::nameof_enum(gCloud.mProfile.mMode));
 
-	// Profile
-	shader_header += std::format("#define SHADER_PROFILE_LIB {}\n", inProfile.starts_with("lib") ? 1 : 0);
-	shader_header += std::format("#define SHADER_PROFILE_CS {}\n", inProfile.starts_with("cs") ? 1 : 0);
-	shader_header += std::format("#define SHADER_PROFILE_PS {}\n", inProfile.starts_with("ps") ? 1 : 0);
-	shader_header += std::format("#define SHADER_PROFILE_VS {}\n", inProfile.starts_with("vs") ? 1 : 0);
-
 	// NVAPI
 	shader_header += std::format("#define NVAPI_SER {}\n", gNVAPI.mShaderExecutionReorderingSupported ? 1 : 0);
 	shader_header += std::format("#define NVAPI_LSS {}\n", gNVAPI.mLinearSweptSpheresSupported ? 1 : 0);
@@ -431,6 +424,7 @@ ComPtr<IDxcBlob> Renderer::Compiler::Compile(const std::string_view& inFilename,
 	// Config
 	shader_header += std::format("#define SHADER_DEBUG {}\n", gConfigs.mShaderDebug ? 1 : 0);
 	shader_header += std::format("#define USE_TEXTURE {}\n", gConfigs.mUseTexture ? 1 : 0);
+	shader_header += std::format("#define QUANTIZED_VERTEX_ATTRIBUTES {}\n", gConfigs.mQuantizeVertexAttributes ? 1 : 0);
 	shader_header += std::format("#define NANOVDB_USE_TEXTURE {}\n", gConfigs.mNanoVDBUseTexture ? 1 : 0);
 
 	// BSDF
@@ -442,6 +436,21 @@ ComPtr<IDxcBlob> Renderer::Compiler::Compile(const std::string_view& inFilename,
 		shader_header += std::format("#define USE_BSDF_{} {}\n", nameof::nameof_enum(bsdf), gConfigs.mSceneBSDFs.find(bsdf) != gConfigs.mSceneBSDFs.end() ? 1 : 0);
 	}
 
+	return shader_header;
+}
+
+ComPtr<IDxcBlob> Renderer::Compiler::Compile(const std::string_view& inFilename, const std::string_view& inEntryPoint, const std::string_view& inProfile)
+{
+	// Generated header
+	std::string shader_header = SharedHeader();
+	mCompiledSharedHeader = shader_header;
+
+	// Profile
+	shader_header += std::format("#define SHADER_PROFILE_LIB {}\n", inProfile.starts_with("lib") ? 1 : 0);
+	shader_header += std::format("#define SHADER_PROFILE_CS {}\n", inProfile.starts_with("cs") ? 1 : 0);
+	shader_header += std::format("#define SHADER_PROFILE_PS {}\n", inProfile.starts_with("ps") ? 1 : 0);
+	shader_header += std::format("#define SHADER_PROFILE_VS {}\n", inProfile.starts_with("vs") ? 1 : 0);
+
 	// EntryPoint
 	shader_header += std::format("#define ENTRY_POINT_{} {}\n", inEntryPoint, 1);
 
@@ -755,10 +764,29 @@ void Renderer::Render(ID3D12GraphicsCommandList4* inCommandList)
 		inCommandList->Dispatch(gAlignUpDiv(mRuntime.mSpatialHashBuffer.GetSizeInBytes() / 16 /* UInt4 */, 64u), 1, 1);
 
 		gRenderer.Setup(gRenderer.mRuntime.mClearBufferShader, { .mData0 = { mRuntime.mSpatialDataBuffer.mUAVIndex, ClearMode::UInt4, 0, 0 }, .mData1 = clear_value_uint });
-		inCommandList->Dispatch(gAlignUpDiv(mRuntime.mSpatialHashBuffer.GetSizeInBytes() / 16 /* UInt4 */, 64u), 1, 1);
+		inCommandList->Dispatch(gAlignUpDiv(mRuntime.mSpatialDataBuffer.GetSizeInBytes() / 16 /* UInt4 */, 64u), 1, 1);
+
+		gRenderer.Setup(gRenderer.mRuntime.mClearBufferShader, { .mData0 = { mRuntime.mSpatialAgeBuffer.mUAVIndex, ClearMode::UInt4, 0, 0 }, .mData1 = clear_value_uint });
+		inCommandList->Dispatch(gAlignUpDiv(mRuntime.mSpatialAgeBuffer.GetSizeInBytes() / 16 /* UInt4 */, 64u), 1, 1);
+
+		gRenderer.Setup(gRenderer.mRuntime.mClearBufferShader, { .mData0 = { mRuntime.mRadianceCacheAccumulationBuffer.mUAVIndex, ClearMode::UInt4, 0, 0 }, .mData1 = clear_value_uint });
+		inCommandList->Dispatch(gAlignUpDiv(mRuntime.mRadianceCacheAccumulationBuffer.GetSizeInBytes() / 16 /* UInt4 */, 64u), 1, 1);
+
+		gRenderer.Setup(gRenderer.mRuntime.mClearBufferShader, { .mData0 = { mRuntime.mRadianceCacheResolvedBuffer.mUAVIndex, ClearMode::UInt4, 0, 0 }, .mData1 = clear_value_uint });
+		inCommandList->Dispatch(gAlignUpDiv(mRuntime.mRadianceCacheResolvedBuffer.GetSizeInBytes() / 16 /* UInt4 */, 64u), 1, 1);
 
 		mSpatialCacheResetRequested = false;
 	}
+
+	// Spatial cache counters are per frame
+	{
+		uint4 clear_value_uint = { 0, 0, 0, 0 };
+
+		gRenderer.Setup(gRenderer.mRuntime.mClearBufferShader, { .mData0 = { mRuntime.mSpatialStatsBuffer.mUAVIndex, ClearMode::UInt4, 0, 0 }, .mData1 = clear_value_uint });
+		inCommandList->Dispatch(gAlignUpDiv(mRuntime.mSpatialStatsBuffer.GetSizeInBytes() / 16 /* UInt4 */, 64u), 1, 1);
+	}
+
+	gBarrierUAV(inCommandList, nullptr);
 }
 
 void Renderer::ImGuiShowTextures()
@@ -805,6 +833,8 @@ void Renderer::FinalizeScreenSizeTextures()
 
 void Renderer::InitializeShaders()
 {
+	PROFILE_SCOPE("Renderer::InitializeShaders");
+
 	for (auto&& shader : mRuntime.mShaders)
 		mCompiler.CompileShader(shader);
 
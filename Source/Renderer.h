@@ -4,6 +4,7 @@
 
 static constexpr DXGI_FORMAT					kBackBufferFormat			= DXGI_FORMAT_R8G8B8A8_UNORM;
 static constexpr uint							kTimestampCount				= 1024;
+static constexpr DXGI_FORMAT					kReservoirFormat			= RESERVOIR_PACKING_COMPACT ? DXGI_FORMAT_R32G32_UINT : DXGI_FORMAT_R32G32B32A32_UINT;
 
 struct Renderer
 {
@@ -17,6 +18,7 @@ struct Renderer
 		Shader									mClearScreenShader			= Shader().FileName("Shader/Composite.hpp").CSName("ClearScreenCS");
 		Shader									mClearDebugShader			= Shader().FileName("Shader/Composite.hpp").CSName("ClearDebugCS");
 		Shader									mClearBufferShader			= Shader().FileName("Shader/Composite.hpp").CSName("ClearBufferCS");
+		Shader									mSpatialCacheUpdateShader	= Shader().FileName("Shader/Composite.hpp").CSName("SpatialCacheUpdateCS");
 		Shader									mGenerateTextureShader		= Shader().FileName("Shader/Composite.hpp").CSName("GeneratTextureCS");
 		Shader									mBRDFSliceShader			= Shader().FileName("Shader/Composite.hpp").CSName("BRDFSliceCS");
 		Shader									mReadbackShader				= Shader().FileName("Shader/Composite.hpp").CSName("ReadbackCS");
@@ -46,9 +48,9 @@ struct Renderer
 		Texture									mScreenDebugTexture			= Texture().Format(DXGI_FORMAT_R32G32B32A32_FLOAT).UAVIndex(ViewDescriptorIndex::ScreenDebugUAV).SRVIndex(ViewDescriptorIndex::ScreenDebugSRV).Name("Renderer.ScreenDebugTexture");
 		Texture									mScreenReadbackTexture		= Texture().Format(DXGI_FORMAT_R8G8B8A8_UNORM).UAVIndex(ViewDescriptorIndex::ScreenReadbackUAV).SRVIndex(ViewDescriptorIndex::ScreenReadbackSRV).Name("Renderer.ScreenReadbackTexture");
 		Texture									mScreenDepthTexture			= Texture().Format(DXGI_FORMAT_D32_FLOAT).DSVIndex(DSVDescriptorIndex::ScreenDepth).SRVIndex(ViewDescriptorIndex::ScreenDepthSRV).SRVFormat(DXGI_FORMAT_R32_FLOAT).Name("Renderer.ScreenDepthTexture");
-		Texture									mScreenReservoirInitializeTexture	= Texture().Format(DXGI_FORMAT_R32G32B32A32_UINT).UAVIndex(ViewDescriptorIndex::ScreenReservoirInitializeUAV).SRVIndex(ViewDescriptorIndex::ScreenReservoirInitializeSRV).Name("Renderer.ScreenReservoirInitializeTexture");
-		Texture									mScreenReservoirTemporalTexture		= Texture().Format(DXGI_FORMAT_R32G32B32A32_UINT).UAVIndex(ViewDescriptorIndex::ScreenReservoirTemporalUAV).SRVIndex(ViewDescriptorIndex::ScreenReservoirTemporalSRV).Name("Renderer.ScreenReservoirTemporalTexture");
-		Texture									mScreenReservoirSpatialTexture		= Texture().Format(DXGI_FORMAT_R32G32B32A32_UINT).UAVIndex(ViewDescriptorIndex::ScreenReservoirSpatialUAV).SRVIndex(ViewDescriptorIndex::ScreenReservoirSpatialSRV).Name("Renderer.ScreenReservoirSpatialTexture");
+		Texture									mScreenReservoirInitializeTexture	= Texture().Format(kReservoirFormat).UAVIndex(ViewDescriptorIndex::ScreenReservoirInitializeUAV).SRVIndex(ViewDescriptorIndex::ScreenReservoirInitializeSRV).Name("Renderer.ScreenReservoirInitializeTexture");
+		Texture									mScreenReservoirTemporalTexture		= Texture().Format(kReservoirFormat).UAVIndex(ViewDescriptorIndex::ScreenReservoirTemporalUAV).SRVIndex(ViewDescriptorIndex::ScreenReservoirTemporalSRV).Name("Renderer.ScreenReservoirTemporalTexture");
+		Texture									mScreenReservoirSpatialTexture		= Texture().Format(kReservoirFormat).UAVIndex(ViewDescriptorIndex::ScreenReservoirSpatialUAV).SRVIndex(ViewDescriptorIndex::ScreenReservoirSpatialSRV).Name("Renderer.ScreenReservoirSpatialTexture");
 		// Texture									mScreen9995Texture			= Texture().Format(DXGI_FORMAT_R9G9B9E5_SHAREDEXP).UAVIndex(ViewDescriptorIndex::Screen9995UAV).SRVIndex(ViewDescriptorIndex::Screen9995SRV).Name("Renderer.Screen9995Texture");
 
 		Texture									mScreenSentinelTexture;
@@ -73,6 +75,10 @@ struct Renderer
 		Buffer									mQueryBuffer				= Buffer().Stride(sizeof(UINT64)).ElementCount(kTimestampCount).Name("Renderer.Query").GPU(false).Readback(true);
 		Buffer 									mSpatialHashBuffer			= Buffer().Stride(sizeof(uint32_t)).ElementCount(kSpatialHashSize).UAVIndex(ViewDescriptorIndex::SpatialHashUAV).Name("Renderer.SpatialHash");
 		Buffer 									mSpatialDataBuffer			= Buffer().Stride(sizeof(uint32_t)).ElementCount(kSpatialHashSize).UAVIndex(ViewDescriptorIndex::SpatialDataUAV).Name("Renderer.SpatialData");
+		Buffer 									mSpatialAgeBuffer			= Buffer().Stride(sizeof(uint32_t)).ElementCount(kSpatialHashSize).UAVIndex(ViewDescriptorIndex::SpatialAgeUAV).Name("Renderer.SpatialAge");
+		Buffer 									mSpatialStatsBuffer			= Buffer().Stride(sizeof(uint32_t)).ElementCount(kSpatialCacheCounterCount).UAVIndex(ViewDescriptorIndex::SpatialStatsUAV).Readback(true).Name("Renderer.SpatialStats");
+		Buffer 									mRadianceCacheAccumulationBuffer	= Buffer().Stride(sizeof(uint32_t)).ElementCount(kSpatialHashSize * 4).UAVIndex(ViewDescriptorIndex::RadianceCacheAccumulationUAV).Name("Renderer.RadianceCacheAccumulation");
+		Buffer 									mRadianceCacheResolvedBuffer		= Buffer().Stride(sizeof(float4)).ElementCount(kSpatialHashSize).UAVIndex(ViewDescriptorIndex::RadianceCacheResolvedUAV).Name("Renderer.RadianceCacheResolved");
 		Buffer 									mShaderPrintBuffer			= Buffer().Stride(sizeof(uint32_t)).ElementCount(64 * 1024).UAVIndex(ViewDescriptorIndex::ShaderPrintUAV).Readback(true).Name("Renderer.ShaderPrintUAV");
 		Buffer									mReservedBuffer				= Buffer().Stride(sizeof(uint32_t)).ElementCount(1).UAVIndex(ViewDescriptorIndex::ReservedUAV).Reserved(true).Name("Renderer.Reserved");
 		Buffer									mPlacedBuffer				= Buffer().Stride(sizeof(uint32_t)).ElementCount(1).UAVIndex(ViewDescriptorIndex::PlacedUAV).Placed(true).Name("Renderer.Placed");
@@ -100,6 +106,8 @@ struct Renderer
 		bool									CreateLibPipelineState(const std::string_view& inFileName, const std::string_view& inLibName, Shader& ioShader);
 		bool									CompileShader(Shader& ioShader);
 		ComPtr<IDxcBlob>						Compile(const std::string_view& inFilename, const std::string_view& inEntryPoint, const std::string_view& inProfile);
+		std::string								SharedHeader() const;	// Part of generated header that does not depend on entry point, e.g. modes, configs, scene BSDFs
+		std::string								mCompiledSharedHeader;	// Of last Compile, shaders are stale once SharedHeader differs
 
 		ComPtr<ID3D12StateObject>				CreateStateObject(IDxcBlob* inBlob, Shader& ioShader);
 		ShaderTable								CreateShaderTable(const Shader& inShader, const Shader& inRayGenerationShader, const Shader& inMissShader);
@@ -187,8 +195,11 @@ struct Renderer
 
 	bool										mSpatialCacheActiveOnce = false;
 	bool										mSpatialCacheResetRequested = true;
+	bool										mSpatialCacheTelemetryVisible = false;	// Set by GUI each frame, occupancy is counted by SpatialCacheUpdateCS
 
 	bool										mSequenceDumpPNG = false;
+	bool										mSequenceEXR = false;			// ScreenColor as EXR instead of postprocessed PNG
+	std::filesystem::path						mSequenceDirectory;				// Of captured images, empty -> working directory
 	bool										mSequenceCameraEnabled = true;
 	int											mSequenceFrameRecording = -1;
 
@@ -209,11 +220,12 @@ struct GPUTiming
 		return timestamp;
 	}
 
-	void TimestampEnd(ID3D12GraphicsCommandList4* inCommandList, UINT64 inTimestampBegin, float* outDurationMSPtr)
+	void TimestampEnd(ID3D12GraphicsCommandList4* inCommandList, UINT64 inTimestampBegin, std::string_view inName, float* outDurationMSPtr)
 	{
 		UINT64 timestamp = gRenderer.mRuntime.mQueryBuffer.GetReadback<UINT64>(gGetFrameContextIndex())[mQueryHeapIndex];
 		float durationMS = (timestamp - inTimestampBegin) * 1000.0f / mTimestampFrequency;
 		if (outDurationMSPtr != nullptr) { *outDurationMSPtr = durationMS; }
+		gStats.mGPUTimingHistory.AddTimestamps(inName, inTimestampBegin, timestamp, mTimestampFrequency);
 		inCommandList->EndQuery(gQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, mQueryHeapIndex++);
 	}
 
@@ -228,12 +240,13 @@ extern GPUTiming								gGPUTiming;
 struct GPUTimingScope
 {
 	GPUTimingScope(ID3D12GraphicsCommandList4* inCommandList) : mCommandList(inCommandList) { mTimestampBegin = gGPUTiming.TimestampBegin(mCommandList); }
-	~GPUTimingScope()							{ gGPUTiming.TimestampEnd(mCommandList, mTimestampBegin, mDurationMSPtr); }
+	~GPUTimingScope()							{ gGPUTiming.TimestampEnd(mCommandList, mTimestampBegin, mName, mDurationMSPtr); }
 
 	UINT64										mTimestampBegin = 0;
+	std::string_view							mName;
 	float*										mDurationMSPtr = nullptr;
 	ID3D12GraphicsCommandList4*					mCommandList = nullptr;
 };
 #define GPU_TIMING_SCOPE(inName, inCommandList, outDurationMSPtr)		\
 		PIXScopedEvent(inCommandList, PIX_COLOR(0, 255, 0), inName);	\
-		GPUTimingScope mGPUTimingScope_##__LINE__(inCommandList); mGPUTimingScope_##__LINE__.mDurationMSPtr = outDurationMSPtr;
\ No newline at end of file
+		GPUTimingScope mGPUTimingScope_##__LINE__(inCommandList); mGPUTimingScope_##__LINE__.mName = inName; mGPUTimingScope_##__LINE__.mDurationMSPtr = outDurationMSPtr;
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Renderer.h"
 #include "Atmosphere.h"
 #include "Cloud.h"
+#include "Validate.h"
 
 #include "Thirdparty/glm/glm/gtx/matrix_decompose.hpp"
 #include "Thirdparty/tinyxml2/tinyxml2.h"
@@ -12,6 +13,8 @@
 #include "Thirdparty/tiny_gltf.h"
 #include "Thirdparty/tinyexr.h"
 
+#include <thread>
+
 #pragma warning(disable: 4244) // possible loss of data
 #pragma warning(disable: 4324) // structure was padded due to alignment specifier
 #include "Thirdparty/openvdb/nanovdb/NanoVDB.h"
@@ -41,13 +44,16 @@ void BLAS::Initialize(const Initializer& inInitializer)
 	mDesc.Triangles.VertexCount = instance_data.mVertexCount;
 	if (instance_data.mIndexCount > 0)
 	{
-		mDesc.Triangles.IndexBuffer = inInitializer.mIndicesBaseAddress + instance_data.mIndexOffset * sizeof(IndexType);
+		mDesc.Triangles.IndexBuffer = inInitializer.mIndicesBaseAddress + instance_data.mIndexByteOffset;
 		mDesc.Triangles.IndexCount = instance_data.mIndexCount;
-		mDesc.Triangles.IndexFormat = DXGI_FORMAT_R32_UINT;
+		mDesc.Triangles.IndexFormat = instance_data.mFlags.mIndex16Bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 	}
 
 	mInputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
 	mInputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+	mCompactedSizeAddress = inInitializer.mCompactedSizeAddress;
+	if (mCompactedSizeAddress != 0)
+		mInputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION;
 	mInputs.NumDescs = 1;
 	mInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
 	mInputs.pGeometryDescs = &mDesc;
@@ -397,6 +403,11 @@ void BLAS::Build(ID3D12GraphicsCommandList4* inCommandList)
 	if (mBuilt)
 		return;
 
+	D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postbuild_info = {};
+	postbuild_info.DestBuffer = mCompactedSizeAddress;
+	postbuild_info.InfoType = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE;
+	UINT postbuild_info_count = mCompactedSizeAddress != 0 ? 1 : 0;
+
 	if (mClusterCLAS.mBuild != nullptr)
 	{
 		// CLAS
@@ -429,8 +440,8 @@ void BLAS::Build(ID3D12GraphicsCommandList4* inCommandList)
 		NVAPI_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_EX_PARAMS params = {};
 		params.version = NVAPI_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_EX_PARAMS_VER;
 		params.pDesc = &desc;
-		params.numPostbuildInfoDescs = 0;
-		params.pPostbuildInfoDescs = nullptr;
+		params.numPostbuildInfoDescs = postbuild_info_count;
+		params.pPostbuildInfoDescs = postbuild_info_count > 0 ? &postbuild_info : nullptr;
 		gVerify(NvAPI_D3D12_BuildRaytracingAccelerationStructureEx(inCommandList, &params) == NVAPI_OK);
 	}
 	else
@@ -440,27 +451,78 @@ void BLAS::Build(ID3D12GraphicsCommandList4* inCommandList)
 		desc.DestAccelerationStructureData = mDest->GetGPUVirtualAddress();
 		desc.SourceAccelerationStructureData = 0;
 		desc.ScratchAccelerationStructureData = mScratch->GetGPUVirtualAddress();
-		inCommandList->BuildRaytracingAccelerationStructure(&desc, 0, nullptr);
+		inCommandList->BuildRaytracingAccelerationStructure(&desc, postbuild_info_count, postbuild_info_count > 0 ? &postbuild_info : nullptr);
 	}
 
 	mBuilt = true;
 }
 
+void BLAS::Compact(ID3D12GraphicsCommandList4* inCommandList, D3D12_GPU_VIRTUAL_ADDRESS inDestination, std::vector<ComPtr<ID3D12Resource>>& ioRetired)
+{
+	inCommandList->CopyRaytracingAccelerationStructure(inDestination, mDest->GetGPUVirtualAddress(), D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_COMPACT);
+	mCompactedAddress = inDestination;
+
+	// Not rebuilt after compaction, scratch goes too
+	ioRetired.push_back(std::move(mDest));
+	ioRetired.push_back(std::move(mScratch));
+}
+
+void TLAS::SetTransform(uint inInstanceIndex, const glm::mat4x4& inTransform)
+{
+	glm::mat4x4 transform = glm::transpose(inTransform); // column-major -> row-major
+	memcpy(mInstanceDescsCPU[inInstanceIndex].Transform, &transform, sizeof(mInstanceDescsCPU[inInstanceIndex].Transform));
+	mUpdatePolicy.SetTransform(inInstanceIndex, inTransform);
+}
+
+void TLAS::SetAccelerationStructure(uint inInstanceIndex, D3D12_GPU_VIRTUAL_ADDRESS inAddress)
+{
+	if (mInstanceDescsCPU[inInstanceIndex].AccelerationStructure == inAddress)
+		return;
+
+	mInstanceDescsCPU[inInstanceIndex].AccelerationStructure = inAddress;
+	mUpdatePolicy.MarkModified(inInstanceIndex);
+}
+
 void TLAS::Build(ID3D12GraphicsCommandList4* inCommandList)
+{
+	Build(inCommandList, false);
+}
+
+void TLAS::Update(ID3D12GraphicsCommandList4* inCommandList)
+{
+	// Slot of this frame is no longer read by GPU, write only what changed since it was last written
+	uint slot_index = gGetFrameContextIndex();
+	TLASUpdatePolicy::Action action = mUpdatePolicy.Update(slot_index, mUpdateRanges);
+	for (const TLASUpdatePolicy::Range& range : mUpdateRanges)
+		memcpy(mInstanceDescsPointer + slot_index * mInputs.NumDescs + range.mBegin, mInstanceDescsCPU.data() + range.mBegin, sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * (range.mEnd - range.mBegin));
+
+	if (action != TLASUpdatePolicy::Action::None)
+		Build(inCommandList, action == TLASUpdatePolicy::Action::Refit && IsUpdatable());
+}
+
+void TLAS::Build(ID3D12GraphicsCommandList4* inCommandList, bool inRefit)
 {
 	// [NOTE] DestAccelerationStructureData = 0/Reserved cause GPU crash on Nvidia, Placed/Evicted and other address don't (not always).
 	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC desc = {};
 	desc.Inputs = mInputs;
-	desc.Inputs.InstanceDescs = mInstanceDescs->GetGPUVirtualAddress();
+	desc.Inputs.InstanceDescs = mInstanceDescs->GetGPUVirtualAddress() + sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * mInputs.NumDescs * gGetFrameContextIndex();
 	desc.DestAccelerationStructureData = mDest->GetGPUVirtualAddress();
 	desc.ScratchAccelerationStructureData = mScratch->GetGPUVirtualAddress();
+	if (inRefit)
+	{
+		// In place refit, topology of last build is kept
+		desc.Inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
+		desc.SourceAccelerationStructureData = mDest->GetGPUVirtualAddress();
+	}
 	inCommandList->BuildRaytracingAccelerationStructure(&desc, 0, nullptr);
 }
 
-void TLAS::Initialize(const std::string& inName, const std::vector<D3D12_RAYTRACING_INSTANCE_DESC>& inInstanceDescs)
+void TLAS::Initialize(const std::string& inName, const std::vector<D3D12_RAYTRACING_INSTANCE_DESC>& inInstanceDescs, std::span<const float> inRadii)
 {
 	mInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
 	mInputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+	if (!inRadii.empty())
+		mInputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
 	mInputs.NumDescs = static_cast<UINT>(inInstanceDescs.size());
 	mInputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
 
@@ -469,7 +531,7 @@ void TLAS::Initialize(const std::string& inName, const std::vector<D3D12_RAYTRAC
 
 	{
 		D3D12_HEAP_PROPERTIES props = gGetDefaultHeapProperties();
-		D3D12_RESOURCE_DESC desc = gGetUAVResourceDesc(info.ScratchDataSizeInBytes);
+		D3D12_RESOURCE_DESC desc = gGetUAVResourceDesc(gMax(info.ScratchDataSizeInBytes, info.UpdateScratchDataSizeInBytes));
 		gValidate(gDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&mScratch)));
 		gSetName(mScratch, "Scene", inName, ".[TLAS].Scratch");
 	}
@@ -482,16 +544,28 @@ void TLAS::Initialize(const std::string& inName, const std::vector<D3D12_RAYTRAC
 	}
 
 	{
+		uint64_t slot_size = sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * gMax(inInstanceDescs.size(), size_t(1));
 		D3D12_HEAP_PROPERTIES props = gGetUploadHeapProperties();
-		D3D12_RESOURCE_DESC desc = gGetBufferResourceDesc(sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * inInstanceDescs.size());
+		D3D12_RESOURCE_DESC desc = gGetBufferResourceDesc(slot_size * kFrameInFlightCount);
 		gValidate(gDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mInstanceDescs)));
 		gSetName(mInstanceDescs, "Scene", inName, ".[TLAS].InstanceDescs");
 
-		uint8_t* pData = nullptr;
-		mInstanceDescs->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-		memcpy(pData, inInstanceDescs.data(), desc.Width);
-		mInstanceDescs->Unmap(0, nullptr);
+		// Persistent map, all slots start with the same descs
+		mInstanceDescs->Map(0, nullptr, reinterpret_cast<void**>(&mInstanceDescsPointer));
+		for (int slot_index = 0; slot_index < kFrameInFlightCount; slot_index++)
+			memcpy(mInstanceDescsPointer + slot_index * inInstanceDescs.size(), inInstanceDescs.data(), sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * inInstanceDescs.size());
+	}
+
+	mInstanceDescsCPU = inInstanceDescs;
+
+	std::vector<glm::mat4x4> transforms(inInstanceDescs.size());
+	for (size_t instance_index = 0; instance_index < inInstanceDescs.size(); instance_index++)
+	{
+		glm::mat4x4 transform(1.0f);
+		memcpy(&transform, inInstanceDescs[instance_index].Transform, sizeof(inInstanceDescs[instance_index].Transform));
+		transforms[instance_index] = glm::transpose(transform); // row-major -> column-major
 	}
+	mUpdatePolicy.Initialize(transforms, inRadii, kFrameInFlightCount);
 }
 
 std::vector<ScenePreset> ScenePreset::sPresets =
@@ -570,17 +644,21 @@ bool Scene::LoadDummy(SceneContent& ioSceneContent)
 	return true;
 }
 
-bool Scene::LoadObj(const std::string& inFilename, const glm::mat4x4& inTransform, bool inFlipV, SceneContent& ioSceneContent)
+bool Scene::LoadObj(const std::string& inFilename, const glm::mat4x4& inTransform, bool inFlipV, SceneContent& ioSceneContent, std::string* outMessages)
 {
+	PROFILE_SCOPE("Scene::LoadObj");
+
 	tinyobj::ObjReader reader;
-	if (!reader.ParseFromFile(inFilename))
-		return false;
+	bool parsed = reader.ParseFromFile(inFilename);
 
-	if (!reader.Warning().empty())
-		gTrace(reader.Warning().c_str());
+	std::string messages = reader.Warning() + reader.Error();
+	if (outMessages != nullptr)
+		*outMessages += messages;
+	else if (!messages.empty())
+		gTrace(messages);
 
-	if (!reader.Error().empty())
-		gTrace(reader.Error().c_str());
+	if (!parsed)
+		return false;
 
 	// Fetch indices, attributes
 	gAssert(reader.GetShapes().size() == 1);
@@ -746,6 +824,8 @@ bool Scene::LoadObj(const std::string& inFilename, const glm::mat4x4& inTransfor
 
 bool Scene::LoadMitsuba(const std::string& inFilename, SceneContent& ioSceneContent)
 {
+	PROFILE_SCOPE("Scene::LoadMitsuba");
+
 	static auto get_first_child_element_by_lambda = [](tinyxml2::XMLElement* inElement, const char* inName, const auto&& inLambda)
 		{
 			tinyxml2::XMLElement* child = inElement->FirstChildElement(inName);
@@ -817,10 +897,77 @@ bool Scene::LoadMitsuba(const std::string& inFilename, SceneContent& ioSceneCont
 			return str;
 		};
 
+	static auto get_obj_path = [](tinyxml2::XMLElement* inShape, const std::string& inFilename)
+		{
+			std::filesystem::path path = inFilename;
+			path.replace_filename(std::filesystem::path(get_child_value(inShape, "filename")));
+			return path;
+		};
+
+	// Fast pass over document to collect referenced OBJ files, in document order
 	tinyxml2::XMLDocument doc;
-	doc.LoadFile(inFilename.c_str());
+	tinyxml2::XMLElement* scene = nullptr;
+	std::vector<std::filesystem::path> obj_paths;
+	std::unordered_map<std::string, uint32_t> obj_key_to_index;		// Normalized lower case path
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mXMLParseMS);
+
+		doc.LoadFile(inFilename.c_str());
+		scene = doc.FirstChildElement("scene");
+		if (scene == nullptr)
+			return false;
+
+		for (tinyxml2::XMLElement* shape = scene->FirstChildElement("shape"); shape != nullptr; shape = shape->NextSiblingElement("shape"))
+		{
+			if (std::string_view(null_to_empty(shape->Attribute("type"))) != "obj")
+				continue;
+
+			std::filesystem::path path = get_obj_path(shape, inFilename);
+			if (obj_key_to_index.try_emplace(gToLower(path.lexically_normal().string()), static_cast<uint32_t>(obj_paths.size())).second)
+				obj_paths.push_back(path);
+		}
+	}
+
+	// Load all OBJ files concurrently, each into its own content
+	// Note that mitsuba apply flip_tex_coords on .obj by default
+	// See flip_tex_coords https://mitsuba.readthedocs.io/en/stable/src/generated/plugins_shapes.html#wavefront-obj-mesh-loader-obj
+	// [NOTE] Workers only write their own ObjLoad, LoadObj touches no Scene state. Messages are traced on this thread after the join.
+	struct ObjLoad
+	{
+		SceneContent mContent;
+		std::string mMessages;
+	};
+	std::vector<ObjLoad> obj_loads(obj_paths.size());
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mObjIOMS);
+
+		std::transform(std::execution::par, obj_paths.begin(), obj_paths.end(), obj_loads.begin(), [&](const std::filesystem::path& inPath)
+		{
+			ObjLoad obj_load;
+			if (!LoadObj(inPath.string(), glm::mat4x4(1.0f), true, obj_load.mContent, &obj_load.mMessages))
+				obj_load.mMessages += std::format("[Scene] Failed to load {}\n", inPath.string());
+			return obj_load;
+		});
+	}
+	for (const ObjLoad& obj_load : obj_loads)
+		if (!obj_load.mMessages.empty())
+			gTrace(obj_load.mMessages);
 
-	tinyxml2::XMLElement* scene = doc.FirstChildElement("scene");
+	// Merge into ioSceneContent in document order, from here on
+	auto merge_begin = std::chrono::steady_clock::now();
+	{
+		size_t obj_vertex_count = 0;
+		size_t obj_index_count = 0;
+		for (const ObjLoad& obj_load : obj_loads)
+		{
+			obj_vertex_count += obj_load.mContent.mVertices.size();
+			obj_index_count += obj_load.mContent.mIndices.size();
+		}
+		ioSceneContent.mVertices.reserve(ioSceneContent.mVertices.size() + obj_vertex_count);
+		ioSceneContent.mNormals.reserve(ioSceneContent.mNormals.size() + obj_vertex_count);
+		ioSceneContent.mUVs.reserve(ioSceneContent.mUVs.size() + obj_vertex_count);
+		ioSceneContent.mIndices.reserve(ioSceneContent.mIndices.size() + obj_index_count);
+	}
 
 	struct BSDFInstance
 	{
@@ -843,8 +990,20 @@ bool Scene::LoadMitsuba(const std::string& inFilename, SceneContent& ioSceneCont
 		GeometryType mGeometryType = GeometryType::LSS;
 	};
 
+	// Shapes referencing same primitive or OBJ file share one vertex/index range, and one BLAS, see Scene::GenerateBLASIndices
+	struct MeshRange
+	{
+		uint32_t mVertexOffset = 0;
+		uint32_t mVertexCount = 0;
+		uint32_t mIndexOffset = 0;
+		uint32_t mIndexCount = 0;
+		bool mHasNormal = false;
+		bool mHasUV = false;
+	};
+
 	std::unordered_map<std::string_view, BSDFInstance> bsdf_id_to_instance;
 	std::unordered_map<std::string_view, ShapegroupInstance> shapegroup_id_to_instance;
+	std::unordered_map<std::string, MeshRange> mesh_key_to_range;	// Primitive type or OBJ path
 	tinyxml2::XMLElement* bsdf = scene->FirstChildElement("bsdf");
 	while (bsdf != nullptr) // loop to handle nested bsdf
 	{
@@ -1036,36 +1195,36 @@ bool Scene::LoadMitsuba(const std::string& inFilename, SceneContent& ioSceneCont
 		std::string_view id = null_to_empty(shape->Attribute("id"));
 
 		SceneContent* primitive = nullptr;
-		SceneContent loaded_primitive;
+		std::string mesh_key;
 		bool is_instance_lss = false;
 		if (type == "cube")
 		{
 			primitive = &mPrimitives.mCube;
+			mesh_key = type;
 			id = id.empty() ? "cube" : id;
 		}
 		else if (type == "rectangle")
 		{
 			primitive = &mPrimitives.mRectangle;
+			mesh_key = type;
 			id = id.empty() ? "rectangle" : id;
 		}
 		else if (type == "sphere")
 		{
 			primitive = &mPrimitives.mSphere;
+			mesh_key = type;
 			id = id.empty() ? "sphere" : id;
 		}
 		else if (type == "cylinder")
 		{
 			primitive = &mPrimitives.mCylinder;
+			mesh_key = type;
 			id = id.empty() ? "cylinder" : id;
 		}
 		else if (type == "obj")
 		{
-			std::filesystem::path path = inFilename;
-			path.replace_filename(std::filesystem::path(get_child_value(shape, "filename")));
-			// Note that mitsuba apply flip_tex_coords on .obj by default
-			// See flip_tex_coords https://mitsuba.readthedocs.io/en/stable/src/generated/plugins_shapes.html#wavefront-obj-mesh-loader-obj
-			LoadObj(path.string(), glm::mat4x4(1.0f), true, loaded_primitive);
-			primitive = &loaded_primitive;
+			mesh_key = gToLower(get_obj_path(shape, inFilename).lexically_normal().string());
+			primitive = &obj_loads[obj_key_to_index.at(mesh_key)].mContent;
 			id = id.empty() ? "obj" : id;
 		}
 		else if (type == "shapegroup")
@@ -1219,26 +1378,42 @@ bool Scene::LoadMitsuba(const std::string& inFilename, SceneContent& ioSceneCont
 		const ShapegroupInstance* shapegroup_instance = nullptr;
 		bool has_uv = false;
 		bool has_normal = false;
-		if (primitive != nullptr)
+		if (!mesh_key.empty())
 		{
-			vertex_offset = static_cast<uint32_t>(ioSceneContent.mVertices.size());
-			vertex_count = static_cast<uint32_t>(primitive->mVertices.size());
+			auto [iter, inserted] = mesh_key_to_range.try_emplace(mesh_key);
+			MeshRange& mesh_range = iter->second;
+			if (inserted)
+			{
+				gAssert(primitive != nullptr);
+				mesh_range.mVertexOffset = static_cast<uint32_t>(ioSceneContent.mVertices.size());
+				mesh_range.mVertexCount = static_cast<uint32_t>(primitive->mVertices.size());
 
-			index_offset = static_cast<uint32_t>(ioSceneContent.mIndices.size());
-			index_count = static_cast<uint32_t>(primitive->mIndices.size());
+				mesh_range.mIndexOffset = static_cast<uint32_t>(ioSceneContent.mIndices.size());
+				mesh_range.mIndexCount = static_cast<uint32_t>(primitive->mIndices.size());
 
-			for (uint32_t i = 0; i < index_count; i++)
-				ioSceneContent.mIndices.push_back(primitive->mIndices[i]);
+				ioSceneContent.mIndices.insert(ioSceneContent.mIndices.end(), primitive->mIndices.begin(), primitive->mIndices.end());
 
-			gAssert(primitive->mVertices.size() == primitive->mNormals.size());
-			gAssert(primitive->mVertices.size() == primitive->mUVs.size());
-			std::copy(primitive->mVertices.begin(), primitive->mVertices.end(), std::back_inserter(ioSceneContent.mVertices));
-			std::copy(primitive->mNormals.begin(), primitive->mNormals.end(), std::back_inserter(ioSceneContent.mNormals));
-			std::copy(primitive->mUVs.begin(), primitive->mUVs.end(), std::back_inserter(ioSceneContent.mUVs));
+				gAssert(primitive->mVertices.size() == primitive->mNormals.size());
+				gAssert(primitive->mVertices.size() == primitive->mUVs.size());
+				std::copy(primitive->mVertices.begin(), primitive->mVertices.end(), std::back_inserter(ioSceneContent.mVertices));
+				std::copy(primitive->mNormals.begin(), primitive->mNormals.end(), std::back_inserter(ioSceneContent.mNormals));
+				std::copy(primitive->mUVs.begin(), primitive->mUVs.end(), std::back_inserter(ioSceneContent.mUVs));
 
-			gAssert(!primitive->mInstanceDatas.empty());
-			has_normal = primitive->mInstanceDatas.front().mFlags.mNormal;
-			has_uv = primitive->mInstanceDatas.front().mFlags.mUV;
+				gAssert(!primitive->mInstanceDatas.empty());
+				mesh_range.mHasNormal = primitive->mInstanceDatas.front().mFlags.mNormal;
+				mesh_range.mHasUV = primitive->mInstanceDatas.front().mFlags.mUV;
+
+				// Loaded OBJ is merged once, release it early to keep peak memory close to serial loading
+				if (type == "obj")
+					*primitive = {};
+			}
+
+			vertex_offset = mesh_range.mVertexOffset;
+			vertex_count = mesh_range.mVertexCount;
+			index_offset = mesh_range.mIndexOffset;
+			index_count = mesh_range.mIndexCount;
+			has_normal = mesh_range.mHasNormal;
+			has_uv = mesh_range.mHasUV;
 		}
 		else if (is_instance_lss)
 		{
@@ -1420,6 +1595,11 @@ bool Scene::LoadMitsuba(const std::string& inFilename, SceneContent& ioSceneCont
 		ioSceneContent.mBSDFs.insert(instance_data.mBSDF);
 	}
 
+	mLoadStats.mMergeMS = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - merge_begin).count();
+
+	gTrace(std::format("[Scene] {} instances share {} meshes, {} vertices\n", ioSceneContent.mInstanceDatas.size(), mesh_key_to_range.size(), ioSceneContent.mVertices.size()));
+	gTrace(std::format("[Scene] Mitsuba XML {:.2f} ms, OBJ I/O {:.2f} ms for {} files, merge {:.2f} ms\n", mLoadStats.mXMLParseMS, mLoadStats.mObjIOMS, obj_paths.size(), mLoadStats.mMergeMS));
+
 	tinyxml2::XMLElement* sensor = scene->FirstChildElement("sensor");
 	if (sensor != nullptr)
 	{
@@ -1438,22 +1618,140 @@ bool Scene::LoadMitsuba(const std::string& inFilename, SceneContent& ioSceneCont
 	return true;
 }
 
+// Replaces stream reads of tinygltf for .gltf, .glb and external buffers
+// [NOTE] tinygltf owns buffer storage, so mapped file is still copied once into it
+static bool sReadWholeFileMapped(std::vector<unsigned char>* outData, std::string* outError, const std::string& inFilename, void* inUserData)
+{
+	UNUSED(inUserData);
+
+	HANDLE file = CreateFileW(gToWString(inFilename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		if (outError != nullptr)
+			*outError += std::format("File open error : {}\n", inFilename);
+		return false;
+	}
+
+	LARGE_INTEGER size = {};
+	HANDLE mapping = nullptr;
+	const void* view = nullptr;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr)
+			view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	bool succeeded = view != nullptr;
+	if (succeeded)
+	{
+		outData->resize(static_cast<size_t>(size.QuadPart));
+		memcpy(outData->data(), view, outData->size());
+		UnmapViewOfFile(view);
+	}
+	else if (outError != nullptr)
+		*outError += std::format("File read error : {}\n", inFilename);
+
+	gSafeCloseHandle(mapping);
+	gSafeCloseHandle(file);
+	return succeeded;
+}
+
+// One memcpy for tightly packed accessor, otherwise element by element with size known at compile time
+template <typename T>
+static void sCopyAccessor(const uint8_t* inSource, size_t inStride, size_t inCount, T* outDestination)
+{
+	if (inStride == sizeof(T))
+		memcpy(outDestination, inSource, inCount * sizeof(T));
+	else
+		for (size_t i = 0; i < inCount; i++)
+			memcpy(outDestination + i, inSource + i * inStride, sizeof(T));
+}
+
+// Branch once per accessor, widening copies are vectorized
+static void sCopyIndices(const uint8_t* inSource, int inComponentType, size_t inCount, IndexType* outDestination)
+{
+	static_assert(sizeof(IndexType) == sizeof(uint32_t));
+
+	switch (inComponentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		memcpy(outDestination, inSource, inCount * sizeof(uint32_t)); break;
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	std::copy_n(reinterpret_cast<const uint16_t*>(inSource), inCount, outDestination); break;
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		std::copy_n(inSource, inCount, outDestination); break;
+	default:										gAssert(false); break;
+	}
+}
+
+// 0 for all hardware threads, 1 for serial
+static uint sParallelForThreadCount(uint inThreadCount)
+{
+	return inThreadCount == 0 ? gMax(std::thread::hardware_concurrency(), 1u) : inThreadCount;
+}
+
+// std::execution::par when thread count is 0, otherwise fixed number of threads pulling indices, to measure scaling
+template <typename FunctionType>
+static void sParallelFor(uint inCount, uint inThreadCount, const FunctionType& inFunction)
+{
+	if (inThreadCount == 0)
+	{
+		auto range = std::views::iota(0u, inCount);
+		std::for_each(std::execution::par, range.begin(), range.end(), inFunction);
+		return;
+	}
+
+	std::atomic<uint> next_index = 0;
+	auto run = [&]()
+	{
+		for (uint index = next_index++; index < inCount; index = next_index++)
+			inFunction(index);
+	};
+
+	std::vector<std::thread> threads;
+	for (uint thread_index = 1; thread_index < gMin(inThreadCount, inCount); thread_index++)
+		threads.emplace_back(run);
+	run();
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
 bool Scene::LoadGLTF(const std::string& inFilename, SceneContent& ioSceneContent)
 {
+	PROFILE_SCOPE("Scene::LoadGLTF");
+
 	using namespace tinygltf;
 	using namespace glm;
 
+	// Stats accumulate, camera animation is loaded from another glTF
 	Model model;
-	TinyGLTF loader;
-	std::string err;
-	std::string warn;
-	bool ret = loader.LoadASCIIFromFile(&model, &err, &warn, inFilename);
+	bool ret = false;
+	float file_ms = 0;
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&file_ms);
+
+		TinyGLTF loader;
+		FsCallbacks callbacks = {};
+		callbacks.FileExists = &tinygltf::FileExists;
+		callbacks.ExpandFilePath = &tinygltf::ExpandFilePath;
+		callbacks.ReadWholeFile = &sReadWholeFileMapped;
+		callbacks.WriteWholeFile = &tinygltf::WriteWholeFile;
+		callbacks.GetFileSizeInBytes = &tinygltf::GetFileSizeInBytes;
+		callbacks.user_data = nullptr;
+		loader.SetFsCallbacks(callbacks);
+
+		std::string err;
+		std::string warn;
+		if (inFilename.ends_with(".glb"))
+			ret = loader.LoadBinaryFromFile(&model, &err, &warn, inFilename);
+		else
+			ret = loader.LoadASCIIFromFile(&model, &err, &warn, inFilename);
 
-	if (!warn.empty())
-		gTrace(warn.c_str());
+		if (!warn.empty())
+			gTrace(warn.c_str());
 
-	if (!err.empty())
-		gTrace(err.c_str());
+		if (!err.empty())
+			gTrace(err.c_str());
+	}
+	mLoadStats.mGLTFFileMS += file_ms;
 
 	if (!ret)
 	{
@@ -1461,254 +1759,341 @@ bool Scene::LoadGLTF(const std::string& inFilename, SceneContent& ioSceneContent
 		return ret;
 	}
 
-	std::map<int, SceneContent::InstanceAnimation> animation_by_node;
-	for (auto&& animation : model.animations)
-	{
-		for (auto&& channel : animation.channels)
-		{
-			SceneContent::InstanceAnimation& instance_animation = animation_by_node[channel.target_node];
+	auto traverse_begin = std::chrono::steady_clock::now();
 
-			int output							= animation.samplers[channel.sampler].output;
-			Accessor& accessor					= model.accessors[output];
-			BufferView& buffer_view				= model.bufferViews[accessor.bufferView];
+	// Phase 1, serial: world transforms and names of node instances, with their primitives in traversal order
+	struct PrimitiveInstance
+	{
+		const Mesh*							mMesh = nullptr;
+		const Primitive*					mPrimitive = nullptr;
+		std::string							mName;
+		mat4x4								mMatrix = mat4x4(1.0f);
+		uint								mVertexOffset = 0;
+		uint								mVertexCount = 0;
+		uint								mIndexOffset = 0;
+		uint								mIndexCount = 0;
+		uint								mAnimationNode = ::Animation::kInvalidIndex;
+	};
+	std::vector<PrimitiveInstance> primitive_instances;
 
-			gAssert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+	// Rest pose of each visited node, channels are added after traversal
+	::Animation animation; // Not tinygltf::Animation
+	std::vector<uint> animation_node_by_node(model.nodes.size(), ::Animation::kInvalidIndex);
+	uint camera_animation_node = ::Animation::kInvalidIndex;
 
-			uint8* data							= model.buffers[buffer_view.buffer].data.data() + buffer_view.byteOffset;
-			size_t size							= buffer_view.byteLength;
-			
-			if (channel.target_path == "translation")
-			{
-				// times accessor, assume animation is baked to each frame, for now
-				// int input = animation.samplers[channel.sampler].input;
+	auto visit_node = [&](int inNodeIndex, const Node& inNode, std::string& ioName, mat4x4& ioMatrix, uint& ioAnimationNode)
+	{
+		::Animation::Node animation_node = { .mParentIndex = ioAnimationNode };
+		if (inNode.matrix.size() == 16)
+		{
+			mat4x4 matrix;
+			for (int element = 0; element < 16; element++)
+				matrix[element / 4][element % 4] = (float)inNode.matrix[element]; // column-major as glm
 
-				gAssert(size == sizeof(glm::vec3) * accessor.count);
-				instance_animation.mTranslation.resize(accessor.count);
-				memcpy(instance_animation.mTranslation.data(), data, size);
-			}
-			else if (channel.target_path == "rotation")
-			{
-				gAssert(size == sizeof(glm::vec4) * accessor.count);
-				instance_animation.mRotation.resize(accessor.count);
-				memcpy(instance_animation.mRotation.data(), data, size);
-			}
-			else if (channel.target_path == "scale")
-			{
-				gAssert(size == sizeof(glm::vec3) * accessor.count);
-				instance_animation.mScale.resize(accessor.count);
-				memcpy(instance_animation.mScale.data(), data, size);
-			}
+			vec3 skew;
+			vec4 perspective;
+			glm::decompose(matrix, animation_node.mScale, animation_node.mRotation, animation_node.mTranslation, skew, perspective);
+			ioMatrix = ioMatrix * matrix;
 		}
-	}
-
-	auto visit_node = [&](int inNodeIndex, const Node& inNode, std::string& ioName, mat4x4& ioMatrix)
-	{
 		if (inNode.translation.size() == 3)
-			ioMatrix = ioMatrix * translate(vec3((float)inNode.translation[0], (float)inNode.translation[1], (float)inNode.translation[2]));
+		{
+			animation_node.mTranslation = vec3((float)inNode.translation[0], (float)inNode.translation[1], (float)inNode.translation[2]);
+			ioMatrix = ioMatrix * translate(animation_node.mTranslation);
+		}
 		if (inNode.rotation.size() == 4)
-			ioMatrix = ioMatrix * toMat4(quat((float)inNode.rotation[3], (float)inNode.rotation[0], (float)inNode.rotation[1], (float)inNode.rotation[2]));
+		{
+			animation_node.mRotation = quat((float)inNode.rotation[3], (float)inNode.rotation[0], (float)inNode.rotation[1], (float)inNode.rotation[2]);
+			ioMatrix = ioMatrix * toMat4(animation_node.mRotation);
+		}
 		if (inNode.scale.size() == 3)
-			ioMatrix = ioMatrix * scale(vec3((float)inNode.scale[0], (float)inNode.scale[1], (float)inNode.scale[2]));
+		{
+			animation_node.mScale = vec3((float)inNode.scale[0], (float)inNode.scale[1], (float)inNode.scale[2]);
+			ioMatrix = ioMatrix * scale(animation_node.mScale);
+		}
+
+		ioAnimationNode = animation.AddNode(animation_node);
+		if (animation_node_by_node[inNodeIndex] == ::Animation::kInvalidIndex)
+			animation_node_by_node[inNodeIndex] = ioAnimationNode;
 
 		ioName = std::format("{}.{}", ioName, inNode.name);
 
-		if (inNode.camera != -1)
-		{
-			auto animation_iter = animation_by_node.find(inNodeIndex);
-			if (animation_iter != animation_by_node.end())
-			{
-				gAssert(!ioSceneContent.mCamera.mHasAnimation); // assume at most 1 camera animation
-				ioSceneContent.mCamera.mAnimation = std::move((*animation_iter).second);
-				ioSceneContent.mCamera.mHasAnimation = true;
-			}
-		}
+		if (inNode.camera != -1 && camera_animation_node == ::Animation::kInvalidIndex)
+			camera_animation_node = ioAnimationNode; // First camera only
 
 		if (inNode.mesh == -1)
 			return;
 
-		Mesh mesh = model.meshes[inNode.mesh];
-
-		for (auto&& primitive : mesh.primitives)
+		const Mesh& mesh = model.meshes[inNode.mesh];
+		for (const Primitive& primitive : mesh.primitives)
 		{
 			gAssert(primitive.mode == TINYGLTF_MODE_TRIANGLES);
 
 			auto position_attribute = primitive.attributes.find("POSITION");
 			gAssert(position_attribute != primitive.attributes.end());
-			auto normal_attribute = primitive.attributes.find("NORMAL");
-			gAssert(normal_attribute != primitive.attributes.end());
-			auto uv_attribute = primitive.attributes.find("TEXCOORD_0");
-			gAssert(uv_attribute != primitive.attributes.end());
-
-			Accessor position_accessor = model.accessors[position_attribute->second];
-			uint8* position_data = model.buffers[model.bufferViews[position_accessor.bufferView].buffer].data.data()
-				+ model.bufferViews[position_accessor.bufferView].byteOffset
-				+ position_accessor.byteOffset;
-			size_t position_stride = model.bufferViews[position_accessor.bufferView].byteStride;
-			position_stride = position_stride == 0 ? sizeof(vec3) : position_stride;
-			gAssert(position_accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && position_accessor.type == TINYGLTF_TYPE_VEC3);
-
-			Accessor normal_accessor = model.accessors[normal_attribute->second];
-			uint8* normal_data = model.buffers[model.bufferViews[normal_accessor.bufferView].buffer].data.data()
-				+ model.bufferViews[normal_accessor.bufferView].byteOffset
-				+ normal_accessor.byteOffset;
-			size_t normal_stride = model.bufferViews[normal_accessor.bufferView].byteStride;
-			normal_stride = normal_stride == 0 ? sizeof(vec3) : normal_stride;
-			gAssert(normal_accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && normal_accessor.type == TINYGLTF_TYPE_VEC3);
-
-			Accessor uv_accessor = model.accessors[uv_attribute->second];
-			uint8* uv_data = model.buffers[model.bufferViews[uv_accessor.bufferView].buffer].data.data()
-				+ model.bufferViews[uv_accessor.bufferView].byteOffset
-				+ uv_accessor.byteOffset;
-			size_t uv_stride = model.bufferViews[uv_accessor.bufferView].byteStride;
-			uv_stride = uv_stride == 0 ? sizeof(vec2) : uv_stride;
-			gAssert(uv_accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && uv_accessor.type == TINYGLTF_TYPE_VEC2);
-
-			gAssert(position_accessor.count == normal_accessor.count);
-			gAssert(position_accessor.count == uv_accessor.count);
-
-			uint vertex_offset = (uint)ioSceneContent.mVertices.size();
-			uint vertex_count = (uint)position_accessor.count;
-			for (uint i = 0; i < vertex_count; i++)
+			gAssert(primitive.indices != -1);
+
+			primitive_instances.push_back(
 			{
-				VertexType vertex;
-				memcpy(&vertex, position_data + i * position_stride, sizeof(VertexType));
-				ioSceneContent.mVertices.push_back(vertex);
+				.mMesh = &mesh,
+				.mPrimitive = &primitive,
+				.mName = std::format("{} - {}", ioName, mesh.name),
+				.mMatrix = ioMatrix,
+				.mVertexCount = (uint)model.accessors[position_attribute->second].count,
+				.mIndexCount = (uint)model.accessors[primitive.indices].count,
+				.mAnimationNode = ioAnimationNode,
+			});
+		}
+	};
 
-				NormalType normal;
-				memcpy(&normal, normal_data + i * normal_stride, sizeof(NormalType));
-				ioSceneContent.mNormals.push_back(normal);
+	auto visit_node_and_children = [&](const auto &self, int inNodeIndex, const Node& inNode, const std::string& inParentName, const mat4x4& inParentMatrix, uint inParentAnimationNode) -> void
+	{
+		std::string name = inParentName;
+		mat4x4 matrix = inParentMatrix;
+		uint animation_node = inParentAnimationNode;
+		visit_node(inNodeIndex, inNode, name, matrix, animation_node);
+		for (int child_node_index : inNode.children)
+			self(self, child_node_index, model.nodes[child_node_index], name, matrix, animation_node);
+	};
 
-				UVType uv;
-				memcpy(&uv, uv_data + i * uv_stride, sizeof(UVType));
-				ioSceneContent.mUVs.push_back(uv);
-			}
+	for (int node_index : model.scenes[model.defaultScene].nodes)
+		visit_node_and_children(visit_node_and_children, node_index, model.nodes[node_index], std::string(), mat4x4(1.0f), ::Animation::kInvalidIndex);
 
-			gAssert(primitive.indices != -1);
-			Accessor index_accessor = model.accessors[primitive.indices];
-			uint8* index_data = model.buffers[model.bufferViews[index_accessor.bufferView].buffer].data.data()
-				+ model.bufferViews[index_accessor.bufferView].byteOffset
-				+ index_accessor.byteOffset; 
-			size_t index_stride = model.bufferViews[index_accessor.bufferView].byteStride;
-			gAssert(index_accessor.type == TINYGLTF_TYPE_SCALAR && index_stride == 0); UNUSED(index_stride);
-
-			uint index_offset = (uint)ioSceneContent.mIndices.size();
-			uint index_count = (uint)index_accessor.count;
-			for (uint i = 0; i < index_count; i++)
-			{
-				IndexType index;
-				if (index_accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-					index = *reinterpret_cast<uint16*>(index_data + i * sizeof(uint16));
-				else if (index_accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-					index = *reinterpret_cast<uint32*>(index_data + i * sizeof(uint32));
-				else
-					gAssert(false);
-				ioSceneContent.mIndices.push_back(index);
-			}
+	// [NOTE] Channels of all animations are added to one timeline, so clips targeting different nodes play together
+	auto read_floats = [&](int inAccessorIndex, std::vector<float>& outValues)
+	{
+		const Accessor& accessor = model.accessors[inAccessorIndex];
+		const BufferView& buffer_view = model.bufferViews[accessor.bufferView];
+		if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+			return false;
 
-			Material material = model.materials[primitive.material];
+		size_t component_count = GetNumComponentsInType(accessor.type);
+		size_t stride = buffer_view.byteStride == 0 ? sizeof(float) * component_count : buffer_view.byteStride;
+		const uint8* data = model.buffers[buffer_view.buffer].data.data() + buffer_view.byteOffset + accessor.byteOffset;
+		outValues.resize(accessor.count * component_count);
+		for (size_t element = 0; element < accessor.count; element++)
+			memcpy(outValues.data() + element * component_count, data + element * stride, sizeof(float) * component_count);
+		return true;
+	};
 
-			auto get_texture_path = [&](int inIndex)
-			{
-				if (inIndex == -1)
-					return std::filesystem::path();
+	std::vector<float> times;
+	std::vector<float> values;
+	for (const tinygltf::Animation& gltf_animation : model.animations)
+	{
+		for (const AnimationChannel& channel : gltf_animation.channels)
+		{
+			if (channel.target_node < 0 || animation_node_by_node[channel.target_node] == ::Animation::kInvalidIndex || channel.target_path == "weights")
+				continue;
 
-				std::filesystem::path path = inFilename;
-				auto dds = model.textures[inIndex].extensions.find("MSFT_texture_dds");
-				if (dds != model.textures[inIndex].extensions.end())
-					path.replace_filename(std::filesystem::path(model.images[dds->second.Get("source").GetNumberAsInt()].uri));
-				else
-					path.replace_filename(std::filesystem::path(model.images[model.textures[inIndex].source].uri));
-				return path;
-			};
+			const AnimationSampler& sampler = gltf_animation.samplers[channel.sampler];
+			::Animation::Path path = channel.target_path == "translation" ? ::Animation::Path::Translation : channel.target_path == "rotation" ? ::Animation::Path::Rotation : ::Animation::Path::Scale;
+			::Animation::Interpolation interpolation = sampler.interpolation == "STEP" ? ::Animation::Interpolation::Step : sampler.interpolation == "CUBICSPLINE" ? ::Animation::Interpolation::CubicSpline : ::Animation::Interpolation::Linear;
 
-			InstanceInfo instance_info =
-			{
-				.mName = std::format("{} - {}", ioName, mesh.name),
-				.mMaterial = 
-				{
-					.mMaterialName = material.name,
-					.mAlbedoTexture = get_texture_path(material.pbrMetallicRoughness.baseColorTexture.index),
-					.mNormalTexture = get_texture_path(material.normalTexture.index),
-					.mReflectanceTexture = get_texture_path(material.pbrMetallicRoughness.metallicRoughnessTexture.index),
-					.mRoughnessTexture = get_texture_path(material.pbrMetallicRoughness.metallicRoughnessTexture.index),
-					.mEmissionTexture = get_texture_path(material.emissiveTexture.index),
-				}
-			};
+			if (!read_floats(sampler.input, times) || !read_floats(sampler.output, values) || !animation.AddChannel(animation_node_by_node[channel.target_node], path, interpolation, times, values))
+				gTrace(std::format("[Scene] glTF animation \"{}\" channel of node {} {} skipped\n", gltf_animation.name, channel.target_node, channel.target_path));
+		}
+	}
+	animation.Finalize();
 
-			auto pbr_specular_glossiness = material.extensions.find("KHR_materials_pbrSpecularGlossiness");
-			if (pbr_specular_glossiness != material.extensions.end())
-			{
-				auto diffuseTexture = pbr_specular_glossiness->second.Get("diffuseTexture");
-				if (diffuseTexture.IsObject())
-					instance_info.mMaterial.mAlbedoTexture = { .mPath = get_texture_path(diffuseTexture.Get("index").GetNumberAsInt()) };
-				
-				auto specularGlossinessTexture = pbr_specular_glossiness->second.Get("specularGlossinessTexture");
-				if (specularGlossinessTexture.IsObject())
-				{
-					instance_info.mMaterial.mReflectanceTexture = { .mPath = get_texture_path(specularGlossinessTexture.Get("index").GetNumberAsInt()) };
-					instance_info.mMaterial.mRoughnessTexture = { .mPath = get_texture_path(specularGlossinessTexture.Get("index").GetNumberAsInt()) };
-				}
-			}
+	if (camera_animation_node != ::Animation::kInvalidIndex && animation.IsAnimated(camera_animation_node))
+	{
+		gAssert(!ioSceneContent.mCamera.mHasAnimation); // assume at most 1 camera animation
+		ioSceneContent.mCamera.mHasAnimation = true;
+		ioSceneContent.mCamera.mAnimationNode = camera_animation_node;
+		ioSceneContent.mCamera.mAnimation = animation;
+	}
 
-			glm::vec3 translation;
-			glm::vec3 skew;
-			glm::vec4 perspective;
-			glm::quat rotation;
-			glm::vec3 scale;
-			glm::decompose(ioMatrix, scale, rotation, translation, skew, perspective);
-			instance_info.mDecomposedScale = scale;
-			
-			ioSceneContent.mInstanceInfos.push_back(instance_info);
+	uint instance_offset = (uint)ioSceneContent.mInstanceDatas.size();
+	ioSceneContent.mInstanceAnimationNodes.resize(instance_offset, ::Animation::kInvalidIndex);
+	for (uint primitive_index = 0; primitive_index < primitive_instances.size(); primitive_index++)
+	{
+		uint animation_node = primitive_instances[primitive_index].mAnimationNode;
+		ioSceneContent.mInstanceAnimationNodes.push_back(animation_node);
+		if (animation_node != ::Animation::kInvalidIndex && animation.IsAnimated(animation_node))
+			ioSceneContent.mAnimatedInstances.push_back(instance_offset + primitive_index);
+	}
+	ioSceneContent.mAnimation = std::move(animation);
 
-			InstanceData instance_data =
-			{
-				.mBSDF = BSDF::pbrMetallicRoughness,
-				.mFlags = { .mTwoSided = material.doubleSided, .mNormal = true, .mUV = true },
-				.mRoughnessAlpha = static_cast<float>(material.pbrMetallicRoughness.roughnessFactor * material.pbrMetallicRoughness.roughnessFactor),
-				.mAlbedo = vec3(material.pbrMetallicRoughness.baseColorFactor[0], material.pbrMetallicRoughness.baseColorFactor[1], material.pbrMetallicRoughness.baseColorFactor[2]),
-				.mReflectance = vec3(static_cast<float>(material.pbrMetallicRoughness.metallicFactor)),
-				.mEmission = vec3(material.emissiveFactor[0], material.emissiveFactor[1], material.emissiveFactor[2]),
-				.mTransform = ioMatrix,
-				.mInverseTranspose = transpose(inverse(ioMatrix)),
-				.mVertexOffset = vertex_offset,
-				.mVertexCount = vertex_count,
-				.mIndexOffset = index_offset,
-				.mIndexCount = index_count
-			};
+	// Output ranges as prefix sum after content already loaded, destination arrays are sized once
+	uint vertex_end = (uint)ioSceneContent.mVertices.size();
+	uint index_end = (uint)ioSceneContent.mIndices.size();
+	for (PrimitiveInstance& primitive_instance : primitive_instances)
+	{
+		primitive_instance.mVertexOffset = vertex_end;
+		primitive_instance.mIndexOffset = index_end;
+		vertex_end += primitive_instance.mVertexCount;
+		index_end += primitive_instance.mIndexCount;
+	}
 
-			if (pbr_specular_glossiness != material.extensions.end())
-			{
-				instance_data.mBSDF = BSDF::pbrSpecularGlossiness;
+	ioSceneContent.mVertices.resize(vertex_end);
+	ioSceneContent.mNormals.resize(vertex_end);
+	ioSceneContent.mUVs.resize(vertex_end);
+	ioSceneContent.mIndices.resize(index_end);
+	ioSceneContent.mInstanceInfos.resize(instance_offset + primitive_instances.size());
+	ioSceneContent.mInstanceDatas.resize(instance_offset + primitive_instances.size());
+
+	auto convert_begin = std::chrono::steady_clock::now();
+	mLoadStats.mGLTFTraverseMS += std::chrono::duration<float, std::milli>(convert_begin - traverse_begin).count();
 
-				auto diffuseFactor = pbr_specular_glossiness->second.Get("diffuseFactor");
-				if (diffuseFactor.IsArray())
-					instance_data.mAlbedo = vec3(diffuseFactor.Get(0).GetNumberAsDouble(), diffuseFactor.Get(1).GetNumberAsDouble(), diffuseFactor.Get(2).GetNumberAsDouble());
+	auto get_texture_path = [&](int inIndex)
+	{
+		if (inIndex == -1)
+			return std::filesystem::path();
+
+		std::filesystem::path path = inFilename;
+		auto dds = model.textures[inIndex].extensions.find("MSFT_texture_dds");
+		const Image& image = model.images[dds != model.textures[inIndex].extensions.end() ? dds->second.Get("source").GetNumberAsInt() : model.textures[inIndex].source];
+		if (image.uri.empty())
+		{
+			// [NOTE] Images embedded in buffer views (usual in .glb) are not supported, textures are loaded from files
+			gTrace(std::format("[Scene] Embedded image \"{}\" skipped\n", image.name));
+			return std::filesystem::path();
+		}
+		path.replace_filename(std::filesystem::path(image.uri));
+		return path;
+	};
 
-				// [TODO] Need proper conversion
+	// Phase 2, parallel: each primitive writes only its own ranges and instance slot
+	sParallelFor(static_cast<uint>(primitive_instances.size()), gConfigs.mLoadThreadCount, [&](uint inPrimitiveIndex)
+	{
+		const PrimitiveInstance& primitive_instance = primitive_instances[inPrimitiveIndex];
+		const Primitive& primitive = *primitive_instance.mPrimitive;
+
+		auto position_attribute = primitive.attributes.find("POSITION");
+		auto normal_attribute = primitive.attributes.find("NORMAL");
+		gAssert(normal_attribute != primitive.attributes.end());
+		auto uv_attribute = primitive.attributes.find("TEXCOORD_0");
+		gAssert(uv_attribute != primitive.attributes.end());
+
+		const Accessor& position_accessor = model.accessors[position_attribute->second];
+		const uint8* position_data = model.buffers[model.bufferViews[position_accessor.bufferView].buffer].data.data()
+			+ model.bufferViews[position_accessor.bufferView].byteOffset
+			+ position_accessor.byteOffset;
+		size_t position_stride = model.bufferViews[position_accessor.bufferView].byteStride;
+		position_stride = position_stride == 0 ? sizeof(vec3) : position_stride;
+		gAssert(position_accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && position_accessor.type == TINYGLTF_TYPE_VEC3);
+
+		const Accessor& normal_accessor = model.accessors[normal_attribute->second];
+		const uint8* normal_data = model.buffers[model.bufferViews[normal_accessor.bufferView].buffer].data.data()
+			+ model.bufferViews[normal_accessor.bufferView].byteOffset
+			+ normal_accessor.byteOffset;
+		size_t normal_stride = model.bufferViews[normal_accessor.bufferView].byteStride;
+		normal_stride = normal_stride == 0 ? sizeof(vec3) : normal_stride;
+		gAssert(normal_accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && normal_accessor.type == TINYGLTF_TYPE_VEC3);
+
+		const Accessor& uv_accessor = model.accessors[uv_attribute->second];
+		const uint8* uv_data = model.buffers[model.bufferViews[uv_accessor.bufferView].buffer].data.data()
+			+ model.bufferViews[uv_accessor.bufferView].byteOffset
+			+ uv_accessor.byteOffset;
+		size_t uv_stride = model.bufferViews[uv_accessor.bufferView].byteStride;
+		uv_stride = uv_stride == 0 ? sizeof(vec2) : uv_stride;
+		gAssert(uv_accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && uv_accessor.type == TINYGLTF_TYPE_VEC2);
+
+		gAssert(position_accessor.count == normal_accessor.count);
+		gAssert(position_accessor.count == uv_accessor.count);
+
+		uint vertex_offset = primitive_instance.mVertexOffset;
+		uint vertex_count = primitive_instance.mVertexCount;
+		sCopyAccessor(position_data, position_stride, vertex_count, ioSceneContent.mVertices.data() + vertex_offset);
+		sCopyAccessor(normal_data, normal_stride, vertex_count, ioSceneContent.mNormals.data() + vertex_offset);
+		sCopyAccessor(uv_data, uv_stride, vertex_count, ioSceneContent.mUVs.data() + vertex_offset);
+
+		const Accessor& index_accessor = model.accessors[primitive.indices];
+		const uint8* index_data = model.buffers[model.bufferViews[index_accessor.bufferView].buffer].data.data()
+			+ model.bufferViews[index_accessor.bufferView].byteOffset
+			+ index_accessor.byteOffset; 
+		size_t index_stride = model.bufferViews[index_accessor.bufferView].byteStride;
+		gAssert(index_accessor.type == TINYGLTF_TYPE_SCALAR && index_stride == 0); UNUSED(index_stride);
+
+		uint index_offset = primitive_instance.mIndexOffset;
+		uint index_count = primitive_instance.mIndexCount;
+		sCopyIndices(index_data, index_accessor.componentType, index_count, ioSceneContent.mIndices.data() + index_offset);
+
+		const Material& material = model.materials[primitive.material];
+
+		InstanceInfo instance_info =
+		{
+			.mName = primitive_instance.mName,
+			.mMaterial = 
+			{
+				.mMaterialName = material.name,
+				.mAlbedoTexture = get_texture_path(material.pbrMetallicRoughness.baseColorTexture.index),
+				.mNormalTexture = get_texture_path(material.normalTexture.index),
+				.mReflectanceTexture = get_texture_path(material.pbrMetallicRoughness.metallicRoughnessTexture.index),
+				.mRoughnessTexture = get_texture_path(material.pbrMetallicRoughness.metallicRoughnessTexture.index),
+				.mEmissionTexture = get_texture_path(material.emissiveTexture.index),
 			}
-			
-			ioSceneContent.mInstanceDatas.push_back(instance_data);
-			ioSceneContent.mBSDFs.insert(instance_data.mBSDF);
+		};
 
-			if (glm::compMax(instance_data.mEmission) > 0.0f)
+		auto pbr_specular_glossiness = material.extensions.find("KHR_materials_pbrSpecularGlossiness");
+		if (pbr_specular_glossiness != material.extensions.end())
+		{
+			auto diffuseTexture = pbr_specular_glossiness->second.Get("diffuseTexture");
+			if (diffuseTexture.IsObject())
+				instance_info.mMaterial.mAlbedoTexture = { .mPath = get_texture_path(diffuseTexture.Get("index").GetNumberAsInt()) };
+			
+			auto specularGlossinessTexture = pbr_specular_glossiness->second.Get("specularGlossinessTexture");
+			if (specularGlossinessTexture.IsObject())
 			{
-				ioSceneContent.mEmissiveInstances.push_back({ static_cast<uint>(ioSceneContent.mInstanceDatas.size()) - 1, ioSceneContent.mEmissiveTriangleCount, });
-				ioSceneContent.mEmissiveTriangleCount += index_count / kIndexCountPerTriangle;
+				instance_info.mMaterial.mReflectanceTexture = { .mPath = get_texture_path(specularGlossinessTexture.Get("index").GetNumberAsInt()) };
+				instance_info.mMaterial.mRoughnessTexture = { .mPath = get_texture_path(specularGlossinessTexture.Get("index").GetNumberAsInt()) };
 			}
 		}
-	};
 
-	auto visit_node_and_children = [&](const auto &self, int inNodeIndex, const Node& inNode, const std::string& inParentName, const mat4x4& inParentMatrix) -> void
+		const mat4x4& matrix = primitive_instance.mMatrix;
+		glm::vec3 translation;
+		glm::vec3 skew;
+		glm::vec4 perspective;
+		glm::quat rotation;
+		glm::vec3 scale;
+		glm::decompose(matrix, scale, rotation, translation, skew, perspective);
+		instance_info.mDecomposedScale = scale;
+		
+		ioSceneContent.mInstanceInfos[instance_offset + inPrimitiveIndex] = std::move(instance_info);
+
+		InstanceData instance_data =
+		{
+			.mBSDF = BSDF::pbrMetallicRoughness,
+			.mFlags = { .mTwoSided = material.doubleSided, .mNormal = true, .mUV = true },
+			.mRoughnessAlpha = static_cast<float>(material.pbrMetallicRoughness.roughnessFactor * material.pbrMetallicRoughness.roughnessFactor),
+			.mAlbedo = vec3(material.pbrMetallicRoughness.baseColorFactor[0], material.pbrMetallicRoughness.baseColorFactor[1], material.pbrMetallicRoughness.baseColorFactor[2]),
+			.mReflectance = vec3(static_cast<float>(material.pbrMetallicRoughness.metallicFactor)),
+			.mEmission = vec3(material.emissiveFactor[0], material.emissiveFactor[1], material.emissiveFactor[2]),
+			.mTransform = matrix,
+			.mInverseTranspose = transpose(inverse(matrix)),
+			.mVertexOffset = vertex_offset,
+			.mVertexCount = vertex_count,
+			.mIndexOffset = index_offset,
+			.mIndexCount = index_count
+		};
+
+		if (pbr_specular_glossiness != material.extensions.end())
+		{
+			instance_data.mBSDF = BSDF::pbrSpecularGlossiness;
+
+			auto diffuseFactor = pbr_specular_glossiness->second.Get("diffuseFactor");
+			if (diffuseFactor.IsArray())
+				instance_data.mAlbedo = vec3(diffuseFactor.Get(0).GetNumberAsDouble(), diffuseFactor.Get(1).GetNumberAsDouble(), diffuseFactor.Get(2).GetNumberAsDouble());
+
+			// [TODO] Need proper conversion
+		}
+		
+		ioSceneContent.mInstanceDatas[instance_offset + inPrimitiveIndex] = instance_data;
+	});
+
+	// Shared sets in instance order
+	for (uint instance_index = instance_offset; instance_index < ioSceneContent.mInstanceDatas.size(); instance_index++)
 	{
-		std::string name = inParentName;
-		mat4x4 matrix = inParentMatrix;
-		visit_node(inNodeIndex, inNode, name, matrix);
-		for (int child_node_index : inNode.children)
-			self(self, inNodeIndex, model.nodes[child_node_index], name, matrix);
-	};
+		const InstanceData& instance_data = ioSceneContent.mInstanceDatas[instance_index];
+		ioSceneContent.mBSDFs.insert(instance_data.mBSDF);
 
-	for (int node_index : model.scenes[model.defaultScene].nodes)
-		visit_node_and_children(visit_node_and_children, node_index, model.nodes[node_index], std::string(), mat4x4(1.0f));
+		if (glm::compMax(instance_data.mEmission) > 0.0f)
+			ioSceneContent.mEmissiveInstances.push_back({ instance_index, 0, }); // Offset is filled in GenerateTriangleLights
+	}
+
+	float convert_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - convert_begin).count();
+	mLoadStats.mGLTFConvertMS += convert_ms;
+	if (!primitive_instances.empty())
+		gTrace(std::format("[Scene] glTF {} primitives converted on {} threads in {:.2f} ms\n", primitive_instances.size(), sParallelForThreadCount(gConfigs.mLoadThreadCount), convert_ms));
 
 	return ret;
 }
@@ -1719,96 +2104,308 @@ void Scene::FillDummyMaterial(InstanceInfo& ioInstanceInfo, InstanceData& ioInst
 	ioInstanceData.mBSDF = BSDF::Diffuse;
 }
 
-void Scene::Load(const ScenePreset& inPreset)
+void Scene::LoadContent(const ScenePreset& inPreset)
 {
-	LoadObj("Asset/primitives/cube.obj", glm::mat4x4(1.0f), false, mPrimitives.mCube);
-	LoadObj("Asset/primitives/rectangle.obj", glm::mat4x4(1.0f), false, mPrimitives.mRectangle);
-	LoadObj("Asset/primitives/sphere.obj", glm::mat4x4(1.0f), false, mPrimitives.mSphere);
-	LoadObj("Asset/primitives/cylinder.obj", glm::mat4x4(1.0f), false, mPrimitives.mCylinder);
+	PROFILE_SCOPE("Scene::LoadContent");
 
-	mSceneContent = {}; // Reset
+	mLoadStats = {};
 
-	std::string path_lower = gToLower(inPreset.mPath);
-	if (std::filesystem::exists(path_lower))
 	{
-		bool loaded = false;
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mParseMS);
 
-		if (!loaded && path_lower.ends_with(".obj"))
-			loaded |= LoadObj(path_lower, inPreset.mTransform, false, mSceneContent);
+		LoadObj("Asset/primitives/cube.obj", glm::mat4x4(1.0f), false, mPrimitives.mCube);
+		LoadObj("Asset/primitives/rectangle.obj", glm::mat4x4(1.0f), false, mPrimitives.mRectangle);
+		LoadObj("Asset/primitives/sphere.obj", glm::mat4x4(1.0f), false, mPrimitives.mSphere);
+		LoadObj("Asset/primitives/cylinder.obj", glm::mat4x4(1.0f), false, mPrimitives.mCylinder);
 
-		if (!loaded && path_lower.ends_with(".xml"))
-			loaded |= LoadMitsuba(path_lower, mSceneContent);
+		mSceneContent = {}; // Reset
+		mSceneCamera.reset();
 
-		if (!loaded && path_lower.ends_with(".gltf"))
-			loaded |= LoadGLTF(path_lower, mSceneContent);
-	}
+		std::string path_lower = gToLower(inPreset.mPath);
+		if (std::filesystem::exists(path_lower))
+		{
+			bool loaded = false;
 
-	std::string camera_animation_path_lower = gToLower(inPreset.mCameraAnimationPath);
-	if (std::filesystem::exists(camera_animation_path_lower))
-	{
-		bool loaded = false;
+			if (!loaded && path_lower.ends_with(".obj"))
+				loaded |= LoadObj(path_lower, inPreset.mTransform, false, mSceneContent);
 
-		SceneContent scene_context;
-		if (!loaded && camera_animation_path_lower.ends_with(".gltf"))
-			loaded |= LoadGLTF(camera_animation_path_lower, scene_context);
+			if (!loaded && path_lower.ends_with(".xml"))
+				loaded |= LoadMitsuba(path_lower, mSceneContent);
 
-		mSceneContent.mCamera = std::move(scene_context.mCamera);
-	}
+			if (!loaded && (path_lower.ends_with(".gltf") || path_lower.ends_with(".glb")))
+				loaded |= LoadGLTF(path_lower, mSceneContent);
+		}
 
-	if (mSceneContent.mInstanceDatas.empty())
-		LoadDummy(mSceneContent);
+		SceneContent::Camera camera;
+		if (LoadCameraAnimation(std::string(inPreset.mCameraAnimationPath), camera))
+			mSceneContent.mCamera = std::move(camera);
 
-	if (gNVAPI.mLinearSweptSpheresSupported && gNVAPI.mLSSWireframeEnabled)
-		GenerateLSSFromTriangle();
+		if (mSceneContent.mInstanceDatas.empty())
+			LoadDummy(mSceneContent);
 
-	if (gNVAPI.mClusterSupported && gNVAPI.mClusterEnabled)
-		GenerateMeshlets();
+		GenerateBounds();
+	}
 
-	InitializeTextures();
-	InitializeBuffers();
-	InitializeRuntime();
-	InitializeAccelerationStructures();
-	InitializeViews();
+	mGeometryStats = {};
+	mGeometryStats.mSourceVertexCount = mSceneContent.mVertices.size();
+	for (const InstanceData& instance_data : mSceneContent.mInstanceDatas)
+		mGeometryStats.mInstancedVertexCount += instance_data.mVertexCount;
+	if (gConfigs.mOptimizeMeshes)
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mOptimizeMeshesMS);
+		OptimizeMeshes();
+	}
+	mGeometryStats.mVertexCount = mSceneContent.mVertices.size();
+	mGeometryStats.mVertexAttributeFloatBytes = mSceneContent.mVertices.size() * (sizeof(VertexType) + sizeof(NormalType) + sizeof(UVType));
+	mGeometryStats.mIndexBytes = mSceneContent.mIndices.size() * sizeof(IndexType);
 
-	gConfigs.mSceneBSDFs = mSceneContent.mBSDFs;
+	float light_bvh_ms = 0;
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mTriangleLightsMS);
+		GenerateTriangleLights();
+	}
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&light_bvh_ms);
+		mLightBVH.Build(mSceneContent);
+	}
+	mLoadStats.mLightsMS = mLoadStats.mTriangleLightsMS + light_bvh_ms;
 }
 
-void Scene::Unload()
+void Scene::LoadCPU(const ScenePreset& inPreset)
 {
-	mPrimitives = {};
-	mSceneContent = {};
-	mBlases = {};
-	mTLAS = {};
-	mRuntime = {};
-	mTextures = {};
-	mBuffers = {};
-	mNextViewDescriptorIndex = 0;
-}
+	LoadContent(inPreset);
 
-void Scene::UpdateGPU(ID3D12GraphicsCommandList4* inCommandList)
-{
-	for (auto&& instance_info : mSceneContent.mInstanceInfos)
+	if (mSceneContent.mLSSVertices.empty()) // Mixing LSS and TriangleAsLSS is not supported
 	{
-		instance_info.mCluster.mMeshletBuffer.UpdateGPU(inCommandList);
-		instance_info.mCluster.mIndexBuffer.UpdateGPU(inCommandList);
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mLSSMS);
+		GenerateLSSFromTriangle();
 	}
 
-	gBarrierUAV(inCommandList, nullptr);
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mMeshletsMS);
+		GenerateMeshlets(false);
+	}
 
-	for (auto&& blas : mBlases)
-		blas->Build(inCommandList);
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mQuantizeMS);
+		QuantizeVertexAttributes();
+	}
+
+	PackIndices();
+	GenerateBLASIndices();
+}
+
+void Scene::Load(const ScenePreset& inPreset)
+{
+	PROFILE_SCOPE("Scene::Load");
+
+	LoadContent(inPreset);
+
+	if (gNVAPI.mLinearSweptSpheresSupported && gNVAPI.mLSSWireframeEnabled)
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mLSSMS);
+		GenerateLSSFromTriangle();
+	}
+
+	if (gNVAPI.mClusterSupported && gNVAPI.mClusterEnabled)
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mMeshletsMS);
+		GenerateMeshlets(true);
+	}
+
+	if (gConfigs.mQuantizeVertexAttributes)
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mQuantizeMS);
+		QuantizeVertexAttributes();
+	}
+
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mTexturesMS);
+		InitializeTextures();
+	}
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mBuffersMS);
+		PackIndices();
+		InitializeBuffers();
+		InitializeRuntime();
+	}
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mAccelerationStructuresMS);
+		InitializeAccelerationStructures();
+	}
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mViewsMS);
+		InitializeViews();
+	}
+
+	gConfigs.mSceneBSDFs = mSceneContent.mBSDFs;
+}
+
+void Scene::Unload()
+{
+	mPrimitives = {};
+	mSceneContent = {};
+	mSceneCamera.reset();
+	mLightBVH.Clear();
+	mBlases = {};
+	mTLAS = {};
+	mBLASCompaction = {};
+	mInstancesDirty = false;
+	mRuntime = {};
+	mTextures = {};
+	mBuffers = {};
+	mNextViewDescriptorIndex = 0;
+}
+
+void Scene::UpdateGPU(ID3D12GraphicsCommandList4* inCommandList)
+{
+	for (auto&& instance_info : mSceneContent.mInstanceInfos)
+	{
+		instance_info.mCluster.mMeshletBuffer.UpdateGPU(inCommandList);
+		instance_info.mCluster.mIndexBuffer.UpdateGPU(inCommandList);
+	}
+
+	gBarrierUAV(inCommandList, nullptr);
+
+	for (auto&& blas : mBlases)
+		blas->Build(inCommandList);
 
 	gBarrierUAV(inCommandList, nullptr);
 
 	mTLAS->Build(inCommandList);
 
 	gBarrierUAV(inCommandList, nullptr);
+
+	if (mBLASCompaction.mSizes != nullptr)
+	{
+		BarrierScope scope(inCommandList, mBLASCompaction.mSizes.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+		inCommandList->CopyResource(mBLASCompaction.mSizesReadback.Get(), mBLASCompaction.mSizes.Get());
+
+		mBLASCompaction.mPending = true;
+		mBLASCompaction.mBuildFrameIndex = gFrameIndex;
+	}
+}
+
+void Scene::CompactBLASes(ID3D12GraphicsCommandList4* inCommandList)
+{
+	// Uncompacted BLASes may still be traced by frames recorded before compaction
+	if (!mBLASCompaction.mRetired.empty() && gFrameIndex >= mBLASCompaction.mRetiredFrameIndex + kFrameInFlightCount)
+		mBLASCompaction.mRetired.clear();
+
+	// Sizes are available once the frame of the builds has completed
+	if (!mBLASCompaction.mPending || gFrameIndex < mBLASCompaction.mBuildFrameIndex + kFrameInFlightCount || mTLAS == nullptr)
+		return;
+
+	mBLASCompaction.mPending = false;
+
+	std::vector<uint64_t> sizes(mBlases.size());
+	{
+		uint64_t* pointer = nullptr;
+		gValidate(mBLASCompaction.mSizesReadback->Map(0, nullptr, reinterpret_cast<void**>(&pointer)));
+		memcpy(sizes.data(), pointer, sizeof(uint64_t) * sizes.size());
+		mBLASCompaction.mSizesReadback->Unmap(0, nullptr);
+	}
+	mBLASCompaction.mSizes = nullptr;
+	mBLASCompaction.mSizesReadback = nullptr;
+
+	// Linear suballocation of one buffer, at alignment required for acceleration structures
+	std::vector<uint64_t> offsets(mBlases.size(), 0);
+	uint64_t pool_size = 0;
+	for (size_t blas_index = 0; blas_index < mBlases.size(); blas_index++)
+	{
+		offsets[blas_index] = pool_size;
+		pool_size += gAlignUp(sizes[blas_index], static_cast<uint64_t>(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT));
+	}
+	if (pool_size == 0)
+		return;
+
+	{
+		D3D12_HEAP_PROPERTIES props = gGetDefaultHeapProperties();
+		D3D12_RESOURCE_DESC desc = gGetUAVResourceDesc(pool_size);
+		gValidate(gDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE, nullptr, IID_PPV_ARGS(&mBLASCompaction.mPool)));
+		gSetName(mBLASCompaction.mPool, "Scene", "", ".[BLAS].CompactedPool");
+	}
+
+	// Earlier commands of this frame may still trace against uncompacted BLASes and TLAS
+	gBarrierUAV(inCommandList, nullptr);
+
+	D3D12_GPU_VIRTUAL_ADDRESS pool_address = mBLASCompaction.mPool->GetGPUVirtualAddress();
+	for (size_t blas_index = 0; blas_index < mBlases.size(); blas_index++)
+	{
+		if (sizes[blas_index] > 0)
+			mBlases[blas_index]->Compact(inCommandList, pool_address + offsets[blas_index], mBLASCompaction.mRetired);
+	}
+	mBLASCompaction.mRetiredFrameIndex = gFrameIndex;
+
+	gBarrierUAV(inCommandList, nullptr);
+
+	mGeometryStats.mBLASCompactedBytes = 0;
+	mGeometryStats.mBLASPoolBytes = pool_size;
+	mGeometryStats.mBLASCompactedCount = 0;
+	for (int instance_index = 0; instance_index < GetInstanceCount(); instance_index++)
+	{
+		uint blas_index = mSceneContent.mInstanceBLASIndices[instance_index];
+		mTLAS->SetAccelerationStructure(instance_index, mBlases[blas_index]->GetGPUVirtualAddress());
+
+		// Stats live on first instance using the BLAS, as prebuild sizes do
+		InstanceInfo& instance_info = GetInstanceInfo(instance_index);
+		if (instance_info.mStats.mResultDataSizeInBytes > 0 && sizes[blas_index] > 0 && instance_info.mStats.mCompactedDataSizeInBytes == 0)
+		{
+			instance_info.mStats.mCompactedDataSizeInBytes = sizes[blas_index];
+			mGeometryStats.mBLASCompactedBytes += sizes[blas_index];
+			mGeometryStats.mBLASCompactedCount++;
+		}
+	}
+
+	// Refit keeps source and destination, addresses of BLASes change so rebuild
+	mTLAS->GetUpdatePolicy().RequestRebuild();
+	mTLAS->Update(inCommandList);
+
+	gBarrierUAV(inCommandList, nullptr);
+
+	gTrace(std::format("[Scene] Compacted {} BLASes: {:.2f} MB -> {:.2f} MB ({:.2f} MB pooled)\n",
+		mGeometryStats.mBLASCompactedCount,
+		mGeometryStats.mBLASResultBytes / (1024.0 * 1024.0),
+		mGeometryStats.mBLASCompactedBytes / (1024.0 * 1024.0),
+		mGeometryStats.mBLASPoolBytes / (1024.0 * 1024.0)));
+}
+
+void Scene::ReportBLASMemory(std::string& outReport) const
+{
+	auto to_MB = [](uint64_t inBytes) { return inBytes / (1024.0 * 1024.0); };
+
+	outReport = std::format("[Scene] BLAS memory, {} BLASes\n", mGeometryStats.mBLASCount);
+	outReport += std::format("  {:<48} {:>12} {:>12} {:>8}\n", "Instance", "ResultMB", "CompactedMB", "Ratio");
+	for (int instance_index = 0; instance_index < GetInstanceCount(); instance_index++)
+	{
+		const InstanceInfo::Stats& stats = GetInstanceInfo(instance_index).mStats;
+		if (stats.mResultDataSizeInBytes == 0)
+			continue; // Shares BLAS of an earlier instance
+
+		if (stats.mCompactedDataSizeInBytes > 0)
+			outReport += std::format("  {:<48} {:>12.3f} {:>12.3f} {:>8.2f}\n", GetInstanceInfo(instance_index).mName, to_MB(stats.mResultDataSizeInBytes), to_MB(stats.mCompactedDataSizeInBytes), static_cast<double>(stats.mCompactedDataSizeInBytes) / stats.mResultDataSizeInBytes);
+		else
+			outReport += std::format("  {:<48} {:>12.3f} {:>12} {:>8}\n", GetInstanceInfo(instance_index).mName, to_MB(stats.mResultDataSizeInBytes), "-", "-");
+	}
+
+	outReport += std::format("  Total: {:.3f} MB result", to_MB(mGeometryStats.mBLASResultBytes));
+	if (mGeometryStats.mBLASCompactedCount > 0)
+		outReport += std::format(", {:.3f} MB compacted ({} BLASes, {:.2f}), {:.3f} MB pooled", to_MB(mGeometryStats.mBLASCompactedBytes), mGeometryStats.mBLASCompactedCount, static_cast<double>(mGeometryStats.mBLASCompactedBytes) / gMax(mGeometryStats.mBLASResultBytes, uint64_t(1)), to_MB(mGeometryStats.mBLASPoolBytes));
+	else if (mBLASCompaction.mPending)
+		outReport += ", compaction pending";
+	else
+		outReport += ", not compacted";
+	outReport += "\n";
 }
 
 void Scene::Render(ID3D12GraphicsCommandList4* inCommandList)
 {
-	for (auto&& texture : mTextures)
-		texture.UpdateGPU(inCommandList);
+	if (std::any_of(mTextures.begin(), mTextures.end(), [](const Texture& inTexture) { return !inTexture.mLoaded; }))
+	{
+		CPU_TIMING_SCOPE_SIMPLE(&mLoadStats.mTextureDecodeMS);
+		for (auto&& texture : mTextures)
+			texture.UpdateGPU(inCommandList);
+	}
 
 	for (auto&& buffer : mBuffers)
 		buffer.UpdateGPU(inCommandList);
@@ -1825,8 +2422,98 @@ void Scene::Render(ID3D12GraphicsCommandList4* inCommandList)
 	mNanoVDBVisualizers.clear();
 }
 
+void Scene::UpdateAnimation(float inTime)
+{
+	if (mSceneContent.mAnimatedInstances.empty())
+		return;
+
+	mSceneContent.mAnimation.Evaluate(inTime);
+	for (uint instance_index : mSceneContent.mAnimatedInstances)
+	{
+		const glm::mat4x4& matrix = mSceneContent.mAnimation.GetWorldMatrix(mSceneContent.mInstanceAnimationNodes[instance_index]);
+		InstanceData& instance_data = mSceneContent.mInstanceDatas[instance_index];
+		instance_data.mTransform = matrix;
+		instance_data.mInverseTranspose = glm::transpose(glm::inverse(matrix));
+
+		if (mTLAS != nullptr)
+			mTLAS->SetTransform(instance_index, matrix);
+	}
+
+	mInstancesDirty = true;
+}
+
+void Scene::UpdateAnimationGPU(ID3D12GraphicsCommandList4* inCommandList)
+{
+	if (!mInstancesDirty || mTLAS == nullptr || mRuntime.mInstanceDatas == nullptr)
+		return;
+
+	mInstancesDirty = false;
+
+	// [NOTE] Only instance transforms follow animation, triangle lights, light BVH and bounds stay at load pose
+	uint64_t size = sizeof(InstanceData) * mSceneContent.mInstanceDatas.size();
+	UploadHeap::Allocation upload = gUploadHeap.Upload(mSceneContent.mInstanceDatas.data(), size);
+	{
+		BarrierScope scope(inCommandList, mRuntime.mInstanceDatas.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
+		inCommandList->CopyBufferRegion(mRuntime.mInstanceDatas.Get(), 0, upload.mResource, upload.mOffset, size);
+	}
+
+	mTLAS->Update(inCommandList);
+
+	gBarrierUAV(inCommandList, nullptr);
+}
+
+bool Scene::SampleCameraAnimation(float inRatio, glm::mat4x4& outMatrix)
+{
+	SceneContent::Camera& camera = mSceneContent.mCamera;
+	if (!camera.mHasAnimation)
+		return false;
+
+	camera.mAnimation.Evaluate(camera.mAnimation.GetTimeAt(inRatio));
+	outMatrix = camera.mAnimation.GetWorldMatrix(camera.mAnimationNode);
+	return true;
+}
+
+bool Scene::LoadCameraAnimation(const std::string& inFilename, SceneContent::Camera& outCamera)
+{
+	std::string path_lower = gToLower(inFilename);
+	if (!std::filesystem::exists(path_lower))
+		return false;
+
+	SceneContent scene_context;
+	if (!(path_lower.ends_with(".gltf") || path_lower.ends_with(".glb")) || !LoadGLTF(path_lower, scene_context))
+		return false;
+
+	outCamera = std::move(scene_context.mCamera);
+	return true;
+}
+
+bool Scene::OverrideCameraAnimation(const std::string& inPath)
+{
+	if (inPath.empty())
+	{
+		if (mSceneCamera.has_value())
+			mSceneContent.mCamera = std::move(mSceneCamera.value());
+		mSceneCamera.reset();
+		return true;
+	}
+
+	SceneContent::Camera camera;
+	if (!LoadCameraAnimation(inPath, camera) || !camera.mHasAnimation)
+	{
+		gTrace(std::format("[Scene] No camera animation in {}\n", inPath));
+		return false;
+	}
+
+	if (!mSceneCamera.has_value())
+		mSceneCamera = std::move(mSceneContent.mCamera);
+	mSceneContent.mCamera = std::move(camera);
+	return true;
+}
+
 void Scene::InitializeTextures()
 {
+	PROFILE_SCOPE("Scene::InitializeTextures");
+
 	std::map<std::string, int> texture_map;
 	for (int i = 0; i < mSceneContent.mInstanceDatas.size(); i++)
 	{
@@ -1849,6 +2536,7 @@ void Scene::InitializeTextures()
 			float* exr_data = nullptr;
 			if (inTexture.string().ends_with(".exr"))
 			{
+				PROFILE_SCOPE("Texture::DecodeEXR");
 				const char* err = nullptr;
 				if (LoadEXR(&exr_data, &x, &y, inTexture.string().c_str(), &err) != TINYEXR_SUCCESS)
 					return {};
@@ -1894,6 +2582,8 @@ void Scene::InitializeTextures()
 
 void Scene::InitializeBuffers()
 {
+	PROFILE_SCOPE("Scene::InitializeBuffers");
+
 	for (int i = 0; i < mSceneContent.mInstanceDatas.size(); i++)
 	{
 		InstanceInfo& instance_info = mSceneContent.mInstanceInfos[i];
@@ -1946,8 +2636,6 @@ void Scene::InitializeBuffers()
 			buffer.Initialize();
 			gAssert(buffer.mUploadPointer[0] != nullptr);
 			memcpy(buffer.mUploadPointer[0], grid, meta_data->gridSize);
-			buffer.mUploadResource[0]->Unmap(0, nullptr);
-			buffer.mUploadPointer[0] = nullptr;
 
 			auto offset = meta_data->indexBBox.min();
 			auto dim = meta_data->indexBBox.dim();
@@ -1989,206 +2677,485 @@ void Scene::InitializeBuffers()
 
 void Scene::InitializeRuntime()
 {
-	D3D12_RESOURCE_DESC desc_upload = gGetBufferResourceDesc(0);
-	D3D12_RESOURCE_DESC desc_uav = gGetUAVResourceDesc(0);
-	D3D12_HEAP_PROPERTIES props_upload = gGetUploadHeapProperties();
-	D3D12_HEAP_PROPERTIES props_default = gGetDefaultHeapProperties();
+	PROFILE_SCOPE("Scene::InitializeRuntime");
+
+	// Static for the lifetime of the scene, uploaded on copy queue while shaders compile
+	// Direct queue waits for the copies before executing, see CopyQueue::QueueWait
+	std::vector<CopyQueue::Request> requests;
+	auto create_buffer = [&](ComPtr<ID3D12Resource>& outResource, const void* inData, uint64_t inByteCount, std::string_view inName)
+	{
+		D3D12_RESOURCE_DESC desc = gGetBufferResourceDesc(inByteCount);
+		D3D12_HEAP_PROPERTIES props = gGetDefaultHeapProperties();
+		gValidate(gDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&outResource)));
+		gSetName(outResource, "Scene.", inName, "");
+
+		requests.push_back({ .mDestination = outResource.Get(), .mData = inData, .mSize = inByteCount });
+	};
 
 	gAssert(mSceneContent.mIndices.size() <= size_t(1) + std::numeric_limits<IndexType>::max());
+	gAssert(!mSceneContent.mPackedIndices.empty());
+	gAssert(mSceneContent.mNormals.size() == mSceneContent.mVertices.size());
+	gAssert(mSceneContent.mUVs.size() == mSceneContent.mVertices.size());
 
+	create_buffer(mRuntime.mIndices,		mSceneContent.mPackedIndices.data(),	mSceneContent.mPackedIndices.size(),				"mBuffers.mIndices");
+	create_buffer(mRuntime.mVertices,		mSceneContent.mVertices.data(),		sizeof(VertexType) * mSceneContent.mVertices.size(),	"mBuffers.mVertices");
+	if (gConfigs.mQuantizeVertexAttributes)
 	{
-		desc_upload.Width = sizeof(IndexType) * mSceneContent.mIndices.size();
-		gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mIndices)));
-		gSetName(mRuntime.mIndices, "Scene.", "mBuffers.mIndices", "");
+		gAssert(mSceneContent.mQuantizedVertices.size() == mSceneContent.mVertices.size());
 
-		uint8_t* pData = nullptr;
-		mRuntime.mIndices->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-		memcpy(pData, mSceneContent.mIndices.data(), desc_upload.Width);
-		mRuntime.mIndices->Unmap(0, nullptr);
+		create_buffer(mRuntime.mQuantizedVertices,	mSceneContent.mQuantizedVertices.data(),	sizeof(uint2) * mSceneContent.mQuantizedVertices.size(),	"mBuffers.mQuantizedVertices");
+		create_buffer(mRuntime.mNormals,			mSceneContent.mQuantizedNormals.data(),		sizeof(uint) * mSceneContent.mQuantizedNormals.size(),		"mBuffers.mQuantizedNormals");
+		create_buffer(mRuntime.mUVs,				mSceneContent.mQuantizedUVs.data(),			sizeof(uint) * mSceneContent.mQuantizedUVs.size(),			"mBuffers.mQuantizedUVs");
 	}
-
+	else
 	{
-		desc_upload.Width = sizeof(VertexType) * mSceneContent.mVertices.size();
-		gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mVertices)));
-		gSetName(mRuntime.mVertices, "Scene.", "mBuffers.mVertices", "");
-
-		uint8_t* pData = nullptr;
-		mRuntime.mVertices->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-		memcpy(pData, mSceneContent.mVertices.data(), desc_upload.Width);
-		mRuntime.mVertices->Unmap(0, nullptr);
+		create_buffer(mRuntime.mNormals,		mSceneContent.mNormals.data(),		sizeof(NormalType) * mSceneContent.mNormals.size(),		"mBuffers.mNormals");
+		create_buffer(mRuntime.mUVs,			mSceneContent.mUVs.data(),			sizeof(UVType) * mSceneContent.mUVs.size(),				"mBuffers.mUVs");
 	}
 
-	gAssert(mSceneContent.mNormals.size() == mSceneContent.mVertices.size());
-	{
-		desc_upload.Width = sizeof(NormalType) * mSceneContent.mNormals.size();
-		gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mNormals)));
-		gSetName(mRuntime.mNormals, "Scene.", "mBuffers.mNormals", "");
+	// LSS
+	if (!mSceneContent.mLSSVertices.empty())
+		create_buffer(mRuntime.mLSSVertices,	mSceneContent.mLSSVertices.data(),	sizeof(VertexType) * mSceneContent.mLSSVertices.size(),	"mBuffers.mLSSVertices");
+	if (!mSceneContent.mLSSIndices.empty())
+		create_buffer(mRuntime.mLSSIndices,		mSceneContent.mLSSIndices.data(),	sizeof(IndexType) * mSceneContent.mLSSIndices.size(),	"mBuffers.mLSSIndices");
+	if (!mSceneContent.mLSSRadii.empty())
+		create_buffer(mRuntime.mLSSRadii,		mSceneContent.mLSSRadii.data(),		sizeof(RadiusType) * mSceneContent.mLSSRadii.size(),	"mBuffers.mLSSRadii");
+
+	// At least one element for a valid view
+	create_buffer(mRuntime.mInstanceDatas,	mSceneContent.mInstanceDatas.empty() ? nullptr : mSceneContent.mInstanceDatas.data(),	sizeof(InstanceData) * gMax(1ull, mSceneContent.mInstanceDatas.size()),		"mBuffers.mInstanceDatas");
+	create_buffer(mRuntime.mLights,			mSceneContent.mLights.empty() ? nullptr : mSceneContent.mLights.data(),					sizeof(Light) * gMax(1ull, mSceneContent.mLights.size()),						"mBuffers.mLights");
+
+	gCopyQueue.Upload(requests);
+}
 
-		uint8_t* pData = nullptr;
-		mRuntime.mNormals->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-		memcpy(pData, mSceneContent.mNormals.data(), desc_upload.Width);
-		mRuntime.mNormals->Unmap(0, nullptr);
-	}
+void Scene::OptimizeMeshes()
+{
+	PROFILE_SCOPE("Scene::OptimizeMeshes");
 
-	gAssert(mSceneContent.mUVs.size() == mSceneContent.mVertices.size());
+	// Instances sharing a vertex range are optimized once
+	struct VertexRange
+	{
+		uint										mVertexCount = 0;
+		std::vector<std::pair<uint, uint>>			mIndexRanges;			// Offset, count
+		uint										mOptimizedVertexOffset = 0;
+		uint										mOptimizedVertexCount = 0;
+	};
+	std::map<uint, VertexRange> vertex_ranges;								// By vertex offset
+	for (const InstanceData& instance_data : mSceneContent.mInstanceDatas)
 	{
-		desc_upload.Width = sizeof(UVType) * mSceneContent.mUVs.size();
-		gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mUVs)));
-		gSetName(mRuntime.mUVs, "Scene.", "mBuffers.mUVs", "");
+		if (instance_data.mVertexCount == 0)
+			continue;
 
-		uint8_t* pData = nullptr;
-		mRuntime.mUVs->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-		memcpy(pData, mSceneContent.mUVs.data(), desc_upload.Width);
-		mRuntime.mUVs->Unmap(0, nullptr);
+		VertexRange& vertex_range					= vertex_ranges[instance_data.mVertexOffset];
+		vertex_range.mVertexCount					= gMax(vertex_range.mVertexCount, instance_data.mVertexCount);
+		std::pair<uint, uint> index_range			= { instance_data.mIndexOffset, instance_data.mIndexCount };
+		if (index_range.second > 0 && std::find(vertex_range.mIndexRanges.begin(), vertex_range.mIndexRanges.end(), index_range) == vertex_range.mIndexRanges.end())
+			vertex_range.mIndexRanges.push_back(index_range);
 	}
 
-	// LSS
+	// Ranges are reordered in place, so [offset, offset + count) of vertex ranges and of index ranges need to be disjoint
 	{
-		if (!mSceneContent.mLSSVertices.empty())
-		{
-			desc_upload.Width = sizeof(VertexType) * mSceneContent.mLSSVertices.size();
-			gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mLSSVertices)));
-			gSetName(mRuntime.mLSSVertices, "Scene.", "mBuffers.mLSSVertices", "");
-
-			uint8_t* pData = nullptr;
-			mRuntime.mLSSVertices->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-			memcpy(pData, mSceneContent.mLSSVertices.data(), desc_upload.Width);
-			mRuntime.mLSSVertices->Unmap(0, nullptr);
+		bool disjoint								= true;
+		uint vertex_end								= 0;
+		std::vector<std::pair<uint, uint>> index_ranges;
+		for (const auto& [vertex_offset, vertex_range] : vertex_ranges)
+		{
+			disjoint								&= vertex_offset >= vertex_end;
+			vertex_end								= vertex_offset + vertex_range.mVertexCount;
+			index_ranges.insert(index_ranges.end(), vertex_range.mIndexRanges.begin(), vertex_range.mIndexRanges.end());
 		}
 
-		if (!mSceneContent.mLSSIndices.empty())
+		std::sort(index_ranges.begin(), index_ranges.end());
+		for (size_t i = 1; i < index_ranges.size(); i++)
+			disjoint								&= index_ranges[i].first >= index_ranges[i - 1].first + index_ranges[i - 1].second;
+
+		if (!disjoint)
 		{
-			desc_upload.Width = sizeof(IndexType) * mSceneContent.mLSSIndices.size();
-			gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mLSSIndices)));
-			gSetName(mRuntime.mLSSIndices, "Scene.", "mBuffers.mLSSIndices", "");
+			gTrace("[Scene] Overlapping vertex or index ranges, OptimizeMeshes skipped\n");
+			return;
+		}
+	}
 
-			uint8_t* pData = nullptr;
-			mRuntime.mLSSIndices->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-			memcpy(pData, mSceneContent.mLSSIndices.data(), desc_upload.Width);
-			mRuntime.mLSSIndices->Unmap(0, nullptr);
+	std::for_each(std::execution::par, vertex_ranges.begin(), vertex_ranges.end(), [&](std::pair<const uint, VertexRange>& ioEntry)
+	{
+		const uint vertex_offset					= ioEntry.first;
+		VertexRange& vertex_range					= ioEntry.second;
+		vertex_range.mOptimizedVertexCount			= vertex_range.mVertexCount;
+
+		// Vertices can only move when a single index range refers to them, otherwise only triangle order changes
+		if (vertex_range.mIndexRanges.size() != 1)
+		{
+			for (const auto& [index_offset, index_count] : vertex_range.mIndexRanges)
+			{
+				IndexType* indices					= &mSceneContent.mIndices[index_offset];
+				meshopt_optimizeVertexCache(indices, indices, index_count, vertex_range.mVertexCount);
+			}
+			return;
 		}
 
-		if (!mSceneContent.mLSSRadii.empty())
+		const uint index_count						= vertex_range.mIndexRanges.front().second;
+		IndexType* indices							= &mSceneContent.mIndices[vertex_range.mIndexRanges.front().first];
+		VertexType* vertices						= &mSceneContent.mVertices[vertex_offset];
+		NormalType* normals							= &mSceneContent.mNormals[vertex_offset];
+		UVType* uvs									= &mSceneContent.mUVs[vertex_offset];
+		std::vector<uint> remap(vertex_range.mVertexCount);
+		auto remap_streams							= [&](size_t inVertexCount)
+		{
+			meshopt_remapIndexBuffer(indices, indices, index_count, remap.data());
+			meshopt_remapVertexBuffer(vertices, vertices, inVertexCount, sizeof(VertexType), remap.data());
+			meshopt_remapVertexBuffer(normals, normals, inVertexCount, sizeof(NormalType), remap.data());
+			meshopt_remapVertexBuffer(uvs, uvs, inVertexCount, sizeof(UVType), remap.data());
+		};
+
+		// Merge identical vertices, loaders may emit one per triangle corner
+		const meshopt_Stream streams[]				=
 		{
-			desc_upload.Width = sizeof(RadiusType) * mSceneContent.mLSSRadii.size();
-			gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mLSSRadii)));
-			gSetName(mRuntime.mLSSRadii, "Scene.", "mBuffers.mLSSRadii", "");
+			{ vertices,	sizeof(VertexType),	sizeof(VertexType) },
+			{ normals,	sizeof(NormalType),	sizeof(NormalType) },
+			{ uvs,		sizeof(UVType),		sizeof(UVType) },
+		};
+		size_t vertex_count							= meshopt_generateVertexRemapMulti(remap.data(), indices, index_count, vertex_range.mVertexCount, streams, std::size(streams));
+		remap_streams(vertex_range.mVertexCount);
+
+		// Triangle order for vertex reuse, then vertex order for fetch locality
+		meshopt_optimizeVertexCache(indices, indices, index_count, vertex_count);
+		size_t fetched_vertex_count					= meshopt_optimizeVertexFetchRemap(remap.data(), indices, index_count, vertex_count);
+		remap_streams(vertex_count);
+
+		vertex_range.mOptimizedVertexCount			= static_cast<uint>(fetched_vertex_count);
+	});
+
+	// Compact streams, vertices not referenced by any instance are dropped
+	std::vector<VertexType> vertices;
+	std::vector<NormalType> normals;
+	std::vector<UVType> uvs;
+	for (auto& [vertex_offset, vertex_range] : vertex_ranges)
+	{
+		vertex_range.mOptimizedVertexOffset			= static_cast<uint>(vertices.size());
+		vertices.insert(vertices.end(), mSceneContent.mVertices.begin() + vertex_offset, mSceneContent.mVertices.begin() + vertex_offset + vertex_range.mOptimizedVertexCount);
+		normals.insert(normals.end(), mSceneContent.mNormals.begin() + vertex_offset, mSceneContent.mNormals.begin() + vertex_offset + vertex_range.mOptimizedVertexCount);
+		uvs.insert(uvs.end(), mSceneContent.mUVs.begin() + vertex_offset, mSceneContent.mUVs.begin() + vertex_offset + vertex_range.mOptimizedVertexCount);
+	}
 
-			uint8_t* pData = nullptr;
-			mRuntime.mLSSRadii->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-			memcpy(pData, mSceneContent.mLSSRadii.data(), desc_upload.Width);
-			mRuntime.mLSSRadii->Unmap(0, nullptr);
-		}
+	for (InstanceData& instance_data : mSceneContent.mInstanceDatas)
+	{
+		if (instance_data.mVertexCount == 0)
+			continue;
+
+		const VertexRange& vertex_range				= vertex_ranges[instance_data.mVertexOffset];
+		instance_data.mVertexOffset					= vertex_range.mOptimizedVertexOffset;
+		instance_data.mVertexCount					= vertex_range.mOptimizedVertexCount;
 	}
 
+	gTrace(std::format("[Scene] Optimized {} meshes, vertices {} -> {}\n", vertex_ranges.size(), mSceneContent.mVertices.size(), vertices.size()));
+
+	mSceneContent.mVertices							= std::move(vertices);
+	mSceneContent.mNormals							= std::move(normals);
+	mSceneContent.mUVs								= std::move(uvs);
+}
+
+void Scene::PackIndices()
+{
+	PROFILE_SCOPE("Scene::PackIndices");
+
+	// Ranges are 4 bytes aligned for ByteAddressBuffer, instances sharing a range share the packed one
+	std::map<uint, std::pair<uint, bool>> packed_ranges;					// Index offset -> byte offset, 16bit
+	std::vector<uint8_t>& packed_indices			= mSceneContent.mPackedIndices;
+	packed_indices.clear();
+	mGeometryStats.mIndex16BitInstanceCount			= 0;
+	for (InstanceData& instance_data : mSceneContent.mInstanceDatas)
 	{
-		desc_upload.Width = sizeof(InstanceData)  * gMax(1ull, mSceneContent.mInstanceDatas.size());
-		gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mInstanceDatas)));
-		gSetName(mRuntime.mInstanceDatas, "Scene.", "mBuffers.mInstanceDatas", "");
+		if (instance_data.mIndexCount == 0)
+			continue;
 
-		if (!mSceneContent.mInstanceDatas.empty())
+		auto [iter, inserted]						= packed_ranges.try_emplace(instance_data.mIndexOffset);
+		if (inserted)
 		{
-			uint8_t* pData = nullptr;
-			mRuntime.mInstanceDatas->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-			memcpy(pData, mSceneContent.mInstanceDatas.data(), desc_upload.Width);
-			mRuntime.mInstanceDatas->Unmap(0, nullptr);
+			std::span<const IndexType> indices(&mSceneContent.mIndices[instance_data.mIndexOffset], instance_data.mIndexCount);
+			bool index_16bit						= *std::max_element(indices.begin(), indices.end()) <= std::numeric_limits<uint16_t>::max();
+			size_t byte_offset						= packed_indices.size();
+			gAssert(byte_offset <= std::numeric_limits<uint>::max());
+
+			packed_indices.resize(byte_offset + gAlignUp<size_t>(indices.size() * (index_16bit ? sizeof(uint16_t) : sizeof(IndexType)), sizeof(uint)));
+			if (index_16bit)
+			{
+				uint16_t* destination				= reinterpret_cast<uint16_t*>(&packed_indices[byte_offset]);
+				for (size_t i = 0; i < indices.size(); i++)
+					destination[i]					= static_cast<uint16_t>(indices[i]);
+			}
+			else
+				memcpy(&packed_indices[byte_offset], indices.data(), indices.size_bytes());
+
+			iter->second							= { static_cast<uint>(byte_offset), index_16bit };
 		}
+
+		instance_data.mIndexByteOffset				= iter->second.first;
+		instance_data.mFlags.mIndex16Bit			= iter->second.second ? 1 : 0;
+		mGeometryStats.mIndex16BitInstanceCount		+= iter->second.second ? 1 : 0;
 	}
 
+	// At least one element for a valid view
+	if (packed_indices.empty())
+		packed_indices.resize(sizeof(uint));
+
+	mGeometryStats.mPackedIndexBytes				= packed_indices.size();
+}
+
+void Scene::GenerateBLASIndices()
+{
+	// Instances differing only by transform and material share a BLAS
+	using GeometryKey = std::tuple<GeometryType, uint, uint, uint, uint, uint, uint, uint, uint, uint>;
+	std::map<GeometryKey, uint> blas_indices;
+	mSceneContent.mInstanceBLASIndices.resize(mSceneContent.mInstanceDatas.size());
+	for (size_t instance_index = 0; instance_index < mSceneContent.mInstanceDatas.size(); instance_index++)
 	{
-		desc_upload.Width = sizeof(Light) * gMax(1ull, mSceneContent.mLights.size());
-		gValidate(gDevice->CreateCommittedResource(&props_upload, D3D12_HEAP_FLAG_NONE, &desc_upload, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mRuntime.mLights)));
-		gSetName(mRuntime.mLights, "Scene.", "mBuffers.mLights", "");
+		const InstanceInfo& instance_info			= mSceneContent.mInstanceInfos[instance_index];
+		const InstanceData& instance_data			= mSceneContent.mInstanceDatas[instance_index];
+		GeometryKey key								= 
+		{
+			instance_info.mGeometryType,
+			instance_data.mVertexOffset, instance_data.mVertexCount, instance_data.mIndexOffset, instance_data.mIndexCount,
+			instance_data.mLSSVertexOffset, instance_data.mLSSVertexCount, instance_data.mLSSIndexOffset, instance_data.mLSSIndexCount,
+			instance_data.mLSSRadiusOffset, // TriangleAsLSS instances of different scales have own radii
+		};
+		mSceneContent.mInstanceBLASIndices[instance_index] = blas_indices.try_emplace(key, static_cast<uint>(blas_indices.size())).first->second;
+	}
+
+	mGeometryStats.mBLASCount						= static_cast<uint>(blas_indices.size());
+}
 
-		if (!mSceneContent.mLights.empty())
+void Scene::GenerateBounds()
+{
+	std::vector<std::pair<float3, float3>> instance_bounds(mSceneContent.mInstanceDatas.size(), { mSceneContent.mBoundsMin, mSceneContent.mBoundsMax });
+	std::transform(std::execution::par, mSceneContent.mInstanceDatas.begin(), mSceneContent.mInstanceDatas.end(), instance_bounds.begin(), [&](const InstanceData& inInstanceData)
+	{
+		std::pair<float3, float3> bounds		= { mSceneContent.mBoundsMin, mSceneContent.mBoundsMax };
+		for (uint i = 0; i < inInstanceData.mVertexCount; i++)
 		{
-			uint8_t* pData = nullptr;
-			mRuntime.mLights->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-			memcpy(pData, mSceneContent.mLights.data(), desc_upload.Width);
-			mRuntime.mLights->Unmap(0, nullptr);
+			float3 position						= float3(inInstanceData.mTransform * float4(mSceneContent.mVertices[inInstanceData.mVertexOffset + i], 1.0f));
+			bounds.first						= glm::min(bounds.first, position);
+			bounds.second						= glm::max(bounds.second, position);
 		}
+		return bounds;
+	});
+
+	for (const auto& [bounds_min, bounds_max] : instance_bounds)
+	{
+		mSceneContent.mBoundsMin				= glm::min(mSceneContent.mBoundsMin, bounds_min);
+		mSceneContent.mBoundsMax				= glm::max(mSceneContent.mBoundsMax, bounds_max);
 	}
 }
 
-void Scene::GenerateLSSFromTriangle()
+void Scene::GenerateTriangleLights()
 {
-	gAssert(mSceneContent.mLSSVertices.empty()); // Mixing LSS and TriangleAsLSS is not supported
+	CPU_TIMING_SCOPE("Scene::GenerateTriangleLights", &gStats.mCPUTimingMS.mPrepareLights);
 
-	D3D12_RESOURCE_DESC desc_upload = gGetBufferResourceDesc(0);
-	D3D12_HEAP_PROPERTIES props_upload = gGetUploadHeapProperties();
+	// [NOTE] Table is kept on CPU as input of LightBVH::Build, it is not uploaded since no shader samples emissive triangles yet
 
-	constexpr uint indices_per_triangle = 3;									// 1 triangles = 3 indices
-	constexpr uint lss_indices_per_edge = 2;									// List
-	constexpr uint lss_indices_per_lss_triangle = 3 * lss_indices_per_edge;		// 1 triangles -> 3 LSS = 6 indices
-	gAssert(mSceneContent.mIndices.size() % indices_per_triangle == 0);
+	// Prefix sum of triangle count -> offset of each emissive instance in the table
+	std::vector<SceneContent::EmissiveInstance>& emissive_instances = mSceneContent.mEmissiveInstances;
+	auto get_triangle_count = [&](const SceneContent::EmissiveInstance& inEmissiveInstance)
+	{
+		return mSceneContent.mInstanceDatas[inEmissiveInstance.mInstanceIndex].mIndexCount / kIndexCountPerTriangle;
+	};
 
-	size_t instance_count = mSceneContent.mInstanceDatas.size();
-	gAssert(instance_count == mSceneContent.mInstanceInfos.size());
-	for (uint instance_index = 0; instance_index < instance_count; instance_index++)
+	std::vector<uint> triangle_offsets(emissive_instances.size());
+	std::transform_exclusive_scan(std::execution::par, emissive_instances.begin(), emissive_instances.end(), triangle_offsets.begin(), 0u, std::plus<uint>(), get_triangle_count);
+
+	mSceneContent.mEmissiveTriangleCount = 0;
+	if (!emissive_instances.empty())
+		mSceneContent.mEmissiveTriangleCount = triangle_offsets.back() + get_triangle_count(emissive_instances.back());
+
+	for (size_t i = 0; i < emissive_instances.size(); i++)
+		emissive_instances[i].mTriangleOffset = triangle_offsets[i];
+
+	// Fill table with world space triangles, each instance writes its own range
+	mSceneContent.mTriangleLights.resize(mSceneContent.mEmissiveTriangleCount);
+	std::for_each(std::execution::par, emissive_instances.begin(), emissive_instances.end(), [&](const SceneContent::EmissiveInstance& inEmissiveInstance)
 	{
-		InstanceData& instance_data = mSceneContent.mInstanceDatas[instance_index];
-		if (gMaxComponent(instance_data.mEmission) > 0.0f)
-			continue; // Leave light source as triangles
+		const InstanceData& instance_data = mSceneContent.mInstanceDatas[inEmissiveInstance.mInstanceIndex];
 
-		// Vertex count is same as triangle list, use existing buffer
-		// Index count doubles, create new buffer
-		// Radius count is same as vertex count, create new buffer
+		auto triangle_range = std::views::iota(0u, get_triangle_count(inEmissiveInstance));
+		std::for_each(std::execution::par, triangle_range.begin(), triangle_range.end(), [&](uint inTriangleIndex)
+		{
+			float3 positions[kIndexCountPerTriangle];
+			for (uint i = 0; i < kIndexCountPerTriangle; i++)
+			{
+				IndexType index					= mSceneContent.mIndices[instance_data.mIndexOffset + inTriangleIndex * kIndexCountPerTriangle + i];
+				positions[i]					= float3(instance_data.mTransform * float4(mSceneContent.mVertices[instance_data.mVertexOffset + index], 1.0f));
+			}
 
-		instance_data.mLSSVertexOffset = instance_data.mVertexOffset;
-		instance_data.mLSSVertexCount = instance_data.mVertexCount;
+			SceneContent::TriangleLight& triangle_light	= mSceneContent.mTriangleLights[inEmissiveInstance.mTriangleOffset + inTriangleIndex];
+			triangle_light.mBase				= positions[0];
+			triangle_light.mEdge1				= positions[1] - positions[0];
+			triangle_light.mEdge2				= positions[2] - positions[0];
+			triangle_light.mInstanceIndex		= inEmissiveInstance.mInstanceIndex;
+			triangle_light.mPrimitiveIndex		= inTriangleIndex;
+			triangle_light.mRadiance			= instance_data.mEmission;
+		});
+	});
+}
 
-		instance_data.mLSSIndexOffset = instance_data.mIndexOffset * 2;
-		instance_data.mLSSIndexCount = instance_data.mIndexCount * 2;
+void Scene::GenerateLSSFromTriangle()
+{
+	PROFILE_SCOPE("Scene::GenerateLSSFromTriangle");
 
-		instance_data.mLSSRadiusOffset = instance_data.mLSSVertexOffset;
-		instance_data.mLSSRadiusCount = instance_data.mLSSVertexCount;
+	gAssert(mSceneContent.mLSSVertices.empty()); // Mixing LSS and TriangleAsLSS is not supported
+	gAssert(mSceneContent.mLSSIndices.empty());
+	gAssert(mSceneContent.mLSSRadii.empty());
 
-		InstanceInfo& instance_info = mSceneContent.mInstanceInfos[instance_index];
+	// Segments are generated once per mesh, instances sharing vertex and index ranges share them
+	struct Mesh
+	{
+		uint								mVertexOffset = 0;
+		uint								mVertexCount = 0;
+		uint								mIndexOffset = 0;
+		uint								mIndexCount = 0;
+		std::vector<uint>					mSegments;
+		std::vector<float>					mEdgeRadii;				// Per edge radius only, relative to radius of instance
+		LSSWireframe::Stats					mStats;
+		uint								mLSSVertexOffset = 0;	// Per edge radius only, into mLSSVertices
+		uint								mLSSIndexOffset = 0;
+	};
+	constexpr uint kInvalidMeshIndex = 0xFFFFFFFF;
+	std::vector<Mesh> meshes;
+	std::vector<uint> instance_meshes(mSceneContent.mInstanceDatas.size(), kInvalidMeshIndex);
+	{
+		std::map<std::tuple<uint, uint, uint>, uint> mesh_indices;
+		for (uint instance_index = 0; instance_index < mSceneContent.mInstanceDatas.size(); instance_index++)
+		{
+			const InstanceData& instance_data = mSceneContent.mInstanceDatas[instance_index];
+			if (gMaxComponent(instance_data.mEmission) > 0.0f || instance_data.mIndexCount == 0)
+				continue; // Leave light source as triangles
 
-		instance_info.mGeometryType = GeometryType::TriangleAsLSS;
+			auto [iter, inserted] = mesh_indices.try_emplace({ instance_data.mVertexOffset, instance_data.mIndexOffset, instance_data.mIndexCount }, static_cast<uint>(meshes.size()));
+			if (inserted)
+				meshes.push_back({ .mVertexOffset = instance_data.mVertexOffset, .mVertexCount = instance_data.mVertexCount, .mIndexOffset = instance_data.mIndexOffset, .mIndexCount = instance_data.mIndexCount });
+			instance_meshes[instance_index] = iter->second;
+		}
 	}
 
+	const LSSWireframe::Settings& settings = mLSSWireframeSettings;
+	sParallelFor(static_cast<uint>(meshes.size()), gConfigs.mLoadThreadCount, [&](uint inMeshIndex)
 	{
-		{
-			size_t triangle_count = mSceneContent.mIndices.size() / indices_per_triangle;
+		Mesh& mesh = meshes[inMeshIndex];
+		std::span<const VertexType> vertices(mSceneContent.mVertices.data() + mesh.mVertexOffset, mesh.mVertexCount);
+		std::span<const IndexType> indices(mSceneContent.mIndices.data() + mesh.mIndexOffset, mesh.mIndexCount);
+		LSSWireframe::sGenerate(vertices, indices, settings, mesh.mSegments, mesh.mStats);
+
+		if (settings.mPerEdgeRadius)
+			LSSWireframe::sEdgeRadii(vertices, mesh.mSegments, 1.0f, mesh.mEdgeRadii);
+	});
+
+	// Offsets of each mesh, per edge radius duplicates segment end points into mLSSVertices so each segment has its own radii
+	LSSWireframe::Stats stats;
+	uint lss_index_count = 0;
+	for (Mesh& mesh : meshes)
+	{
+		mesh.mLSSIndexOffset = lss_index_count;
+		mesh.mLSSVertexOffset = lss_index_count;
+		lss_index_count += static_cast<uint>(mesh.mSegments.size());
+		stats += mesh.mStats;
+	}
+
+	mSceneContent.mLSSIndices.resize(lss_index_count);
+	if (settings.mPerEdgeRadius)
+		mSceneContent.mLSSVertices.resize(lss_index_count);
 
-			gAssert(mSceneContent.mLSSIndices.empty());
-			mSceneContent.mLSSIndices.resize(triangle_count * lss_indices_per_lss_triangle);
-			for (uint triangle_index = 0; triangle_index < triangle_count; triangle_index++)
+	for (const Mesh& mesh : meshes)
+	{
+		if (settings.mPerEdgeRadius)
+		{
+			for (uint segment_index = 0; segment_index < mesh.mEdgeRadii.size(); segment_index++)
 			{
-				uint triangle_index_offset = triangle_index * indices_per_triangle;
-				IndexType v0 = mSceneContent.mIndices[triangle_index_offset + 0];
-				IndexType v1 = mSceneContent.mIndices[triangle_index_offset + 1];
-				IndexType v2 = mSceneContent.mIndices[triangle_index_offset + 2];
-
-				uint lss_triangle_index_offset = triangle_index * lss_indices_per_lss_triangle;
-				mSceneContent.mLSSIndices[lss_triangle_index_offset + 0] = v0;
-				mSceneContent.mLSSIndices[lss_triangle_index_offset + 1] = v1;
-				mSceneContent.mLSSIndices[lss_triangle_index_offset + 2] = v1;
-				mSceneContent.mLSSIndices[lss_triangle_index_offset + 3] = v2;
-				mSceneContent.mLSSIndices[lss_triangle_index_offset + 4] = v2;
-				mSceneContent.mLSSIndices[lss_triangle_index_offset + 5] = v0;
+				for (uint end = 0; end < 2; end++)
+				{
+					uint lss_index = mesh.mLSSIndexOffset + segment_index * 2 + end;
+					mSceneContent.mLSSVertices[lss_index] = mSceneContent.mVertices[mesh.mVertexOffset + mesh.mSegments[segment_index * 2 + end]];
+					mSceneContent.mLSSIndices[lss_index] = segment_index * 2 + end;
+				}
 			}
 		}
+		else
+			std::copy(mesh.mSegments.begin(), mesh.mSegments.end(), mSceneContent.mLSSIndices.begin() + mesh.mLSSIndexOffset);
+	}
+
+	// Radius follows scale of each instance. Instances sharing a mesh at same radius share a radius range, others get their own one (and BLAS, see GenerateBLASIndices).
+	// Range covers LSS vertices of mesh: vertices of triangle list for uniform radius, segment end points for per edge radius.
+	// [NOTE] Radius can also be uniform by use stride = 0, see NVAPI_D3D12_RAYTRACING_GEOMETRY_LSS_DESC
+	auto get_radius = [&](uint inInstanceIndex) { return gNVAPI.mLSSWireframeRadius * 1.0f / gMinComponent(mSceneContent.mInstanceInfos[inInstanceIndex].mDecomposedScale); };
+	auto get_radius_count = [&](const Mesh& inMesh) { return settings.mPerEdgeRadius ? static_cast<uint>(inMesh.mSegments.size()) : inMesh.mVertexCount; };
+	std::map<std::pair<uint, float>, uint> radius_offsets;	// Mesh index and radius -> offset into mLSSRadii
+	uint radius_count = 0;
+	for (uint instance_index = 0; instance_index < mSceneContent.mInstanceDatas.size(); instance_index++)
+	{
+		uint mesh_index = instance_meshes[instance_index];
+		if (mesh_index == kInvalidMeshIndex || meshes[mesh_index].mSegments.empty())
+			continue;
+
+		if (radius_offsets.try_emplace({ mesh_index, get_radius(instance_index) }, radius_count).second)
+			radius_count += get_radius_count(meshes[mesh_index]);
+	}
 
+	mSceneContent.mLSSRadii.resize(radius_count);
+	for (const auto& [mesh_radius, radius_offset] : radius_offsets)
+	{
+		const Mesh& mesh = meshes[mesh_radius.first];
+		float radius = mesh_radius.second;
+		if (settings.mPerEdgeRadius)
 		{
-			// [NOTE] Radius can also be uniform by use stride = 0, see NVAPI_D3D12_RAYTRACING_GEOMETRY_LSS_DESC
-			gAssert(mSceneContent.mLSSRadii.empty());
-			mSceneContent.mLSSRadii.resize(mSceneContent.mVertices.size());
-			// std::fill(mSceneContent.mLSSRadii.begin(), mSceneContent.mLSSRadii.end(), gNVAPI.mWireframeRadius);
-			for (uint instance_index = 0; instance_index < instance_count; instance_index++)
-			{
-				// Assume vertex is not shared between instances
-				float wireframe_radius = gNVAPI.mLSSWireframeRadius * 1.0f / gMinComponent(mSceneContent.mInstanceInfos[instance_index].mDecomposedScale);
-				for (uint vertex_index = 0; vertex_index < mSceneContent.mInstanceDatas[instance_index].mVertexCount; vertex_index++)
-					mSceneContent.mLSSRadii[mSceneContent.mInstanceDatas[instance_index].mVertexOffset + vertex_index] = wireframe_radius;
-			}
+			for (uint segment_index = 0; segment_index < mesh.mEdgeRadii.size(); segment_index++)
+				for (uint end = 0; end < 2; end++)
+					mSceneContent.mLSSRadii[radius_offset + segment_index * 2 + end] = radius * mesh.mEdgeRadii[segment_index];
+		}
+		else
+			std::fill_n(mSceneContent.mLSSRadii.begin() + radius_offset, get_radius_count(mesh), radius);
+	}
+
+	size_t instance_count = mSceneContent.mInstanceDatas.size();
+	gAssert(instance_count == mSceneContent.mInstanceInfos.size());
+	for (uint instance_index = 0; instance_index < instance_count; instance_index++)
+	{
+		if (instance_meshes[instance_index] == kInvalidMeshIndex)
+			continue;
+
+		const Mesh& mesh = meshes[instance_meshes[instance_index]];
+		if (mesh.mSegments.empty())
+			continue; // No feature edge, leave as triangles
+
+		InstanceData& instance_data = mSceneContent.mInstanceDatas[instance_index];
+		InstanceInfo& instance_info = mSceneContent.mInstanceInfos[instance_index];
+
+		instance_data.mLSSIndexOffset = mesh.mLSSIndexOffset;
+		instance_data.mLSSIndexCount = static_cast<uint>(mesh.mSegments.size());
+		if (settings.mPerEdgeRadius)
+		{
+			instance_data.mLSSVertexOffset = mesh.mLSSVertexOffset;
+			instance_data.mLSSVertexCount = static_cast<uint>(mesh.mSegments.size());
+		}
+		else
+		{
+			// Vertex count is same as triangle list, use existing buffer
+			instance_data.mLSSVertexOffset = instance_data.mVertexOffset;
+			instance_data.mLSSVertexCount = instance_data.mVertexCount;
 		}
+		instance_data.mLSSRadiusOffset = radius_offsets.at({ instance_meshes[instance_index], get_radius(instance_index) });
+		instance_data.mLSSRadiusCount = instance_data.mLSSVertexCount;
+
+		instance_info.mGeometryType = GeometryType::TriangleAsLSS;
 	}
+
+	mGeometryStats.mLSSTriangleCount = stats.mTriangleCount;
+	mGeometryStats.mLSSSegmentCount = stats.mSegmentCount;
+	mGeometryStats.mLSSBytes = sizeof(IndexType) * mSceneContent.mLSSIndices.size() + sizeof(RadiusType) * mSceneContent.mLSSRadii.size() + sizeof(VertexType) * mSceneContent.mLSSVertices.size();
+	gTrace(std::format("[Scene] LSS wireframe {}: {} meshes, {} radius ranges, {} triangles -> {} segments ({:.2f} per triangle), {:.2f} MB\n",
+		nameof::nameof_enum(settings.mMode), meshes.size(), radius_offsets.size(), stats.mTriangleCount, stats.mSegmentCount, stats.mTriangleCount > 0 ? static_cast<double>(stats.mSegmentCount) / stats.mTriangleCount : 0.0, mGeometryStats.mLSSBytes / 1048576.0));
 }
 
-void Scene::GenerateMeshlets()
+void Scene::GenerateMeshlets(bool inInitializeBuffers)
 {
+	PROFILE_SCOPE("Scene::GenerateMeshlets");
+
 	D3D12_RESOURCE_DESC desc_upload = gGetBufferResourceDesc(0);
 	D3D12_HEAP_PROPERTIES props_upload = gGetUploadHeapProperties();
 
@@ -2235,6 +3202,9 @@ void Scene::GenerateMeshlets()
 			}
 		});
 
+		if (!inInitializeBuffers)
+			continue;
+
 		// Meshlet
 		{
 			Buffer& buffer = instance_info.mCluster.mMeshletBuffer;
@@ -2248,8 +3218,6 @@ void Scene::GenerateMeshlets()
 			buffer.Initialize();
 			gAssert(buffer.mUploadPointer[0] != nullptr);
 			memcpy(buffer.mUploadPointer[0], instance_info.mCluster.mMeshlets.data(), buffer.GetSizeInBytes());
-			buffer.mUploadResource[0]->Unmap(0, nullptr);
-			buffer.mUploadPointer[0] = nullptr;
 
 			instance_data.mClusterMeshletBufferIndex = (uint)buffer.mSRVIndex;
 		}
@@ -2267,16 +3235,203 @@ void Scene::GenerateMeshlets()
 			buffer.Initialize();
 			gAssert(buffer.mUploadPointer[0] != nullptr);
 			memcpy(buffer.mUploadPointer[0], instance_info.mCluster.mIndices.data(), buffer.GetSizeInBytes());
-			buffer.mUploadResource[0]->Unmap(0, nullptr);
-			buffer.mUploadPointer[0] = nullptr;
 
 			instance_data.mClusterIndexBufferIndex = (uint)buffer.mSRVIndex;
 		}
 	}
 }
 
+static void sQuantizePositions(std::span<const VertexType> inVertices, std::span<uint2> outPacked, float3& outMin, float3& outScale)
+{
+	float3 bounds_min							= inVertices.empty() ? float3(0.0f) : float3(std::numeric_limits<float>::max());
+	float3 bounds_max							= inVertices.empty() ? float3(0.0f) : float3(-std::numeric_limits<float>::max());
+	for (const VertexType& vertex : inVertices)
+	{
+		bounds_min								= glm::min(bounds_min, vertex);
+		bounds_max								= glm::max(bounds_max, vertex);
+	}
+
+	// Flat axis quantizes to 0
+	float3 extent								= bounds_max - bounds_min;
+	float3 inv_extent							= float3(0.0f);
+	for (int axis = 0; axis < 3; axis++)
+		inv_extent[axis]						= extent[axis] > 0.0f ? 1.0f / extent[axis] : 0.0f;
+
+	for (size_t i = 0; i < inVertices.size(); i++)
+	{
+		float3 normalized						= (inVertices[i] - bounds_min) * inv_extent;
+		uint x									= static_cast<uint>(meshopt_quantizeUnorm(normalized.x, 16));
+		uint y									= static_cast<uint>(meshopt_quantizeUnorm(normalized.y, 16));
+		uint z									= static_cast<uint>(meshopt_quantizeUnorm(normalized.z, 16));
+		outPacked[i]							= uint2(x | (y << 16), z);
+	}
+
+	outMin										= bounds_min;
+	outScale									= extent / 65535.0f;
+}
+
+static void sQuantizeNormals(std::span<const NormalType> inNormals, std::span<uint> outPacked)
+{
+	// meshopt_encodeFilterOct takes 4 floats and writes 4 components per normal, only xy are kept
+	std::vector<float4> normals(inNormals.size());
+	for (size_t i = 0; i < inNormals.size(); i++)
+		normals[i]								= float4(inNormals[i], 0.0f);
+
+	std::vector<int16_t> encoded(inNormals.size() * 4);
+	meshopt_encodeFilterOct(encoded.data(), inNormals.size(), sizeof(int16_t) * 4, 16, &normals.data()->x);
+
+	for (size_t i = 0; i < inNormals.size(); i++)
+		outPacked[i]							= static_cast<uint>(static_cast<uint16_t>(encoded[i * 4 + 0])) | (static_cast<uint>(static_cast<uint16_t>(encoded[i * 4 + 1])) << 16);
+}
+
+static void sQuantizeUVs(std::span<const UVType> inUVs, std::span<uint> outPacked)
+{
+	for (size_t i = 0; i < inUVs.size(); i++)
+		outPacked[i]							= static_cast<uint>(meshopt_quantizeHalf(inUVs[i].x)) | (static_cast<uint>(meshopt_quantizeHalf(inUVs[i].y)) << 16);
+}
+
+void Scene::QuantizeVertexAttributes()
+{
+	PROFILE_SCOPE("Scene::QuantizeVertexAttributes");
+
+	size_t vertex_count							= mSceneContent.mVertices.size();
+	mSceneContent.mQuantizedVertices.resize(vertex_count);
+	mSceneContent.mQuantizedNormals.resize(vertex_count);
+	mSceneContent.mQuantizedUVs.resize(vertex_count);
+
+	sQuantizeNormals(mSceneContent.mNormals, mSceneContent.mQuantizedNormals);
+	sQuantizeUVs(mSceneContent.mUVs, mSceneContent.mQuantizedUVs);
+
+	// Positions are quantized within bounds of each vertex range, instances may share a range
+	std::map<uint, uint> instance_by_vertex_offset;
+	for (uint instance_index = 0; instance_index < mSceneContent.mInstanceDatas.size(); instance_index++)
+		instance_by_vertex_offset.try_emplace(mSceneContent.mInstanceDatas[instance_index].mVertexOffset, instance_index);
+
+	std::for_each(std::execution::par, instance_by_vertex_offset.begin(), instance_by_vertex_offset.end(), [&](const std::pair<const uint, uint>& inEntry)
+	{
+		InstanceData& instance_data				= mSceneContent.mInstanceDatas[inEntry.second];
+		std::span<const VertexType> vertices(mSceneContent.mVertices.data() + instance_data.mVertexOffset, instance_data.mVertexCount);
+		std::span<uint2> packed(mSceneContent.mQuantizedVertices.data() + instance_data.mVertexOffset, instance_data.mVertexCount);
+		sQuantizePositions(vertices, packed, instance_data.mPositionQuantizationMin, instance_data.mPositionQuantizationScale);
+	});
+
+	for (InstanceData& instance_data : mSceneContent.mInstanceDatas)
+	{
+		const InstanceData& quantized			= mSceneContent.mInstanceDatas[instance_by_vertex_offset[instance_data.mVertexOffset]];
+		instance_data.mPositionQuantizationMin	= quantized.mPositionQuantizationMin;
+		instance_data.mPositionQuantizationScale = quantized.mPositionQuantizationScale;
+	}
+
+	mGeometryStats.mVertexAttributeQuantizedBytes = vertex_count * (sizeof(uint2) + sizeof(uint) + sizeof(uint));
+	mGeometryStats.mVertexAttributeResidentBytes = mGeometryStats.mVertexAttributeQuantizedBytes + vertex_count * sizeof(VertexType);
+	gTrace(std::format("[Scene] Quantized vertex attributes of {} vertices, {:.2f} MB -> {:.2f} MB, {:.2f} MB resident with float positions for BLAS\n", 
+		vertex_count, mGeometryStats.mVertexAttributeFloatBytes / 1048576.0, mGeometryStats.mVertexAttributeQuantizedBytes / 1048576.0, mGeometryStats.mVertexAttributeResidentBytes / 1048576.0));
+}
+
+bool Scene::sValidateVertexQuantization(std::string& outMessage)
+{
+	constexpr uint kVertexCount					= 100000;
+
+	std::mt19937 random_engine(0);
+	std::uniform_real_distribution<float> position_distribution(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> uv_distribution(-8.0f, 8.0f);
+	std::normal_distribution<float> normal_distribution(0.0f, 1.0f);
+
+	std::vector<VertexType> vertices(kVertexCount);
+	std::vector<NormalType> normals(kVertexCount);
+	std::vector<UVType> uvs(kVertexCount);
+	for (uint i = 0; i < kVertexCount; i++)
+	{
+		vertices[i]								= float3(position_distribution(random_engine), position_distribution(random_engine) * 0.01f, 0.5f); // Includes a flat axis
+		normals[i]								= glm::normalize(float3(normal_distribution(random_engine), normal_distribution(random_engine), normal_distribution(random_engine)));
+		uvs[i]									= float2(uv_distribution(random_engine), uv_distribution(random_engine) * 1.0e-3f);
+	}
+
+	// Axes and diagonals are the edges of octahedral mapping
+	const float3 kEdgeNormals[]					= { float3(1, 0, 0), float3(-1, 0, 0), float3(0, 1, 0), float3(0, -1, 0), float3(0, 0, 1), float3(0, 0, -1), glm::normalize(float3(1, -1, -1)), glm::normalize(float3(-1, 1, 0)) };
+	for (uint i = 0; i < std::size(kEdgeNormals); i++)
+		normals[i]								= kEdgeNormals[i];
+
+	std::vector<uint2> packed_vertices(kVertexCount);
+	std::vector<uint> packed_normals(kVertexCount);
+	std::vector<uint> packed_uvs(kVertexCount);
+	float3 position_min, position_scale;
+	sQuantizePositions(vertices, packed_vertices, position_min, position_scale);
+	sQuantizeNormals(normals, packed_normals);
+	sQuantizeUVs(uvs, packed_uvs);
+
+	// Rounding to nearest bounds error by half a step, plus float error of decode
+	double position_error_max					= 0;
+	double normal_error_max						= 0;
+	double uv_error_max							= 0;
+	bool position_within_bound					= true;
+	bool uv_within_bound						= true;
+	bool normal_unit							= true;
+	for (uint i = 0; i < kVertexCount; i++)
+	{
+		float3 position							= DecodePositionUnorm16(packed_vertices[i], position_min, position_scale);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			double error						= std::abs(static_cast<double>(position[axis]) - vertices[i][axis]);
+			double bound						= position_scale[axis] * 0.5 + (std::abs(position_min[axis]) + position_scale[axis] * 65535.0) * 1.0e-6;
+			position_within_bound				&= error <= bound;
+			position_error_max					= std::max(position_error_max, position_scale[axis] > 0.0f ? error / position_scale[axis] : error);
+		}
+
+		float3 normal							= DecodeNormalOct16(packed_normals[i]);
+		double distance							= glm::length(glm::dvec3(normal) - glm::dvec3(normals[i]));
+		normal_error_max						= std::max(normal_error_max, 2.0 * std::asin(std::min(distance * 0.5, 1.0)));
+		normal_unit								&= std::abs(glm::length(normal) - 1.0f) < 1.0e-5f;
+
+		float2 uv								= DecodeUVHalf(packed_uvs[i]);
+		for (int axis = 0; axis < 2; axis++)
+		{
+			double error						= std::abs(static_cast<double>(uv[axis]) - uvs[i][axis]);
+			double bound						= std::max(std::abs(uvs[i][axis]) * std::ldexp(1.0, -11), std::ldexp(1.0, -25));
+			uv_within_bound						&= error <= bound;
+			uv_error_max						= std::max(uv_error_max, uvs[i][axis] != 0.0f ? error / std::abs(uvs[i][axis]) : error);
+		}
+	}
+
+	constexpr double kNormalErrorBound			= 1.0e-4; // Radians, 16bit octahedral is about 3.5e-5 at worst
+	std::vector<std::pair<std::string, bool>> checks =
+	{
+		{ std::format("position error within half step, max {:.3f} step", position_error_max),		position_within_bound },
+		{ std::format("normal error within {} rad, max {:.2e} rad", kNormalErrorBound, normal_error_max),	normal_error_max <= kNormalErrorBound },
+		{ "normal decodes to unit length",																normal_unit },
+		{ std::format("uv error within half precision, max {:.2e} relative", uv_error_max),			uv_within_bound },
+	};
+
+	outMessage									= std::format("[Scene] Validate vertex quantization: {} vertices, {} -> {} bytes per vertex\n",
+		kVertexCount, sizeof(VertexType) + sizeof(NormalType) + sizeof(UVType), sizeof(uint2) + sizeof(uint) + sizeof(uint));
+	return gReportValidateChecks(checks, outMessage);
+}
+
 void Scene::InitializeAccelerationStructures()
 {
+	PROFILE_SCOPE("Scene::InitializeAccelerationStructures");
+
+	GenerateBLASIndices();
+	mBlases.resize(mGeometryStats.mBLASCount);
+
+	// Compacted size of each BLAS, written by its build. Cluster BLASes are built through NVAPI cluster operations, not compacted.
+	mBLASCompaction = {};
+	bool compact = gConfigs.mCompactBLAS && !mBlases.empty() && !(gNVAPI.mClusterSupported && gNVAPI.mClusterEnabled);
+	if (compact)
+	{
+		uint64_t size = sizeof(uint64_t) * mBlases.size();
+
+		D3D12_HEAP_PROPERTIES props = gGetDefaultHeapProperties();
+		D3D12_RESOURCE_DESC desc = gGetUAVResourceDesc(size);
+		gValidate(gDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&mBLASCompaction.mSizes)));
+		gSetName(mBLASCompaction.mSizes, "Scene", "", ".[BLAS].CompactedSizes");
+
+		props = gGetReadbackHeapProperties();
+		desc = gGetBufferResourceDesc(size);
+		gValidate(gDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&mBLASCompaction.mSizesReadback)));
+		gSetName(mBLASCompaction.mSizesReadback, "Scene", "", ".[BLAS].CompactedSizesReadback");
+	}
+
 	std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instance_descs;
 	instance_descs.resize(GetInstanceCount());
 	for (int instance_index = 0; instance_index < GetInstanceCount(); instance_index++)
@@ -2284,18 +3439,25 @@ void Scene::InitializeAccelerationStructures()
 		const InstanceInfo& instance_info = GetInstanceInfo(instance_index);
 		const InstanceData& instance_data = GetInstanceData(instance_index);
 
-		BLASRef blas = std::make_shared<BLAS>();
-		blas->Initialize(
+		// Initialized by first instance using it
+		uint blas_index = mSceneContent.mInstanceBLASIndices[instance_index];
+		BLASRef& blas = mBlases[blas_index];
+		if (blas == nullptr)
 		{
-			.mInstanceInfo = instance_info,
-			.mInstanceData = instance_data,
-			.mVerticesBaseAddress = mRuntime.mVertices->GetGPUVirtualAddress(),
-			.mIndicesBaseAddress = mRuntime.mIndices->GetGPUVirtualAddress(),
-			.mLSSVerticesBaseAddress = mRuntime.mLSSVertices != nullptr ? mRuntime.mLSSVertices->GetGPUVirtualAddress() : mRuntime.mVertices->GetGPUVirtualAddress(),
-			.mLSSIndicesBaseAddress = mRuntime.mLSSIndices != nullptr ? mRuntime.mLSSIndices->GetGPUVirtualAddress() : 0,
-			.mLSSRadiiBaseAddress = mRuntime.mLSSRadii != nullptr ? mRuntime.mLSSRadii->GetGPUVirtualAddress() : 0,
-		});
-		mBlases.push_back(blas);
+			blas = std::make_shared<BLAS>();
+			blas->Initialize(
+			{
+				.mInstanceInfo = instance_info,
+				.mInstanceData = instance_data,
+				.mVerticesBaseAddress = mRuntime.mVertices->GetGPUVirtualAddress(),
+				.mIndicesBaseAddress = mRuntime.mIndices->GetGPUVirtualAddress(),
+				.mLSSVerticesBaseAddress = mRuntime.mLSSVertices != nullptr ? mRuntime.mLSSVertices->GetGPUVirtualAddress() : mRuntime.mVertices->GetGPUVirtualAddress(),
+				.mLSSIndicesBaseAddress = mRuntime.mLSSIndices != nullptr ? mRuntime.mLSSIndices->GetGPUVirtualAddress() : 0,
+				.mLSSRadiiBaseAddress = mRuntime.mLSSRadii != nullptr ? mRuntime.mLSSRadii->GetGPUVirtualAddress() : 0,
+				.mCompactedSizeAddress = compact ? mBLASCompaction.mSizes->GetGPUVirtualAddress() + sizeof(uint64_t) * blas_index : 0,
+			});
+			mGeometryStats.mBLASResultBytes += instance_info.mStats.mResultDataSizeInBytes;
+		}
 
 		glm::mat4x4 transform = glm::transpose(instance_data.mTransform); // column-major -> row-major
 		memcpy(instance_descs[instance_index].Transform, &transform, sizeof(instance_descs[instance_index].Transform));
@@ -2306,12 +3468,34 @@ void Scene::InitializeAccelerationStructures()
 		instance_descs[instance_index].AccelerationStructure = blas->GetGPUVirtualAddress();
 	}
 
+	// Radii of animated scenes enable refit, shared by instances of same BLAS
+	std::vector<float> radii;
+	if (HasAnimatedInstances())
+	{
+		std::vector<float> blas_radii(mBlases.size(), -1.0f);
+		radii.resize(GetInstanceCount());
+		for (int instance_index = 0; instance_index < GetInstanceCount(); instance_index++)
+		{
+			float& radius = blas_radii[mSceneContent.mInstanceBLASIndices[instance_index]];
+			if (radius < 0.0f)
+			{
+				const InstanceData& instance_data = GetInstanceData(instance_index);
+				radius = 0.0f;
+				for (uint vertex_index = instance_data.mVertexOffset; vertex_index < instance_data.mVertexOffset + instance_data.mVertexCount; vertex_index++)
+					radius = gMax(radius, glm::length(mSceneContent.mVertices[vertex_index]));
+			}
+			radii[instance_index] = radius;
+		}
+	}
+
 	mTLAS = std::make_shared<TLAS>();
-	mTLAS->Initialize("Default", instance_descs);
+	mTLAS->Initialize("Default", instance_descs, radii);
 }
 
 void Scene::InitializeViews()
 {
+	PROFILE_SCOPE("Scene::InitializeViews");
+
 	auto create_acceleration_structure_SRV = [](ID3D12Resource* inResource, ViewDescriptorIndex inViewDescriptorIndex)
 	{
 		D3D12_SHADER_RESOURCE_VIEW_DESC desc = {};
@@ -2338,6 +3522,21 @@ void Scene::InitializeViews()
 			gDevice->CreateShaderResourceView(inResource, &desc, gFrameContexts[i].mViewDescriptorHeap.GetCPUHandle(inViewDescriptorIndex));
 	};
 
+	auto create_buffer_raw_SRV = [](ID3D12Resource* inResource, ViewDescriptorIndex inViewDescriptorIndex)
+	{
+		D3D12_SHADER_RESOURCE_VIEW_DESC desc = {};
+		D3D12_RESOURCE_DESC resource_desc = inResource->GetDesc();
+		desc.Format = DXGI_FORMAT_R32_TYPELESS;
+		desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+		desc.Buffer.NumElements = static_cast<UINT>(resource_desc.Width / sizeof(uint));
+		desc.Buffer.StructureByteStride = 0;
+		desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+
+		for (int i = 0; i < kFrameInFlightCount; i++)
+			gDevice->CreateShaderResourceView(inResource, &desc, gFrameContexts[i].mViewDescriptorHeap.GetCPUHandle(inViewDescriptorIndex));
+	};
+
 	auto create_buffer_UAV = [](ID3D12Resource* inResource, int inStride, ViewDescriptorIndex inViewDescriptorIndex)
 	{
 		D3D12_UNORDERED_ACCESS_VIEW_DESC desc = {};
@@ -2353,9 +3552,18 @@ void Scene::InitializeViews()
 	};
 	
 	create_buffer_SRV(mRuntime.mInstanceDatas.Get(), sizeof(InstanceData), ViewDescriptorIndex::RaytraceInstanceDataSRV);
-	create_buffer_SRV(mRuntime.mIndices.Get(), sizeof(IndexType), ViewDescriptorIndex::RaytraceIndicesSRV);
-	create_buffer_SRV(mRuntime.mVertices.Get(), sizeof(VertexType), ViewDescriptorIndex::RaytraceVerticesSRV);
-	create_buffer_SRV(mRuntime.mNormals.Get(), sizeof(NormalType), ViewDescriptorIndex::RaytraceNormalsSRV);
-	create_buffer_SRV(mRuntime.mUVs.Get(), sizeof(UVType), ViewDescriptorIndex::RaytraceUVsSRV);
+	create_buffer_raw_SRV(mRuntime.mIndices.Get(), ViewDescriptorIndex::RaytraceIndicesSRV);
+	if (gConfigs.mQuantizeVertexAttributes)
+	{
+		create_buffer_SRV(mRuntime.mQuantizedVertices.Get(), sizeof(uint2), ViewDescriptorIndex::RaytraceVerticesSRV);
+		create_buffer_SRV(mRuntime.mNormals.Get(), sizeof(uint), ViewDescriptorIndex::RaytraceNormalsSRV);
+		create_buffer_SRV(mRuntime.mUVs.Get(), sizeof(uint), ViewDescriptorIndex::RaytraceUVsSRV);
+	}
+	else
+	{
+		create_buffer_SRV(mRuntime.mVertices.Get(), sizeof(VertexType), ViewDescriptorIndex::RaytraceVerticesSRV);
+		create_buffer_SRV(mRuntime.mNormals.Get(), sizeof(NormalType), ViewDescriptorIndex::RaytraceNormalsSRV);
+		create_buffer_SRV(mRuntime.mUVs.Get(), sizeof(UVType), ViewDescriptorIndex::RaytraceUVsSRV);
+	}
 	create_buffer_SRV(mRuntime.mLights.Get(), sizeof(Light), ViewDescriptorIndex::RaytraceLightsSRV);
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Common.h"
+#include "LightBVH.h"
+#include "Animation.h"
+#include "TLASUpdatePolicy.h"
+#include "LSSWireframe.h"
 
 #include <meshoptimizer.h>
 
@@ -75,6 +79,7 @@ struct InstanceInfo
 	{
 		mutable uint64_t mScratchDataSizeInBytes = 0;
 		mutable uint64_t mResultDataSizeInBytes = 0;
+		mutable uint64_t mCompactedDataSizeInBytes = 0;	// 0 until compacted
 
 		struct Cluster
 		{
@@ -105,12 +110,17 @@ public:
 		D3D12_GPU_VIRTUAL_ADDRESS mLSSVerticesBaseAddress;
 		D3D12_GPU_VIRTUAL_ADDRESS mLSSIndicesBaseAddress;
 		D3D12_GPU_VIRTUAL_ADDRESS mLSSRadiiBaseAddress;
+
+		D3D12_GPU_VIRTUAL_ADDRESS mCompactedSizeAddress = 0;		// Build writes compacted size there, 0 to build without ALLOW_COMPACTION
 	};
 
 	void Initialize(const Initializer& inInitializer);
 	void InitializeCLAS(const Initializer& inInitializer);
 	void Build(ID3D12GraphicsCommandList4* inCommandList);
 
+	// Copy into inDestination, uncompacted result and scratch are moved to ioRetired to be released once GPU is done with them
+	void Compact(ID3D12GraphicsCommandList4* inCommandList, D3D12_GPU_VIRTUAL_ADDRESS inDestination, std::vector<ComPtr<ID3D12Resource>>& ioRetired);
+
 	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const 
 	{
 		if (mClusterBLAS.mBuild != nullptr)
@@ -118,6 +128,9 @@ public:
 			return mClusterBLAS.mBuild->GetGPUVirtualAddress();
 		}
 
+		if (mCompactedAddress != 0)
+			return mCompactedAddress;
+
 		return mDest->GetGPUVirtualAddress(); 
 	}
 
@@ -131,6 +144,9 @@ private:
 	ComPtr<ID3D12Resource> mScratch = nullptr;
 	ComPtr<ID3D12Resource> mDest = nullptr;
 
+	D3D12_GPU_VIRTUAL_ADDRESS mCompactedSizeAddress = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS mCompactedAddress = 0;		// In Scene::BLASCompaction::mPool
+
 	struct Cluster
 	{
 		NVAPI_D3D12_RAYTRACING_MULTI_INDIRECT_CLUSTER_OPERATION_DESC mBuildDesc{};
@@ -161,27 +177,34 @@ using RadiusType = float;
 struct SceneContent
 {
 	std::vector<IndexType>						mIndices;
+	std::vector<uint8_t>						mPackedIndices;			// 16bit or 32bit per instance, see InstanceData::mIndexByteOffset
 	std::vector<VertexType>						mVertices;
 	std::vector<NormalType>						mNormals;
 	std::vector<UVType>							mUVs;
 
+	// Packed as expected by DecodePositionUnorm16, DecodeNormalOct16 and DecodeUVHalf, empty unless quantized
+	std::vector<uint2>							mQuantizedVertices;
+	std::vector<uint>							mQuantizedNormals;
+	std::vector<uint>							mQuantizedUVs;
+
 	std::vector<VertexType>						mLSSVertices;
 	std::vector<IndexType>						mLSSIndices;
 	std::vector<float>							mLSSRadii;
 
 	std::vector<InstanceInfo>					mInstanceInfos;
 	std::vector<InstanceData>					mInstanceDatas;
+	std::vector<uint>							mInstanceBLASIndices;	// Into Scene::mBlases, see Scene::GenerateBLASIndices
+
+	// Node hierarchy of glTF, instances follow their node when animated
+	Animation									mAnimation;
+	std::vector<uint>							mInstanceAnimationNodes;	// Per instance, Animation::kInvalidIndex if not from a node
+	std::vector<uint>							mAnimatedInstances;
 
-	struct InstanceAnimation
-	{
-		std::vector<glm::vec3>					mTranslation;
-		std::vector<glm::vec4>					mRotation;
-		std::vector<glm::vec3>					mScale;
-	};
 	struct Camera
 	{
 		bool									mHasAnimation = false;
-		InstanceAnimation						mAnimation;
+		uint									mAnimationNode = Animation::kInvalidIndex;
+		Animation								mAnimation;					// Own copy, camera animation may come from another glTF than the scene
 	};
 	Camera										mCamera;
 
@@ -193,8 +216,25 @@ struct SceneContent
 	std::vector<EmissiveInstance>				mEmissiveInstances;
 	uint										mEmissiveTriangleCount = 0;
 
+	// World space triangle of emissive instance, see Scene::GenerateTriangleLights
+	// [NOTE] CPU only, triangle emitters of LightBVH are built from it. Light sampling on GPU covers Light only.
+	struct TriangleLight
+	{
+		glm::vec3								mBase;
+		glm::vec3								mEdge1;
+		glm::vec3								mEdge2;
+		glm::vec3								mRadiance;				// Emission factor, texture is not applied
+		uint									mInstanceIndex;
+		uint									mPrimitiveIndex;
+	};
+	std::vector<TriangleLight>					mTriangleLights;		// Indexed by EmissiveInstance::mTriangleOffset + primitive index
+
 	std::vector<Light>							mLights;
 
+	// World space, of all instances
+	glm::vec3									mBoundsMin = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3									mBoundsMax = glm::vec3(-std::numeric_limits<float>::max());
+
 	std::set<BSDF>								mBSDFs;
 
 	std::optional<glm::mat4x4>					mCameraTransform;
@@ -206,18 +246,32 @@ struct SceneContent
 class TLAS final
 {
 public:
-	void Initialize(const std::string& inName, const std::vector<D3D12_RAYTRACING_INSTANCE_DESC>& inInstanceDescs);
+	// inRadii of instances enable refit, see TLASUpdatePolicy. Empty for static scenes, which keep a build without ALLOW_UPDATE.
+	void Initialize(const std::string& inName, const std::vector<D3D12_RAYTRACING_INSTANCE_DESC>& inInstanceDescs, std::span<const float> inRadii = {});
+	void SetTransform(uint inInstanceIndex, const glm::mat4x4& inTransform);
+	void SetAccelerationStructure(uint inInstanceIndex, D3D12_GPU_VIRTUAL_ADDRESS inAddress);
 	void Build(ID3D12GraphicsCommandList4* inCommandList);
+	void Update(ID3D12GraphicsCommandList4* inCommandList);	// Per frame, writes modified descs then refits or rebuilds as TLASUpdatePolicy decides
 
 	ID3D12Resource* GetResource() const						{ return mDest.Get(); }
 	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const	{ return mDest->GetGPUVirtualAddress(); }
+	bool IsUpdatable() const								{ return (mInputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE) != 0; }
+	TLASUpdatePolicy& GetUpdatePolicy()						{ return mUpdatePolicy; }
 
 private:
+	void Build(ID3D12GraphicsCommandList4* inCommandList, bool inRefit);
+
 	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS	mInputs {};
 
 	ComPtr<ID3D12Resource>									mScratch;
 	ComPtr<ID3D12Resource>									mDest;
+
+	// Persistent upload ring, one slot of all descs per frame in flight
 	ComPtr<ID3D12Resource>									mInstanceDescs;
+	D3D12_RAYTRACING_INSTANCE_DESC*							mInstanceDescsPointer = nullptr;
+	std::vector<D3D12_RAYTRACING_INSTANCE_DESC>				mInstanceDescsCPU;
+	TLASUpdatePolicy										mUpdatePolicy;
+	std::vector<TLASUpdatePolicy::Range>					mUpdateRanges;
 };
 using TLASRef = std::shared_ptr<TLAS>;
 
@@ -268,11 +322,23 @@ class Scene
 {
 public:
 	void Load(const ScenePreset& inPreset);
+	void LoadContent(const ScenePreset& inPreset);				// CPU side only, without D3D12 resources
+	void LoadCPU(const ScenePreset& inPreset);					// LoadContent, then LSS and meshlets regardless of device support, for benchmark without GPU
 	void Unload();
 
 	void UpdateGPU(ID3D12GraphicsCommandList4* inCommandList);
 	void Render(ID3D12GraphicsCommandList4* inCommandList);
 
+	// Once sizes written by BLAS builds are read back, copy BLASes into a pool and rebuild TLAS against it. See gConfigs.mCompactBLAS.
+	void CompactBLASes(ID3D12GraphicsCommandList4* inCommandList);
+
+	// Evaluate node animation and update transforms of animated instances, uploaded with TLAS refit or rebuild by UpdateAnimationGPU
+	void UpdateAnimation(float inTime);
+	void UpdateAnimationGPU(ID3D12GraphicsCommandList4* inCommandList);
+	bool SampleCameraAnimation(float inRatio, glm::mat4x4& outMatrix);
+	bool OverrideCameraAnimation(const std::string& inPath);	// Camera animation of another glTF, e.g. per batch job. Empty path restores the one of the scene.
+	bool HasAnimatedInstances() const							{ return !mSceneContent.mAnimatedInstances.empty(); }
+
 	const SceneContent& GetSceneContent() const					{ return mSceneContent; }
 
 	int GetInstanceCount() const								{ return static_cast<int>(mSceneContent.mInstanceInfos.size()); }
@@ -284,18 +350,81 @@ public:
 	int GetLightCount() const									{ return static_cast<int>(mSceneContent.mLights.size()); }
 	const Light& GetLight(int inIndex) const					{ return mSceneContent.mLights[inIndex]; }
 
+	struct LoadStats
+	{
+		float								mParseMS = 0;
+		float								mXMLParseMS = 0;				// Mitsuba only, within mParseMS, document and fast pass collecting OBJ files
+		float								mObjIOMS = 0;					// Mitsuba only, within mParseMS, all OBJ files loaded concurrently
+		float								mMergeMS = 0;					// Mitsuba only, within mParseMS, shapes merged in document order
+		float								mGLTFFileMS = 0;				// glTF only, within mParseMS, JSON and buffers read by tinygltf
+		float								mGLTFTraverseMS = 0;			// glTF only, within mParseMS, node transforms and output ranges
+		float								mGLTFConvertMS = 0;				// glTF only, within mParseMS, primitive copies and instances, on gConfigs.mLoadThreadCount threads
+		float								mOptimizeMeshesMS = 0;
+		float								mLightsMS = 0;					// Triangle lights and light BVH
+		float								mTriangleLightsMS = 0;			// Within mLightsMS, world space triangles of emissive instances
+		float								mLSSMS = 0;
+		float								mMeshletsMS = 0;
+		float								mQuantizeMS = 0;
+		float								mTexturesMS = 0;
+		float								mTextureDecodeMS = 0;			// On first render
+		float								mBuffersMS = 0;
+		float								mAccelerationStructuresMS = 0;	// BLAS inputs and build recording
+		float								mViewsMS = 0;
+	};
+	const LoadStats& GetLoadStats() const						{ return mLoadStats; }
+
+	struct GeometryStats
+	{
+		uint64_t							mInstancedVertexCount = 0;			// Sum over instances, as if no range was shared
+		uint64_t							mSourceVertexCount = 0;				// As loaded, before OptimizeMeshes
+		uint64_t							mVertexCount = 0;
+		uint64_t							mVertexAttributeFloatBytes = 0;		// Positions, normals and UVs read by shading
+		uint64_t							mVertexAttributeQuantizedBytes = 0;	// Same streams when quantized, 0 otherwise
+		uint64_t							mVertexAttributeResidentBytes = 0;	// On GPU when quantized, float positions stay as BLAS build input
+		uint64_t							mIndexBytes = 0;					// As 32bit
+		uint64_t							mPackedIndexBytes = 0;				// 16bit where vertex range allows, 0 until packed
+		uint								mIndex16BitInstanceCount = 0;
+		uint								mBLASCount = 0;
+		uint64_t							mBLASResultBytes = 0;				// Prebuild size of all BLASes, as built
+		uint64_t							mBLASCompactedBytes = 0;			// 0 until compacted, see CompactBLASes
+		uint64_t							mBLASPoolBytes = 0;					// Compacted with alignment
+		uint								mBLASCompactedCount = 0;
+		uint64_t							mLSSTriangleCount = 0;				// Of meshes turned into LSS wireframe, see GenerateLSSFromTriangle
+		uint64_t							mLSSSegmentCount = 0;
+		uint64_t							mLSSBytes = 0;						// Indices, radii, and vertices when per edge radius
+	};
+	const GeometryStats& GetGeometryStats() const				{ return mGeometryStats; }
+
+	// Quantizes random attributes and checks decode error against bounds of each encoding
+	static bool sValidateVertexQuantization(std::string& outMessage);
+
+	// Per BLAS, named after first instance using it, then scene totals
+	void ReportBLASMemory(std::string& outReport) const;
+
+	const LightBVH& GetLightBVH() const							{ return mLightBVH; }
+	void EvaluateLightBVH()										{ mLightBVH.Evaluate(mSceneContent, 1024, 256); }
+
+	LSSWireframe::Settings					mLSSWireframeSettings;		// Of TriangleAsLSS, applied on load
+
 	void ImGuiShowTextures()									{ ImGui::Textures(mTextures, "Scene", ImGuiTreeNodeFlags_None); }
 
 private:
 	bool LoadDummy(SceneContent& ioContext);
-	bool LoadObj(const std::string& inFilename, const glm::mat4x4& inTransform, bool inFlipV, SceneContent& ioContext);
+	bool LoadObj(const std::string& inFilename, const glm::mat4x4& inTransform, bool inFlipV, SceneContent& ioContext, std::string* outMessages = nullptr); // Messages are traced when outMessages is null
 	bool LoadMitsuba(const std::string& inFilename, SceneContent& ioContext);
 	bool LoadGLTF(const std::string& inFilename, SceneContent& ioContext);
+	bool LoadCameraAnimation(const std::string& inFilename, SceneContent::Camera& outCamera);
 
-	void FillDummyMaterial(InstanceInfo& ioInstanceInfo, InstanceData& ioInstanceData);
+	static void FillDummyMaterial(InstanceInfo& ioInstanceInfo, InstanceData& ioInstanceData);
 	
+	void OptimizeMeshes();
+	void PackIndices();
+	void GenerateBLASIndices();
+	void GenerateBounds();
+	void GenerateTriangleLights();
 	void GenerateLSSFromTriangle();
-	void GenerateMeshlets();
+	void GenerateMeshlets(bool inInitializeBuffers);
+	void QuantizeVertexAttributes();
 
 	void InitializeTextures();
 	void InitializeBuffers();
@@ -313,16 +442,36 @@ private:
 	Primitives								mPrimitives;
 
 	SceneContent							mSceneContent;
+	std::optional<SceneContent::Camera>		mSceneCamera;				// Camera of the scene while overridden by OverrideCameraAnimation
+
+	LightBVH								mLightBVH;
+	LoadStats								mLoadStats;
+	GeometryStats							mGeometryStats;
 
 	std::vector<BLASRef>					mBlases;
 	TLASRef									mTLAS;
 
+	// Builds write compacted sizes, read back once the frame of the builds completes, then BLASes are copied into one pool
+	struct BLASCompaction
+	{
+		bool								mPending = false;
+		uint								mBuildFrameIndex = 0;
+		ComPtr<ID3D12Resource>				mSizes;						// uint64_t per BLAS
+		ComPtr<ID3D12Resource>				mSizesReadback;
+		ComPtr<ID3D12Resource>				mPool;
+		std::vector<ComPtr<ID3D12Resource>>	mRetired;					// Uncompacted, still referenced by frames in flight
+		uint								mRetiredFrameIndex = 0;
+	};
+	BLASCompaction							mBLASCompaction;
+	bool									mInstancesDirty = false;	// Transforms changed by UpdateAnimation since last UpdateAnimationGPU
+
 	struct Runtime
 	{
 		ComPtr<ID3D12Resource>				mIndices;
 		ComPtr<ID3D12Resource>				mVertices;
 		ComPtr<ID3D12Resource>				mNormals;
 		ComPtr<ID3D12Resource>				mUVs;
+		ComPtr<ID3D12Resource>				mQuantizedVertices;		// For shading when quantized, BLAS still uses mVertices
 
 		ComPtr<ID3D12Resource>				mInstanceDatas;
 		ComPtr<ID3D12Resource>				mLights;
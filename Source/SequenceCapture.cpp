@@ -0,0 +1,154 @@
+#include "SequenceCapture.h"
+
+SequenceCapture gSequenceCapture;
+
+static bool sToEncoderFormat(DXGI_FORMAT inFormat, FrameEncoder::Format& outFormat)
+{
+	switch (inFormat)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:		outFormat = FrameEncoder::Format::RGBA8; return true;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:	outFormat = FrameEncoder::Format::RGBA16F; return true;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:	outFormat = FrameEncoder::Format::RGBA32F; return true;
+	default:								return false;
+	}
+}
+
+void SequenceCapture::Finalize()
+{
+	Flush();
+	mEncoder.Finalize();
+
+	for (Slot& slot : mSlots)
+		slot												= {};
+	mNextSlotIndex											= 0;
+}
+
+void SequenceCapture::Capture(ID3D12GraphicsCommandList4* inCommandList, const Texture& inTexture, const std::filesystem::path& inPath, uint64_t inFenceValue)
+{
+	if (mEncoder.GetThreadCount() == 0)
+		mEncoder.Initialize(mThreadCount, mQueueCapacity);
+
+	D3D12_RESOURCE_DESC resource_desc						= inTexture.mResource->GetDesc();
+	FrameEncoder::Format format								= FrameEncoder::Format::RGBA8;
+	if (!sToEncoderFormat(resource_desc.Format, format))
+	{
+		gTrace(std::format("[SequenceCapture] Unsupported format {} for {}\n", nameof::nameof_enum(resource_desc.Format), inPath.string()));
+		return;
+	}
+
+	Slot& slot												= mSlots[mNextSlotIndex];
+	mNextSlotIndex											= (mNextSlotIndex + 1) % kRingSize;
+
+	if (slot.mPending)
+	{
+		// Ring is full, GPU or encoder is behind
+		float stall_ms										= 0.0f;
+		{
+			CPU_TIMING_SCOPE_SIMPLE(&stall_ms);
+			WaitForSlot(slot);
+		}
+		mStats.mRingStallCount++;
+		mStats.mRingStallMS									+= stall_ms;
+	}
+
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint			= {};
+	UINT64 size_in_bytes									= 0;
+	gDevice->GetCopyableFootprints(&resource_desc, 0, 1, 0, &footprint, nullptr, nullptr, &size_in_bytes);
+
+	// (Re)create on first use or resize
+	if (slot.mResource == nullptr || slot.mSizeInBytes < size_in_bytes)
+	{
+		slot.mResource										= nullptr;
+
+		D3D12_RESOURCE_DESC readback_resource_desc			= gGetBufferResourceDesc(size_in_bytes);
+		D3D12_HEAP_PROPERTIES readback_props				= gGetReadbackHeapProperties();
+		gValidate(gDevice->CreateCommittedResource(&readback_props, D3D12_HEAP_FLAG_NONE, &readback_resource_desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&slot.mResource)));
+		gSetName(slot.mResource, "SequenceCapture.", "Slot", gToString(static_cast<uint>(&slot - mSlots)));
+
+		// Persistent map - https://docs.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12resource-map#advanced-usage-models
+		slot.mResource->Map(0, nullptr, reinterpret_cast<void**>(&slot.mPointer));
+		slot.mSizeInBytes									= size_in_bytes;
+	}
+
+	slot.mFootprint											= footprint;
+	slot.mWidth												= static_cast<uint>(resource_desc.Width);
+	slot.mHeight											= resource_desc.Height;
+	slot.mFormat											= format;
+	slot.mPath												= inPath;
+	slot.mFenceValue										= inFenceValue;
+	slot.mPending											= true;
+
+	{
+		BarrierScope scope(inCommandList, inTexture.mResource.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+		D3D12_TEXTURE_COPY_LOCATION dst						= {};
+		dst.pResource										= slot.mResource.Get();
+		dst.Type											= D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+		dst.PlacedFootprint									= footprint;
+
+		D3D12_TEXTURE_COPY_LOCATION src						= {};
+		src.pResource										= inTexture.mResource.Get();
+		src.Type											= D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		src.SubresourceIndex								= 0;
+
+		inCommandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	mStats.mCapturedCount++;
+}
+
+void SequenceCapture::Poll()
+{
+	UINT64 completed_value									= gIncrementalFence->GetCompletedValue();
+
+	mStats.mSlotsInFlight									= 0;
+	for (Slot& slot : mSlots)
+	{
+		if (!slot.mPending)
+			continue;
+
+		if (slot.mFenceValue <= completed_value)
+			Retire(slot);
+		else
+			mStats.mSlotsInFlight++;
+	}
+}
+
+void SequenceCapture::Flush()
+{
+	for (Slot& slot : mSlots)
+		if (slot.mPending)
+			WaitForSlot(slot);
+
+	mStats.mSlotsInFlight									= 0;
+	mEncoder.Flush();
+}
+
+void SequenceCapture::WaitForSlot(Slot& ioSlot)
+{
+	if (gIncrementalFence->GetCompletedValue() < ioSlot.mFenceValue)
+	{
+		gIncrementalFence->SetEventOnCompletion(ioSlot.mFenceValue, gIncrementalFenceEvent);
+		WaitForSingleObject(gIncrementalFenceEvent, INFINITE);
+	}
+
+	Retire(ioSlot);
+}
+
+void SequenceCapture::Retire(Slot& ioSlot)
+{
+	// Strip row pitch padding, the slot is reused as soon as this returns
+	size_t row_size											= ioSlot.mWidth * FrameEncoder::sBytesPerPixel(ioSlot.mFormat);
+
+	FrameEncoder::Frame frame;
+	frame.mWidth											= ioSlot.mWidth;
+	frame.mHeight											= ioSlot.mHeight;
+	frame.mFormat											= ioSlot.mFormat;
+	frame.mPath												= ioSlot.mPath;
+	frame.mPixels.resize(row_size * ioSlot.mHeight);
+	for (uint y = 0; y < ioSlot.mHeight; y++)
+		memcpy(&frame.mPixels[y * row_size], ioSlot.mPointer + ioSlot.mFootprint.Offset + y * ioSlot.mFootprint.Footprint.RowPitch, row_size);
+
+	ioSlot.mPending											= false;
+	mEncoder.Submit(std::move(frame));
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Common.h"
+#include "FrameEncoder.h"
+
+// Copies a screen texture into a ring of readback buffers without waiting on the queue
+// Slots are handed to FrameEncoder once gIncrementalFence passes the value of the frame that recorded the copy
+class SequenceCapture
+{
+public:
+	static constexpr uint kRingSize								= 4;
+
+	struct Stats
+	{
+		uint64_t mCapturedCount									= 0;
+		uint64_t mRingStallCount								= 0;		// Capture waited on GPU as all slots were in flight
+		float mRingStallMS										= 0.0f;
+		uint mSlotsInFlight										= 0;
+	};
+
+	void Finalize();
+
+	// Record copy of inTexture (COMMON state) into next slot, inFenceValue is the value gIncrementalFence is signaled with after this command list
+	void Capture(ID3D12GraphicsCommandList4* inCommandList, const Texture& inTexture, const std::filesystem::path& inPath, uint64_t inFenceValue);
+
+	// Hand slots whose copy completed to the encoder, never waits on GPU
+	void Poll();
+
+	// Wait for all slots and encoded files
+	void Flush();
+
+	const Stats& GetStats() const								{ return mStats; }
+	FrameEncoder& GetEncoder()									{ return mEncoder; }
+
+	uint mThreadCount											= FrameEncoder::sDefaultThreadCount();
+	uint mQueueCapacity											= 16;
+
+private:
+	struct Slot
+	{
+		ComPtr<ID3D12Resource> mResource;
+		uint8_t* mPointer										= nullptr;	// Persistent map
+		uint64_t mSizeInBytes									= 0;
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT mFootprint			= {};
+		uint mWidth												= 0;
+		uint mHeight											= 0;
+		FrameEncoder::Format mFormat							= FrameEncoder::Format::RGBA8;
+		std::filesystem::path mPath;
+		uint64_t mFenceValue									= 0;
+		bool mPending											= false;
+	};
+
+	void WaitForSlot(Slot& ioSlot);
+	void Retire(Slot& ioSlot);
+
+	Slot mSlots[kRingSize];
+	uint mNextSlotIndex											= 0;
+	Stats mStats;
+	FrameEncoder mEncoder;
+};
+extern SequenceCapture gSequenceCapture;
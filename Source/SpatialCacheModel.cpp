@@ -0,0 +1,407 @@
+#include "SpatialCacheModel.h"
+#include "Scene.h"
+#include "Sweep.h"
+#include "Validate.h"
+
+SpatialCacheModel gSpatialCacheModel;
+
+static constexpr uint kStreamMagic							= 0x32435053; // "SPC2", with camera position per frame
+
+// SpatialCache::pcg
+static uint sPCG(uint inValue)
+{
+	uint state												= inValue * 747796405u + 2891336453u;
+	uint word												= ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+// SpatialCache::xxhash32
+static uint sXXHash32(uint inValue)
+{
+	const uint PRIME32_2 = 2246822519U, PRIME32_3 = 3266489917U;
+	const uint PRIME32_4 = 668265263U, PRIME32_5 = 374761393U;
+	uint h32												= inValue + PRIME32_5;
+	h32														= PRIME32_4 * ((h32 << 17) | (h32 >> (32 - 17)));
+	h32														= PRIME32_2 * (h32 ^ (h32 >> 15));
+	h32														= PRIME32_3 * (h32 ^ (h32 >> 13));
+	return h32 ^ (h32 >> 16);
+}
+
+// float -> uint of HLSL as in pcg(cellSize + pcg(...)), saturated as GPUs do
+static uint sToUint(float inValue)
+{
+	if (!(inValue > 0.0f))
+		return 0;
+	if (inValue >= 4294967040.0f) // Largest float below 2^32
+		return 0xFFFFFFFF;
+	return static_cast<uint>(inValue);
+}
+
+uint SpatialCacheModel::CellKey::CellIndex(uint inTableSize) const
+{
+	float cell_size											= mCellSize * 10000.0f;
+	const int3& p											= mPosition;
+	const int3& n											= mNormal;
+	uint hash_key											= sPCG(sToUint(cell_size + static_cast<float>(sPCG(p.x + sPCG(p.y + sPCG(p.z + sPCG(n.x + sPCG(n.y + sPCG(n.z)))))))));
+	return hash_key % inTableSize;
+}
+
+uint SpatialCacheModel::CellKey::Checksum() const
+{
+	float cell_size											= mCellSize * 10000.0f;
+	const int3& p											= mPosition;
+	const int3& n											= mNormal;
+	uint checksum											= sXXHash32(sToUint(cell_size + static_cast<float>(sXXHash32(p.x + sXXHash32(p.y + sXXHash32(p.z + sXXHash32(n.x + sXXHash32(n.y + sXXHash32(n.z)))))))));
+	return std::clamp(checksum, 1u, Table::kTombstone - 1); // 0 is reserved for available cells, kTombstone for evicted ones
+}
+
+uint64_t SpatialCacheModel::CellKey::Hash64() const
+{
+	uint64_t hash											= 14695981039346656037ull; // FNV-1a
+	for (uint value : { static_cast<uint>(mPosition.x), static_cast<uint>(mPosition.y), static_cast<uint>(mPosition.z), static_cast<uint>(mNormal.x), static_cast<uint>(mNormal.y), static_cast<uint>(mNormal.z), asuint(mCellSize) })
+		hash												= (hash ^ value) * 1099511628211ull;
+	return hash;
+}
+
+SpatialCacheModel::CellKey SpatialCacheModel::CellKey::sGenerate(float3 inPositionWS, float3 inNormalWS, float3 inCameraPositionWS, const Settings& inSettings)
+{
+	SpatialCacheConstants constants							= inSettings.mConstants;
+	CellKey key;
+	key.mCellSize											= constants.CellSize(inPositionWS, inCameraPositionWS);
+	key.mPosition											= int3(glm::floor(inPositionWS / key.mCellSize + 1E-3f));
+	key.mNormal												= inSettings.mUseNormal ? int3(glm::floor(inNormalWS * 3.0f)) : int3(0);
+	return key;
+}
+
+SpatialCacheModel::Table::Lookup SpatialCacheModel::Table::FindOrInsert(const CellKey& inKey, uint inFrameIndex)
+{
+	Lookup lookup;
+	uint cell_index											= inKey.CellIndex(Size());
+	uint checksum											= inKey.Checksum();
+	uint insert_index										= kInvalidCellIndex;
+	for (uint i = 0; i < mSearchCount; i++)
+	{
+		lookup.mProbeCount++;
+
+		uint cell_hash										= mHashes[cell_index];
+		if (cell_hash == checksum)
+		{
+			lookup.mAlias									= !(mKeys[cell_index] == inKey);
+			lookup.mCellIndex								= cell_index;
+			break;
+		}
+
+		// Key may still be behind a tombstone, the first one is reused once the chain ends without it
+		if (cell_hash == kTombstone && insert_index == kInvalidCellIndex)
+			insert_index									= cell_index;
+
+		if (cell_hash == 0)
+		{
+			if (insert_index == kInvalidCellIndex)
+				insert_index								= cell_index;
+			break;
+		}
+
+		cell_index++;
+
+		if (cell_index >= Size())
+			break;
+	}
+
+	if (lookup.mCellIndex == kInvalidCellIndex && insert_index != kInvalidCellIndex)
+	{
+		mHashes[insert_index]								= checksum;
+		mKeys[insert_index]									= inKey;
+		mOccupiedCount++;
+		lookup.mCellIndex									= insert_index;
+		lookup.mInserted									= true;
+	}
+
+	if (lookup.mCellIndex != kInvalidCellIndex)
+		mAges[lookup.mCellIndex]							= inFrameIndex;
+	return lookup;
+}
+
+uint SpatialCacheModel::Table::Find(const CellKey& inKey) const
+{
+	uint cell_index											= inKey.CellIndex(Size());
+	uint checksum											= inKey.Checksum();
+	for (uint i = 0; i < mSearchCount && cell_index < Size(); i++, cell_index++)
+	{
+		if (mHashes[cell_index] == checksum)
+			return cell_index;
+		if (mHashes[cell_index] == 0)
+			break;
+	}
+	return kInvalidCellIndex;
+}
+
+bool SpatialCacheModel::Table::Evict(uint inCellIndex, uint inFrameIndex, uint inMaxAge)
+{
+	if (mHashes[inCellIndex] == 0 || mHashes[inCellIndex] == kTombstone || inMaxAge == 0 || inFrameIndex - mAges[inCellIndex] <= inMaxAge)
+		return false;
+
+	mHashes[inCellIndex]									= kTombstone;
+	mOccupiedCount--;
+	return true;
+}
+
+bool SpatialCacheModel::sValidate(std::string& outMessage)
+{
+	constexpr uint kTableSize								= 64;
+	constexpr uint kSearchCount								= 16;
+
+	// Three keys starting their probe at the same cell, away from the end of the table
+	std::vector<CellKey> keys;
+	for (int x = 0; keys.size() < 3 && x < 100000; x++)
+	{
+		CellKey key;
+		key.mPosition										= int3(x, 0, 0);
+		key.mCellSize										= 0.1f;
+		uint cell_index										= key.CellIndex(kTableSize);
+		if (keys.empty() ? cell_index < kTableSize - kSearchCount : cell_index == keys.front().CellIndex(kTableSize))
+			keys.push_back(key);
+	}
+	if (keys.size() < 3)
+	{
+		outMessage											= "[SpatialCache] Validate: no colliding keys found\n";
+		return false;
+	}
+
+	Table table(kTableSize, kSearchCount);
+	Table::Lookup first										= table.FindOrInsert(keys[0], 0);
+	Table::Lookup second									= table.FindOrInsert(keys[1], 4);
+	bool first_evicted										= table.Evict(first.mCellIndex, 4, 2);
+	bool second_kept										= !table.Evict(second.mCellIndex, 4, 2);
+	uint second_found										= table.Find(keys[1]);
+	Table::Lookup second_again								= table.FindOrInsert(keys[1], 5);
+	Table::Lookup third										= table.FindOrInsert(keys[2], 5);
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "keys share a probe chain",						first.mInserted && second.mInserted && second.mCellIndex == first.mCellIndex + 1 },
+		{ "first key evicted, second kept",					first_evicted && second_kept },
+		{ "second key found behind tombstone",				second_found == second.mCellIndex },
+		{ "second key hit behind tombstone",				!second_again.mInserted && second_again.mCellIndex == second.mCellIndex },
+		{ "evicted key not found",							table.Find(keys[0]) == Table::kInvalidCellIndex },
+		{ "tombstone reused by insert",						third.mInserted && third.mCellIndex == first.mCellIndex },
+		{ "occupancy excludes tombstones",					table.GetOccupiedCount() == 2 },
+	};
+
+	outMessage												= std::format("[SpatialCache] Validate: table of {} cells, keys colliding at cell {}\n", kTableSize, first.mCellIndex);
+	return gReportValidateChecks(checks, outMessage);
+}
+
+void SpatialCacheModel::Record(const SceneContent& inSceneContent, const Constants& inConstants, uint inWidth, uint inHeight)
+{
+	if (mFrames.empty())
+		mRayCaster.Build(inSceneContent);
+
+	if (mRayCaster.Empty())
+		return;
+
+	Frame& frame											= mFrames.emplace_back();
+	frame.mCameraPositionWS									= float3(inConstants.mCameraTransform[3]);
+	for (const RayCaster::Hit& hit : mRayCaster.CastCamera(inConstants, inWidth, inHeight))
+		if (hit.mValid)
+			frame.mSamples.push_back({ .mPositionWS = hit.mPositionWS, .mNormalWS = hit.mNormalWS });
+}
+
+SpatialCacheModel::Settings SpatialCacheModel::Settings::sFromConstants()
+{
+	Settings settings;
+	settings.mConstants										= gConstants.mSpatialCache;
+	return settings;
+}
+
+uint64_t SpatialCacheModel::GetSampleCount() const
+{
+	uint64_t sample_count									= 0;
+	for (const Frame& frame : mFrames)
+		sample_count										+= frame.mSamples.size();
+	return sample_count;
+}
+
+bool SpatialCacheModel::Save(const std::filesystem::path& inPath) const
+{
+	std::ofstream file(inPath, std::ios::binary);
+	if (!file)
+		return false;
+
+	uint frame_count										= GetFrameCount();
+	file.write(reinterpret_cast<const char*>(&kStreamMagic), sizeof(kStreamMagic));
+	file.write(reinterpret_cast<const char*>(&frame_count), sizeof(frame_count));
+	for (const Frame& frame : mFrames)
+	{
+		uint sample_count									= static_cast<uint>(frame.mSamples.size());
+		file.write(reinterpret_cast<const char*>(&frame.mCameraPositionWS), sizeof(frame.mCameraPositionWS));
+		file.write(reinterpret_cast<const char*>(&sample_count), sizeof(sample_count));
+		file.write(reinterpret_cast<const char*>(frame.mSamples.data()), static_cast<std::streamsize>(frame.mSamples.size() * sizeof(Sample)));
+	}
+	return file.good();
+}
+
+bool SpatialCacheModel::Load(const std::filesystem::path& inPath)
+{
+	std::ifstream file(inPath, std::ios::binary);
+	if (!file)
+		return false;
+
+	uint magic												= 0;
+	uint frame_count										= 0;
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&frame_count), sizeof(frame_count));
+	if (!file || magic != kStreamMagic)
+		return false;
+
+	std::vector<Frame> frames(frame_count);
+	for (Frame& frame : frames)
+	{
+		uint sample_count									= 0;
+		file.read(reinterpret_cast<char*>(&frame.mCameraPositionWS), sizeof(frame.mCameraPositionWS));
+		file.read(reinterpret_cast<char*>(&sample_count), sizeof(sample_count));
+		frame.mSamples.resize(sample_count);
+		file.read(reinterpret_cast<char*>(frame.mSamples.data()), static_cast<std::streamsize>(frame.mSamples.size() * sizeof(Sample)));
+		if (!file)
+			return false;
+	}
+
+	mFrames													= std::move(frames);
+	return true;
+}
+
+SpatialCacheModel::Result SpatialCacheModel::Run(const Settings& inSettings) const
+{
+	Result result;
+	result.mSettings										= inSettings;
+	if (inSettings.mTableSize == 0 || inSettings.mConstants.mCellSize <= 0.0f || inSettings.mConstants.mCellSizeMin <= 0.0f)
+		return result;
+
+	CPU_TIMING_SCOPE_SIMPLE(&result.mReplayMS);
+
+	Table table(inSettings.mTableSize, inSettings.mSearchCount);
+	std::unordered_set<uint64_t> distinct_keys;
+
+	uint64_t hit_count										= 0;
+	uint64_t failure_count									= 0;
+	uint64_t probe_sum										= 0;
+	double cell_size_sum									= 0.0;
+	uint peak_occupied_count								= 0;
+
+	for (uint frame_index = 0; frame_index < GetFrameCount(); frame_index++)
+	{
+		// FindOrInsert
+		const Frame& frame									= mFrames[frame_index];
+		for (const Sample& sample : frame.mSamples)
+		{
+			CellKey key										= CellKey::sGenerate(sample.mPositionWS, sample.mNormalWS, frame.mCameraPositionWS, inSettings);
+			distinct_keys.insert(key.Hash64());
+			cell_size_sum									+= key.mCellSize;
+			result.mLookupCount++;
+
+			Table::Lookup lookup							= table.FindOrInsert(key, frame_index);
+			if (lookup.mCellIndex == Table::kInvalidCellIndex)
+				failure_count++;
+			else if (!lookup.mInserted)
+				hit_count++;
+			if (lookup.mAlias)
+				result.mAliasCount++;
+			probe_sum										+= lookup.mProbeCount;
+			result.mMaxProbeLength							= gMax(result.mMaxProbeLength, lookup.mProbeCount);
+		}
+
+		peak_occupied_count									= gMax(peak_occupied_count, table.GetOccupiedCount());
+
+		// SpatialCacheUpdateCS
+		if (inSettings.mConstants.mMaxAge == 0)
+			continue;
+
+		for (uint cell_index = 0; cell_index < inSettings.mTableSize; cell_index++)
+			if (table.Evict(cell_index, frame_index, inSettings.mConstants.mMaxAge))
+				result.mEvictedCount++;
+	}
+
+	if (result.mLookupCount > 0)
+	{
+		double lookup_count									= static_cast<double>(result.mLookupCount);
+		result.mHitRate										= static_cast<float>(hit_count / lookup_count);
+		result.mFailureRate									= static_cast<float>(failure_count / lookup_count);
+		result.mMeanProbeLength								= static_cast<float>(probe_sum / lookup_count);
+		result.mMeanCellSize								= static_cast<float>(cell_size_sum / lookup_count);
+	}
+	result.mPeakOccupancy									= static_cast<float>(peak_occupied_count) / inSettings.mTableSize;
+	result.mFinalOccupancy									= static_cast<float>(table.GetOccupiedCount()) / inSettings.mTableSize;
+	result.mDistinctCellCount								= static_cast<uint>(distinct_keys.size());
+	return result;
+}
+
+void SpatialCacheModel::Replay(std::span<const Settings> inSettings)
+{
+	mResults.clear();
+	if (mFrames.empty())
+	{
+		gTrace("[SpatialCache] Nothing to replay, record a stream first\n");
+		return;
+	}
+
+	// Settings are independent, each replays the whole stream in order as the GPU sees it frame by frame
+	mResults.resize(inSettings.size());
+	std::transform(std::execution::par, inSettings.begin(), inSettings.end(), mResults.begin(), [&](const Settings& inSetting) { return Run(inSetting); });
+
+	std::string message = std::format("[SpatialCache] Replayed {} frames, {} samples\n", GetFrameCount(), GetSampleCount());
+	message += "  table_size mode     cell_size search max_age normal | hit_rate failure mean_probe max_probe peak_occ final_occ evicted  alias    distinct mean_cell | ms\n";
+	for (const Result& result : mResults)
+	{
+		const Settings& settings							= result.mSettings;
+		message += std::format("  {:10} {:8} {:9.4f} {:6} {:7} {:6} | {:8.4f} {:7.4f} {:10.3f} {:9} {:8.4f} {:9.4f} {:8} {:6} {:10} {:9.4f} | {:.2f}\n",
+			settings.mTableSize, nameof::nameof_enum(settings.mConstants.mCellSizeMode), settings.mConstants.mCellSize, settings.mSearchCount, settings.mConstants.mMaxAge, settings.mUseNormal,
+			result.mHitRate, result.mFailureRate, result.mMeanProbeLength, result.mMaxProbeLength, result.mPeakOccupancy, result.mFinalOccupancy, result.mEvictedCount, result.mAliasCount, result.mDistinctCellCount, result.mMeanCellSize,
+			result.mReplayMS);
+	}
+	gTrace(message);
+}
+
+void SpatialCacheModel::CompareCellSizeModes()
+{
+	Settings settings[static_cast<uint>(SpatialCacheCellSizeMode::Count)];
+	for (uint mode = 0; mode < static_cast<uint>(SpatialCacheCellSizeMode::Count); mode++)
+	{
+		settings[mode]										= Settings::sFromConstants();
+		settings[mode].mConstants.mCellSizeMode				= static_cast<SpatialCacheCellSizeMode>(mode);
+	}
+	Replay(settings);
+}
+
+void SpatialCacheModel::RunSweep(const std::filesystem::path& inPath)
+{
+	const SweepParameter<Settings> kParameters[] =
+	{
+		{ "table_size",				[](Settings& ioSettings, float inValue) { ioSettings.mTableSize = static_cast<uint>(inValue); } },
+		{ "search_count",			[](Settings& ioSettings, float inValue) { ioSettings.mSearchCount = static_cast<uint>(inValue); } },
+		{ "use_normal",				[](Settings& ioSettings, float inValue) { ioSettings.mUseNormal = inValue != 0.0f; } },
+		{ "max_age",				[](Settings& ioSettings, float inValue) { ioSettings.mConstants.mMaxAge = static_cast<uint>(inValue); } },
+		{ "cell_size_mode",			[](Settings& ioSettings, float inValue) { ioSettings.mConstants.mCellSizeMode = static_cast<SpatialCacheCellSizeMode>(gMin(static_cast<uint>(inValue), static_cast<uint>(SpatialCacheCellSizeMode::Count) - 1)); } },
+		{ "cell_size",				[](Settings& ioSettings, float inValue) { ioSettings.mConstants.mCellSize = inValue; } },
+		{ "scene_scale",			[](Settings& ioSettings, float inValue) { ioSettings.mConstants.mSceneScale = inValue; } },
+		{ "logarithm_base",			[](Settings& ioSettings, float inValue) { ioSettings.mConstants.mLogarithmBase = inValue; } },
+		{ "level_bias",				[](Settings& ioSettings, float inValue) { ioSettings.mConstants.mLevelBias = inValue; } },
+	};
+
+	std::vector<Settings> settings;
+	if (!gLoadSweep<Settings>("SpatialCache", inPath, kParameters, Settings::sFromConstants(), settings))
+		return;
+
+	Replay(settings);
+	if (mResults.empty())
+		return;
+
+	gWriteSweepCSV<Result>("SpatialCache", inPath, "table_size,cell_size_mode,cell_size,scene_scale,logarithm_base,level_bias,search_count,max_age,use_normal,lookups,hit_rate,failure_rate,mean_probe,max_probe,peak_occupancy,final_occupancy,evicted,alias,distinct_cells,mean_cell_size,replay_ms",
+		mResults, [](const Result& inResult)
+	{
+		const Settings& setting								= inResult.mSettings;
+		return std::format("{},{},{},{},{},{},{},{},{},", setting.mTableSize, nameof::nameof_enum(setting.mConstants.mCellSizeMode), setting.mConstants.mCellSize, setting.mConstants.mSceneScale, setting.mConstants.mLogarithmBase, setting.mConstants.mLevelBias,
+			setting.mSearchCount, setting.mConstants.mMaxAge, setting.mUseNormal)
+			+ std::format("{},{},{},{},{},{},{},{},{},{},{},{}", inResult.mLookupCount, inResult.mHitRate, inResult.mFailureRate, inResult.mMeanProbeLength, inResult.mMaxProbeLength, inResult.mPeakOccupancy, inResult.mFinalOccupancy,
+			inResult.mEvictedCount, inResult.mAliasCount, inResult.mDistinctCellCount, inResult.mMeanCellSize, inResult.mReplayMS);
+	});
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "Common.h"
+
+#include "RayCaster.h"
+
+struct SceneContent;
+
+// CPU model of the hash map in Shader/SpatialCache.h, same hashing, linear probing, tombstones and eviction as FindOrInsert / SpatialCacheUpdateCS
+// Streams of position/normal are recorded from camera hits, then replayed against varying table size, cell size and max age
+class SpatialCacheModel
+{
+public:
+	struct Sample
+	{
+		float3 mPositionWS										= float3(0.0f);
+		float3 mNormalWS										= float3(0.0f);
+	};
+
+	struct Frame
+	{
+		float3 mCameraPositionWS								= float3(0.0f);
+		std::vector<Sample> mSamples;
+	};
+
+	struct Settings
+	{
+		uint mTableSize											= kSpatialHashSize;
+		uint mSearchCount										= 16;		// SpatialCache::SEARCH_COUNT
+		bool mUseNormal											= false;	// Callers of FindOrInsert pass zero normal for now
+		SpatialCacheConstants mConstants;									// Cell size and max age
+
+		static Settings sFromConstants();
+	};
+
+	// Inputs to hashing of SpatialCache::FindOrInsert
+	struct CellKey
+	{
+		int3 mPosition											= int3(0);
+		int3 mNormal											= int3(0);
+		float mCellSize											= 0.0f;
+
+		bool operator==(const CellKey& inOther) const			{ return mPosition == inOther.mPosition && mNormal == inOther.mNormal && mCellSize == inOther.mCellSize; }
+
+		uint CellIndex(uint inTableSize) const;
+		uint Checksum() const;
+		uint64_t Hash64() const;
+
+		static CellKey sGenerate(float3 inPositionWS, float3 inNormalWS, float3 inCameraPositionWS, const Settings& inSettings);
+	};
+
+	// SpatialHashUAV and SpatialAgeUAV, with keys only known on CPU
+	class Table
+	{
+	public:
+		static constexpr uint kInvalidCellIndex					= 0xFFFFFFFF;	// SpatialCache::kInvalidCellIndex
+		static constexpr uint kTombstone						= 0xFFFFFFFF;	// SpatialCache::kTombstone
+
+		struct Lookup
+		{
+			uint mCellIndex										= kInvalidCellIndex;
+			uint mProbeCount									= 0;
+			bool mInserted										= false;
+			bool mAlias											= false;	// Matched checksum of a different key
+		};
+
+		Table(uint inTableSize, uint inSearchCount) : mSearchCount(inSearchCount), mHashes(inTableSize, 0), mAges(inTableSize, 0), mKeys(inTableSize) {}
+
+		Lookup FindOrInsert(const CellKey& inKey, uint inFrameIndex);
+		uint Find(const CellKey& inKey) const;
+		bool Evict(uint inCellIndex, uint inFrameIndex, uint inMaxAge);
+
+		uint Size() const										{ return static_cast<uint>(mHashes.size()); }
+		uint GetOccupiedCount() const							{ return mOccupiedCount; }
+
+	private:
+		uint mSearchCount										= 0;
+		uint mOccupiedCount										= 0;
+		std::vector<uint> mHashes;
+		std::vector<uint> mAges;
+		std::vector<CellKey> mKeys;
+	};
+
+	struct Result
+	{
+		Settings mSettings;
+		uint64_t mLookupCount									= 0;
+		float mHitRate											= 0.0f;
+		float mFailureRate										= 0.0f;		// No available cell within mSearchCount probes
+		float mMeanProbeLength									= 0.0f;
+		uint mMaxProbeLength									= 0;
+		float mPeakOccupancy									= 0.0f;
+		float mFinalOccupancy									= 0.0f;
+		uint64_t mEvictedCount									= 0;
+		uint64_t mAliasCount									= 0;		// Lookups matching checksum of a different cell, invisible on GPU
+		uint mDistinctCellCount									= 0;
+		float mMeanCellSize										= 0.0f;
+		float mReplayMS											= 0.0f;
+	};
+
+	// Evicts a key in front of a colliding one and checks the second is still found and the tombstone reused
+	static bool sValidate(std::string& outMessage);
+
+	// Cast camera rays of inConstants and append hits as a frame of the stream. Scene is captured on first frame.
+	void Record(const SceneContent& inSceneContent, const Constants& inConstants, uint inWidth, uint inHeight);
+	void ClearRecord()											{ mFrames.clear(); }
+
+	bool Save(const std::filesystem::path& inPath) const;
+	bool Load(const std::filesystem::path& inPath);
+
+	void Replay(std::span<const Settings> inSettings);
+
+	// Fixed against Adaptive cell size, other settings from gConstants.mSpatialCache
+	void CompareCellSizeModes();
+
+	// JSON with base settings and arrays of values to sweep, e.g.
+	// { "cell_size": 0.05, "sweep": { "table_size": [262144, 1048576], "max_age": [0, 16, 64], "cell_size_mode": [0, 1] } }
+	// Results are written next to it as .csv
+	void RunSweep(const std::filesystem::path& inPath);
+
+	uint GetFrameCount() const									{ return static_cast<uint>(mFrames.size()); }
+	uint64_t GetSampleCount() const;
+	const std::vector<Result>& GetResults() const				{ return mResults; }
+
+	bool mRecording												= false;
+	uint2 mRecordSize											= uint2(320, 180);
+
+private:
+	Result Run(const Settings& inSettings) const;
+
+	RayCaster mRayCaster;
+	std::vector<Frame> mFrames;
+	std::vector<Result> mResults;
+};
+extern SpatialCacheModel gSpatialCacheModel;
@@ -0,0 +1,114 @@
+#pragma once
+#include "Common.h"
+
+#include "Thirdparty/tinygltf/json.hpp"
+
+// Parameter sweeps of CPU models, see ReSTIR::RunSweep and SpatialCacheModel::RunSweep
+// JSON with base settings and arrays of values to sweep, e.g. { "frames": 8, "sweep": { "initial_sample_count": [1, 4, 8], "m_cap": [0, 20] } }
+// Results are written next to it as .csv
+template <typename SettingsType>
+struct SweepParameter
+{
+	const char* mName										= nullptr;
+	std::function<void(SettingsType&, float)> mSetter;
+	bool mSweepable											= true;		// False when all settings of a run share the value of the first one
+};
+
+// Base settings and Cartesian product of swept values. Unknown keys, non numbers and swept shared parameters fail the load with a trace.
+template <typename SettingsType>
+bool gLoadSweep(const char* inTag, const std::filesystem::path& inPath, std::span<const SweepParameter<SettingsType>> inParameters, SettingsType inBaseSettings, std::vector<SettingsType>& outSettings)
+{
+	std::ifstream file(inPath);
+	nlohmann::json json										= nlohmann::json::parse(file, nullptr, false);
+	if (json.is_discarded() || !json.is_object())
+	{
+		gTrace(std::format("[{}] Failed to parse sweep {}\n", inTag, inPath.string()));
+		return false;
+	}
+
+	std::string errors;
+	auto error												= [&](const std::string& inKey, const char* inReason) { errors += std::format("{}\"{}\" {}", errors.empty() ? "" : "; ", inKey, inReason); };
+	auto find												= [&](const std::string& inKey) -> const SweepParameter<SettingsType>*
+	{
+		for (const SweepParameter<SettingsType>& parameter : inParameters)
+			if (inKey == parameter.mName)
+				return &parameter;
+		return nullptr;
+	};
+
+	for (nlohmann::json::const_iterator iterator = json.cbegin(); iterator != json.cend(); iterator++)
+	{
+		if (iterator.key() == "sweep")
+			continue;
+
+		const SweepParameter<SettingsType>* parameter		= find(iterator.key());
+		if (parameter == nullptr)
+			error(iterator.key(), "is unknown");
+		else if (!iterator->is_number())
+			error(iterator.key(), "is not a number");
+		else
+			parameter->mSetter(inBaseSettings, iterator->get<float>());
+	}
+
+	// In order of inParameters, so the last one varies fastest
+	outSettings												= { inBaseSettings };
+	if (json.contains("sweep") && !json["sweep"].is_object())
+		error("sweep", "is not an object");
+	else if (json.contains("sweep"))
+	{
+		const nlohmann::json& sweep							= json["sweep"];
+		for (nlohmann::json::const_iterator iterator = sweep.cbegin(); iterator != sweep.cend(); iterator++)
+			if (find(iterator.key()) == nullptr)
+				error(iterator.key(), "is unknown");
+
+		for (const SweepParameter<SettingsType>& parameter : inParameters)
+		{
+			if (!sweep.contains(parameter.mName))
+				continue;
+
+			const nlohmann::json& values					= sweep[parameter.mName];
+			if (!parameter.mSweepable)
+			{
+				error(parameter.mName, "is shared by all settings and can not be swept");
+				continue;
+			}
+			if (!values.is_array() || values.empty() || std::any_of(values.begin(), values.end(), [](const nlohmann::json& inValue) { return !inValue.is_number(); }))
+			{
+				error(parameter.mName, "is not an array of numbers");
+				continue;
+			}
+
+			std::vector<SettingsType> expanded;
+			for (const SettingsType& setting : outSettings)
+			{
+				for (const nlohmann::json& value : values)
+				{
+					expanded.push_back(setting);
+					parameter.mSetter(expanded.back(), value.get<float>());
+				}
+			}
+			outSettings										= std::move(expanded);
+		}
+	}
+
+	if (!errors.empty())
+	{
+		gTrace(std::format("[{}] Invalid sweep {}: {}\n", inTag, inPath.string(), errors));
+		outSettings.clear();
+		return false;
+	}
+	return true;
+}
+
+// Header line and one line per result, next to inPath as .csv
+template <typename ResultType>
+void gWriteSweepCSV(const char* inTag, const std::filesystem::path& inPath, const char* inHeader, std::span<const ResultType> inResults, const std::function<std::string(const ResultType&)>& inLine)
+{
+	std::filesystem::path csv_path							= inPath;
+	csv_path.replace_extension(".csv");
+	std::ofstream csv(csv_path);
+	csv << inHeader << "\n";
+	for (const ResultType& result : inResults)
+		csv << inLine(result) << "\n";
+	gTrace(std::format("[{}] Sweep of {} settings written to {}\n", inTag, inResults.size(), csv_path.string()));
+}
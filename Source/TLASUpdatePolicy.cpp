@@ -0,0 +1,237 @@
+#include "TLASUpdatePolicy.h"
+
+#include "Validate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <random>
+
+void TLASUpdatePolicy::Initialize(std::span<const glm::mat4x4> inTransforms, std::span<const float> inRadii, uint32_t inSlotCount)
+{
+	mTransforms.assign(inTransforms.begin(), inTransforms.end());
+	mRebuildTransforms										= mTransforms;
+	mRadii.assign(inRadii.begin(), inRadii.end());
+	mRadii.resize(mTransforms.size(), 0.0f);
+
+	mPendingInstances.clear();
+	mPending.assign(mTransforms.size(), 0);
+	mHistory.assign(std::max(inSlotCount, 1u), {});
+	mSlotSerials.assign(std::max(inSlotCount, 1u), 0);
+	mSerial													= 0;
+
+	mRebuildRequested										= true;
+	mStats													= {};
+}
+
+void TLASUpdatePolicy::SetTransform(uint32_t inInstanceIndex, const glm::mat4x4& inTransform)
+{
+	mTransforms[inInstanceIndex]							= inTransform;
+	MarkModified(inInstanceIndex);
+}
+
+void TLASUpdatePolicy::MarkModified(uint32_t inInstanceIndex)
+{
+	if (mPending[inInstanceIndex] == 0)
+	{
+		mPending[inInstanceIndex]							= 1;
+		mPendingInstances.push_back(inInstanceIndex);
+	}
+}
+
+float TLASUpdatePolicy::MotionRatio(uint32_t inInstanceIndex) const
+{
+	// Upper bound of distance moved by any point of the bounding sphere
+	const glm::mat4x4& current								= mTransforms[inInstanceIndex];
+	const glm::mat4x4& reference							= mRebuildTransforms[inInstanceIndex];
+	float radius											= mRadii[inInstanceIndex];
+	float basis_motion										= 0.0f;
+	for (int column = 0; column < 3; column++)
+		basis_motion										= std::max(basis_motion, glm::length(glm::vec3(current[column] - reference[column])));
+	float motion											= glm::length(glm::vec3(current[3] - reference[3])) + std::sqrt(3.0f) * basis_motion * radius;
+	return motion / std::max(radius, 1.0e-6f);
+}
+
+TLASUpdatePolicy::Action TLASUpdatePolicy::Update(uint32_t inSlotIndex, std::vector<Range>& outRanges)
+{
+	outRanges.clear();
+
+	// History entry of this serial
+	mSerial++;
+	uint64_t history_size									= mHistory.size();
+	std::vector<uint32_t>& modified							= mHistory[mSerial % history_size];
+	modified.swap(mPendingInstances);
+	mPendingInstances.clear();
+	for (uint32_t instance_index : modified)
+		mPending[instance_index]							= 0;
+
+	// Instances modified after slot was last written, all of them when history does not reach back that far
+	uint64_t slot_serial									= mSlotSerials[inSlotIndex % mSlotSerials.size()];
+	std::vector<uint32_t> instances;
+	if (mSerial - slot_serial > history_size)
+	{
+		if (!mTransforms.empty())
+			outRanges.push_back({ 0, GetInstanceCount() });
+	}
+	else
+	{
+		for (uint64_t serial = slot_serial + 1; serial <= mSerial; serial++)
+			instances.insert(instances.end(), mHistory[serial % history_size].begin(), mHistory[serial % history_size].end());
+		std::sort(instances.begin(), instances.end());
+		instances.erase(std::unique(instances.begin(), instances.end()), instances.end());
+
+		for (uint32_t instance_index : instances)
+		{
+			if (!outRanges.empty() && instance_index <= outRanges.back().mEnd + mSettings.mMergeGap)
+				outRanges.back().mEnd						= instance_index + 1;
+			else
+				outRanges.push_back({ instance_index, instance_index + 1 });
+		}
+	}
+	mSlotSerials[inSlotIndex % mSlotSerials.size()]			= mSerial;
+
+	mStats.mModifiedCount									= static_cast<uint32_t>(modified.size());
+	mStats.mRangeCount										= static_cast<uint32_t>(outRanges.size());
+	mStats.mWrittenCount									= 0;
+	for (const Range& range : outRanges)
+		mStats.mWrittenCount								+= range.mEnd - range.mBegin;
+
+	Action action											= Action::None;
+	if (mRebuildRequested)
+		action												= Action::Rebuild;
+	else if (!modified.empty())
+	{
+		for (uint32_t instance_index : modified)
+			mStats.mPeakMotionRatio							= std::max(mStats.mPeakMotionRatio, MotionRatio(instance_index));
+
+		bool rebuild										= mStats.mPeakMotionRatio > mSettings.mRebuildMotionRatio || mStats.mRefitsSinceRebuild >= mSettings.mRebuildRefitCount;
+		action												= rebuild ? Action::Rebuild : Action::Refit;
+	}
+
+	if (action == Action::Rebuild)
+	{
+		mRebuildTransforms									= mTransforms;
+		mRebuildRequested									= false;
+		mStats.mPeakMotionRatio								= 0.0f;
+		mStats.mRefitsSinceRebuild							= 0;
+		mStats.mRebuildCount++;
+	}
+	else if (action == Action::Refit)
+	{
+		mStats.mRefitsSinceRebuild++;
+		mStats.mRefitCount++;
+	}
+	mStats.mLastAction										= action;
+	return action;
+}
+
+bool TLASUpdatePolicy::sValidate(std::string& outMessage)
+{
+	constexpr uint32_t kInstanceCount						= 4096;
+	constexpr uint32_t kSlotCount							= 3;
+	constexpr uint32_t kFrameCount							= 512;
+
+	std::vector<glm::mat4x4> transforms(kInstanceCount, glm::mat4x4(1.0f));
+	std::vector<float> radii(kInstanceCount, 1.0f);
+
+	TLASUpdatePolicy policy;
+	policy.Initialize(transforms, radii, kSlotCount);
+
+	// Slot contents as written through ranges, starting from initial transforms
+	std::vector<std::vector<glm::mat4x4>> slots(kSlotCount, transforms);
+	std::vector<Range> ranges;
+	uint32_t frame_index									= 0;
+	auto update												= [&]()
+	{
+		uint32_t slot_index									= frame_index++ % kSlotCount;
+		Action action										= policy.Update(slot_index, ranges);
+		for (const Range& range : ranges)
+			for (uint32_t instance_index = range.mBegin; instance_index < range.mEnd; instance_index++)
+				slots[slot_index][instance_index]			= policy.GetTransform(instance_index);
+		return std::make_pair(action, slot_index);
+	};
+	auto translate											= [&](uint32_t inInstanceIndex, float inDistance)
+	{
+		policy.SetTransform(inInstanceIndex, glm::translate(policy.GetTransform(inInstanceIndex), glm::vec3(inDistance, 0.0f, 0.0f)));
+	};
+
+	bool initial											= true;
+	initial													&= update().first == Action::Rebuild && ranges.empty();
+	initial													&= update().first == Action::None && ranges.empty();
+
+	bool small_motion_refit									= true;
+	translate(5, 0.01f);
+	small_motion_refit										&= update().first == Action::Refit && ranges.size() == 1 && ranges[0].mBegin == 5 && ranges[0].mEnd == 6;
+	// Slot not written since, gets instance 5 without new modification
+	small_motion_refit										&= update().first == Action::None && ranges.size() == 1 && ranges[0].mBegin == 5;
+
+	bool large_motion_rebuild								= true;
+	translate(7, 2.0f);
+	large_motion_rebuild									&= update().first == Action::Rebuild;
+	translate(7, 0.01f);
+	large_motion_rebuild									&= update().first == Action::Refit; // Measured from last rebuild
+
+	bool refit_count_rebuild								= true;
+	policy.mSettings.mRebuildRefitCount						= 4;
+	policy.RequestRebuild();
+	refit_count_rebuild										&= update().first == Action::Rebuild;
+	for (uint32_t refit_index = 0; refit_index < 4; refit_index++)
+	{
+		translate(9, 0.001f);
+		refit_count_rebuild									&= update().first == Action::Refit;
+	}
+	translate(9, 0.001f);
+	refit_count_rebuild										&= update().first == Action::Rebuild;
+	policy.mSettings										= {};
+
+	bool merged												= true;
+	for (uint32_t slot_index = 0; slot_index < kSlotCount; slot_index++)
+		update(); // Flush earlier modifications from all slots
+	translate(10, 0.001f);
+	translate(12, 0.001f);
+	translate(100, 0.001f);
+	update();
+	merged													&= ranges.size() == 2 && ranges[0].mBegin == 10 && ranges[0].mEnd == 13 && ranges[1].mBegin == 100 && ranges[1].mEnd == 101;
+
+	// Random modifications, each slot must match current transforms right after it is written
+	std::mt19937 random_engine(0);
+	std::uniform_int_distribution<uint32_t> instance_distribution(0, kInstanceCount - 1);
+	std::uniform_int_distribution<uint32_t> count_distribution(0, 16);
+	bool slots_match										= true;
+	bool written_bounded									= true;
+	for (uint32_t frame = 0; frame < kFrameCount; frame++)
+	{
+		uint32_t modified_count								= count_distribution(random_engine);
+		for (uint32_t modified_index = 0; modified_index < modified_count; modified_index++)
+			translate(instance_distribution(random_engine), 0.001f);
+
+		uint32_t slot_index									= update().second;
+		for (uint32_t instance_index = 0; instance_index < kInstanceCount; instance_index++)
+			slots_match										&= slots[slot_index][instance_index] == policy.GetTransform(instance_index);
+		written_bounded										&= policy.GetStats().mWrittenCount < kInstanceCount;
+	}
+
+	// Slot skipped for longer than history, written as a whole
+	bool lagging_slot										= true;
+	translate(3, 0.001f);
+	policy.Update(0, ranges);
+	policy.Update(0, ranges);
+	policy.Update(0, ranges);
+	policy.Update(0, ranges);
+	lagging_slot											&= policy.Update(1, ranges) == Action::None && ranges.size() == 1 && ranges[0].mBegin == 0 && ranges[0].mEnd == kInstanceCount;
+
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "initial rebuild, slots already written",			initial },
+		{ "small motion refits, lagging slot catches up",	small_motion_refit },
+		{ "large motion rebuilds",							large_motion_rebuild },
+		{ "refit count rebuilds",							refit_count_rebuild },
+		{ "close ranges merged",							merged },
+		{ "slots match after random frames",				slots_match },
+		{ "only modified instances written",				written_bounded },
+		{ "slot beyond history written whole",				lagging_slot },
+	};
+
+	outMessage												= std::format("[TLASUpdatePolicy] Validate: {} instances, {} slots, {} refits, {} rebuilds\n", kInstanceCount, kSlotCount, policy.GetStats().mRefitCount, policy.GetStats().mRebuildCount);
+	return gReportValidateChecks(checks, outMessage);
+}
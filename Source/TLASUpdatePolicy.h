@@ -0,0 +1,85 @@
+#pragma once
+
+// Standard library and glm only, so change tracking and refit policy can be validated without a device
+#include "Thirdparty/glm.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Change tracking of TLAS instances, and choice between refit (PERFORM_UPDATE) and rebuild
+// Instance descs live in a persistent upload ring with one slot per frame in flight, each slot only gets instances modified since it was last written
+// Refit keeps the BVH topology of last rebuild, quality drops as instances move away from it. Rebuild once motion relative to instance size, or refit count, gets large.
+class TLASUpdatePolicy
+{
+public:
+	enum class Action : uint8_t
+	{
+		None,
+		Refit,
+		Rebuild,
+
+		Count
+	};
+
+	struct Range
+	{
+		uint32_t mBegin										= 0;
+		uint32_t mEnd										= 0;	// Exclusive
+	};
+
+	struct Settings
+	{
+		float mRebuildMotionRatio							= 0.5f;	// Motion since last rebuild relative to instance radius
+		uint32_t mRebuildRefitCount							= 256;	// Refits since last rebuild
+		uint32_t mMergeGap									= 8;	// Unmodified instances between two ranges written anyway, to save a copy
+	};
+
+	struct Stats
+	{
+		Action mLastAction									= Action::None;
+		uint32_t mModifiedCount								= 0;	// Of last Update
+		uint32_t mWrittenCount								= 0;	// Written into slot by last Update
+		uint32_t mRangeCount								= 0;
+		uint32_t mRefitsSinceRebuild						= 0;
+		float mPeakMotionRatio								= 0.0f;	// Since last rebuild
+		uint64_t mRefitCount								= 0;
+		uint64_t mRebuildCount								= 0;
+	};
+
+	Settings mSettings;
+
+	// inRadii are bounding sphere radii of instances around their local origin. All slots are assumed to hold inTransforms already.
+	void Initialize(std::span<const glm::mat4x4> inTransforms, std::span<const float> inRadii, uint32_t inSlotCount);
+	void SetTransform(uint32_t inInstanceIndex, const glm::mat4x4& inTransform);
+	void MarkModified(uint32_t inInstanceIndex);				// Desc changed other than transform, e.g. BLAS address
+	void RequestRebuild()									{ mRebuildRequested = true; }
+
+	// Once per frame with slot of that frame. outRanges are instances to write into the slot before building with returned action.
+	Action Update(uint32_t inSlotIndex, std::vector<Range>& outRanges);
+
+	uint32_t GetInstanceCount() const						{ return static_cast<uint32_t>(mTransforms.size()); }
+	const glm::mat4x4& GetTransform(uint32_t inInstanceIndex) const { return mTransforms[inInstanceIndex]; }
+	const Stats& GetStats() const							{ return mStats; }
+
+	// Runs a frame loop with lagging slots and checks slot contents, refit and rebuild decisions and range merging
+	static bool sValidate(std::string& outMessage);
+
+private:
+	float MotionRatio(uint32_t inInstanceIndex) const;
+
+	std::vector<glm::mat4x4> mTransforms;
+	std::vector<glm::mat4x4> mRebuildTransforms;			// At last rebuild, motion of refits is measured against them
+	std::vector<float> mRadii;
+
+	// Modified instances per Update, last mSlotSerials.size() of them. A slot written at serial S needs the ones after S.
+	std::vector<uint32_t> mPendingInstances;				// Since last Update, unique
+	std::vector<uint8_t> mPending;
+	std::vector<std::vector<uint32_t>> mHistory;			// Indexed by serial % size
+	std::vector<uint64_t> mSlotSerials;
+	uint64_t mSerial										= 0;
+
+	bool mRebuildRequested									= true;
+	Stats mStats;
+};
@@ -1,14 +1,7 @@
 #define TINYGLTF_IMPLEMENTATION
 #include "tiny_gltf.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "tinygltf/stb_image.h"
-
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "tinygltf/stb_image_write.h"
-
-#define TINYEXR_IMPLEMENTATION
-#include "tinyexr.h"
+// stb_image, stb_image_write and tinyexr are implemented in ThirdpartyPortable.cpp
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "Thirdparty/tinyobjloader/tiny_obj_loader.h"
@@ -0,0 +1,10 @@
+// Implementations needed by DXRPlaygroundPortable, the renderer links them from there
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "tinygltf/stb_image.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "tinygltf/stb_image_write.h"
+
+#define TINYEXR_IMPLEMENTATION
+#include "tinyexr.h"
@@ -0,0 +1,162 @@
+#include "TimingHistory.h"
+
+#include "Validate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <ostream>
+#include <random>
+
+void TimingHistory::Series::Add(float inValue)
+{
+	mSamples[mWriteCount % mSamples.size()]					= inValue;
+	mWriteCount++;
+}
+
+std::vector<float> TimingHistory::Series::Ordered() const
+{
+	std::vector<float> ordered;
+	ordered.reserve(Size());
+	uint64_t begin											= mWriteCount - Size();
+	for (uint64_t index = begin; index < mWriteCount; index++)
+		ordered.push_back(mSamples[index % mSamples.size()]);
+	return ordered;
+}
+
+// Nearest rank on sorted samples
+static float sPercentile(const std::vector<float>& inSorted, float inPercent)
+{
+	size_t rank												= static_cast<size_t>(std::ceil(inPercent / 100.0f * inSorted.size()));
+	return inSorted[std::clamp<size_t>(rank, 1, inSorted.size()) - 1];
+}
+
+TimingHistory::Statistics TimingHistory::Series::Compute() const
+{
+	Statistics statistics;
+	statistics.mCount										= Size();
+	if (statistics.mCount == 0)
+		return statistics;
+
+	std::vector<float> sorted								= Ordered();
+	std::sort(sorted.begin(), sorted.end());
+
+	double sum												= 0.0;
+	double squared_sum										= 0.0;
+	for (float value : sorted)
+	{
+		sum													+= value;
+		squared_sum											+= static_cast<double>(value) * value;
+	}
+	double mean												= sum / sorted.size();
+
+	statistics.mLast										= Last();
+	statistics.mMean										= static_cast<float>(mean);
+	statistics.mStdDev										= static_cast<float>(std::sqrt(std::max(squared_sum / sorted.size() - mean * mean, 0.0)));
+	statistics.mMin											= sorted.front();
+	statistics.mMax											= sorted.back();
+	statistics.mP50											= sPercentile(sorted, 50.0f);
+	statistics.mP95											= sPercentile(sorted, 95.0f);
+	statistics.mP99											= sPercentile(sorted, 99.0f);
+
+	// Median absolute deviation is not skewed by the spikes it is meant to find
+	// [NOTE] Floored to 1% of median, otherwise a near constant pass flags every tiny jitter
+	std::vector<float> deviations(sorted.size());
+	std::transform(sorted.begin(), sorted.end(), deviations.begin(), [&](float inValue) { return std::abs(inValue - statistics.mP50); });
+	std::sort(deviations.begin(), deviations.end());
+	float mad												= std::max(sPercentile(deviations, 50.0f), statistics.mP50 * 0.01f);
+
+	statistics.mOutlierThreshold							= statistics.mP50 + kOutlierMADScale * mad;
+	statistics.mOutlierCount								= static_cast<uint32_t>(sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), statistics.mOutlierThreshold));
+	return statistics;
+}
+
+void TimingHistory::Add(std::string_view inName, float inValue)
+{
+	auto iter												= std::find_if(mSeries.begin(), mSeries.end(), [&](const auto& inPair) { return inPair.first == inName; });
+	if (iter == mSeries.end())
+	{
+		mSeries.emplace_back(std::string(inName), Series(mCapacity));
+		iter												= mSeries.end() - 1;
+	}
+	iter->second.Add(inValue);
+}
+
+bool TimingHistory::AddTimestamps(std::string_view inName, uint64_t inBegin, uint64_t inEnd, uint64_t inFrequency)
+{
+	if (inBegin == 0 || inEnd < inBegin || inFrequency == 0)
+		return false;
+
+	Add(inName, static_cast<float>((inEnd - inBegin) * 1000.0 / inFrequency));
+	return true;
+}
+
+void TimingHistory::Clear()
+{
+	for (auto& [name, series] : mSeries)
+		series.Clear();
+}
+
+const TimingHistory::Series* TimingHistory::Find(std::string_view inName) const
+{
+	auto iter												= std::find_if(mSeries.begin(), mSeries.end(), [&](const auto& inPair) { return inPair.first == inName; });
+	return iter != mSeries.end() ? &iter->second : nullptr;
+}
+
+void TimingHistory::sWriteCSVHeader(std::ostream& ioStream)
+{
+	ioStream << "category,name,count,last_ms,mean_ms,stddev_ms,min_ms,max_ms,p50_ms,p95_ms,p99_ms,outlier_threshold_ms,outlier_count\n";
+}
+
+void TimingHistory::WriteCSV(std::ostream& ioStream, std::string_view inCategory) const
+{
+	for (const auto& [name, series] : mSeries)
+	{
+		Statistics statistics								= series.Compute();
+		ioStream << std::format("{},{},{},{},{},{},{},{},{},{},{},{},{}\n", inCategory, name, statistics.mCount, statistics.mLast, statistics.mMean, statistics.mStdDev,
+			statistics.mMin, statistics.mMax, statistics.mP50, statistics.mP95, statistics.mP99, statistics.mOutlierThreshold, statistics.mOutlierCount);
+	}
+}
+
+bool TimingHistory::sValidate(std::string& outMessage)
+{
+	constexpr uint64_t kFrequency							= 10'000'000;	// 10 MHz, typical of timestamp queries
+	constexpr uint32_t kFrameCount							= 1000;
+	constexpr uint32_t kSpikeInterval						= 100;
+	constexpr double kBaseMS								= 2.0;
+	constexpr double kSpikeMS								= 10.0;
+
+	TimingHistory history;
+	std::mt19937 random_engine(0);
+	std::normal_distribution<double> jitter_ms(0.0, 0.05);
+	uint64_t timestamp										= kFrequency;	// Non zero, zero marks an unresolved query
+	for (uint32_t frame_index = 0; frame_index < kFrameCount; frame_index++)
+	{
+		double duration_ms									= frame_index % kSpikeInterval == 0 ? kSpikeMS : kBaseMS + jitter_ms(random_engine);
+		uint64_t end										= timestamp + static_cast<uint64_t>(duration_ms * kFrequency / 1000.0);
+		history.AddTimestamps("Synthetic", timestamp, end, kFrequency);
+		timestamp											= end + kFrequency / 1000;
+	}
+
+	bool rejected											= !history.AddTimestamps("Synthetic", 0, 100, kFrequency) && !history.AddTimestamps("Synthetic", 200, 100, kFrequency);
+
+	// Window keeps the last kDefaultCapacity frames, spikes at frames 500, 600, ..., 900
+	uint32_t expected_spike_count							= 0;
+	for (uint32_t frame_index = kFrameCount - kDefaultCapacity; frame_index < kFrameCount; frame_index++)
+		expected_spike_count								+= frame_index % kSpikeInterval == 0 ? 1 : 0;
+
+	Statistics statistics									= history.Find("Synthetic")->Compute();
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "invalid pairs rejected",							rejected },
+		{ "count is capacity",								statistics.mCount == kDefaultCapacity },
+		{ "p50 near base",									std::abs(statistics.mP50 - kBaseMS) < 0.02 },
+		{ "p95 below spikes",								statistics.mP95 < kBaseMS + 0.2 },
+		{ "max is spike",									std::abs(statistics.mMax - kSpikeMS) < 0.01 },
+		{ "spikes are outliers",							statistics.mOutlierCount == expected_spike_count },
+	};
+
+	outMessage												= std::format("[TimingHistory] Validate: mean {:.3f} p50 {:.3f} p95 {:.3f} p99 {:.3f} max {:.3f} ms, outliers {}/{} (threshold {:.3f} ms)\n",
+		statistics.mMean, statistics.mP50, statistics.mP95, statistics.mP99, statistics.mMax, statistics.mOutlierCount, expected_spike_count, statistics.mOutlierThreshold);
+	return gReportValidateChecks(checks, outMessage);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// Standard library only, timestamps are plain integers so synthetic ones can be fed without a device
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Rolling window of timings per named pass with percentile statistics
+class TimingHistory
+{
+public:
+	static constexpr uint32_t kDefaultCapacity				= 512;		// Samples per series
+	static constexpr float kOutlierMADScale					= 5.0f;		// Outlier when above p50 + scale * median absolute deviation
+
+	struct Statistics
+	{
+		uint32_t mCount										= 0;
+		float mLast											= 0.0f;
+		float mMean											= 0.0f;
+		float mStdDev										= 0.0f;
+		float mMin											= 0.0f;
+		float mMax											= 0.0f;
+		float mP50											= 0.0f;
+		float mP95											= 0.0f;
+		float mP99											= 0.0f;
+		float mOutlierThreshold								= 0.0f;
+		uint32_t mOutlierCount								= 0;
+	};
+
+	class Series
+	{
+	public:
+		explicit Series(uint32_t inCapacity = kDefaultCapacity) : mSamples(inCapacity > 0 ? inCapacity : 1) {}
+
+		void Add(float inValue);
+		void Clear()										{ mWriteCount = 0; }
+
+		uint32_t Size() const								{ return static_cast<uint32_t>(mWriteCount < mSamples.size() ? mWriteCount : mSamples.size()); }
+		float Last() const									{ return mWriteCount > 0 ? mSamples[(mWriteCount - 1) % mSamples.size()] : 0.0f; }
+		std::vector<float> Ordered() const;					// Oldest first
+
+		Statistics Compute() const;
+
+	private:
+		std::vector<float> mSamples;
+		uint64_t mWriteCount								= 0;
+	};
+
+	// Series are kept in order of first use, which is the order passes are recorded
+	void Add(std::string_view inName, float inValue);
+	bool AddTimestamps(std::string_view inName, uint64_t inBegin, uint64_t inEnd, uint64_t inFrequency); // false when pair is not valid yet, e.g. readback of frames not rendered
+	void Clear();
+
+	uint32_t GetSeriesCount() const							{ return static_cast<uint32_t>(mSeries.size()); }
+	const std::string& GetName(uint32_t inIndex) const		{ return mSeries[inIndex].first; }
+	const Series& GetSeries(uint32_t inIndex) const			{ return mSeries[inIndex].second; }
+	const Series* Find(std::string_view inName) const;
+
+	// One row per series, inCategory as first column so several histories can share a file
+	static void sWriteCSVHeader(std::ostream& ioStream);
+	void WriteCSV(std::ostream& ioStream, std::string_view inCategory) const;
+
+	// Feeds synthetic timestamps with injected spikes and checks statistics, returns false and fills outMessage on mismatch
+	static bool sValidate(std::string& outMessage);
+
+	uint32_t mCapacity										= kDefaultCapacity;
+
+private:
+	std::vector<std::pair<std::string, Series>> mSeries;
+};
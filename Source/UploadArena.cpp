@@ -0,0 +1,299 @@
+#include "UploadArena.h"
+
+#include "Validate.h"
+
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <random>
+
+static uint64_t sAlignUp(uint64_t inValue, uint64_t inAlignment)
+{
+	return (inValue + inAlignment - 1) & ~(inAlignment - 1);
+}
+
+UploadArena::Allocation UploadArena::Allocate(uint64_t inSize, uint64_t inAlignment)
+{
+	uint64_t alignment										= std::max<uint64_t>(inAlignment, 1);
+	uint64_t size											= std::max<uint64_t>(inSize, 1);
+	assert((alignment & (alignment - 1)) == 0);
+
+	uint32_t block_index									= kInvalidBlockIndex;
+	if (size > mBlockSize)
+	{
+		// Dedicated block, active block is kept for the small ones following
+		block_index											= AcquireBlock(sAlignUp(size, kBlockAlignment));
+		mBlocks[block_index].mState							= BlockState::Pending;
+	}
+	else
+	{
+		if (mActiveBlockIndex != kInvalidBlockIndex)
+		{
+			Block& active									= mBlocks[mActiveBlockIndex];
+			if (sAlignUp(active.mCursor, alignment) + size > active.mSize)
+			{
+				mStats.mAbandonedBytes						+= active.mSize - active.mCursor;
+				active.mState								= BlockState::Pending;
+				mActiveBlockIndex							= kInvalidBlockIndex;
+			}
+		}
+
+		if (mActiveBlockIndex == kInvalidBlockIndex)
+		{
+			mActiveBlockIndex								= AcquireBlock(mBlockSize);
+			mBlocks[mActiveBlockIndex].mState				= BlockState::Active;
+		}
+		block_index											= mActiveBlockIndex;
+	}
+
+	Block& block											= mBlocks[block_index];
+	uint64_t offset											= sAlignUp(block.mCursor, alignment);
+	assert(offset + size <= block.mSize);
+
+	mStats.mPaddingBytes									+= offset - block.mCursor;
+	mStats.mAllocatedBytes									+= size;
+	mStats.mAllocationCount++;
+	block.mCursor											= offset + size;
+	block.mUnretiredCount++;
+
+	UpdateStats();
+	return { .mBlockIndex = block_index, .mOffset = offset, .mSize = size };
+}
+
+void UploadArena::Retire(uint64_t inFenceValue)
+{
+	for (Block& block : mBlocks)
+	{
+		if (block.mUnretiredCount == 0)
+			continue;
+
+		block.mFenceValue									= std::max(block.mFenceValue, inFenceValue);
+		block.mUnretiredCount								= 0;
+	}
+}
+
+void UploadArena::Recycle(uint64_t inCompletedFenceValue)
+{
+	uint32_t free_count										= 0;
+	for (Block& block : mBlocks)
+	{
+		bool completed										= block.mUnretiredCount == 0 && block.mFenceValue <= inCompletedFenceValue;
+		if (block.mState == BlockState::Pending && completed)
+		{
+			block.mState									= BlockState::Free;
+			block.mCursor									= 0;
+			mStats.mRecycledBlockCount++;
+		}
+		else if (block.mState == BlockState::Active && completed && block.mCursor > 0)
+		{
+			// Rewind in place, nothing in it is read anymore
+			block.mCursor									= 0;
+			mStats.mRecycledBlockCount++;
+		}
+
+		free_count											+= block.mState == BlockState::Free ? 1 : 0;
+	}
+
+	// Dedicated blocks are rarely reusable, release them first
+	for (uint32_t block_index = 0; block_index < mBlocks.size() && free_count > 0; block_index++)
+	{
+		if (mBlocks[block_index].mState == BlockState::Free && mBlocks[block_index].mSize != mBlockSize)
+		{
+			ReleaseBlock(block_index);
+			free_count--;
+		}
+	}
+	for (uint32_t block_index = 0; block_index < mBlocks.size() && free_count > mRetainedBlockCount; block_index++)
+	{
+		if (mBlocks[block_index].mState == BlockState::Free)
+		{
+			ReleaseBlock(block_index);
+			free_count--;
+		}
+	}
+
+	UpdateStats();
+}
+
+void UploadArena::Trim()
+{
+	if (mActiveBlockIndex != kInvalidBlockIndex && mBlocks[mActiveBlockIndex].mCursor == 0)
+	{
+		mBlocks[mActiveBlockIndex].mState					= BlockState::Free;
+		mActiveBlockIndex									= kInvalidBlockIndex;
+	}
+
+	for (uint32_t block_index = 0; block_index < mBlocks.size(); block_index++)
+		if (mBlocks[block_index].mState == BlockState::Free)
+			ReleaseBlock(block_index);
+
+	UpdateStats();
+}
+
+void UploadArena::Reset()
+{
+	for (uint32_t block_index = 0; block_index < mBlocks.size(); block_index++)
+		if (mBlocks[block_index].mState != BlockState::Released)
+			ReleaseBlock(block_index);
+
+	mActiveBlockIndex										= kInvalidBlockIndex;
+	UpdateStats();
+}
+
+void UploadArena::ResetPeaks()
+{
+	mStats.mPeakInFlightBytes								= mStats.mInFlightBytes;
+	mStats.mPeakCommittedBytes								= mStats.mCommittedBytes;
+	mStats.mPeakBlockCount									= mStats.mBlockCount;
+}
+
+uint32_t UploadArena::AcquireBlock(uint64_t inSize)
+{
+	// Smallest free block that fits
+	uint32_t best_index										= kInvalidBlockIndex;
+	for (uint32_t block_index = 0; block_index < mBlocks.size(); block_index++)
+	{
+		const Block& block									= mBlocks[block_index];
+		if (block.mState == BlockState::Free && block.mSize >= inSize && (best_index == kInvalidBlockIndex || block.mSize < mBlocks[best_index].mSize))
+			best_index										= block_index;
+	}
+	if (best_index != kInvalidBlockIndex)
+		return best_index;
+
+	auto released											= std::find_if(mBlocks.begin(), mBlocks.end(), [](const Block& inBlock) { return inBlock.mState == BlockState::Released; });
+	uint32_t block_index									= static_cast<uint32_t>(released - mBlocks.begin());
+	if (released == mBlocks.end())
+		mBlocks.emplace_back();
+
+	Block& block											= mBlocks[block_index];
+	block													= {};
+	block.mSize												= inSize;
+	block.mState											= BlockState::Free;
+	mStats.mCreatedBlockCount++;
+
+	if (mCreateBlock)
+		mCreateBlock(block_index, inSize);
+	return block_index;
+}
+
+void UploadArena::ReleaseBlock(uint32_t inBlockIndex)
+{
+	if (mReleaseBlock)
+		mReleaseBlock(inBlockIndex);
+
+	mBlocks[inBlockIndex]									= {};
+	mStats.mReleasedBlockCount++;
+}
+
+void UploadArena::UpdateStats()
+{
+	mStats.mInFlightBytes									= 0;
+	mStats.mCommittedBytes									= 0;
+	mStats.mBlockCount										= 0;
+	for (const Block& block : mBlocks)
+	{
+		if (block.mState == BlockState::Released)
+			continue;
+
+		mStats.mInFlightBytes								+= block.mCursor;
+		mStats.mCommittedBytes								+= block.mSize;
+		mStats.mBlockCount++;
+	}
+
+	mStats.mPeakInFlightBytes								= std::max(mStats.mPeakInFlightBytes, mStats.mInFlightBytes);
+	mStats.mPeakCommittedBytes								= std::max(mStats.mPeakCommittedBytes, mStats.mCommittedBytes);
+	mStats.mPeakBlockCount									= std::max(mStats.mPeakBlockCount, mStats.mBlockCount);
+}
+
+bool UploadArena::sValidate(std::string& outMessage)
+{
+	constexpr uint64_t kBlockSize							= 1ull << 20;
+	constexpr uint32_t kFrameCount							= 256;
+	constexpr uint32_t kFrameLatency						= 2;		// Fence of frame N completes when frame N + latency + 1 begins
+	constexpr uint64_t kAlignments[]						= { 4, 16, 256, 512, 64ull << 10 };
+
+	struct Live
+	{
+		Allocation mAllocation;
+		uint64_t mFenceValue								= 0;
+	};
+
+	UploadArena arena;
+	arena.mBlockSize										= kBlockSize;
+	std::vector<uint64_t> block_sizes;
+	uint32_t created_count									= 0;
+	uint32_t released_count									= 0;
+	arena.mCreateBlock										= [&](uint32_t inBlockIndex, uint64_t inSize) { block_sizes.resize(std::max<size_t>(block_sizes.size(), inBlockIndex + 1)); block_sizes[inBlockIndex] = inSize; created_count++; };
+	arena.mReleaseBlock										= [&](uint32_t inBlockIndex) { block_sizes[inBlockIndex] = 0; released_count++; };
+
+	bool aligned											= true;
+	bool in_bounds											= true;
+	bool disjoint											= true;
+	std::vector<Live> live;
+	auto add_live											= [&](const Allocation& inAllocation, uint64_t inAlignment, uint64_t inFenceValue)
+	{
+		aligned												&= inAllocation.mOffset % inAlignment == 0;
+		in_bounds											&= inAllocation.IsValid() && inAllocation.mBlockIndex < block_sizes.size() && inAllocation.mOffset + inAllocation.mSize <= block_sizes[inAllocation.mBlockIndex];
+		for (const Live& other : live)
+		{
+			if (other.mAllocation.mBlockIndex == inAllocation.mBlockIndex
+				&& other.mAllocation.mOffset < inAllocation.mOffset + inAllocation.mSize
+				&& inAllocation.mOffset < other.mAllocation.mOffset + other.mAllocation.mSize)
+				disjoint									= false;
+		}
+		live.push_back({ .mAllocation = inAllocation, .mFenceValue = inFenceValue });
+	};
+
+	std::mt19937 random_engine(0);
+	std::uniform_int_distribution<uint32_t> count_distribution(1, 32);
+	std::uniform_int_distribution<uint64_t> size_distribution(1, 64ull << 10);
+	std::uniform_int_distribution<uint32_t> alignment_distribution(0, static_cast<uint32_t>(std::size(kAlignments)) - 1);
+	for (uint64_t frame_index = 1; frame_index <= kFrameCount; frame_index++)
+	{
+		uint64_t completed_fence_value						= frame_index > kFrameLatency + 1 ? frame_index - kFrameLatency - 1 : 0;
+		arena.Recycle(completed_fence_value);
+		std::erase_if(live, [&](const Live& inLive) { return inLive.mFenceValue <= completed_fence_value; });
+
+		uint32_t allocation_count							= count_distribution(random_engine);
+		for (uint32_t allocation_index = 0; allocation_index < allocation_count; allocation_index++)
+		{
+			uint64_t alignment								= kAlignments[alignment_distribution(random_engine)];
+			uint64_t size									= allocation_index == 0 && frame_index % 64 == 0 ? kBlockSize + kBlockSize / 2 : size_distribution(random_engine); // Dedicated once in a while
+			add_live(arena.Allocate(size, alignment), alignment, frame_index);
+		}
+		arena.Retire(frame_index);
+	}
+	Stats loop_stats										= arena.GetStats();
+
+	// Not retired yet -> survives any completed fence value
+	live.clear();
+	add_live(arena.Allocate(1024, 256), 256, 0);
+	arena.Recycle(~0ull);
+	add_live(arena.Allocate(1024, 256), 256, 0);
+	arena.Retire(kFrameCount + 1);
+	arena.Recycle(kFrameCount + 1);
+	bool retained_bounded									= arena.GetStats().mBlockCount <= arena.mRetainedBlockCount + 1;
+	bool rewound											= arena.GetStats().mInFlightBytes == 0;
+
+	arena.Reset();
+	bool all_released										= created_count == released_count && arena.GetStats().mBlockCount == 0;
+
+	// Without recycling every frame would need new memory
+	uint64_t total_bytes									= loop_stats.mAllocatedBytes + loop_stats.mPaddingBytes + loop_stats.mAbandonedBytes;
+	std::vector<std::pair<std::string, bool>> checks		=
+	{
+		{ "offsets aligned",								aligned },
+		{ "allocations in block bounds",					in_bounds },
+		{ "live allocations disjoint",						disjoint },
+		{ "blocks recycled",								loop_stats.mRecycledBlockCount > 0 },
+		{ "blocks reused",									loop_stats.mCreatedBlockCount * kBlockSize < total_bytes / 4 },
+		{ "free blocks bounded",							retained_bounded },
+		{ "completed blocks rewound",						rewound },
+		{ "all blocks released",							all_released },
+	};
+
+	outMessage												= std::format("[UploadArena] Validate: {} allocations, {:.2f} MB, peak in flight {:.2f} MB, peak committed {:.2f} MB in {} blocks, {} created, {} recycled, fragmentation {:.1f}%\n",
+		loop_stats.mAllocationCount, loop_stats.mAllocatedBytes / 1048576.0, loop_stats.mPeakInFlightBytes / 1048576.0, loop_stats.mPeakCommittedBytes / 1048576.0,
+		loop_stats.mPeakBlockCount, loop_stats.mCreatedBlockCount, loop_stats.mRecycledBlockCount, loop_stats.Fragmentation() * 100.0f);
+	return gReportValidateChecks(checks, outMessage);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+// Standard library only, backing memory is created and released through callbacks so the policy can be validated without a device
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Linear suballocation of upload memory from a few large blocks
+// Allocations are retired with the fence value of the work reading them, blocks are recycled as a whole once that fence completes
+class UploadArena
+{
+public:
+	static constexpr uint64_t kDefaultBlockSize				= 64ull << 20;
+	static constexpr uint64_t kBlockAlignment				= 64ull << 10;	// Size granularity of dedicated blocks, matches buffer placement alignment
+	static constexpr uint32_t kDefaultRetainedBlockCount	= 2;			// Free blocks kept for reuse, others are released
+	static constexpr uint32_t kInvalidBlockIndex			= 0xFFFFFFFF;
+
+	struct Allocation
+	{
+		uint32_t mBlockIndex								= kInvalidBlockIndex;
+		uint64_t mOffset									= 0;
+		uint64_t mSize										= 0;
+
+		bool IsValid() const								{ return mBlockIndex != kInvalidBlockIndex; }
+	};
+
+	struct Stats
+	{
+		uint64_t mAllocationCount							= 0;
+		uint64_t mAllocatedBytes							= 0;	// As requested
+		uint64_t mPaddingBytes								= 0;	// Lost to alignment
+		uint64_t mAbandonedBytes							= 0;	// Tails of blocks left when next allocation did not fit
+		uint64_t mInFlightBytes								= 0;	// Used part of blocks not recycled yet
+		uint64_t mPeakInFlightBytes							= 0;
+		uint64_t mCommittedBytes							= 0;	// Size of all blocks, including free ones
+		uint64_t mPeakCommittedBytes						= 0;
+		uint32_t mBlockCount								= 0;
+		uint32_t mPeakBlockCount							= 0;
+		uint32_t mCreatedBlockCount							= 0;
+		uint32_t mRecycledBlockCount						= 0;
+		uint32_t mReleasedBlockCount						= 0;
+
+		float Fragmentation() const							{ uint64_t total = mAllocatedBytes + mPaddingBytes + mAbandonedBytes; return total > 0 ? static_cast<float>(mPaddingBytes + mAbandonedBytes) / total : 0.0f; }
+	};
+
+	std::function<void(uint32_t inBlockIndex, uint64_t inSize)> mCreateBlock;
+	std::function<void(uint32_t inBlockIndex)>				mReleaseBlock;
+	uint64_t mBlockSize										= kDefaultBlockSize;
+	uint32_t mRetainedBlockCount							= kDefaultRetainedBlockCount;
+
+	// inAlignment must be a power of two, offsets are relative to block start which is assumed to be at least kBlockAlignment aligned
+	Allocation Allocate(uint64_t inSize, uint64_t inAlignment);
+
+	// Everything allocated so far is in use until inFenceValue completes. Allocations not retired yet are never recycled.
+	void Retire(uint64_t inFenceValue);
+	void Recycle(uint64_t inCompletedFenceValue);
+
+	void Trim();											// Release all free blocks, active one too when empty
+	void Reset();											// Release all blocks, caller makes sure GPU is idle
+
+	const Stats& GetStats() const							{ return mStats; }
+	void ResetPeaks();
+
+	// Runs a synthetic frame loop with lagging fences and checks alignment, overlap of live allocations and block reuse
+	static bool sValidate(std::string& outMessage);
+
+private:
+	enum class BlockState : uint32_t
+	{
+		Active,		// Current block for linear allocation
+		Pending,	// Waiting for fence
+		Free,
+		Released,	// Slot can be reused
+	};
+
+	struct Block
+	{
+		uint64_t mSize										= 0;
+		uint64_t mCursor									= 0;
+		uint64_t mFenceValue								= 0;
+		uint32_t mUnretiredCount							= 0;
+		BlockState mState									= BlockState::Released;
+	};
+
+	uint32_t AcquireBlock(uint64_t inSize);
+	void ReleaseBlock(uint32_t inBlockIndex);
+	void UpdateStats();
+
+	std::vector<Block> mBlocks;
+	uint32_t mActiveBlockIndex								= kInvalidBlockIndex;
+	Stats mStats;
+};
@@ -0,0 +1,61 @@
+#include "Validate.h"
+
+#include "Animation.h"
+#include "BatchJob.h"
+#include "CloudNoise.h"
+#include "CopyPlan.h"
+#include "FrameEncoder.h"
+#include "LSSWireframe.h"
+#include "Profiler.h"
+#include "TLASUpdatePolicy.h"
+#include "TimingHistory.h"
+#include "UploadArena.h"
+
+#include <format>
+
+std::span<const ValidateEntry> gPortableValidateEntries()
+{
+	static const ValidateEntry kEntries[]					=
+	{
+		{ "Animation",										&Animation::sValidate },
+		{ "BatchJobFile",									&BatchJobFile::sValidate },
+		{ "CloudNoise",										&CloudNoise::sValidate },
+		{ "CopyPlan",										&CopyPlan::sValidate },
+		{ "FrameEncoder",									&FrameEncoder::sValidate },
+		{ "LSSWireframe",									&LSSWireframe::sValidate },
+		{ "Profiler",										&Profiler::sValidate },
+		{ "TLASUpdatePolicy",								&TLASUpdatePolicy::sValidate },
+		{ "TimingHistory",									&TimingHistory::sValidate },
+		{ "UploadArena",									&UploadArena::sValidate },
+	};
+	return kEntries;
+}
+
+bool gReportValidateChecks(std::span<const std::pair<std::string, bool>> inChecks, std::string& ioMessage)
+{
+	bool succeeded											= true;
+	for (const auto& [name, passed] : inChecks)
+	{
+		ioMessage											+= std::format("  {} {}\n", passed ? "[PASS]" : "[FAIL]", name);
+		succeeded											&= passed;
+	}
+	return succeeded;
+}
+
+int gRunValidateEntries(std::span<const ValidateEntry> inEntries, std::string& ioReport)
+{
+	int failure_count										= 0;
+	std::string failures;
+	for (const ValidateEntry& entry : inEntries)
+	{
+		std::string message;
+		if (!entry.mFunction(message))
+		{
+			failure_count++;
+			failures										+= std::format(" {}", entry.mName);
+		}
+		ioReport											+= message;
+	}
+	ioReport												+= std::format("[Validate] {} of {} failed{}\n", failure_count, inEntries.size(), failures);
+	return failure_count;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Standard library only, runs self checks of classes that need no device
+// Used by DXRPlayground -validate and DXRPlaygroundValidate, which builds on any platform
+#include <span>
+#include <string>
+#include <utility>
+
+struct ValidateEntry
+{
+	const char* mName										= nullptr;
+	bool (*mFunction)(std::string& outMessage)				= nullptr;
+};
+
+// Checks of one sValidate as name and result, each appended to ioMessage as "  [PASS] name" or "  [FAIL] name"
+// Returns true if all passed
+bool gReportValidateChecks(std::span<const std::pair<std::string, bool>> inChecks, std::string& ioMessage);
+
+// sValidate of classes in the portable source set, see CMakeLists.txt
+std::span<const ValidateEntry> gPortableValidateEntries();
+
+// Appends messages of all entries and a summary to ioReport, returns number of failures
+int gRunValidateEntries(std::span<const ValidateEntry> inEntries, std::string& ioReport);
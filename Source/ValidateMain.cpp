@@ -0,0 +1,12 @@
+#include "Validate.h"
+
+#include <iostream>
+
+// Entry of DXRPlaygroundValidate, exit code is the number of failures
+int main()
+{
+	std::string report;
+	int failure_count										= gRunValidateEntries(gPortableValidateEntries(), report);
+	std::cout << report;
+	return failure_count;
+}